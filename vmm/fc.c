@@ -151,14 +151,20 @@ fail:
 }
 
 _Success_(return)
-BOOL Fc_SqlInsertStr(_In_ VMM_HANDLE H, _In_ sqlite3_stmt *hStmt, _In_ LPCSTR usz, _Out_ PFCSQL_INSERTSTRTABLE pThis)
+BOOL Fc_SqlInsertStrLength(_In_ LPCSTR usz, _Out_ PFCSQL_INSERTSTRTABLE pThis)
 {
+    pThis->id = 0;
     if(!CharUtil_UtoU(usz, -1, NULL, 0, NULL, &pThis->cbu, 0)) { return FALSE; }
     pThis->cbu--;               // don't count null terminator.
     CharUtil_UtoJ(usz, -1, NULL, 0, NULL, &pThis->cbj, 0);      // # of bytes to represent JSON string (incl. null-terminator)
     if(pThis->cbj) { pThis->cbj--; }
     CharUtil_UtoCSV(usz, -1, NULL, 0, NULL, &pThis->cbv, 0);    // # of bytes to represent CSV string (incl. null-terminator)
     if(pThis->cbv) { pThis->cbv--; }
+    return TRUE;
+}
+
+VOID Fc_SqlInsertStrPrecalc(_In_ VMM_HANDLE H, _In_ sqlite3_stmt *hStmt, _In_ LPCSTR usz, _Inout_ PFCSQL_INSERTSTRTABLE pThis)
+{
     pThis->id = InterlockedIncrement64(&H->fc->db.qwIdStr);
     sqlite3_reset(hStmt);
     sqlite3_bind_int64(hStmt, 1, pThis->id);
@@ -167,6 +173,13 @@ BOOL Fc_SqlInsertStr(_In_ VMM_HANDLE H, _In_ sqlite3_stmt *hStmt, _In_ LPCSTR us
     sqlite3_bind_int(hStmt, 4, pThis->cbv);
     sqlite3_bind_text(hStmt, 5, usz, -1, NULL);
     sqlite3_step(hStmt);
+}
+
+_Success_(return)
+BOOL Fc_SqlInsertStr(_In_ VMM_HANDLE H, _In_ sqlite3_stmt *hStmt, _In_ LPCSTR usz, _Out_ PFCSQL_INSERTSTRTABLE pThis)
+{
+    if(!Fc_SqlInsertStrLength(usz, pThis)) { return FALSE; }
+    Fc_SqlInsertStrPrecalc(H, hStmt, usz, pThis);
     return TRUE;
 }
 
@@ -279,7 +292,7 @@ SIZE_T FcFileAppendEx(_In_ VMM_HANDLE H, _In_ LPCSTR uszFileName, _In_z_ _Printf
         // add/allocate new file:
         if(!(pObFcFile = Ob_AllocEx(H, OB_TAG_FC_FILE, LMEM_ZEROINIT, sizeof(FCOB_FILE), FcFile_CleanupCB, NULL))) { goto fail; }
         if(!CharUtil_UtoU(uszFileName, -1, (PBYTE)pObFcFile->uszName, _countof(pObFcFile->uszName), NULL, NULL, CHARUTIL_FLAG_STR_BUFONLY)) { goto fail; }
-        if(!(pObFcFile->pmf = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { goto fail; }
+        if(!(pObFcFile->pmf = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { goto fail; }
         if(!ObMap_Push(H->fc->FileCSV.pm, qwFileNameHash, pObFcFile)) { goto fail; }
     }
     ret = ObMemFile_AppendStringEx2(pObFcFile->pmf, uszFormat, arglist);
@@ -433,9 +446,9 @@ VOID FcEvilInitialize_ThreadProc(_In_ VMM_HANDLE H, _In_ QWORD qwNotUsed)
 {
     if(H->fAbort) { return; }
     if(!(H->fc->FindEvil.pm = ObMap_New(H, OB_MAP_FLAGS_NOKEY | OB_MAP_FLAGS_OBJECT_LOCALFREE))) { return; }
-    if(!(H->fc->FindEvil.pmf = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { return; }
-    if(!(H->fc->FindEvil.pmfYara = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { return; }
-    if(!(H->fc->FindEvil.pmfYaraRules = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { return; }
+    if(!(H->fc->FindEvil.pmf = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { return; }
+    if(!(H->fc->FindEvil.pmfYara = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { return; }
+    if(!(H->fc->FindEvil.pmfYaraRules = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { return; }
     if(!InfoDB_YaraRulesBuiltIn_Exists(H)) {
         ObMemFile_AppendStringEx(H->fc->FindEvil.pmfYara, FCEVIL_YARA_NO_BUILTIN_RULES, (H->cfg.fLicenseAcceptElasticV2 ? "ACCEPTED    " : "NOT ACCEPTED"));
     }
@@ -1431,6 +1444,43 @@ BOOL FcIsProcessSkip(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess)
         (H->cfg.ForensicProcessSkipList.cusz && CharUtil_StrCmpAnyEx(CharUtil_StrEquals, pProcess->szName, TRUE, H->cfg.ForensicProcessSkipList.cusz, (LPCSTR*)H->cfg.ForensicProcessSkipList.pusz));
 }
 
+VOID FcGetCompressionInfo_Add(_Inout_ POB_COMPRESSED_INFO pInfo, _In_opt_ POB_MEMFILE pmf)
+{
+    OB_COMPRESSED_INFO e;
+    if(!ObMemFile_GetCompressionInfo(pmf, &e)) { return; }
+    pInfo->cObjects += e.cObjects;
+    pInfo->cObjectsStored += e.cObjectsStored;
+    pInfo->cDecompress += e.cDecompress;
+    pInfo->cbUncompressed += e.cbUncompressed;
+    pInfo->cbCompressed += e.cbCompressed;
+    pInfo->qwCompressUs += e.qwCompressUs;
+    pInfo->qwDecompressUs += e.qwDecompressUs;
+}
+
+/*
+* Retrieve aggregated compression statistics of the in-memory forensic output
+* files (JSON, CSV and FindEvil).
+* -- H
+* -- pInfo
+*/
+VOID FcGetCompressionInfo(_In_ VMM_HANDLE H, _Out_ POB_COMPRESSED_INFO pInfo)
+{
+    PFCOB_FILE pObFcFile = NULL;
+    ZeroMemory(pInfo, sizeof(OB_COMPRESSED_INFO));
+    pInfo->tpCodec = VMM_CFG_COMPRESSED_CODEC(H);
+    if(!H->fc) { return; }
+    EnterCriticalSection(&H->fc->Lock);
+    FcGetCompressionInfo_Add(pInfo, H->fc->FileJSON.pGen);
+    FcGetCompressionInfo_Add(pInfo, H->fc->FileJSON.pReg);
+    FcGetCompressionInfo_Add(pInfo, H->fc->FindEvil.pmf);
+    FcGetCompressionInfo_Add(pInfo, H->fc->FindEvil.pmfYara);
+    FcGetCompressionInfo_Add(pInfo, H->fc->FindEvil.pmfYaraRules);
+    while((pObFcFile = ObMap_GetNext(H->fc->FileCSV.pm, pObFcFile))) {
+        FcGetCompressionInfo_Add(pInfo, pObFcFile->pmf);
+    }
+    LeaveCriticalSection(&H->fc->Lock);
+}
+
 
 
 // ----------------------------------------------------------------------------
@@ -1680,8 +1730,8 @@ BOOL FcInitialize_Impl(_In_ VMM_HANDLE H, _In_ DWORD dwDatabaseType, _In_ BOOL f
     if(H->fc) { FcClose(H); }
     if(!(H->fc = (PFC_CONTEXT)LocalAlloc(LMEM_ZEROINIT, sizeof(FC_CONTEXT)))) { goto fail; }
     InitializeCriticalSection(&H->fc->Lock);
-    if(!(H->fc->FileJSON.pGen = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { goto fail; }
-    if(!(H->fc->FileJSON.pReg = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { goto fail; }
+    if(!(H->fc->FileJSON.pGen = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { goto fail; }
+    if(!(H->fc->FileJSON.pReg = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { goto fail; }
     if(!(H->fc->FileCSV.pm = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
     // 2: SQLITE INIT:
     if(SQLITE_CONFIG_MULTITHREAD != sqlite3_threadsafe()) {
@@ -133,6 +133,14 @@ VOID FcClose(_In_ VMM_HANDLE H);
 
 BOOL FcIsProcessSkip(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess);
 
+/*
+* Retrieve aggregated compression statistics of the in-memory forensic output
+* files (JSON, CSV and FindEvil).
+* -- H
+* -- pInfo
+*/
+VOID FcGetCompressionInfo(_In_ VMM_HANDLE H, _Out_ POB_COMPRESSED_INFO pInfo);
+
 
 
 // ----------------------------------------------------------------------------
@@ -209,6 +217,35 @@ BOOL Fc_SqlInsertStr(
     _Out_ PFCSQL_INSERTSTRTABLE pThis
 );
 
+/*
+* Calculate the byte counts of a string to be inserted into the database 'str'
+* table without inserting it. Thread-safe and may be called concurrently. The
+* string is later inserted with Fc_SqlInsertStrPrecalc().
+* -- usz = utf-8 string to be inserted
+* -- pThis = receives the byte counts (id is set to zero).
+* -- return
+*/
+_Success_(return)
+BOOL Fc_SqlInsertStrLength(
+    _In_ LPCSTR usz,
+    _Out_ PFCSQL_INSERTSTRTABLE pThis
+);
+
+/*
+* Insert a string with byte counts previously calculated by the function
+* Fc_SqlInsertStrLength() into the database 'str' table.
+* -- H
+* -- hStmt
+* -- usz = utf-8 string to be inserted
+* -- pThis = byte counts; receives the string id.
+*/
+VOID Fc_SqlInsertStrPrecalc(
+    _In_ VMM_HANDLE H,
+    _In_ sqlite3_stmt *hStmt,
+    _In_ LPCSTR usz,
+    _Inout_ PFCSQL_INSERTSTRTABLE pThis
+);
+
 /*
 * Helper function to do multiple 64-bit binds towards a statement in a 
 * convenient way. NB! 32-bit DWORDs must be casted to 64-bit QWORD to
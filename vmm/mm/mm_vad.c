@@ -458,23 +458,28 @@ int MmVad_CmpVadEntry(const void *v1, const void *v2)
         (*(PQWORD)v1 > * (PQWORD)v2) ? 1 : 0;
 }
 
-BOOL MmVad_Spider_PoolTagAny(_In_ DWORD dwPoolTag, _In_ DWORD cPoolTag, ...)
+typedef PVMM_MAP_VADENTRY(*PFN_MMVAD_SPIDER)(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead);
+
+/*
+* Check whether a pool tag is one of the VAD pool tags.
+* -- dwPoolTag
+* -- return
+*/
+__forceinline BOOL MmVad_Spider_PoolTagVad(_In_ DWORD dwPoolTag)
 {
-    va_list argp;
-    dwPoolTag = _byteswap_ulong(dwPoolTag);
-    va_start(argp, cPoolTag);
-    while(cPoolTag) {
-        if(dwPoolTag == va_arg(argp, DWORD)) {
-            va_end(argp);
+    switch(_byteswap_ulong(dwPoolTag)) {
+        case MMVAD_POOLTAG_VADS:
+        case MMVAD_POOLTAG_VAD:
+        case MMVAD_POOLTAG_VADL:
+        case MMVAD_POOLTAG_VADM:
+        case MMVAD_POOLTAG_VADF:
             return TRUE;
-        }
-        cPoolTag--;
+        default:
+            return FALSE;
     }
-    va_end(argp);
-    return FALSE;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_XP(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwReserved)
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_XP(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
 {
     _MMVAD32_XP v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -482,7 +487,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_XP(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -511,7 +516,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_XP(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     return e;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwReserved)
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
 {
     _MMVAD32_7 v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -519,7 +524,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pS
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -547,7 +552,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pS
     return e;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwReserved)
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
 {
     _MMVAD64_7 v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -555,7 +560,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pS
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -583,7 +588,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_7(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pS
     return e;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwReserved)
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
 {
     _MMVAD32_80 v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -591,7 +596,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -620,7 +625,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     return e;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwReserved)
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
 {
     _MMVAD64_80 v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -628,7 +633,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -657,7 +662,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_80(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     return e;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwFlagsBitMask)
+__forceinline PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10_Core(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD oVadType, _In_ DWORD oProtection, _In_ DWORD oPrivateMemory)
 {
     _MMVAD32_10 v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -665,7 +670,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -680,9 +685,9 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     e->vaEnd = ((QWORD)v.EndingVpn << 12) | 0xfff;
     e->CommitCharge = v.CommitCharge;
     e->MemCommit = v.MemCommit;
-    e->VadType = 0x07 & (v.u >> (dwFlagsBitMask & 0xff));
-    e->Protection = 0x1f & (v.u >> ((dwFlagsBitMask >> 8) & 0xff));
-    e->fPrivateMemory = 0x01 & (v.u >> ((dwFlagsBitMask >> 16) & 0xff));
+    e->VadType = 0x07 & (v.u >> oVadType);
+    e->Protection = 0x1f & (v.u >> oProtection);
+    e->fPrivateMemory = 0x01 & (v.u >> oPrivateMemory);
     // full vad
     if(v.PoolTag == MMVAD_POOLTAG_VADS) { return e; }
     e->flags[2] = v.u2;
@@ -694,7 +699,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     return e;
 }
 
-PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwFlagsBitMask)
+__forceinline PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10_Core(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD oVadType, _In_ DWORD oProtection, _In_ DWORD oPrivateMemory)
 {
     _MMVAD64_10 v = { 0 };
     PVMM_MAP_VADENTRY e;
@@ -702,7 +707,7 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
         ObSet_Push(psTry2, va);
         return NULL;
     }
-    if((v.EndingVpnHigh < v.StartingVpnHigh) || (v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+    if((v.EndingVpnHigh < v.StartingVpnHigh) || (v.EndingVpn < v.StartingVpn) || !MmVad_Spider_PoolTagVad(v.PoolTag)) {
         return NULL;
     }
     // short vad
@@ -717,9 +722,9 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     e->vaEnd = ((QWORD)v.EndingVpnHigh << (32 + 12)) | ((QWORD)v.EndingVpn << 12) | 0xfff;
     e->CommitCharge = (DWORD)v.CommitCharge;
     e->MemCommit = (DWORD)v.MemCommit;
-    e->VadType = 0x07 & (v.u >> (dwFlagsBitMask & 0xff));
-    e->Protection = 0x1f & (v.u >> ((dwFlagsBitMask >> 8) & 0xff));
-    e->fPrivateMemory = 0x01 & (v.u >> ((dwFlagsBitMask >> 16) & 0xff));
+    e->VadType = 0x07 & (v.u >> oVadType);
+    e->Protection = 0x1f & (v.u >> oProtection);
+    e->fPrivateMemory = 0x01 & (v.u >> oPrivateMemory);
     // full vad
     if(v.PoolTag == MMVAD_POOLTAG_VADS) { return e; }
     e->flags[2] = (DWORD)v.u2;
@@ -731,16 +736,92 @@ PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS p
     return e;
 }
 
+/*
+* Win10+ VAD spider functions specialized per _MMVAD_FLAGS bit layout. The bit
+* offsets of VadType:Protection:PrivateMemory are compile time constants which
+* allows the compiler to generate a branch-light walker for each build family.
+*/
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10_10240(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD32_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 0, 3, 15);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10_17134(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD32_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 0, 3, 14);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10_18362(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD32_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 4, 7, 20);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD32_10_20348(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD32_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 4, 7, 21);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10_10240(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD64_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 0, 3, 15);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10_17134(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD64_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 0, 3, 14);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10_18362(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD64_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 4, 7, 20);
+}
+
+PVMM_MAP_VADENTRY MmVad_Spider_MMVAD64_10_20348(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead)
+{
+    return MmVad_Spider_MMVAD64_10_Core(H, pSystemProcess, va, pmVad, psAll, psTry1, psTry2, fVmmRead, 4, 7, 21);
+}
+
+/*
+* Retrieve the VAD spider function matching the _MMVAD layout of the analyzed
+* Windows build family.
+* -- H
+* -- return
+*/
+PFN_MMVAD_SPIDER MmVad_Spider_GetFn(_In_ VMM_HANDLE H)
+{
+    BOOL f32 = H->vmm.f32;
+    DWORD dwVersionBuild = H->vmm.kernel.dwVersionBuild;
+    if(dwVersionBuild >= 20348) {
+        return f32 ? MmVad_Spider_MMVAD32_10_20348 : MmVad_Spider_MMVAD64_10_20348;
+    }
+    if(dwVersionBuild >= 18362) {
+        return f32 ? MmVad_Spider_MMVAD32_10_18362 : MmVad_Spider_MMVAD64_10_18362;
+    }
+    if(dwVersionBuild >= 17134) {
+        return f32 ? MmVad_Spider_MMVAD32_10_17134 : MmVad_Spider_MMVAD64_10_17134;
+    }
+    if(dwVersionBuild >= 9600) {    // Win8.1 and later: bit offset of VadType:Protection:PrivateMemory varies.
+        return f32 ? MmVad_Spider_MMVAD32_10_10240 : MmVad_Spider_MMVAD64_10_10240;
+    }
+    if(dwVersionBuild >= 9200) {    // Win8.0
+        return f32 ? MmVad_Spider_MMVAD32_80 : MmVad_Spider_MMVAD64_80;
+    }
+    if(dwVersionBuild >= 6000) {    // WinVista :: Win7
+        return f32 ? MmVad_Spider_MMVAD32_7 : MmVad_Spider_MMVAD64_7;
+    }
+    return MmVad_Spider_MMVAD32_XP; // WinXP
+}
+
 VOID MmVad_Spider_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ PVMM_PROCESS pProcess, _In_ QWORD fVmmRead)
 {
     BOOL f, f32 = H->vmm.f32;
     DWORD dwVersionBuild = H->vmm.kernel.dwVersionBuild;
     QWORD i, va, fVmmReadSpider;
-    DWORD cMax, cVads, dwFlagsBitMask = 0;
+    DWORD cMax, cVads;
     PVMM_MAP_VADENTRY eVad;
     PVMMOB_MAP_VAD pmObVad = NULL, pmObVadTemp;
     POB_SET psObAll = NULL, psObTry1 = NULL, psObTry2 = NULL, psObPrefetch = NULL;
-    PVMM_MAP_VADENTRY(*pfnMmVad_Spider)(VMM_HANDLE, PVMM_PROCESS, QWORD, PVMMOB_MAP_VAD, POB_SET, POB_SET, POB_SET, QWORD, DWORD);
+    PFN_MMVAD_SPIDER pfnMmVad_Spider;
     if(!(H->vmm.tpSystem == VMM_SYSTEM_WINDOWS_64 || H->vmm.tpSystem == VMM_SYSTEM_WINDOWS_32)) { goto fail; }
     // 1: retrieve # of VAD entries and sanity check.
     if(dwVersionBuild >= 9600) {
@@ -780,28 +861,7 @@ VOID MmVad_Spider_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _I
         ObSet_Push(psObTry2, va);
     }
     if(!ObSet_Size(psObTry2)) { goto fail; }
-    if(dwVersionBuild >= 9600) {
-        // Win8.1 and later
-        pfnMmVad_Spider = f32 ? MmVad_Spider_MMVAD32_10 : MmVad_Spider_MMVAD64_10;
-        if(dwVersionBuild >= 20348) {    // bitmask offset for empty:PrivateMemory:Protection:VadType
-            dwFlagsBitMask = 0x00150704;
-        } else if(dwVersionBuild >= 18362) {
-            dwFlagsBitMask = 0x00140704;
-        } else if(dwVersionBuild >= 17134) {
-            dwFlagsBitMask = 0x000e0300;
-        } else {
-            dwFlagsBitMask = 0x000f0300;
-        }
-    } else if(dwVersionBuild >= 9200) {
-        // Win8.0
-        pfnMmVad_Spider = f32 ? MmVad_Spider_MMVAD32_80 : MmVad_Spider_MMVAD64_80;
-    } else if(dwVersionBuild >= 6000) {
-        // WinVista :: Win7
-        pfnMmVad_Spider = f32 ? MmVad_Spider_MMVAD32_7 : MmVad_Spider_MMVAD64_7;
-    } else {
-        // WinXP
-        pfnMmVad_Spider = MmVad_Spider_MMVAD32_XP;
-    }
+    pfnMmVad_Spider = MmVad_Spider_GetFn(H);
     // 4: cache: prefetch previous addresses
     if((psObPrefetch = ObContainer_GetOb(pProcess->pObPersistent->pObCMapVadPrefetch))) {
         VmmCachePrefetchPages3(H, pSystemProcess, psObPrefetch, sizeof(_MMVAD64_10), fVmmRead);
@@ -818,7 +878,7 @@ VOID MmVad_Spider_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _I
         // fetch vad entries 2nd attempt
         VmmCachePrefetchPages3(H, pSystemProcess, psObTry2, sizeof(_MMVAD64_10), fVmmReadSpider);
         while((pmObVad->cMap < cMax) && (va = ObSet_Pop(psObTry2))) {
-            if((eVad = pfnMmVad_Spider(H, pSystemProcess, va, pmObVad, psObAll, psObTry1, NULL, fVmmReadSpider, dwFlagsBitMask))) {
+            if((eVad = pfnMmVad_Spider(H, pSystemProcess, va, pmObVad, psObAll, psObTry1, NULL, fVmmReadSpider))) {
                 if(eVad->CommitCharge > ((eVad->vaEnd + 1 - eVad->vaStart) >> 12)) { eVad->CommitCharge = 0; }
                 eVad->vaVad = va + (f32 ? 8 : 0x10);
                 eVad->cbuText = 1;
@@ -828,7 +888,7 @@ VOID MmVad_Spider_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _I
         }
         // fetch vad entries 1st attempt
         while((pmObVad->cMap < cMax) && (ObSet_Size(psObTry2) < (VMM_CACHE_REGION_MEMS_PHYS >> 1)) && (va = ObSet_Pop(psObTry1))) {
-            if((eVad = pfnMmVad_Spider(H, pSystemProcess, va, pmObVad, psObAll, psObTry1, psObTry2, fVmmReadSpider, dwFlagsBitMask))) {
+            if((eVad = pfnMmVad_Spider(H, pSystemProcess, va, pmObVad, psObAll, psObTry1, psObTry2, fVmmReadSpider))) {
                 if(eVad->CommitCharge > ((eVad->vaEnd + 1 - eVad->vaStart) >> 12)) { eVad->CommitCharge = 0; }
                 eVad->vaVad = va + (f32 ? 8 : 0x10);
                 eVad->cbuText = 1;
@@ -1113,6 +1173,51 @@ VOID MmVad_PrototypePteArray_FetchNew(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSyst
     LocalFree(pbData);
 }
 
+/*
+* Fetch the prototype pte arrays of a range of vads into the cache in a batch.
+* All pages spanned by the not already cached prototype pte arrays (including
+* any pool header) are prefetched as one deduplicated scatter read before the
+* individual arrays are decoded from the cache.
+* -- H
+* -- pSystemProcess
+* -- pProcess
+* -- pVadMap
+* -- iVad = index of first vad in pVadMap.
+* -- cVad = number of vads.
+* -- cbMax = max prototype pte array size to include (max 0x00010000).
+* -- fVmmRead
+*/
+VOID MmVad_PrototypePteArray_FetchBatch(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ PVMM_PROCESS pProcess, _In_ PVMMOB_MAP_VAD pVadMap, _In_ DWORD iVad, _In_ DWORD cVad, _In_ DWORD cbMax, _In_ QWORD fVmmRead)
+{
+    QWORD i, va, vaEnd;
+    PVMM_MAP_VADENTRY peVad;
+    POB_SET psObPrefetch = NULL;
+    if(!(psObPrefetch = ObSet_New(H))) { return; }
+    cVad = min(cVad, pVadMap->cMap - min(iVad, pVadMap->cMap));
+    // 1: gather pages of uncached prototype pte arrays (max pool header offset included)
+    for(i = iVad; i < iVad + cVad; i++) {
+        peVad = pVadMap->pMap + i;
+        if(!peVad->vaPrototypePte || !peVad->cbPrototypePte || (peVad->cbPrototypePte > cbMax) || ObMap_ExistsKey(H->vmm.Cache.pmPrototypePte, peVad->vaPrototypePte)) { continue; }
+        va = (peVad->vaPrototypePte - ((peVad->vaPrototypePte & 0xfff) ? 0x60 : 0)) & ~0xfff;
+        vaEnd = peVad->vaPrototypePte + peVad->cbPrototypePte;
+        for(; va < vaEnd; va += 0x1000) {
+            ObSet_Push(psObPrefetch, va);
+        }
+    }
+    if(!ObSet_Size(psObPrefetch)) { goto fail; }
+    VmmCachePrefetchPages3(H, pSystemProcess, psObPrefetch, 0x1000, fVmmRead);
+    // 2: decode prototype pte arrays from cache
+    EnterCriticalSection(&pProcess->LockUpdate);
+    for(i = iVad; i < iVad + cVad; i++) {
+        peVad = pVadMap->pMap + i;
+        if(!peVad->vaPrototypePte || !peVad->cbPrototypePte || (peVad->cbPrototypePte > cbMax) || ObMap_ExistsKey(H->vmm.Cache.pmPrototypePte, peVad->vaPrototypePte)) { continue; }
+        MmVad_PrototypePteArray_FetchNew(H, pSystemProcess, peVad, fVmmRead | VMM_FLAG_FORCECACHE_READ);
+    }
+    LeaveCriticalSection(&pProcess->LockUpdate);
+fail:
+    Ob_DECREF(psObPrefetch);
+}
+
 /*
 * Retrieve an object manager object containing the prototype pte's. THe object
 * will be retrieved from cache if possible, otherwise a read will be attempted
@@ -1124,9 +1229,7 @@ VOID MmVad_PrototypePteArray_FetchNew(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSyst
 */
 POB_DATA MmVad_PrototypePteArray_Get(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_VADENTRY pVad, _In_ QWORD fVmmRead)
 {
-    QWORD i, va;
     POB_DATA e = NULL;
-    POB_SET psObPrefetch = NULL;
     PVMM_PROCESS pObSystemProcess = NULL;
     PVMMOB_MAP_VAD pVadMap;
     if(!pVad->vaPrototypePte || !pVad->cbPrototypePte) { return NULL; }
@@ -1137,25 +1240,13 @@ POB_DATA MmVad_PrototypePteArray_Get(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProce
         return e;
     }
     if((pObSystemProcess = VmmProcessGet(H, 4))) {
-        if(!pProcess->Map.pObVad->fSpiderPrototypePte && pVad->cbPrototypePte < 0x1000 && (psObPrefetch = ObSet_New(H))) {
+        if(!pProcess->Map.pObVad->fSpiderPrototypePte && pVad->cbPrototypePte < 0x1000) {
             pVadMap = pProcess->Map.pObVad;
             // spider all prototype pte's less than 0x1000 in size into the cache
             pVadMap->fSpiderPrototypePte = TRUE;
-            for(i = 0; i < pVadMap->cMap; i++) {
-                va = pVadMap->pMap[i].vaPrototypePte;
-                if(va && (pVadMap->pMap[i].cbPrototypePte < 0x1000) && !ObMap_ExistsKey(H->vmm.Cache.pmPrototypePte, va)) {
-                    ObSet_Push(psObPrefetch, va);
-                }
-            }
-            VmmCachePrefetchPages3(H, pObSystemProcess, psObPrefetch, 0x1000, fVmmRead);
-            for(i = 0; i < pVadMap->cMap; i++) {
-                va = pVadMap->pMap[i].vaPrototypePte;
-                if(va && (pVadMap->pMap[i].cbPrototypePte < 0x1000) && !ObMap_ExistsKey(H->vmm.Cache.pmPrototypePte, va)) {
-                    MmVad_PrototypePteArray_FetchNew(H, pObSystemProcess, pVadMap->pMap + i, fVmmRead | VMM_FLAG_FORCECACHE_READ);
-                }
-            }
-            Ob_DECREF(psObPrefetch);
-        } else {
+            MmVad_PrototypePteArray_FetchBatch(H, pObSystemProcess, pProcess, pVadMap, 0, pVadMap->cMap, 0x0fff, fVmmRead);
+        }
+        if(!ObMap_ExistsKey(H->vmm.Cache.pmPrototypePte, pVad->vaPrototypePte)) {
             // fetch single vad prototypte pte array into the cache
             MmVad_PrototypePteArray_FetchNew(H, pObSystemProcess, pVad, fVmmRead);
         }
@@ -1445,7 +1536,8 @@ PVMMOB_MAP_VADEX MmVadEx_MapInitialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pPro
 {
     DWORD iVadEx = 0, iPageCurrent, cPageCurrent;
     POB_DATA pObProtoPteArray = NULL;
-    PVMM_MAP_VADENTRY peVad = NULL;
+    PVMM_MAP_VADENTRY peVad = NULL, peVadLast = NULL;
+    PVMM_PROCESS pObSystemProcess = NULL;
     PVMM_MAP_VADEXENTRY pex;
     PVMMOB_MAP_PTE pObPte = NULL;
     PVMMOB_MAP_VAD pObVad = NULL;
@@ -1459,7 +1551,15 @@ PVMMOB_MAP_VADEX MmVadEx_MapInitialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pPro
     if(!pObVadEx) { goto fail; }
     pObVadEx->pVadMap = Ob_INCREF(pObVad);
     pObVadEx->cMap = cPage;
-    // 3: fill extended vad map entries with va and peVad
+    // 3: batch fetch prototype pte arrays of all vads in range into the cache
+    if(cPage && (peVad = Util_qfind((QWORD)iPage, pObVad->cMap, pObVad->pMap, sizeof(VMM_MAP_VADENTRY), MmVadEx_VadEntryFind_CmpFind))) {
+        peVadLast = Util_qfind((QWORD)iPage + cPage - 1, pObVad->cMap, pObVad->pMap, sizeof(VMM_MAP_VADENTRY), MmVadEx_VadEntryFind_CmpFind);
+        if(peVadLast && (peVadLast != peVad) && (pObSystemProcess = VmmProcessGet(H, 4))) {
+            MmVad_PrototypePteArray_FetchBatch(H, pObSystemProcess, pProcess, pObVad, (DWORD)(peVad - pObVad->pMap), (DWORD)(peVadLast - peVad + 1), 0x00010000, 0);
+            Ob_DECREF_NULL(&pObSystemProcess);
+        }
+    }
+    // 4: fill extended vad map entries with va and peVad
     iPageCurrent = iPage;
     while(iPageCurrent < iPage + cPage) {
         peVad = Util_qfind((QWORD)iPageCurrent, pObVad->cMap, pObVad->pMap, sizeof(VMM_MAP_VADENTRY), MmVadEx_VadEntryFind_CmpFind);
@@ -1468,7 +1568,7 @@ PVMMOB_MAP_VADEX MmVadEx_MapInitialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pPro
         MmVadEx_EntryPrefill(H, pProcess, pObPte, peVad, cPageCurrent, iPageCurrent - peVad->cVadExPagesBase, pObVadEx->pMap + iPageCurrent - iPage);
         iPageCurrent += cPageCurrent;
     }
-    // 4: fill page table information with hardware mappings
+    // 5: fill page table information with hardware mappings
     iVadEx = 0;
     while(iVadEx < pObVadEx->cMap) {
         if(pObVadEx->pMap[iVadEx].va) {
@@ -1477,7 +1577,7 @@ PVMMOB_MAP_VADEX MmVadEx_MapInitialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pPro
             iVadEx++;
         }
     }
-    // 5: fill page table information with software mappings
+    // 6: fill page table information with software mappings
     for(iVadEx = 0; iVadEx < pObVadEx->cMap; iVadEx++) {
         pex = pObVadEx->pMap + iVadEx;
         if(pex->tp == VMM_PTE_TP_NA) {
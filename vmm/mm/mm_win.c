@@ -63,10 +63,22 @@ typedef struct tdMMWIN_MEMCOMPRESS_CONTEXT {
     MMWIN_MEMCOMPRESS_OFFSET O;
 } MMWIN_MEMCOMPRESS_CONTEXT, *PMMWIN_MEMCOMPRESS_CONTEXT;
 
+#define MMWIN_PROTOMEMO_ENTRIES                     0x00010000  // power of two
+#define MMWIN_PROTOMEMO_INDEX(vaProto)              ((DWORD)(((vaProto) >> 3) ^ ((vaProto) >> 19)) & (MMWIN_PROTOMEMO_ENTRIES - 1))
+#define MMWIN_PROTOMEMO_FLAGS_BYPASS                (VMM_FLAG_NOCACHE | VMM_FLAG_FORCECACHE_READ | VMM_FLAG_NOPAGING | VMM_FLAG_NOPAGING_IO | VMM_FLAG_CACHE_RECENT_ONLY)
+
+typedef struct tdMMWIN_PROTOMEMO_ENTRY {
+    QWORD vaProto;
+    QWORD pte;
+    QWORD tc;                   // H->vmm.tcRefreshMEM at time of resolve.
+    QWORD qwCheck;              // vaProto ^ pte ^ tc (detect torn entries) - only accessed with interlocked operations.
+} MMWIN_PROTOMEMO_ENTRY, *PMMWIN_PROTOMEMO_ENTRY;
+
 typedef struct tdMMWIN_CONTEXT {
     CRITICAL_SECTION Lock;
     FILE *pPageFile[10];
     MMWIN_MEMCOMPRESS_CONTEXT MemCompress;
+    PMMWIN_PROTOMEMO_ENTRY pProtoMemo;
 } MMWIN_CONTEXT, *PMMWIN_CONTEXT;
 
 
@@ -1169,6 +1181,69 @@ BOOL MmWin_PfRead(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD
 
 
 
+//-----------------------------------------------------------------------------
+// PROTOTYPE PTE MEMOIZATION BELOW:
+// Shared image pages (such as ntdll.dll) in different processes point to the
+// same prototype PTE. Resolved prototype PTEs are remembered in a small direct
+// mapped table, keyed by prototype PTE address, until the next memory refresh
+// so that they are dereferenced once system-wide rather than once per process.
+// The table is lock-free: a writer clears the check word, writes the entry and
+// publishes the check word with interlocked (full barrier) exchanges. A reader
+// reads the check word before and after the entry and rejects the entry if the
+// check words differ or don't match the entry (torn / concurrently written).
+// Reads with flags restricting how memory may be retrieved bypass the table.
+//-----------------------------------------------------------------------------
+
+/*
+* Retrieve a memoized prototype PTE.
+* -- H
+* -- vaProto = address of the prototype PTE.
+* -- fVmmRead
+* -- ppte
+* -- return
+*/
+_Success_(return)
+BOOL MmWin_ProtoMemo_Get(_In_ VMM_HANDLE H, _In_ QWORD vaProto, _In_ QWORD fVmmRead, _Out_ PQWORD ppte)
+{
+    QWORD qwCheck;
+    MMWIN_PROTOMEMO_ENTRY e;
+    PMMWIN_PROTOMEMO_ENTRY pe;
+    PMMWIN_CONTEXT ctx = H->vmm.pMmContext;
+    if(!ctx || !ctx->pProtoMemo || (fVmmRead & MMWIN_PROTOMEMO_FLAGS_BYPASS)) { return FALSE; }
+    pe = ctx->pProtoMemo + MMWIN_PROTOMEMO_INDEX(vaProto);
+    if(!(qwCheck = InterlockedCompareExchange64(&pe->qwCheck, 0, 0))) { return FALSE; }
+    e.vaProto = pe->vaProto;
+    e.pte = pe->pte;
+    e.tc = pe->tc;
+    if(qwCheck != InterlockedCompareExchange64(&pe->qwCheck, 0, 0)) { return FALSE; }
+    if((e.vaProto != vaProto) || (e.tc != H->vmm.tcRefreshMEM) || (qwCheck != (e.vaProto ^ e.pte ^ e.tc))) { return FALSE; }
+    *ppte = e.pte;
+    return TRUE;
+}
+
+/*
+* Memoize a successfully resolved prototype PTE.
+* -- H
+* -- vaProto = address of the prototype PTE.
+* -- pte
+*/
+VOID MmWin_ProtoMemo_Put(_In_ VMM_HANDLE H, _In_ QWORD vaProto, _In_ QWORD pte)
+{
+    QWORD tc;
+    PMMWIN_PROTOMEMO_ENTRY pe;
+    PMMWIN_CONTEXT ctx = H->vmm.pMmContext;
+    if(!ctx || !ctx->pProtoMemo || !pte) { return; }
+    tc = H->vmm.tcRefreshMEM;
+    pe = ctx->pProtoMemo + MMWIN_PROTOMEMO_INDEX(vaProto);
+    InterlockedExchange64(&pe->qwCheck, 0);
+    pe->vaProto = vaProto;
+    pe->pte = pte;
+    pe->tc = tc;
+    InterlockedExchange64(&pe->qwCheck, vaProto ^ pte ^ tc);
+}
+
+
+
 //-----------------------------------------------------------------------------
 // X86 VIRTUAL MEMORY BELOW:
 //-----------------------------------------------------------------------------
@@ -1182,12 +1257,15 @@ BOOL MmWin_PfRead(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD
 */
 DWORD MmWinX86_Prototype(_In_ VMM_HANDLE H, _In_ DWORD pte, _In_ QWORD fVmmRead)
 {
-    DWORD cbRead, dwPtePage = 0;
-    VmmReadEx(H, PVMM_PROCESS_SYSTEM, MMWINX86_PTE_PROTOTYPE(pte), (PBYTE)&dwPtePage, 4, &cbRead, fVmmRead);
+    DWORD cbRead, dwPtePage = 0, vaProto = MMWINX86_PTE_PROTOTYPE(pte);
+    QWORD qwPteMemo;
+    if(MmWin_ProtoMemo_Get(H, vaProto, fVmmRead, &qwPteMemo)) { return (DWORD)qwPteMemo; }
+    VmmReadEx(H, PVMM_PROCESS_SYSTEM, vaProto, (PBYTE)&dwPtePage, 4, &cbRead, fVmmRead);
     if(cbRead != 4) { return 0; }
     if((MMWINX86_PTE_IS_HARDWARE(dwPtePage) && (dwPtePage >= H->dev.paMax)) || MMWINX86_PTE_PROTOTYPE(dwPtePage)) {
         return 0;
     }
+    MmWin_ProtoMemo_Put(H, vaProto, dwPtePage);
     return dwPtePage;
 }
 
@@ -1291,12 +1369,14 @@ fail:
 QWORD MmWinX86PAE_Prototype(_In_ VMM_HANDLE H, _In_ QWORD pte, _In_ QWORD fVmmRead)
 {
     DWORD cbRead;
-    QWORD qwPtePage = 0;
-    VmmReadEx(H, PVMM_PROCESS_SYSTEM, MMWINX86PAE_PTE_PROTOTYPE(pte), (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead);
+    QWORD qwPtePage = 0, vaProto = MMWINX86PAE_PTE_PROTOTYPE(pte);
+    if(MmWin_ProtoMemo_Get(H, vaProto, fVmmRead, &qwPtePage)) { return qwPtePage; }
+    VmmReadEx(H, PVMM_PROCESS_SYSTEM, vaProto, (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead);
     if(cbRead != 8) { return 0; }
     if((MMWINX86PAE_PTE_IS_HARDWARE(qwPtePage) && ((qwPtePage & 0x0000003ffffff000) >= H->dev.paMax)) || MMWINX86PAE_PTE_PROTOTYPE(qwPtePage)) {
         return 0;
     }
+    MmWin_ProtoMemo_Put(H, vaProto, qwPtePage);
     return qwPtePage;
 }
 
@@ -1400,12 +1480,14 @@ fail:
 QWORD MmWinX64_Prototype(_In_ VMM_HANDLE H, _In_ QWORD pte, _In_ QWORD fVmmRead)
 {
     DWORD cbRead;
-    QWORD qwPtePage = 0;
-    VmmReadEx(H, PVMM_PROCESS_SYSTEM, MMWINX64_PTE_PROTOTYPE(pte), (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead);
+    QWORD qwPtePage = 0, vaProto = MMWINX64_PTE_PROTOTYPE(pte);
+    if(MmWin_ProtoMemo_Get(H, vaProto, fVmmRead, &qwPtePage)) { return qwPtePage; }
+    VmmReadEx(H, PVMM_PROCESS_SYSTEM, vaProto, (PBYTE)&qwPtePage, 8, &cbRead, fVmmRead);
     if(cbRead != 8) { return 0; }
     if((MMWINX64_PTE_IS_HARDWARE(qwPtePage) && ((qwPtePage & 0x0000fffffffff000) >= H->dev.paMax)) || MMWINX64_PTE_PROTOTYPE(qwPtePage)) {
         return 0;
     }
+    MmWin_ProtoMemo_Put(H, vaProto, qwPtePage);
     return qwPtePage;
 }
 
@@ -1549,6 +1631,7 @@ VOID MmWin_PagingClose(_In_ VMM_HANDLE H)
                 fclose(ctx->pPageFile[i]);
             }
         }
+        LocalFree(ctx->pProtoMemo);
         LocalFree(ctx);
     }
 }
@@ -1579,6 +1662,7 @@ VOID MmWin_PagingInitialize(_In_ VMM_HANDLE H, _In_ BOOL fModeFull)
         ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(MMWIN_CONTEXT));
         if(!ctx) { return; }
         InitializeCriticalSection(&ctx->Lock);
+        ctx->pProtoMemo = LocalAlloc(LMEM_ZEROINIT, MMWIN_PROTOMEMO_ENTRIES * sizeof(MMWIN_PROTOMEMO_ENTRY));
         for(i = 0; i < 10; i++) {
             if(H->cfg.szPageFile[i][0]) {
                 if(fopen_s(&ctx->pPageFile[i], H->cfg.szPageFile[i], "rb")) {
@@ -11,6 +11,83 @@
 _Success_(return)
 BOOL VMMDLL_ConfigSet_Impl(_In_ VMM_HANDLE H, _In_ ULONG64 fOption, _In_ ULONG64 qwValue);
 
+/*
+* Render the statistics.txt file.
+* -- H
+* -- szBuffer = optional buffer to receive the text, NULL to only retrieve the length.
+* -- cchBuffer
+* -- return = the length of the text (excluding terminating null).
+*/
+DWORD MConf_StatisticsToString(_In_ VMM_HANDLE H, _Out_writes_opt_(cchBuffer) LPSTR szBuffer, _In_ DWORD cchBuffer)
+{
+    QWORD cPageReadTotal, cPageFailTotal;
+    OB_CORE_STATISTICS ObStat;
+    OB_COMPRESSED_INFO FcCompress;
+    FcGetCompressionInfo(H, &FcCompress);
+    cPageReadTotal = H->vmm.stat.page.cPrototype + H->vmm.stat.page.cTransition + H->vmm.stat.page.cDemandZero + H->vmm.stat.page.cVAD + H->vmm.stat.page.cCacheHit + H->vmm.stat.page.cPageFile + H->vmm.stat.page.cCompressed;
+    Ob_GetStatistics(&ObStat);
+    cPageFailTotal = H->vmm.stat.page.cFailCacheHit + H->vmm.stat.page.cFailVAD + H->vmm.stat.page.cFailFileMapped + H->vmm.stat.page.cFailPageFile + H->vmm.stat.page.cFailCompressed + H->vmm.stat.page.cFail;
+    return (DWORD)snprintf(szBuffer, cchBuffer,
+        "VMM STATISTICS   (4kB PAGES / COUNTS - HEXADECIMAL)\n" \
+        "===================================================\n" \
+        "PHYSICAL MEMORY:                      \n" \
+        "  READ CACHE HIT:               %16llx\n" \
+        "  READ RETRIEVED:               %16llx\n" \
+        "  READ FAIL:                    %16llx\n" \
+        "  WRITE:                        %16llx\n" \
+        "PAGED VIRTUAL MEMORY:                 \n" \
+        "  READ SUCCESS:                 %16llx\n" \
+        "    Prototype:                  %16llx\n" \
+        "    Transition:                 %16llx\n" \
+        "    DemandZero:                 %16llx\n" \
+        "    VAD:                        %16llx\n" \
+        "    Cache:                      %16llx\n" \
+        "    PageFile:                   %16llx\n" \
+        "    Compressed:                 %16llx\n" \
+        "  READ FAIL:                    %16llx\n" \
+        "    Cache:                      %16llx\n" \
+        "    VAD:                        %16llx\n" \
+        "    FileMapped:                 %16llx\n" \
+        "    PageFile:                   %16llx\n" \
+        "    Compressed:                 %16llx\n" \
+        "TLB (PAGE TABLES):                    \n" \
+        "  CACHE HIT:                    %16llx\n" \
+        "  RETRIEVED:                    %16llx\n" \
+        "  FAILED:                       %16llx\n" \
+        "GUEST-PHYSICAL MEMORY:                \n" \
+        "  READ SUCESS:                  %16llx\n" \
+        "  READ FAIL:                    %16llx\n" \
+        "  WRITE:                        %16llx\n" \
+        "PHYSICAL MEMORY REFRESH:        %16llx\n" \
+        "TLB MEMORY REFRESH:             %16llx\n" \
+        "PROCESS PARTIAL REFRESH:        %16llx\n" \
+        "PROCESS FULL REFRESH:           %16llx\n" \
+        "OBJECT MANAGER (ALL HANDLES):         \n" \
+        "  ALLOC:                        %16llx\n" \
+        "  ALLOC FROM POOL:              %16llx\n" \
+        "  FREE:                         %16llx\n" \
+        "  FREE TO POOL:                 %16llx\n" \
+        "FORENSIC FILE COMPRESSION:            \n" \
+        "  CODEC (0=FAST 1=HC):          %16llx\n" \
+        "  BLOCKS:                       %16llx\n" \
+        "  BLOCKS STORED:                %16llx\n" \
+        "  BYTES UNCOMPRESSED:           %16llx\n" \
+        "  BYTES COMPRESSED:             %16llx\n" \
+        "  COMPRESS TIME (us):           %16llx\n" \
+        "  DECOMPRESS COUNT:             %16llx\n" \
+        "  DECOMPRESS TIME (us):         %16llx\n",
+        H->vmm.stat.cPhysCacheHit, H->vmm.stat.cPhysReadSuccess, H->vmm.stat.cPhysReadFail, H->vmm.stat.cPhysWrite,
+        cPageReadTotal, H->vmm.stat.page.cPrototype, H->vmm.stat.page.cTransition, H->vmm.stat.page.cDemandZero, H->vmm.stat.page.cVAD, H->vmm.stat.page.cCacheHit, H->vmm.stat.page.cPageFile, H->vmm.stat.page.cCompressed,
+        cPageFailTotal, H->vmm.stat.page.cFailCacheHit, H->vmm.stat.page.cFailVAD, H->vmm.stat.page.cFailFileMapped, H->vmm.stat.page.cFailPageFile, H->vmm.stat.page.cFailCompressed,
+        H->vmm.stat.cTlbCacheHit, H->vmm.stat.cTlbReadSuccess, H->vmm.stat.cTlbReadFail,
+        H->vmm.stat.cGpaReadSuccess, H->vmm.stat.cGpaReadFail, H->vmm.stat.cGpaWrite,
+        H->vmm.stat.cPhysRefreshCache, H->vmm.stat.cTlbRefreshCache, H->vmm.stat.cProcessRefreshPartial, H->vmm.stat.cProcessRefreshFull,
+        ObStat.cAlloc, ObStat.cAllocPool, ObStat.cFree, ObStat.cFreePool,
+        (QWORD)FcCompress.tpCodec, (QWORD)FcCompress.cObjects, (QWORD)FcCompress.cObjectsStored, FcCompress.cbUncompressed, FcCompress.cbCompressed,
+        FcCompress.qwCompressUs, (QWORD)FcCompress.cDecompress, FcCompress.qwDecompressUs
+    );
+}
+
 /*
 * Read : function as specified by the module manager. The module manager will
 * call into this callback function whenever a read shall occur from a "file".
@@ -25,10 +102,9 @@ BOOL VMMDLL_ConfigSet_Impl(_In_ VMM_HANDLE H, _In_ ULONG64 fOption, _In_ ULONG64
 NTSTATUS MConf_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
 {
     DWORD cchBuffer;
-    CHAR szBuffer[0x800];
+    CHAR szBuffer[0x1000];
     DWORD cbCallStatistics = 0;
     LPSTR szCallStatistics = NULL;
-    QWORD cPageReadTotal, cPageFailTotal;
     NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
     if(!_stricmp(ctxP->uszPath, "config_process_show_terminated.txt")) {
         return Util_VfsReadFile_FromBOOL(H->vmm.flags & VMM_FLAG_PROCESS_SHOW_TERMINATED, pb, cb, pcbRead, cbOffset);
@@ -82,51 +158,8 @@ NTSTATUS MConf_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_wr
         return Util_VfsReadFile_FromNumber(0, pb, cb, pcbRead, cbOffset);
     }
     if(!_stricmp(ctxP->uszPath, "statistics.txt")) {
-        cPageReadTotal = H->vmm.stat.page.cPrototype + H->vmm.stat.page.cTransition + H->vmm.stat.page.cDemandZero + H->vmm.stat.page.cVAD + H->vmm.stat.page.cCacheHit + H->vmm.stat.page.cPageFile + H->vmm.stat.page.cCompressed;
-        cPageFailTotal = H->vmm.stat.page.cFailCacheHit + H->vmm.stat.page.cFailVAD + H->vmm.stat.page.cFailFileMapped + H->vmm.stat.page.cFailPageFile + H->vmm.stat.page.cFailCompressed + H->vmm.stat.page.cFail;
-        cchBuffer = snprintf(szBuffer, 0x800,
-            "VMM STATISTICS   (4kB PAGES / COUNTS - HEXADECIMAL)\n" \
-            "===================================================\n" \
-            "PHYSICAL MEMORY:                      \n" \
-            "  READ CACHE HIT:               %16llx\n" \
-            "  READ RETRIEVED:               %16llx\n" \
-            "  READ FAIL:                    %16llx\n" \
-            "  WRITE:                        %16llx\n" \
-            "PAGED VIRTUAL MEMORY:                 \n" \
-            "  READ SUCCESS:                 %16llx\n" \
-            "    Prototype:                  %16llx\n" \
-            "    Transition:                 %16llx\n" \
-            "    DemandZero:                 %16llx\n" \
-            "    VAD:                        %16llx\n" \
-            "    Cache:                      %16llx\n" \
-            "    PageFile:                   %16llx\n" \
-            "    Compressed:                 %16llx\n" \
-            "  READ FAIL:                    %16llx\n" \
-            "    Cache:                      %16llx\n" \
-            "    VAD:                        %16llx\n" \
-            "    FileMapped:                 %16llx\n" \
-            "    PageFile:                   %16llx\n" \
-            "    Compressed:                 %16llx\n" \
-            "TLB (PAGE TABLES):                    \n" \
-            "  CACHE HIT:                    %16llx\n" \
-            "  RETRIEVED:                    %16llx\n" \
-            "  FAILED:                       %16llx\n" \
-            "GUEST-PHYSICAL MEMORY:                \n" \
-            "  READ SUCESS:                  %16llx\n" \
-            "  READ FAIL:                    %16llx\n" \
-            "  WRITE:                        %16llx\n" \
-            "PHYSICAL MEMORY REFRESH:        %16llx\n" \
-            "TLB MEMORY REFRESH:             %16llx\n" \
-            "PROCESS PARTIAL REFRESH:        %16llx\n" \
-            "PROCESS FULL REFRESH:           %16llx\n",
-            H->vmm.stat.cPhysCacheHit, H->vmm.stat.cPhysReadSuccess, H->vmm.stat.cPhysReadFail, H->vmm.stat.cPhysWrite,
-            cPageReadTotal, H->vmm.stat.page.cPrototype, H->vmm.stat.page.cTransition, H->vmm.stat.page.cDemandZero, H->vmm.stat.page.cVAD, H->vmm.stat.page.cCacheHit, H->vmm.stat.page.cPageFile, H->vmm.stat.page.cCompressed,
-            cPageFailTotal, H->vmm.stat.page.cFailCacheHit, H->vmm.stat.page.cFailVAD, H->vmm.stat.page.cFailFileMapped, H->vmm.stat.page.cFailPageFile, H->vmm.stat.page.cFailCompressed,
-            H->vmm.stat.cTlbCacheHit, H->vmm.stat.cTlbReadSuccess, H->vmm.stat.cTlbReadFail,
-            H->vmm.stat.cGpaReadSuccess, H->vmm.stat.cGpaReadFail, H->vmm.stat.cGpaWrite,
-            H->vmm.stat.cPhysRefreshCache, H->vmm.stat.cTlbRefreshCache, H->vmm.stat.cProcessRefreshPartial, H->vmm.stat.cProcessRefreshFull
-        );
-        return Util_VfsReadFile_FromPBYTE(szBuffer, cchBuffer, pb, cb, pcbRead, cbOffset);
+        cchBuffer = MConf_StatisticsToString(H, szBuffer, sizeof(szBuffer));
+        return Util_VfsReadFile_FromPBYTE(szBuffer, min(cchBuffer, sizeof(szBuffer) - 1), pb, cb, pcbRead, cbOffset);
     }
     if(!_stricmp(ctxP->uszPath, "statistics_fncall.txt")) {
         if(Statistics_CallToString(H, &szCallStatistics, &cbCallStatistics)) {
@@ -350,7 +383,7 @@ BOOL MConf_List(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Inout_ PHA
         VMMDLL_VfsList_AddFile(pFileList, "config_symbolcache.txt", strlen(H->pdb.szLocal), NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_symbolserver.txt", strlen(H->pdb.szServer), NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_symbolserver_enable.txt", 1, NULL);
-        VMMDLL_VfsList_AddFile(pFileList, "statistics.txt", 1632, NULL);
+        VMMDLL_VfsList_AddFile(pFileList, "statistics.txt", MConf_StatisticsToString(H, NULL, 0), NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_printf_enable.txt", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_printf_v.txt", 1, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "config_printf_vv.txt", 1, NULL);
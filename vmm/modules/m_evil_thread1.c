@@ -251,6 +251,11 @@ VOID MEvilThread1_DoWork(_In_ VMM_HANDLE H, _In_ VMMDLL_MODULE_ID MID, _In_opt_
             VmmMap_GetModule(H, pObProcess, 0, &ctx.pModuleMap);
             VmmMap_GetVad(H, pObProcess, &ctx.pVadMap, VMM_VADMAP_TP_FULL);
             ctx.pProcess = pObProcess;
+            if(pObProcess->pObPersistent->Plugin.flags & VMMOB_PROCESS_PERSISTENT_FLAG_THREAD_CALLSTACK_ENABLE) {
+                // callstacks enabled - unwind all threads in a batch so that the
+                // callstacks of detected threads are served from the cache:
+                VmmMap_GetThreadCallstackBatch(H, pObProcess, 0);
+            }
 
             for(i = 0; i < pObThreadMap->cMap; i++) {
                 if(H->fAbort) { goto fail; }
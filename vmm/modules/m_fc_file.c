@@ -208,7 +208,7 @@ BOOL MFcFile_ContextInitialize(_In_ VMM_HANDLE H, _In_opt_ PMFCFILE_CONTEXT ctx)
     ObMap_SortEntryIndexByKey(ctx->Init.pmFileObj);
     if(!MFcFile_ContextInitialize_1_FileEntryAlloc_DirInit(H, ctx)) { goto fail; }
     if(!MFcFile_ContextInitialize_2_FillFiles(H, ctx)) { goto fail; }
-    if(!(ctx->pmfFiles = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { goto fail; }
+    if(!(ctx->pmfFiles = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { goto fail; }
     MFcFile_ContextInitialize_3_GenerateSummaryFile(H, ctx, ctx->pRoot);
     ctx->fValid = TRUE;
 fail:
@@ -11,6 +11,13 @@
 
 #include "modules.h"
 #include "../vmmwinobj.h"
+#if defined(_M_X64) || defined(__amd64__) || defined(__SSE2__)
+#define FCNTFS2_INGEST_SCAN_SSE2
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define FCNTFS2_INGEST_SCAN_NEON
+#include <arm_neon.h>
+#endif
 
 #define M_NTFS_INFO_LINELENGTH_UTF8          104
 #define M_NTFS_INFO_LINELENGTH_JSON          104
@@ -253,11 +260,30 @@ typedef struct tdFCNTFS2_VOLUME {
     BYTE uszVolumeName[MAX_PATH];
 } FCNTFS2_VOLUME, *PFCNTFS2_VOLUME;
 
+#define FCNTFS2_ARENA_BLOCK_SIZE        0x00100000  // 1MB arena blocks
+
+typedef struct tdFCNTFS2_ARENA_BLOCK {
+    struct tdFCNTFS2_ARENA_BLOCK *pNext;
+    DWORD cb;
+    DWORD oUsed;
+    DWORD oLast;                        // offset of last allocation (for rewind)
+    DWORD _Filler;
+    BYTE pb[0];
+} FCNTFS2_ARENA_BLOCK, *PFCNTFS2_ARENA_BLOCK;
+
+typedef struct tdFCNTFS2_ARENA {
+    SRWLOCK LockSRW;
+    PFCNTFS2_ARENA_BLOCK pBlock;        // current block (head of block list)
+    QWORD cBlock;
+    QWORD cbBlock;                      // sum of block sizes (excl. headers).
+    QWORD cAlloc;
+} FCNTFS2_ARENA, *PFCNTFS2_ARENA;
+
 typedef struct tdOB_FCNTFS2_INIT_CONTEXT {
     OB ObHdr;
     VMMDLL_MODULE_ID MID;
     BOOL fLogTrace;
-    POB_MAP pmMft;              // MFT record number + index (owns reference to PFCNTFS2)
+    POB_MAP pmMft;              // MFT record number + index (PFCNTFS2 owned by Arena)
     POB_MAP pmVolume;           // Volume ID (owns reference to PFCNTFS2_VOLUME)
     POB_COUNTER pcDuplicate;    // duplicate check
     WORD wNextVolumeId;
@@ -265,19 +291,150 @@ typedef struct tdOB_FCNTFS2_INIT_CONTEXT {
     DWORD cVolumes;
     PFCNTFS2_VOLUME pVolumes;
     SRWLOCK LockPhysIngestSRW;
+    FCNTFS2_ARENA Arena;        // FCNTFS2 entries - free'd as one unit on context cleanup.
+    POB_CONTAINER pcVfs;        // module vfs context container (receives POB_FCNTFS2_VFS on finalize).
 } OB_FCNTFS2_INIT_CONTEXT, *POB_FCNTFS2_INIT_CONTEXT;
 
+#define FCNTFS2_VFS_WINDOW_RECORDS      0x1000  // records per rendered ntfs_files.txt window.
+#define FCNTFS2_VFS_WINDOW_CACHE        8       // max number of cached rendered windows.
+
+#define FCNTFS2_VFS_ID_NONE             0xffffffff
+
+// memory resident file system record (one per database id).
+typedef struct tdFCNTFS2_VFS_RECORD {
+    QWORD pa;
+    QWORD cbFileSize;
+    QWORD ftCreate;
+    QWORD ftModify;
+    QWORD ftRead;
+    DWORD dwMftId;
+    DWORD dwMftIdParent;
+    DWORD dwIdParent;           // FCNTFS2_VFS_ID_NONE = volume root.
+    DWORD dwIdChild;            // first child (lowest id) or FCNTFS2_VFS_ID_NONE.
+    DWORD dwIdSibling;          // next sibling (higher id) or FCNTFS2_VFS_ID_NONE.
+    DWORD oName;                // offset of name in OB_FCNTFS2_VFS.uszNames.
+    WORD flags;
+    WORD wNameSeq;
+} FCNTFS2_VFS_RECORD, *PFCNTFS2_VFS_RECORD;
+
+typedef struct tdFCNTFS2_VFS_HASH {
+    QWORD qwHashPath;
+    QWORD qwId;
+} FCNTFS2_VFS_HASH, *PFCNTFS2_VFS_HASH;
+
+// memory resident line offset and record index of ntfs_files.txt and the
+// directory listings built on finalize. The record index is optional.
+typedef struct tdOB_FCNTFS2_VFS {
+    OB ObHdr;
+    QWORD cRecords;
+    QWORD cbUTF8;               // ntfs_files.txt file size.
+    QWORD cbJSON;
+    PQWORD pqwOlnU;             // [id] -> ntfs_files.txt line offset (cRecords + 1 entries).
+    POB_CACHEMAP pcmWindow;     // window index -> POB_FCNTFS2_VFS_WINDOW
+    PFCNTFS2_VFS_RECORD pRecord;    // [id] -> record (cRecords entries).
+    PFCNTFS2_VFS_HASH pHash;        // path hash index sorted by hash, id (cRecords entries).
+    LPSTR uszNames;                 // record names (multi-string).
+    DWORD dwIdRoot;                 // first volume root, volume roots are linked as siblings.
+} OB_FCNTFS2_VFS, *POB_FCNTFS2_VFS;
+
+typedef struct tdOB_FCNTFS2_VFS_WINDOW {
+    OB ObHdr;
+    QWORD cbOffset;             // ntfs_files.txt offset of window start.
+    DWORD cb;
+    CHAR sz[0];
+} OB_FCNTFS2_VFS_WINDOW, *POB_FCNTFS2_VFS_WINDOW;
+
+#define FCNTFS2_FINALIZE_WORK_THREADS   8
+#define szFCNTFS2_SQL_INSERT            "INSERT INTO ntfs (id, id_parent, id_str, hash, hash_parent, addr_phys, inode, inode_parent, flags, size_file, time_create, time_modify, time_read, name_seq, oln_u, oln_j) VALUES "
+#define FCNTFS2_FINALIZE_HASH_SPLIT     0x400   // pending sub-trees required before hashing in parallel.
+#define FCNTFS2_FINALIZE_DBPUSH_BATCH   32      // rows per multi-row INSERT (32 * 16 = 512 binds).
+#define FCNTFS2_FINALIZE_DBPUSH_COLUMNS 16
+#define FCNTFS2_FINALIZE_PATH_CHUNK     0x400   // entries per path string job.
+#define FCNTFS2_FINALIZE_PATH_MAX       2048
+
 typedef struct tdFCNTFS2_FINALIZE_CONTEXT {
     sqlite3 *hSql;
     sqlite3_stmt *st;
+    sqlite3_stmt *st_batch;
     sqlite3_stmt *st_str;
     QWORD cbUtf8Total;
     QWORD cbJsonTotal;
     QWORD qwNextDbId;
+    DWORD cBatch;
+    QWORD qwBatch[FCNTFS2_FINALIZE_DBPUSH_BATCH][FCNTFS2_FINALIZE_DBPUSH_COLUMNS];
+    QWORD cOlnU;
+    QWORD cOlnUMax;
+    PQWORD pqwOlnU;
+    QWORD cEntry;
+    PFCNTFS2 *ppEntry;                  // [id] -> entry (cOlnUMax entries).
+    PFCSQL_INSERTSTRTABLE pStr;         // [id] -> pre-calculated path string byte counts.
 } FCNTFS2_FINALIZE_CONTEXT, *PFCNTFS2_FINALIZE_CONTEXT;
 
+typedef struct tdFCNTFS2_FINALIZE_WORK {
+    POB_FCNTFS2_INIT_CONTEXT ctx;
+    PFCNTFS2_FINALIZE_CONTEXT ctxFinal;
+    LONG iJob;
+    DWORD cJob;
+    DWORD oJob;                 // index of first job (in pmMft / pmJob / pVolumes).
+    POB_MAP pmJob;              // optional job entries (PFCNTFS2).
+} FCNTFS2_FINALIZE_WORK, *PFCNTFS2_FINALIZE_WORK;
+
 #define FCNTFS2_DUPLICATE_CHECK_FILE_RECORD(dwMftRecordNumber, ftCreate, ftModify, ftRead)      (((QWORD)(dwMftRecordNumber) << 32) ^ (dwMftRecordNumber) ^ (ftCreate) ^ (ftModify) ^ (ftRead))
 
+/*
+* Allocate a zero-initialized FCNTFS2 entry (incl. name) from the context arena.
+* Entries are packed densely in large blocks which are all free'd at once when
+* the context is cleaned up. Entries must not be LocalFree'd.
+* -- ctx
+* -- cbName = number of bytes of name buffer following the FCNTFS2 entry.
+* -- return
+*/
+_Success_(return != NULL)
+PFCNTFS2 FcNtfs2_ArenaAlloc(_In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_ DWORD cbName)
+{
+    PBYTE pb = NULL;
+    PFCNTFS2_ARENA_BLOCK pBlock;
+    DWORD cb = (sizeof(FCNTFS2) + cbName + 7) & ~7;
+    AcquireSRWLockExclusive(&ctx->Arena.LockSRW);
+    pBlock = ctx->Arena.pBlock;
+    if(!pBlock || (pBlock->oUsed + cb > pBlock->cb)) {
+        if(!(pBlock = LocalAlloc(0, sizeof(FCNTFS2_ARENA_BLOCK) + max(FCNTFS2_ARENA_BLOCK_SIZE, cb)))) { goto fail; }
+        pBlock->pNext = ctx->Arena.pBlock;
+        pBlock->cb = max(FCNTFS2_ARENA_BLOCK_SIZE, cb);
+        pBlock->oUsed = 0;
+        ctx->Arena.pBlock = pBlock;
+        ctx->Arena.cBlock++;
+        ctx->Arena.cbBlock += pBlock->cb;
+    }
+    pb = pBlock->pb + pBlock->oUsed;
+    pBlock->oLast = pBlock->oUsed;
+    pBlock->oUsed += cb;
+    ctx->Arena.cAlloc++;
+    ZeroMemory(pb, cb);
+fail:
+    ReleaseSRWLockExclusive(&ctx->Arena.LockSRW);
+    return (PFCNTFS2)pb;
+}
+
+/*
+* Return a FCNTFS2 entry to the context arena. Only the most recent allocation
+* is reclaimed, other entries are kept until context cleanup.
+* -- ctx
+* -- pNt
+*/
+VOID FcNtfs2_ArenaFree(_In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_opt_ PFCNTFS2 pNt)
+{
+    PFCNTFS2_ARENA_BLOCK pBlock;
+    if(!pNt) { return; }
+    AcquireSRWLockExclusive(&ctx->Arena.LockSRW);
+    pBlock = ctx->Arena.pBlock;
+    if(pBlock && ((PBYTE)pNt == pBlock->pb + pBlock->oLast) && (pBlock->oLast < pBlock->oUsed)) {
+        pBlock->oUsed = pBlock->oLast;
+        ctx->Arena.cAlloc--;
+    }
+    ReleaseSRWLockExclusive(&ctx->Arena.LockSRW);
+}
+
 /*
 * Push the pNt entry to the internal context (if possible).
 */
@@ -332,7 +489,7 @@ _Success_(return != 0)
 PFCNTFS2 FcNtfs2_IngestPushEntrySynthetic(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_ DWORD dwMftRecordNumber, _In_opt_ PFCNTFS2 pNtParent, _In_ WORD wVolumeId, _In_ DWORD dwId)
 {
     PFCNTFS2 pNt;
-    if(!(pNt = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS2) + FCNTFS2_SYNTHETIC_NAME_BUFSIZE))) { return NULL; }
+    if(!(pNt = FcNtfs2_ArenaAlloc(ctx, FCNTFS2_SYNTHETIC_NAME_BUFSIZE))) { return NULL; }
     pNt->dwMftRecordNumber = dwMftRecordNumber;
     pNt->dwParentMftRecordNumber = pNtParent ? pNtParent->dwMftRecordNumber : 0;
     pNt->wVolumeId = wVolumeId;
@@ -351,7 +508,7 @@ PFCNTFS2 FcNtfs2_IngestPushEntrySynthetic(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_IN
         }
         return pNt;
     } else {
-        LocalFree(pNt);
+        FcNtfs2_ArenaFree(ctx, pNt);
         return NULL;
     }
 }
@@ -397,9 +554,9 @@ VOID FcNtfs2_IngestIndexEntry(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT c
     if(ObCounter_Exists(ctx->pcDuplicate, qwKey)) { return; }
     // Create NTFS object:
     if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, NULL, 0, NULL, &cbuName, 0) || !cbuName) { return; }
-    if(!(pNt = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS2) + cbuName))) { return; }
+    if(!(pNt = FcNtfs2_ArenaAlloc(ctx, cbuName))) { return; }
     if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, pNt->uszName, cbuName, NULL, &cbuName, CHARUTIL_FLAG_STR_BUFONLY) || !cbuName) {
-        LocalFree(pNt);
+        FcNtfs2_ArenaFree(ctx, pNt);
         return;
     }
     pNt->dwMftRecordNumber = (DWORD)pIE->FileReference.SegmentNumber;
@@ -413,7 +570,7 @@ VOID FcNtfs2_IngestIndexEntry(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT c
     pNt->cbFileSize = pfn->SizeReal;
     // Push NTFS object to "MAP":
     if(!FcNtfs2_IngestPushEntry(H, ctx, pNt, pfn)) {
-        LocalFree(pNt);
+        FcNtfs2_ArenaFree(ctx, pNt);
         return;
     }
 }
@@ -526,14 +683,14 @@ VOID FcNtfs2_IngestFileRecord(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT c
             if((wFlagsSource == FCNTFS2_FLAG_SOURCE_FILE_DIR) || (wFlagsSource == FCNTFS2_FLAG_SOURCE_PMEM_DIR) || (pNtDuplicate->flags & FCNTFS2_FLAG_SOURCE_FILE_MFT) || (pNtDuplicate->flags & FCNTFS2_FLAG_SOURCE_PMEM_MFT)) {
                 return;
             }
-            LocalFree(ObMap_Remove(ctx->pmMft, pNtDuplicate));
+            ObMap_Remove(ctx->pmMft, pNtDuplicate);
         }
     }
     // Create NTFS object:
     if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, NULL, 0, NULL, &cbuName, 0) || !cbuName) { return; }
-    if(!(pNt = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS2) + cbuName))) { return; }
+    if(!(pNt = FcNtfs2_ArenaAlloc(ctx, cbuName))) { return; }
     if(!CharUtil_WtoU(pfn->Name, pfn->NameLength, pNt->uszName, cbuName, NULL, &cbuName, CHARUTIL_FLAG_STR_BUFONLY) || !cbuName) {
-        LocalFree(pNt);
+        FcNtfs2_ArenaFree(ctx, pNt);
         return;
     }
     pNt->paRecord = paRecord;
@@ -549,17 +706,17 @@ VOID FcNtfs2_IngestFileRecord(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT c
     pNt->cbFileSize = cbData ? cbData : pfn->SizeReal;
     // Push NTFS object to "MAP":
     if(!FcNtfs2_IngestPushEntry(H, ctx, pNt, pfn)) {
-        LocalFree(pNt);
+        FcNtfs2_ArenaFree(ctx, pNt);
         return;
     }
     if(!pADataADS) { return; }
     // If ADS, create NTFS object for ADS:
     if(!CharUtil_WtoU((LPWSTR)((PBYTE)pADataADS + pADataADS->NameOffset), pADataADS->NameLength, NULL, 0, NULL, &cbuNameADS, 0) || !cbuNameADS) { return; }
-    if(!(pNtADS = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS2) + cbuName + cbuNameADS))) { return; }
+    if(!(pNtADS = FcNtfs2_ArenaAlloc(ctx, cbuName + cbuNameADS))) { return; }
     memcpy(pNtADS, pNt, sizeof(FCNTFS2) + cbuName);
     pNtADS->uszName[cbuName - 1] = ':';
     if(!CharUtil_WtoU((LPWSTR)((PBYTE)pADataADS + pADataADS->NameOffset), pADataADS->NameLength, pNtADS->uszName + cbuName, cbuNameADS, NULL, &cbuNameADS, CHARUTIL_FLAG_STR_BUFONLY) || !cbuNameADS) {
-        LocalFree(pNtADS);
+        FcNtfs2_ArenaFree(ctx, pNtADS);
         return;
     }
     pNtADS->cbFileSize = pADataADS->fNonResident ? 0 : pADataADS->AttrLength;
@@ -567,7 +724,7 @@ VOID FcNtfs2_IngestFileRecord(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT c
     pNtADS->wRecordNumberIndex++;
     // Push NTFS ADS object to "MAP":
     if(!FcNtfs2_IngestPushEntry(H, ctx, pNtADS, NULL)) {
-        LocalFree(pNtADS);
+        FcNtfs2_ArenaFree(ctx, pNtADS);
         return;
     }
 }
@@ -707,9 +864,73 @@ fail:
     Ob_DECREF(pmObMft);
 }
 
+#define FCNTFS2_INGEST_SCAN_MASK_FILE        0x0f    // bit set per valid 'FILE' record slot in page
+#define FCNTFS2_INGEST_SCAN_MASK_INDX        0x10    // page is an 'INDX' record
+
+/*
+* Scan a single 4kB physical page for NTFS record signatures. The page holds
+* four 1kB MFT record slots. A slot is valid if it has the 'FILE' signature
+* and its MFT record number is aligned to its slot in the page.
+* Almost all pages in a chunk are not MFT/INDX pages and are rejected by the
+* single compare of the first dword. Only candidate pages (first slot 'FILE')
+* are validated - all four slots at the same time. The slot headers are loaded
+* with 16-byte vector loads and transposed into signature and record number
+* vectors with SSE2 (x64) / loaded lane-wise with NEON (arm64). Both are part
+* of the base instruction sets so no runtime cpu feature detection is needed.
+* -- pb = 4kB page.
+* -- return = FCNTFS2_INGEST_SCAN_MASK_* bit mask, zero if no candidates.
+*/
+DWORD FcNtfs2_IngestScanPage(_In_reads_(0x1000) PBYTE pb)
+{
+    DWORD dwSignature = *(PDWORD)pb;
+#if defined(FCNTFS2_INGEST_SCAN_SSE2)
+    __m128i vSig, vNum, v0, v1, v2, v3;
+#elif defined(FCNTFS2_INGEST_SCAN_NEON)
+    static const uint32_t pdwSlot[4] = { 0, 1, 2, 3 };
+    static const uint32_t pdwBit[4] = { 1, 2, 4, 8 };
+    uint32x4_t vSig, vNum;
+#else
+    DWORD i, dwMask = 0;
+#endif /* FCNTFS2_INGEST_SCAN_SSE2 */
+    if(dwSignature != 'ELIF') {
+        return (dwSignature == 'XDNI') ? FCNTFS2_INGEST_SCAN_MASK_INDX : 0;
+    }
+#if defined(FCNTFS2_INGEST_SCAN_SSE2)
+    // signature is dword 0 of slot+0x00, record number is dword 3 of slot+0x20:
+    v0 = _mm_unpacklo_epi32(_mm_loadu_si128((__m128i*)(pb + 0x000)), _mm_loadu_si128((__m128i*)(pb + 0x400)));
+    v1 = _mm_unpacklo_epi32(_mm_loadu_si128((__m128i*)(pb + 0x800)), _mm_loadu_si128((__m128i*)(pb + 0xc00)));
+    v2 = _mm_unpackhi_epi32(_mm_loadu_si128((__m128i*)(pb + 0x020)), _mm_loadu_si128((__m128i*)(pb + 0x420)));
+    v3 = _mm_unpackhi_epi32(_mm_loadu_si128((__m128i*)(pb + 0x820)), _mm_loadu_si128((__m128i*)(pb + 0xc20)));
+    vSig = _mm_cmpeq_epi32(_mm_unpacklo_epi64(v0, v1), _mm_set1_epi32('ELIF'));
+    vNum = _mm_cmpeq_epi32(_mm_and_si128(_mm_unpackhi_epi64(v2, v3), _mm_set1_epi32(3)), _mm_set_epi32(3, 2, 1, 0));
+    return (DWORD)_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(vSig, vNum)));
+#elif defined(FCNTFS2_INGEST_SCAN_NEON)
+    vSig = vdupq_n_u32(dwSignature);
+    vSig = vld1q_lane_u32((const uint32_t*)(pb + 0x400), vSig, 1);
+    vSig = vld1q_lane_u32((const uint32_t*)(pb + 0x800), vSig, 2);
+    vSig = vld1q_lane_u32((const uint32_t*)(pb + 0xc00), vSig, 3);
+    vNum = vld1q_dup_u32((const uint32_t*)(pb + 0x02c));
+    vNum = vld1q_lane_u32((const uint32_t*)(pb + 0x42c), vNum, 1);
+    vNum = vld1q_lane_u32((const uint32_t*)(pb + 0x82c), vNum, 2);
+    vNum = vld1q_lane_u32((const uint32_t*)(pb + 0xc2c), vNum, 3);
+    vSig = vceqq_u32(vSig, vdupq_n_u32('ELIF'));
+    vNum = vceqq_u32(vandq_u32(vNum, vdupq_n_u32(3)), vld1q_u32(pdwSlot));
+    return (DWORD)vaddvq_u32(vandq_u32(vandq_u32(vSig, vNum), vld1q_u32(pdwBit)));
+#else
+    for(i = 0; i < 4; i++) {
+        if((*(PDWORD)(pb + (i << 10)) == 'ELIF') && ((*(PDWORD)(pb + (i << 10) + 0x2c) & 3) == i)) {
+            dwMask |= 1 << i;
+        }
+    }
+    return dwMask;
+#endif /* FCNTFS2_INGEST_SCAN_SSE2 */
+}
+
 /*
 * Filter incoming POB_FC_SCANPHYSMEM_CHUNK to retrieve potential MFT entry
-* physical page addresses and their data in a map [pa -> pb].
+* physical page addresses and their data in a map [pa|mask -> pb].
+* The chunk is pre-filtered in one pass by FcNtfs2_IngestScanPage() and the
+* FCNTFS2_INGEST_SCAN_MASK_* candidate mask is stored in the low key bits.
 * CALLER DECREF: return
 * -- pc
 * -- return = MAP or NULL if no candidate pages found.
@@ -717,23 +938,25 @@ fail:
 POB_MAP FcNtfs2_IngestGetValidAddrMap(_In_ VMM_HANDLE H, _In_ PVMMDLL_FORENSIC_INGEST_PHYSMEM pc)
 {
     BOOL fPfnValidForMft;
-    DWORD i, dwSignature = 0;
+    DWORD i, dwMask;
+    PMEM_SCATTER pMEM;
     POB_MAP pmObAddr;
     PVMMDLL_MAP_PFNENTRY pePfn;
     if(!(pmObAddr = ObMap_New(H, 0))) { return NULL; }
-    for(i = 0; i < 0x1000; i++) {
-        if((pc->ppMEMs[i]->qwA != (QWORD)-1) && pc->ppMEMs[i]->f && (pc->ppMEMs[i]->cb == 0x1000) && (dwSignature = *(PDWORD)pc->ppMEMs[i]->pb) && ((dwSignature == 'ELIF') || dwSignature == 'XDNI')) {
-            pePfn = (pc->pPfnMap && (i < pc->pPfnMap->cMap)) ? (pc->pPfnMap->pMap + i) : NULL;
-            fPfnValidForMft =
-                !pePfn || (pePfn->dwPfn != (pc->ppMEMs[i]->qwA >> 12)) ||
-                (pePfn->PageLocation == MmPfnTypeStandby) ||
-                (pePfn->PageLocation == MmPfnTypeModified) ||
-                (pePfn->PageLocation == MmPfnTypeModifiedNoWrite) ||
-                (pePfn->PageLocation == MmPfnTypeTransition) ||
-                ((pePfn->PageLocation == MmPfnTypeActive) && (pePfn->Priority >= 5));
-            if(fPfnValidForMft) {
-                ObMap_Push(pmObAddr, pc->ppMEMs[i]->qwA, pc->ppMEMs[i]->pb);
-            }
+    for(i = 0; i < pc->cMEMs; i++) {
+        pMEM = pc->ppMEMs[i];
+        if((pMEM->qwA == (QWORD)-1) || !pMEM->f || (pMEM->cb != 0x1000)) { continue; }
+        if(!(dwMask = FcNtfs2_IngestScanPage(pMEM->pb))) { continue; }
+        pePfn = (pc->pPfnMap && (i < pc->pPfnMap->cMap)) ? (pc->pPfnMap->pMap + i) : NULL;
+        fPfnValidForMft =
+            !pePfn || (pePfn->dwPfn != (pMEM->qwA >> 12)) ||
+            (pePfn->PageLocation == MmPfnTypeStandby) ||
+            (pePfn->PageLocation == MmPfnTypeModified) ||
+            (pePfn->PageLocation == MmPfnTypeModifiedNoWrite) ||
+            (pePfn->PageLocation == MmPfnTypeTransition) ||
+            ((pePfn->PageLocation == MmPfnTypeActive) && (pePfn->Priority >= 5));
+        if(fPfnValidForMft) {
+            ObMap_Push(pmObAddr, (pMEM->qwA & ~0xfff) | dwMask, pMEM->pb);
         }
     }
     if(0 == ObMap_Size(pmObAddr)) {
@@ -751,25 +974,21 @@ POB_MAP FcNtfs2_IngestGetValidAddrMap(_In_ VMM_HANDLE H, _In_ PVMMDLL_FORENSIC_I
 */
 VOID FcNtfs2_FcIngestPhysmem(_In_ VMM_HANDLE H, _In_opt_ PVOID ctxfc, _In_ PVMMDLL_FORENSIC_INGEST_PHYSMEM pIngestPhysmem)
 {
-    PNTFS_INDEX_RECORD pI;
-    PNTFS_FILE_RECORD pR;
     DWORD i;
-    QWORD pa;
+    QWORD qwKey, pa;
     PBYTE pb;
     POB_MAP pmObAddr = NULL;
     POB_FCNTFS2_INIT_CONTEXT ctx = (POB_FCNTFS2_INIT_CONTEXT)ctxfc;
     if(ctx && (pmObAddr = FcNtfs2_IngestGetValidAddrMap(H, pIngestPhysmem))) {
-        while((pb = ObMap_PopWithKey(pmObAddr, &pa))) {
-            if(*(PDWORD)pb == 'XDNI') {
-                pI = (PNTFS_INDEX_RECORD)pb;
-                FcNtfs2_IngestIndexRecord(H, ctx, pI, pb, 0, FCNTFS2_FLAG_SOURCE_PMEM_DIR);
-            } else {
-                for(i = 0; i < 4; i++) {
-                    pR = (PNTFS_FILE_RECORD)pb;
-                    if((pR->Signature != 'ELIF') || ((pR->MftRecordNumber & 3) != i)) { continue; }
-                    FcNtfs2_IngestFileRecord(H, ctx, pR, pb, 0, FCNTFS2_FLAG_SOURCE_PMEM_MFT, pa);
-                    pa += 0x400;
-                    pb += 0x400;
+        while((pb = ObMap_PopWithKey(pmObAddr, &qwKey))) {
+            pa = qwKey & ~0xfff;
+            if(qwKey & FCNTFS2_INGEST_SCAN_MASK_INDX) {
+                FcNtfs2_IngestIndexRecord(H, ctx, (PNTFS_INDEX_RECORD)pb, pb, 0, FCNTFS2_FLAG_SOURCE_PMEM_DIR);
+                continue;
+            }
+            for(i = 0; i < 4; i++) {
+                if(qwKey & (1ULL << i)) {
+                    FcNtfs2_IngestFileRecord(H, ctx, (PNTFS_FILE_RECORD)(pb + (i << 10)), pb + (i << 10), 0, FCNTFS2_FLAG_SOURCE_PMEM_MFT, pa + (i << 10));
                 }
             }
         }
@@ -782,11 +1001,17 @@ VOID FcNtfs2_FcIngestPhysmem(_In_ VMM_HANDLE H, _In_opt_ PVOID ctxfc, _In_ PVMMD
 */
 VOID FcNtfs2_InitContext_CleanupCB(POB_FCNTFS2_INIT_CONTEXT pOb)
 {
+    PFCNTFS2_ARENA_BLOCK pBlock;
     Ob_DECREF(pOb->pmMft);
     Ob_DECREF(pOb->pmVolume);
     Ob_DECREF(pOb->pcDuplicate);
     LocalFree(pOb->pb1M);
     LocalFree(pOb->pVolumes);
+    Ob_DECREF(pOb->pcVfs);
+    while((pBlock = pOb->Arena.pBlock)) {
+        pOb->Arena.pBlock = pBlock->pNext;
+        LocalFree(pBlock);
+    }
 }
 
 /*
@@ -801,11 +1026,12 @@ POB_FCNTFS2_INIT_CONTEXT FcNtfs2_InitContext(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLU
     PFCNTFS2_VOLUME pVolume = NULL;
     POB_FCNTFS2_INIT_CONTEXT ctxOb = NULL;
     if(!(ctxOb = Ob_AllocEx(H, 'CNtF', LMEM_ZEROINIT, sizeof(OB_FCNTFS2_INIT_CONTEXT), (OB_CLEANUP_CB)FcNtfs2_InitContext_CleanupCB, NULL))) { goto fail; }
-    if(!(ctxOb->pmMft = ObMap_New(H, OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
+    if(!(ctxOb->pmMft = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID))) { goto fail; }
     if(!(ctxOb->pmVolume = ObMap_New(H, OB_MAP_FLAGS_OBJECT_LOCALFREE))) { goto fail; }
     if(!(ctxOb->pcDuplicate = ObCounter_New(H, 0))) { goto fail; }
     if(!(ctxOb->pb1M = LocalAlloc(0, 0x00100000))) { goto fail; }
     ctxOb->MID = ctxP->MID;
+    ctxOb->pcVfs = Ob_INCREF((POB_CONTAINER)ctxP->ctxM);
     ctxOb->fLogTrace = VmmLogIsActive(H, ctxP->MID, LOGLEVEL_6_TRACE);
     // create a fake volume for physical-only entries:
     {
@@ -993,26 +1219,57 @@ int FcNtfs2_FcIngestFinalize_MergeSortCompare(_In_ PFCNTFS2 *ppe1, _In_ PFCNTFS2
 }
 
 /*
-* Sort directory entries by type, and and children.
+* Run a finalize step on the worker threads. All workers share pWork and pull
+* jobs from it until all pWork->cJob jobs are processed.
+* -- H
+* -- pWork
+* -- pfn
 */
-VOID FcNtfs2_FcIngestFinalize_MergeSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+VOID FcNtfs2_FcIngestFinalize_WorkRun(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_WORK pWork, _In_ PVMM_WORK_START_ROUTINE_PVOID_PFN pfn)
 {
-    DWORD iEntry, cEntries, i;
-    DWORD cChildArrayMax = 0x80000;     // 512k entries
-    PFCNTFS2 *pChildArray, pDir, pe;
-    pChildArray = (PFCNTFS2*)LocalAlloc(0, cChildArrayMax * sizeof(SIZE_T));
-    if(!pChildArray) {
-        VmmLog(H, ctx->MID, LOGLEVEL_1_CRITICAL, "Out of memory.");
-        return;
+    DWORD i, cWork;
+    PVOID pvWork[FCNTFS2_FINALIZE_WORK_THREADS];
+    PVMM_WORK_START_ROUTINE_PVOID_PFN pfnWork[FCNTFS2_FINALIZE_WORK_THREADS];
+    cWork = min(FCNTFS2_FINALIZE_WORK_THREADS, pWork->cJob);
+    for(i = 0; i < cWork; i++) {
+        pfnWork[i] = pfn;
+        pvWork[i] = pWork;
     }
-    cEntries = ObMap_Size(ctx->pmMft);
-    for(iEntry = 0; iEntry < cEntries; iEntry++) {
-        pDir = (PFCNTFS2)ObMap_GetByIndex(ctx->pmMft, iEntry);
-        if(pDir->cChild < 2) { continue; }
+    if(cWork) {
+        VmmWorkWaitMultiple2_Void(H, cWork, pfnWork, pvWork);
+    }
+}
+
+/*
+* Worker thread function: sort the children of directories in pmMft. Each job
+* is a pmMft index. Directories have disjoint child lists and may be sorted
+* independently of each other.
+*/
+VOID FcNtfs2_FcIngestFinalize_MergeSort_ThreadProc(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_WORK pWork)
+{
+    LONG iJob;
+    DWORD i, cChildArray = 0;
+    DWORD cChildArrayMax = 0x80000;     // 512k entries
+    PFCNTFS2 *pChildArray = NULL, pDir, pe;
+    while(!H->fAbort && ((iJob = InterlockedIncrement(&pWork->iJob) - 1) < (LONG)pWork->cJob)) {
+        pDir = (PFCNTFS2)ObMap_GetByIndex(pWork->ctx->pmMft, iJob);
+        if(!pDir || (pDir->cChild < 2)) { continue; }
         if(pDir->cChild >= cChildArrayMax) {
-            VmmLog(H, ctx->MID, LOGLEVEL_2_WARNING, "Large number of files (>%uk) in directory '%s'. If possible to share memory dump file create an issue @Github!", cChildArrayMax >> 10, pDir->uszName);
+            VmmLog(H, pWork->ctx->MID, LOGLEVEL_2_WARNING, "Large number of files (>%uk) in directory '%s'. If possible to share memory dump file create an issue @Github!", cChildArrayMax >> 10, pDir->uszName);
             continue;
         }
+        for(i = 0, pe = pDir->pChild; pe && (i < cChildArrayMax); pe = pe->pSibling) {
+            i++;
+        }
+        if(i >= cChildArrayMax) { continue; }
+        if(i > cChildArray) {
+            LocalFree(pChildArray);
+            cChildArray = max(0x1000, i);
+            if(!(pChildArray = (PFCNTFS2*)LocalAlloc(0, cChildArray * sizeof(SIZE_T)))) {
+                VmmLog(H, pWork->ctx->MID, LOGLEVEL_1_CRITICAL, "Out of memory.");
+                return;
+            }
+        }
         pe = pDir->pChild;
         i = 0;
         while(pe) {
@@ -1031,6 +1288,17 @@ VOID FcNtfs2_FcIngestFinalize_MergeSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT
     LocalFree(pChildArray);
 }
 
+/*
+* Sort directory entries by type, and and children.
+*/
+VOID FcNtfs2_FcIngestFinalize_MergeSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    FCNTFS2_FINALIZE_WORK Work = { 0 };
+    Work.ctx = ctx;
+    Work.cJob = ObMap_Size(ctx->pmMft);
+    FcNtfs2_FcIngestFinalize_WorkRun(H, &Work, (PVMM_WORK_START_ROUTINE_PVOID_PFN)FcNtfs2_FcIngestFinalize_MergeSort_ThreadProc);
+}
+
 int FcNtfs2_FcIngestFinalize_VolumeCountSort_Compare(PFCNTFS2_VOLUME p1, PFCNTFS2_VOLUME p2)
 {
     if(p1->cEntry != p2->cEntry) {
@@ -1040,19 +1308,19 @@ int FcNtfs2_FcIngestFinalize_VolumeCountSort_Compare(PFCNTFS2_VOLUME p1, PFCNTFS
 }
 
 /*
-* Sort volumes by #entries, so that non-physical with largest #entries are put as [1], physical being [0].
+* Worker thread function: count the entries of volumes. Each job is an index
+* into ctx->pVolumes (offset by pWork->oJob).
 */
-VOID FcNtfs2_FcIngestFinalize_VolumeCountSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+VOID FcNtfs2_FcIngestFinalize_VolumeCountSort_ThreadProc(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_WORK pWork)
 {
-    DWORD i, c;
+    LONG iJob;
+    QWORD c;
     PFCNTFS2 pe;
     POB_MAP pmOb = NULL;
-    if(ctx->cVolumes == 1) { return; }
     if(!(pmOb = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID | OB_MAP_FLAGS_NOKEY))) { return; }
-    // 1: volume roots (excl. required physical [i = 0]:
-    for(i = 1; i < ctx->cVolumes; i++) {
+    while(!H->fAbort && ((iJob = InterlockedIncrement(&pWork->iJob) - 1) < (LONG)pWork->cJob)) {
         c = 0;
-        ObMap_Push(pmOb, 0, ctx->pVolumes[i].pRoot);
+        ObMap_Push(pmOb, 0, pWork->ctx->pVolumes[pWork->oJob + iJob].pRoot);
         while((pe = ObMap_Pop(pmOb))) {
             while(pe) {
                 c++;
@@ -1062,8 +1330,24 @@ VOID FcNtfs2_FcIngestFinalize_VolumeCountSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS
                 pe = pe->pSibling;
             }
         }
-        ctx->pVolumes[i].cEntry = c;
+        pWork->ctx->pVolumes[pWork->oJob + iJob].cEntry = c;
     }
+    Ob_DECREF(pmOb);
+}
+
+/*
+* Sort volumes by #entries, so that non-physical with largest #entries are put as [1], physical being [0].
+*/
+VOID FcNtfs2_FcIngestFinalize_VolumeCountSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    DWORD i;
+    FCNTFS2_FINALIZE_WORK Work = { 0 };
+    if(ctx->cVolumes == 1) { return; }
+    // 1: volume roots (excl. required physical [i = 0]:
+    Work.ctx = ctx;
+    Work.oJob = 1;
+    Work.cJob = ctx->cVolumes - 1;
+    FcNtfs2_FcIngestFinalize_WorkRun(H, &Work, (PVMM_WORK_START_ROUTINE_PVOID_PFN)FcNtfs2_FcIngestFinalize_VolumeCountSort_ThreadProc);
     // 2: sort volumes by entry count:
     qsort(ctx->pVolumes + 1, ctx->cVolumes - 1, sizeof(FCNTFS2_VOLUME), (_CoreCrtNonSecureSearchSortCompareFunction)FcNtfs2_FcIngestFinalize_VolumeCountSort_Compare);
     for(i = 1; i < ctx->cVolumes; i++) {
@@ -1072,11 +1356,72 @@ VOID FcNtfs2_FcIngestFinalize_VolumeCountSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS
             _snprintf_s(ctx->pVolumes[i].pRoot->uszName, FCNTFS2_SYNTHETIC_NAME_BUFSIZE, _TRUNCATE, "%u", i);
         }
     }
+}
+
+/*
+* Hash the children of a single directory entry. The hashes only depend on the
+* already hashed parent entry which means that sub-trees may be hashed in any
+* order and in parallel.
+* -- peParent
+* -- pcOb = per-thread name collision counter.
+* -- pmOb = queue to receive children with children of their own.
+*/
+VOID FcNtfs2_FcIngestFinalize_MergeHashEntry(_In_ PFCNTFS2 peParent, _In_ POB_COUNTER pcOb, _In_ POB_MAP pmOb)
+{
+    PFCNTFS2 pe;
+    QWORD qwName_SeqNbr;
+    ObCounter_Clear(pcOb);
+    pe = peParent->pChild;
+    while(pe) {
+        pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, 0);
+        if((qwName_SeqNbr = ObCounter_Inc(pcOb, pe->dwHashName) - 1)) {
+            if(qwName_SeqNbr >= 0xffff) {
+                pe->pSibling = NULL;
+            }
+            pe->wName_SeqNbr = (WORD)qwName_SeqNbr;
+            pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, pe->wName_SeqNbr);
+        }
+        pe->qwHashPath = pe->dwHashName + ((peParent->qwHashPath >> 13) | (peParent->qwHashPath << 51));
+        if(pe->pChild) {
+            ObMap_Push(pmOb, 0, pe);
+        }
+        // detach/remove same-name entries with no physical address/children:
+        while(pe->pSibling && !pe->pSibling->paRecord && !pe->pSibling->cChild && (pe->dwHashName == CharUtil_HashNameFsU(pe->pSibling->uszName, 0))) {
+            pe->pSibling = pe->pSibling->pSibling;
+            pe->pParent->cChild--;
+        }
+        pe = pe->pSibling;
+    }
+}
+
+/*
+* Worker thread function: hash sub-trees. Each job is a pmJob index (offset by
+* pWork->oJob) of a hashed entry which children are yet to be hashed.
+*/
+VOID FcNtfs2_FcIngestFinalize_MergeHash_ThreadProc(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_WORK pWork)
+{
+    LONG iJob;
+    PFCNTFS2 pe;
+    POB_MAP pmOb = NULL;
+    POB_COUNTER pcOb = NULL;
+    if(!(pmOb = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID | OB_MAP_FLAGS_NOKEY))) { goto fail; }
+    if(!(pcOb = ObCounter_New(H, 0))) { goto fail; }
+    while(!H->fAbort && ((iJob = InterlockedIncrement(&pWork->iJob) - 1) < (LONG)pWork->cJob)) {
+        pe = ObMap_GetByIndex(pWork->pmJob, pWork->oJob + iJob);
+        while(pe) {
+            FcNtfs2_FcIngestFinalize_MergeHashEntry(pe, pcOb, pmOb);
+            pe = ObMap_Pop(pmOb);
+        }
+    }
+fail:
+    Ob_DECREF(pcOb);
     Ob_DECREF(pmOb);
 }
 
 /*
-* File system hash entries.
+* File system hash entries. The top of the tree is hashed breath-first until
+* enough independent sub-trees are found, the sub-trees are then hashed in
+* parallel on the worker threads.
 */
 _Success_(return)
 BOOL FcNtfs2_FcIngestFinalize_MergeHash(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
@@ -1086,7 +1431,7 @@ BOOL FcNtfs2_FcIngestFinalize_MergeHash(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT
     PFCNTFS2 peParent, pe;
     POB_MAP pmOb = NULL;
     POB_COUNTER pcOb = NULL;
-    QWORD qwName_SeqNbr;
+    FCNTFS2_FINALIZE_WORK Work = { 0 };
     if(!(pmOb = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID | OB_MAP_FLAGS_NOKEY))) { goto fail; }
     if(!(pcOb = ObCounter_New(H, 0))) { goto fail; }
     // 1: hash volume roots:
@@ -1097,34 +1442,19 @@ BOOL FcNtfs2_FcIngestFinalize_MergeHash(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT
             ObMap_Push(pmOb, 0, pe);
         }
     }
-    // 2: hash all entries - a breath-first traversal:
-    while(TRUE) {
+    // 2: hash top entries - a breath-first traversal:
+    while(ObMap_Size(pmOb) - iParent < FCNTFS2_FINALIZE_HASH_SPLIT) {
         peParent = ObMap_GetByIndex(pmOb, iParent++);
         if(!peParent) { break; }
-        ObCounter_Clear(pcOb);
-        pe = peParent->pChild;
-        while(pe) {
-            pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, 0);
-            if((qwName_SeqNbr = ObCounter_Inc(pcOb, pe->dwHashName) - 1)) {
-                if(qwName_SeqNbr >= 0xffff) {
-                    pe->pSibling = NULL;
-                }
-                pe->wName_SeqNbr = (WORD)qwName_SeqNbr;
-                pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, pe->wName_SeqNbr);
-            }
-            pe->qwHashPath = pe->dwHashName + ((peParent->qwHashPath >> 13) | (peParent->qwHashPath << 51));
-            if(pe->pChild) {
-                ObMap_Push(pmOb, 0, pe);
-            }
-            // detach/remove same-name entries with no physical address/children:
-            while(pe->pSibling && !pe->pSibling->paRecord && !pe->pSibling->cChild && (pe->dwHashName == CharUtil_HashNameFsU(pe->pSibling->uszName, 0))) {
-                pe->pSibling = pe->pSibling->pSibling;
-                pe->pParent->cChild--;
-            }
-            pe = pe->pSibling;
-        }
-    }
-    fResult = TRUE;
+        FcNtfs2_FcIngestFinalize_MergeHashEntry(peParent, pcOb, pmOb);
+    }
+    // 3: hash remaining sub-trees in parallel:
+    Work.ctx = ctx;
+    Work.pmJob = pmOb;
+    Work.oJob = iParent;
+    Work.cJob = (ObMap_Size(pmOb) > iParent) ? (ObMap_Size(pmOb) - iParent) : 0;
+    FcNtfs2_FcIngestFinalize_WorkRun(H, &Work, (PVMM_WORK_START_ROUTINE_PVOID_PFN)FcNtfs2_FcIngestFinalize_MergeHash_ThreadProc);
+    fResult = !H->fAbort;
 fail:
     Ob_DECREF(pcOb);
     Ob_DECREF(pmOb);
@@ -1132,55 +1462,311 @@ fail:
 }
 
 /*
-* Add a file system entry to the database.
+* Flush buffered file system entries to the database. Full batches are inserted
+* with one multi-row INSERT, partial batches row-by-row.
+*/
+VOID FcNtfs2_FcIngestFinalize_DbPush_DatabaseFlush(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctx)
+{
+    DWORD iRow, iCol;
+    if(ctx->cBatch == FCNTFS2_FINALIZE_DBPUSH_BATCH) {
+        sqlite3_reset(ctx->st_batch);
+        for(iRow = 0; iRow < FCNTFS2_FINALIZE_DBPUSH_BATCH; iRow++) {
+            for(iCol = 0; iCol < FCNTFS2_FINALIZE_DBPUSH_COLUMNS; iCol++) {
+                sqlite3_bind_int64(ctx->st_batch, 1 + iRow * FCNTFS2_FINALIZE_DBPUSH_COLUMNS + iCol, ctx->qwBatch[iRow][iCol]);
+            }
+        }
+        sqlite3_step(ctx->st_batch);
+    } else {
+        for(iRow = 0; iRow < ctx->cBatch; iRow++) {
+            sqlite3_reset(ctx->st);
+            for(iCol = 0; iCol < FCNTFS2_FINALIZE_DBPUSH_COLUMNS; iCol++) {
+                sqlite3_bind_int64(ctx->st, 1 + iCol, ctx->qwBatch[iRow][iCol]);
+            }
+            sqlite3_step(ctx->st);
+        }
+    }
+    ctx->cBatch = 0;
+}
+
+/*
+* Add a file system entry to the database (buffered).
+* -- H
+* -- ctx
+* -- pe
+* -- uszPathName
 */
 VOID FcNtfs2_FcIngestFinalize_DbPush_Database(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctx, _In_ PFCNTFS2 pe, _In_ LPSTR uszPathName)
 {
+    PQWORD pqw;
     FCSQL_INSERTSTRTABLE SqlStrInsert = { 0 };
-    if(!Fc_SqlInsertStr(H, ctx->st_str, uszPathName + 1, &SqlStrInsert)) { return; }
-    sqlite3_reset(ctx->st);
-    sqlite3_bind_int64(ctx->st, 1, pe->qwDbId);
-    sqlite3_bind_int64(ctx->st, 2, pe->pParent ? pe->pParent->qwDbId : (QWORD)-1);
-    sqlite3_bind_int64(ctx->st, 3, SqlStrInsert.id);
-    sqlite3_bind_int64(ctx->st, 4, pe->qwHashPath);
-    sqlite3_bind_int64(ctx->st, 5, pe->pParent ? pe->pParent->qwHashPath : 0);
-    sqlite3_bind_int64(ctx->st, 6, pe->paRecord);
-    sqlite3_bind_int64(ctx->st, 7, pe->dwMftRecordNumber);
-    sqlite3_bind_int64(ctx->st, 8, pe->dwParentMftRecordNumber);
-    sqlite3_bind_int64(ctx->st, 9, pe->flags);
-    sqlite3_bind_int64(ctx->st, 10, pe->cbFileSize);
-    sqlite3_bind_int64(ctx->st, 11, pe->ftCreate);
-    sqlite3_bind_int64(ctx->st, 12, pe->ftModify);
-    sqlite3_bind_int64(ctx->st, 13, pe->ftRead);
-    sqlite3_bind_int64(ctx->st, 14, pe->wName_SeqNbr);
-    sqlite3_bind_int64(ctx->st, 15, ctx->cbUtf8Total + pe->qwDbId * M_NTFS_INFO_LINELENGTH_UTF8);
-    sqlite3_bind_int64(ctx->st, 16, ctx->cbJsonTotal + pe->qwDbId * M_NTFS_INFO_LINELENGTH_JSON);
-    sqlite3_step(ctx->st);
+    if(ctx->pStr) {
+        SqlStrInsert = ctx->pStr[pe->qwDbId];
+        if(!SqlStrInsert.cbu) { return; }
+        Fc_SqlInsertStrPrecalc(H, ctx->st_str, uszPathName + 1, &SqlStrInsert);
+    } else {
+        if(!Fc_SqlInsertStr(H, ctx->st_str, uszPathName + 1, &SqlStrInsert)) { return; }
+    }
+    pqw = ctx->qwBatch[ctx->cBatch++];
+    pqw[0] = pe->qwDbId;
+    pqw[1] = pe->pParent ? pe->pParent->qwDbId : (QWORD)-1;
+    pqw[2] = SqlStrInsert.id;
+    pqw[3] = pe->qwHashPath;
+    pqw[4] = pe->pParent ? pe->pParent->qwHashPath : 0;
+    pqw[5] = pe->paRecord;
+    pqw[6] = pe->dwMftRecordNumber;
+    pqw[7] = pe->dwParentMftRecordNumber;
+    pqw[8] = pe->flags;
+    pqw[9] = pe->cbFileSize;
+    pqw[10] = pe->ftCreate;
+    pqw[11] = pe->ftModify;
+    pqw[12] = pe->ftRead;
+    pqw[13] = pe->wName_SeqNbr;
+    pqw[14] = ctx->cbUtf8Total + pe->qwDbId * M_NTFS_INFO_LINELENGTH_UTF8;
+    if(ctx->pqwOlnU && (pe->qwDbId == ctx->cOlnU) && (ctx->cOlnU < ctx->cOlnUMax)) {
+        ctx->pqwOlnU[ctx->cOlnU++] = pqw[14];
+    }
+    pqw[15] = ctx->cbJsonTotal + pe->qwDbId * M_NTFS_INFO_LINELENGTH_JSON;
     ctx->cbUtf8Total += SqlStrInsert.cbu;
     ctx->cbJsonTotal += SqlStrInsert.cbj;
+    if(ctx->cBatch == FCNTFS2_FINALIZE_DBPUSH_BATCH) {
+        FcNtfs2_FcIngestFinalize_DbPush_DatabaseFlush(H, ctx);
+    }
 }
 
-VOID FcNtfs2_FcIngestFinalize_DbPush_BuildPath(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctx, _In_ PFCNTFS2 peNt, _In_ WORD wDirDepth, _In_reads_(2048) LPSTR uszPath, _In_ DWORD cuszPath)
+/*
+* Assign database ids and directory depths to the entries in the depth-first
+* order in which they are pushed to the database. Entries with a too long path
+* (and their remaining siblings) are skipped - same as in the path building.
+* -- ctx
+* -- peNt
+* -- wDirDepth
+* -- cuszPath = length of the parent path.
+*/
+VOID FcNtfs2_FcIngestFinalize_DbPush_Enumerate(_In_ PFCNTFS2_FINALIZE_CONTEXT ctx, _In_ PFCNTFS2 peNt, _In_ WORD wDirDepth, _In_ DWORD cuszPath)
+{
+    DWORD cuszName;
+    while(peNt) {
+        cuszName = (DWORD)strlen(peNt->uszName);
+        if(cuszPath + cuszName + 2 >= FCNTFS2_FINALIZE_PATH_MAX) { break; }
+        peNt->wDirDepth = wDirDepth;
+        peNt->qwDbId = ctx->qwNextDbId++;
+        if(ctx->ppEntry) {
+            if(peNt->qwDbId < ctx->cOlnUMax) {
+                ctx->ppEntry[peNt->qwDbId] = peNt;
+                ctx->cEntry++;
+            } else {
+                LocalFree(ctx->ppEntry);
+                ctx->ppEntry = NULL;
+            }
+        }
+        if(peNt->pChild) {
+            FcNtfs2_FcIngestFinalize_DbPush_Enumerate(ctx, peNt->pChild, wDirDepth + 1, cuszPath + cuszName + 1);
+        }
+        peNt = peNt->pSibling;
+    }
+}
+
+/*
+* Worker thread function: build the path strings of enumerated entries and
+* calculate their 'str' table byte counts. Each job is a range of
+* FCNTFS2_FINALIZE_PATH_CHUNK database ids. The path of an entry is built from
+* its parent chain which is the same as the depth-first traversal path.
+*/
+VOID FcNtfs2_FcIngestFinalize_DbPush_PathLength_ThreadProc(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_WORK pWork)
+{
+    LONG iJob;
+    QWORD qwId, qwIdMax;
+    DWORD i, cuszName, cuszPath;
+    PFCNTFS2 pe, peNt;
+    PFCNTFS2_FINALIZE_CONTEXT ctx = pWork->ctxFinal;
+    CHAR uszPath[FCNTFS2_FINALIZE_PATH_MAX];
+    PFCNTFS2 ppeChain[FCNTFS2_FINALIZE_PATH_MAX / 2];
+    while(!H->fAbort && ((iJob = InterlockedIncrement(&pWork->iJob) - 1) < (LONG)pWork->cJob)) {
+        qwId = (QWORD)iJob * FCNTFS2_FINALIZE_PATH_CHUNK;
+        qwIdMax = min(ctx->cEntry, qwId + FCNTFS2_FINALIZE_PATH_CHUNK);
+        for(; qwId < qwIdMax; qwId++) {
+            peNt = ctx->ppEntry[qwId];
+            for(i = 0, pe = peNt; pe && (i <= peNt->wDirDepth) && (i < _countof(ppeChain)); pe = pe->pParent) {
+                ppeChain[i++] = pe;
+            }
+            cuszPath = 0;
+            while(i) {
+                pe = ppeChain[--i];
+                cuszName = (DWORD)strlen(pe->uszName);
+                if(cuszPath + cuszName + 3 >= FCNTFS2_FINALIZE_PATH_MAX) { break; }
+                uszPath[cuszPath] = '\\';
+                memcpy(&uszPath[cuszPath + 1], pe->uszName, cuszName + 1ULL);
+                cuszPath += cuszName + 1;
+            }
+            if(i || !Fc_SqlInsertStrLength(uszPath, &ctx->pStr[qwId])) {
+                ZeroMemory(&ctx->pStr[qwId], sizeof(FCSQL_INSERTSTRTABLE));
+            }
+        }
+    }
+}
+
+/*
+* Build the path strings of all enumerated entries and calculate their 'str'
+* table byte counts in parallel on the worker threads. Falls back to inline
+* calculation when pushing to the database (ctx->pStr == NULL) on failure.
+* -- H
+* -- ctx
+* -- ctxFinal
+*/
+VOID FcNtfs2_FcIngestFinalize_DbPush_PathLength(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_ PFCNTFS2_FINALIZE_CONTEXT ctxFinal)
+{
+    FCNTFS2_FINALIZE_WORK Work = { 0 };
+    if(!ctxFinal->ppEntry || (ctxFinal->cEntry != ctxFinal->qwNextDbId)) { return; }
+    if(!(ctxFinal->pStr = LocalAlloc(0, (SIZE_T)max(1, ctxFinal->cEntry) * sizeof(FCSQL_INSERTSTRTABLE)))) { return; }
+    Work.ctx = ctx;
+    Work.ctxFinal = ctxFinal;
+    Work.cJob = (DWORD)((ctxFinal->cEntry + FCNTFS2_FINALIZE_PATH_CHUNK - 1) / FCNTFS2_FINALIZE_PATH_CHUNK);
+    FcNtfs2_FcIngestFinalize_WorkRun(H, &Work, (PVMM_WORK_START_ROUTINE_PVOID_PFN)FcNtfs2_FcIngestFinalize_DbPush_PathLength_ThreadProc);
+    if(H->fAbort) {
+        LocalFree(ctxFinal->pStr);
+        ctxFinal->pStr = NULL;
+    }
+}
+
+/*
+* Push entries to the database in the depth-first order of the enumeration.
+* Database ids and directory depths are already assigned.
+*/
+VOID FcNtfs2_FcIngestFinalize_DbPush_BuildPath(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctx, _In_ PFCNTFS2 peNt, _In_reads_(FCNTFS2_FINALIZE_PATH_MAX) LPSTR uszPath, _In_ DWORD cuszPath)
 {
     DWORD cuszName;
     while(peNt) {
         // update/set path
         cuszName = (DWORD)strlen(peNt->uszName);
-        if(cuszPath + cuszName + 2 >= 2048) { break; }
+        if(cuszPath + cuszName + 2 >= FCNTFS2_FINALIZE_PATH_MAX) { break; }
         uszPath[cuszPath] = '\\';
         memcpy(&uszPath[cuszPath + 1], peNt->uszName, cuszName + 1ULL);
-        // update/set path hash
-        peNt->wDirDepth = wDirDepth;
-        peNt->qwDbId = ctx->qwNextDbId++;
         FcNtfs2_FcIngestFinalize_DbPush_Database(H, ctx, peNt, uszPath);
         if(peNt->pChild) {
-            FcNtfs2_FcIngestFinalize_DbPush_BuildPath(H, ctx, peNt->pChild, wDirDepth + 1, uszPath, cuszPath + cuszName + 1);
+            FcNtfs2_FcIngestFinalize_DbPush_BuildPath(H, ctx, peNt->pChild, uszPath, cuszPath + cuszName + 1);
         }
         peNt = peNt->pSibling;
     }
     uszPath[cuszPath] = 0;
 }
 
+VOID FcNtfs2_Vfs_CleanupCB(POB_FCNTFS2_VFS pOb)
+{
+    Ob_DECREF(pOb->pcmWindow);
+    LocalFree(pOb->pqwOlnU);
+    LocalFree(pOb->pRecord);
+    LocalFree(pOb->pHash);
+    LocalFree(pOb->uszNames);
+}
+
+int FcNtfs2_FcIngestFinalize_VfsRecords_CmpHash(_In_ PFCNTFS2_VFS_HASH p1, _In_ PFCNTFS2_VFS_HASH p2)
+{
+    if(p1->qwHashPath != p2->qwHashPath) {
+        return (p1->qwHashPath < p2->qwHashPath) ? -1 : 1;
+    }
+    return (p1->qwId < p2->qwId) ? -1 : ((p1->qwId > p2->qwId) ? 1 : 0);
+}
+
+/*
+* Copy the enumerated entries into the memory resident record index of the vfs
+* object so that directory listings and ntfs_files.txt are served without any
+* database queries once the finalize context (and its arena) is gone. Children
+* are linked in ascending id order - which is also the database order.
+* -- H
+* -- ctxFinal
+* -- pVfs
+* -- return
+*/
+_Success_(return)
+BOOL FcNtfs2_FcIngestFinalize_VfsRecords(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctxFinal, _In_ POB_FCNTFS2_VFS pVfs)
+{
+    QWORD i, cbNames = 0, oName = 0;
+    DWORD cbName, dwId, dwIdParent;
+    PFCNTFS2 pe;
+    PFCNTFS2_VFS_RECORD pr;
+    if(!ctxFinal->ppEntry || (ctxFinal->cEntry != pVfs->cRecords) || (pVfs->cRecords >= FCNTFS2_VFS_ID_NONE)) { return FALSE; }
+    for(i = 0; i < pVfs->cRecords; i++) {
+        cbNames += strlen(ctxFinal->ppEntry[i]->uszName) + 1;
+    }
+    if(cbNames > 0xffffffff) { return FALSE; }
+    pVfs->pRecord = LocalAlloc(0, (SIZE_T)max(1, pVfs->cRecords) * sizeof(FCNTFS2_VFS_RECORD));
+    pVfs->pHash = LocalAlloc(0, (SIZE_T)max(1, pVfs->cRecords) * sizeof(FCNTFS2_VFS_HASH));
+    pVfs->uszNames = LocalAlloc(0, (SIZE_T)max(1, cbNames));
+    if(!pVfs->pRecord || !pVfs->pHash || !pVfs->uszNames) { goto fail; }
+    for(i = 0; i < pVfs->cRecords; i++) {
+        pe = ctxFinal->ppEntry[i];
+        pr = pVfs->pRecord + i;
+        pr->pa = pe->paRecord;
+        pr->cbFileSize = pe->cbFileSize;
+        pr->ftCreate = pe->ftCreate;
+        pr->ftModify = pe->ftModify;
+        pr->ftRead = pe->ftRead;
+        pr->dwMftId = pe->dwMftRecordNumber;
+        pr->dwMftIdParent = pe->dwParentMftRecordNumber;
+        pr->dwIdParent = pe->pParent ? (DWORD)pe->pParent->qwDbId : FCNTFS2_VFS_ID_NONE;
+        pr->dwIdChild = FCNTFS2_VFS_ID_NONE;
+        pr->flags = pe->flags;
+        pr->wNameSeq = pe->wName_SeqNbr;
+        pr->oName = (DWORD)oName;
+        cbName = (DWORD)strlen(pe->uszName) + 1;
+        memcpy(pVfs->uszNames + oName, pe->uszName, cbName);
+        oName += cbName;
+        pVfs->pHash[i].qwHashPath = pe->qwHashPath;
+        pVfs->pHash[i].qwId = i;
+    }
+    // link children/siblings (prepend in descending id order -> ascending lists):
+    pVfs->dwIdRoot = FCNTFS2_VFS_ID_NONE;
+    for(i = pVfs->cRecords; i; i--) {
+        dwId = (DWORD)(i - 1);
+        dwIdParent = pVfs->pRecord[dwId].dwIdParent;
+        if(dwIdParent == FCNTFS2_VFS_ID_NONE) {
+            pVfs->pRecord[dwId].dwIdSibling = pVfs->dwIdRoot;
+            pVfs->dwIdRoot = dwId;
+        } else {
+            pVfs->pRecord[dwId].dwIdSibling = pVfs->pRecord[dwIdParent].dwIdChild;
+            pVfs->pRecord[dwIdParent].dwIdChild = dwId;
+        }
+    }
+    qsort(pVfs->pHash, (SIZE_T)pVfs->cRecords, sizeof(FCNTFS2_VFS_HASH), (_CoreCrtNonSecureSearchSortCompareFunction)FcNtfs2_FcIngestFinalize_VfsRecords_CmpHash);
+    return TRUE;
+fail:
+    LocalFree(pVfs->pRecord);
+    LocalFree(pVfs->pHash);
+    LocalFree(pVfs->uszNames);
+    pVfs->pRecord = NULL;
+    pVfs->pHash = NULL;
+    pVfs->uszNames = NULL;
+    return FALSE;
+}
+
+/*
+* Publish the ntfs_files.txt line offset index collected while pushing entries
+* to the database and the record index to the module vfs context. The index is
+* only published if all entries were pushed in id order (i.e. is complete).
+* -- H
+* -- ctx
+* -- ctxFinal
+*/
+VOID FcNtfs2_FcIngestFinalize_VfsIndex(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_ PFCNTFS2_FINALIZE_CONTEXT ctxFinal)
+{
+    POB_FCNTFS2_VFS pObVfs = NULL;
+    if(!ctx->pcVfs || !ctxFinal->pqwOlnU || (ctxFinal->cOlnU != ctxFinal->qwNextDbId)) { return; }
+    if(!(pObVfs = Ob_AllocEx(H, OB_TAG_MOD_FCNTFS_CTX, LMEM_ZEROINIT, sizeof(OB_FCNTFS2_VFS), (OB_CLEANUP_CB)FcNtfs2_Vfs_CleanupCB, NULL))) { return; }
+    if(!(pObVfs->pcmWindow = ObCacheMap_New(H, FCNTFS2_VFS_WINDOW_CACHE, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB))) { goto fail; }
+    pObVfs->cRecords = ctxFinal->cOlnU;
+    pObVfs->cbUTF8 = ctxFinal->cbUtf8Total + pObVfs->cRecords * M_NTFS_INFO_LINELENGTH_UTF8;
+    pObVfs->cbJSON = ctxFinal->cbJsonTotal + pObVfs->cRecords * M_NTFS_INFO_LINELENGTH_JSON;
+    pObVfs->pqwOlnU = ctxFinal->pqwOlnU;
+    pObVfs->pqwOlnU[pObVfs->cRecords] = pObVfs->cbUTF8;
+    ctxFinal->pqwOlnU = NULL;
+    if(!FcNtfs2_FcIngestFinalize_VfsRecords(H, ctxFinal, pObVfs)) {
+        VmmLog(H, ctx->MID, LOGLEVEL_4_VERBOSE, "Failed to create record index - listings use database.");
+    }
+    ObContainer_SetOb(ctx->pcVfs, pObVfs);
+fail:
+    Ob_DECREF(pObVfs);
+}
+
 /*
 * Finalize the NTFS setup/initialization phase. Try to put re-assemble the NTFS
 * MFT file fragments into some kind of usable file-system approximation using
@@ -1191,34 +1777,56 @@ VOID FcNtfs2_FcIngestFinalize_DbPush_BuildPath(_In_ VMM_HANDLE H, _In_ PFCNTFS2_
 VOID FcNtfs2_FcIngestFinalize_DbPush(_In_ VMM_HANDLE H, POB_FCNTFS2_INIT_CONTEXT ctx)
 {
     FCNTFS2_FINALIZE_CONTEXT ctxFinal = { 0 };
-    CHAR uszPath[2048] = { 0 };
+    CHAR uszPath[FCNTFS2_FINALIZE_PATH_MAX] = { 0 };
+    CHAR szSqlBatch[4096];
     POB_SET psObHashPath = NULL;
-    DWORD i;
+    DWORD i, o;
     int rc;
     // SETUP FINISH:
     uszPath[0] = '\\';
+    ctxFinal.cOlnUMax = ObMap_Size(ctx->pmMft);
+    ctxFinal.pqwOlnU = LocalAlloc(0, (SIZE_T)(ctxFinal.cOlnUMax + 1) * sizeof(QWORD));
+    ctxFinal.ppEntry = LocalAlloc(0, (SIZE_T)max(1, ctxFinal.cOlnUMax) * sizeof(PFCNTFS2));
+    // 1: assign database ids in depth-first order; then build path strings
+    //    and calculate their byte counts in parallel:
+    for(i = 0; i < ctx->cVolumes; i++) {
+        if((i == 0) || (ctx->pVolumes[i].cEntry > 2)) {
+            FcNtfs2_FcIngestFinalize_DbPush_Enumerate(&ctxFinal, ctx->pVolumes[i].pRoot, 0, 1);
+        }
+    }
+    FcNtfs2_FcIngestFinalize_DbPush_PathLength(H, ctx, &ctxFinal);
+    if(H->fAbort) { goto fail; }
+    // 2: push to database (single connection, sequential):
     if(!(ctxFinal.hSql = Fc_SqlReserve(H))) { goto fail; }
-    rc = sqlite3_prepare_v2(ctxFinal.hSql,
-        "INSERT INTO ntfs " \
-        "(id, id_parent, id_str, hash, hash_parent, addr_phys, inode, inode_parent, flags, size_file, time_create, time_modify, time_read, name_seq, oln_u, oln_j) " \
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);"
-        , -1, &ctxFinal.st, NULL);
+    o = _snprintf_s(szSqlBatch, sizeof(szSqlBatch), _TRUNCATE, "%s", szFCNTFS2_SQL_INSERT);
+    for(i = 0; i < FCNTFS2_FINALIZE_DBPUSH_BATCH; i++) {
+        o += _snprintf_s(szSqlBatch + o, sizeof(szSqlBatch) - o, _TRUNCATE, "%s(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", (i ? ", " : ""));
+    }
+    rc = sqlite3_prepare_v2(ctxFinal.hSql, szFCNTFS2_SQL_INSERT "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &ctxFinal.st, NULL);
+    if(rc != SQLITE_OK) { goto fail; }
+    rc = sqlite3_prepare_v2(ctxFinal.hSql, szSqlBatch, -1, &ctxFinal.st_batch, NULL);
     if(rc != SQLITE_OK) { goto fail; }
     rc = sqlite3_prepare_v2(ctxFinal.hSql, szFC_SQL_STR_INSERT, -1, &ctxFinal.st_str, NULL);
     if(rc != SQLITE_OK) { goto fail; }
     sqlite3_exec(ctxFinal.hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
     for(i = 0; i < ctx->cVolumes; i++) {
         if((i == 0) || (ctx->pVolumes[i].cEntry > 2)) {
-            FcNtfs2_FcIngestFinalize_DbPush_BuildPath(H, &ctxFinal, ctx->pVolumes[i].pRoot, 0, uszPath, 1);
+            FcNtfs2_FcIngestFinalize_DbPush_BuildPath(H, &ctxFinal, ctx->pVolumes[i].pRoot, uszPath, 1);
         }
     }
+    FcNtfs2_FcIngestFinalize_DbPush_DatabaseFlush(H, &ctxFinal);
     sqlite3_exec(ctxFinal.hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+    FcNtfs2_FcIngestFinalize_VfsIndex(H, ctx, &ctxFinal);
     // CLEAN UP:
 fail:
     sqlite3_finalize(ctxFinal.st);
+    sqlite3_finalize(ctxFinal.st_batch);
     sqlite3_finalize(ctxFinal.st_str);
     Fc_SqlReserveReturn(H, ctxFinal.hSql);
     Ob_DECREF(psObHashPath);
+    LocalFree(ctxFinal.pqwOlnU);
+    LocalFree(ctxFinal.ppEntry);
+    LocalFree(ctxFinal.pStr);
 }
 
 VOID FcNtfs2_FcIngestFinalize(_In_ VMM_HANDLE H, _In_opt_ PVOID ctxfc)
@@ -1233,6 +1841,7 @@ VOID FcNtfs2_FcIngestFinalize(_In_ VMM_HANDLE H, _In_opt_ PVOID ctxfc)
     if(!FcNtfs2_FcIngestFinalize_MergeHash(H, ctx)) { return; }
     Fc_SqlExec(H, FC_SQL_SCHEMA_NTFS);
     FcNtfs2_FcIngestFinalize_DbPush(H, ctx);
+    VmmLog(H, ctx->MID, LOGLEVEL_5_DEBUG, "Entries:[%llu] Arena:[%llu MB in %llu blocks]", ctx->Arena.cAlloc, ctx->Arena.cbBlock >> 20, ctx->Arena.cBlock);
 }
 
 /*
@@ -1304,7 +1913,6 @@ typedef struct tdFC_MAP_NTFSENTRY {
     DWORD flags;
     DWORD dwTextSeq;
     QWORD cszuOffset;               // offset to start of "line" in bytes (utf-8)
-    QWORD cszjOffset;               // offset to start of "line" in bytes (json)
     DWORD cbuText;                  // utf-8 byte count including terminating null
     LPSTR uszText;                  // utf-8 string pointed into FCOB_MAP_NTFS.uszMultiText
 } FC_MAP_NTFSENTRY, *PFC_MAP_NTFSENTRY;
@@ -1364,7 +1972,7 @@ BOOL FcNtfs2_GetMftResidentData(_In_ VMM_HANDLE H, _In_ PFC_MAP_NTFSENTRY pNtfsE
     return FALSE;
 }
 
-#define FCNTFS_SQL_SELECT_FIELDS " sz, id, addr_phys, inode, inode_parent, flags, name_seq, time_create, time_modify, time_read, size_file, oln_u, oln_j "
+#define FCNTFS_SQL_SELECT_FIELDS " sz, id, addr_phys, inode, inode_parent, flags, name_seq, time_create, time_modify, time_read, size_file, oln_u "
 
 _Success_(return)
 BOOL FcNtfs2_Map_CreateInternal(_In_ VMM_HANDLE H, _In_ LPSTR szSqlCount, _In_ LPSTR szSqlSelect, _In_ DWORD cQueryValues, _In_reads_(cQueryValues) PQWORD pqwQueryValues, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
@@ -1415,7 +2023,6 @@ BOOL FcNtfs2_Map_CreateInternal(_In_ VMM_HANDLE H, _In_ LPSTR szSqlCount, _In_ L
         pe->ftRead = sqlite3_column_int64(hStmt, 9);
         pe->qwFileSize = sqlite3_column_int64(hStmt, 10);
         pe->cszuOffset = sqlite3_column_int64(hStmt, 11);
-        pe->cszjOffset = sqlite3_column_int64(hStmt, 12);
     }
     Ob_INCREF(pObNtfsMap);
 fail:
@@ -1425,17 +2032,176 @@ fail:
     return (*ppObNtfsMap != NULL);
 }
 
+/*
+* Build the path of a record in the memory resident record index. The path is
+* the same as the database 'str' path.
+* -- pVfs
+* -- dwId
+* -- uszPath = optional buffer, if NULL only the length is returned.
+* -- return = path length excl. terminating null, zero on fail.
+*/
+DWORD FcNtfs2_Vfs_BuildPath(_In_ POB_FCNTFS2_VFS pVfs, _In_ DWORD dwId, _Out_writes_opt_(FCNTFS2_FINALIZE_PATH_MAX) LPSTR uszPath)
+{
+    DWORD i = 0, cuszName, cuszPath = 0;
+    DWORD pdwChain[FCNTFS2_FINALIZE_PATH_MAX / 2];
+    LPSTR uszName;
+    while((dwId != FCNTFS2_VFS_ID_NONE) && (i < _countof(pdwChain))) {
+        pdwChain[i++] = dwId;
+        dwId = pVfs->pRecord[dwId].dwIdParent;
+    }
+    if(dwId != FCNTFS2_VFS_ID_NONE) { return 0; }
+    while(i) {
+        uszName = pVfs->uszNames + pVfs->pRecord[pdwChain[--i]].oName;
+        cuszName = (DWORD)strlen(uszName);
+        if(cuszPath + cuszName + 3 >= FCNTFS2_FINALIZE_PATH_MAX) { return 0; }
+        if(uszPath) {
+            uszPath[cuszPath] = '\\';
+            memcpy(uszPath + cuszPath + 1, uszName, cuszName + 1ULL);
+        }
+        cuszPath += cuszName + 1;
+    }
+    return cuszPath;
+}
+
+/*
+* Retrieve the ids of the records with a given path hash - or the ids of the
+* records whose parent has the given path hash (volume roots have parent hash
+* zero) from the memory resident record index. Ids are returned in ascending
+* order - same as the database.
+* -- pVfs
+* -- qwHash
+* -- fParent
+* -- pdwId = optional buffer, if NULL only the count is returned.
+* -- cIdMax
+* -- return = number of ids.
+*/
+DWORD FcNtfs2_Vfs_GetIdFromHash(_In_ POB_FCNTFS2_VFS pVfs, _In_ QWORD qwHash, _In_ BOOL fParent, _Out_writes_opt_(cIdMax) PDWORD pdwId, _In_ DWORD cIdMax)
+{
+    QWORD iLo = 0, iHi = pVfs->cRecords, iMid;
+    DWORD c = 0, cParent = 0, dwId;
+    // 1: locate first record with matching hash (binary search):
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) / 2;
+        if(pVfs->pHash[iMid].qwHashPath < qwHash) {
+            iLo = iMid + 1;
+        } else {
+            iHi = iMid;
+        }
+    }
+    // 2: collect ids:
+    if(fParent && !qwHash) {
+        for(dwId = pVfs->dwIdRoot; dwId != FCNTFS2_VFS_ID_NONE; dwId = pVfs->pRecord[dwId].dwIdSibling) {
+            if(pdwId && (c < cIdMax)) { pdwId[c] = dwId; }
+            c++;
+        }
+        cParent++;
+    }
+    for(; (iLo < pVfs->cRecords) && (pVfs->pHash[iLo].qwHashPath == qwHash); iLo++) {
+        if(!fParent) {
+            if(pdwId && (c < cIdMax)) { pdwId[c] = (DWORD)pVfs->pHash[iLo].qwId; }
+            c++;
+            continue;
+        }
+        for(dwId = pVfs->pRecord[pVfs->pHash[iLo].qwId].dwIdChild; dwId != FCNTFS2_VFS_ID_NONE; dwId = pVfs->pRecord[dwId].dwIdSibling) {
+            if(pdwId && (c < cIdMax)) { pdwId[c] = dwId; }
+            c++;
+        }
+        cParent++;
+    }
+    // 3: children of multiple (colliding) parents are merged in id order:
+    if(pdwId && (cParent > 1)) {
+        qsort(pdwId, min(c, cIdMax), sizeof(DWORD), Util_qsort_DWORD);
+    }
+    return c;
+}
+
+/*
+* Create a FCOB_MAP_NTFS map object from the memory resident record index.
+* -- H
+* -- pVfs
+* -- qwIdBase = first id if pdwId is NULL.
+* -- cId
+* -- pdwId = optional ids, if NULL the range qwIdBase..qwIdBase+cId is used.
+* -- ppObNtfsMap
+* -- return
+*/
+_Success_(return)
+BOOL FcNtfs2_Map_CreateFromVfs(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_VFS pVfs, _In_ QWORD qwIdBase, _In_ DWORD cId, _In_reads_opt_(cId) PDWORD pdwId, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
+{
+    DWORD i, dwId, cuszPath, cbuMultiText = 1, oMultiText = 1;
+    PFCOB_MAP_NTFS pObNtfsMap = NULL;
+    PFC_MAP_NTFSENTRY pe;
+    PFCNTFS2_VFS_RECORD pr;
+    *ppObNtfsMap = NULL;
+    if((cId > 0x00010000) || (!pdwId && (qwIdBase + cId > pVfs->cRecords))) { return FALSE; }
+    for(i = 0; i < cId; i++) {
+        dwId = pdwId ? pdwId[i] : (DWORD)(qwIdBase + i);
+        if(!(cuszPath = FcNtfs2_Vfs_BuildPath(pVfs, dwId, NULL))) { return FALSE; }
+        cbuMultiText += cuszPath + 1;
+    }
+    pObNtfsMap = Ob_AllocEx(H, OB_TAG_MOD_FCNTFS_CTX, LMEM_ZEROINIT, sizeof(FCOB_MAP_NTFS) + cId * sizeof(FC_MAP_NTFSENTRY) + cbuMultiText, NULL, NULL);
+    if(!pObNtfsMap) { return FALSE; }
+    pObNtfsMap->uszMultiText = (LPSTR)((PBYTE)pObNtfsMap + sizeof(FCOB_MAP_NTFS) + cId * sizeof(FC_MAP_NTFSENTRY));
+    pObNtfsMap->cbuMultiText = cbuMultiText;
+    pObNtfsMap->cMap = cId;
+    for(i = 0; i < cId; i++) {
+        dwId = pdwId ? pdwId[i] : (DWORD)(qwIdBase + i);
+        pr = pVfs->pRecord + dwId;
+        pe = pObNtfsMap->pMap + i;
+        pe->uszText = pObNtfsMap->uszMultiText + oMultiText;
+        pe->cbuText = FcNtfs2_Vfs_BuildPath(pVfs, dwId, pe->uszText) + 1;
+        oMultiText += pe->cbuText;
+        pe->qwId = dwId;
+        pe->pa = pr->pa;
+        pe->dwMftId = pr->dwMftId;
+        pe->dwMftIdParent = pr->dwMftIdParent;
+        pe->flags = pr->flags;
+        pe->dwTextSeq = pr->wNameSeq;
+        pe->ftCreate = pr->ftCreate;
+        pe->ftModify = pr->ftModify;
+        pe->ftRead = pr->ftRead;
+        pe->qwFileSize = pr->cbFileSize;
+        pe->cszuOffset = pVfs->pqwOlnU[dwId];
+    }
+    *ppObNtfsMap = pObNtfsMap;
+    return TRUE;
+}
+
+/*
+* Create a FCOB_MAP_NTFS map object from the memory resident record index given
+* a path hash or parent path hash.
+*/
+_Success_(return)
+BOOL FcNtfs2_Map_CreateFromVfsHash(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_VFS pVfs, _In_ QWORD qwHash, _In_ BOOL fParent, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
+{
+    BOOL fResult;
+    DWORD cId;
+    PDWORD pdwId = NULL;
+    *ppObNtfsMap = NULL;
+    cId = FcNtfs2_Vfs_GetIdFromHash(pVfs, qwHash, fParent, NULL, 0);
+    if(cId > 0x00010000) { return FALSE; }
+    if(!(pdwId = LocalAlloc(0, max(1, cId) * sizeof(DWORD)))) { return FALSE; }
+    cId = FcNtfs2_Vfs_GetIdFromHash(pVfs, qwHash, fParent, pdwId, cId);
+    fResult = FcNtfs2_Map_CreateFromVfs(H, pVfs, 0, cId, pdwId, ppObNtfsMap);
+    LocalFree(pdwId);
+    return fResult;
+}
+
 /*
 * Retrieve a FCOB_MAP_NTFS map object containing a specific entry given by its
 * file system hash.
 * -- H
+* -- pVfs = optional record index, the database is queried if missing.
 * -- qwHash
 * -- ppObNtfsMap
 * -- return
 */
 _Success_(return)
-BOOL FcNtfs2_Map_GetFromHash(_In_ VMM_HANDLE H, _In_ QWORD qwHash, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
+BOOL FcNtfs2_Map_GetFromHash(_In_ VMM_HANDLE H, _In_opt_ POB_FCNTFS2_VFS pVfs, _In_ QWORD qwHash, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
 {
+    if(pVfs && pVfs->pRecord) {
+        return FcNtfs2_Map_CreateFromVfsHash(H, pVfs, qwHash, FALSE, ppObNtfsMap);
+    }
     return FcNtfs2_Map_CreateInternal(
         H,
         "SELECT COUNT(*), SUM(cbu) FROM v_ntfs WHERE hash = ?",
@@ -1450,13 +2216,17 @@ BOOL FcNtfs2_Map_GetFromHash(_In_ VMM_HANDLE H, _In_ QWORD qwHash, _Out_ PFCOB_M
 * Retrieve a FCOB_MAP_NTFS map object containing entries which have the same
 * file system parent given by its parent hash.
 * -- H
+* -- pVfs = optional record index, the database is queried if missing.
 * -- qwHashParent
 * -- ppObNtfsMap
 * -- return
 */
 _Success_(return)
-BOOL FcNtfs2_Map_GetFromHashParent(_In_ VMM_HANDLE H, _In_ QWORD qwHashParent, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
+BOOL FcNtfs2_Map_GetFromHashParent(_In_ VMM_HANDLE H, _In_opt_ POB_FCNTFS2_VFS pVfs, _In_ QWORD qwHashParent, _Out_ PFCOB_MAP_NTFS *ppObNtfsMap)
 {
+    if(pVfs && pVfs->pRecord) {
+        return FcNtfs2_Map_CreateFromVfsHash(H, pVfs, qwHashParent, TRUE, ppObNtfsMap);
+    }
     return FcNtfs2_Map_CreateInternal(
         H,
         "SELECT COUNT(*), SUM(cbu) FROM v_ntfs WHERE hash_parent = ?",
@@ -1470,15 +2240,20 @@ BOOL FcNtfs2_Map_GetFromHashParent(_In_ VMM_HANDLE H, _In_ QWORD qwHashParent, _
 /*
 * Retrieve a FCOB_MAP_NTFS map object containing entries within a range.
 * -- H
+* -- pVfs = optional record index, the database is queried if missing.
 * -- qwId
 * -- cId
 * -- ppObNtfsMap
 * -- return
 */
 _Success_(return)
-BOOL FcNtfs2_Map_GetFromIdRange(_In_ VMM_HANDLE H, _In_ QWORD qwId, _In_ QWORD cId, _Out_ PFCOB_MAP_NTFS * ppObNtfsMap)
+BOOL FcNtfs2_Map_GetFromIdRange(_In_ VMM_HANDLE H, _In_opt_ POB_FCNTFS2_VFS pVfs, _In_ QWORD qwId, _In_ QWORD cId, _Out_ PFCOB_MAP_NTFS * ppObNtfsMap)
 {
     QWORD v[] = { qwId, qwId + cId };
+    if(pVfs && pVfs->pRecord) {
+        if(qwId >= pVfs->cRecords) { *ppObNtfsMap = NULL; return FALSE; }
+        return FcNtfs2_Map_CreateFromVfs(H, pVfs, qwId, (DWORD)min(cId, pVfs->cRecords - qwId), NULL, ppObNtfsMap);
+    }
     return FcNtfs2_Map_CreateInternal(
         H,
         "SELECT COUNT(*), SUM(cbu) FROM v_ntfs WHERE id >= ? AND id < ?",
@@ -1492,15 +2267,22 @@ BOOL FcNtfs2_Map_GetFromIdRange(_In_ VMM_HANDLE H, _In_ QWORD qwId, _In_ QWORD c
 /*
 * Retieve the file size of the ntfs information file either in JSON or UTF8.
 * -- H
+* -- pVfs = optional line offset index, the database is queried if missing.
 * -- pcRecords = number of entries/lines/records.
 * -- pcbUTF8 = UTF8 text file size.
 * -- pcbJSON = JSON file size.
 * -- return
 */
 _Success_(return)
-BOOL FcNtfs2_GetFileSize(_In_ VMM_HANDLE H, _Out_opt_ PQWORD pcRecords, _Out_opt_ PQWORD pcbUTF8, _Out_opt_ PQWORD pcbJSON)
+BOOL FcNtfs2_GetFileSize(_In_ VMM_HANDLE H, _In_opt_ POB_FCNTFS2_VFS pVfs, _Out_opt_ PQWORD pcRecords, _Out_opt_ PQWORD pcbUTF8, _Out_opt_ PQWORD pcbJSON)
 {
     QWORD pqwResult[3];
+    if(pVfs) {
+        if(pcRecords) { *pcRecords = pVfs->cRecords; }
+        if(pcbUTF8) { *pcbUTF8 = pVfs->cbUTF8; }
+        if(pcbJSON) { *pcbJSON = pVfs->cbJSON; }
+        return TRUE;
+    }
     // query below is convoluted but it's very fast ...
     if(SQLITE_OK != Fc_SqlQueryN(H, "SELECT id, oln_u+cbu+"STRINGIZE(M_NTFS_INFO_LINELENGTH_UTF8)" AS cbu_tot, oln_j+cbj+"STRINGIZE(M_NTFS_INFO_LINELENGTH_JSON)" AS cbj_tot FROM v_ntfs WHERE id = (SELECT MAX(id) FROM v_ntfs)", 0, NULL, 3, pqwResult, NULL)) { return FALSE; }
     if(pcRecords) { *pcRecords = pqwResult[0]; }
@@ -1687,29 +2469,25 @@ fail:
     return sz;
 }
 
-NTSTATUS FcNtfs2_ReadInfoAll(_In_ VMM_HANDLE H, _Out_ PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+/*
+* Render ntfs_files.txt lines for the entries in pObNtfsMap into szu.
+* -- pObNtfsMap
+* -- szu
+* -- cszu
+* -- return = number of bytes written.
+*/
+QWORD FcNtfs2_ReadInfoAll_Render(_In_ PFCOB_MAP_NTFS pObNtfsMap, _Out_writes_(cszu) LPSTR szu, _In_ QWORD cszu)
 {
-    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
+    QWORD i, o;
     PFC_MAP_NTFSENTRY pe;
-    PFCOB_MAP_NTFS pObNtfsMap = NULL;
-    QWORD i, o, qwIdBase, qwIdTop, cId, cszuBuffer, cbOffsetBuffer;
-    LPSTR szuBuffer = NULL;
     CHAR szTimeCreate[24], szTimeModify[24];
-    if(!FcNtfs2_GetIdFromPosition(H, cbOffset, FALSE, &qwIdBase)) { goto fail; }
-    if(!FcNtfs2_GetIdFromPosition(H, cbOffset + cb, FALSE, &qwIdTop)) { goto fail; }
-    cId = min(cb / M_NTFS_INFO_LINELENGTH_UTF8, qwIdTop - qwIdBase) + 1;
-    if(!FcNtfs2_Map_GetFromIdRange(H, qwIdBase, cId, &pObNtfsMap) || !pObNtfsMap->cMap) { goto fail; }
-    cbOffsetBuffer = pObNtfsMap->pMap[0].cszuOffset;
-    if((cbOffsetBuffer > cbOffset) || (cbOffset - cbOffsetBuffer > 0x10000)) { goto fail; }
-    cszuBuffer = 0x01000000;
-    if(!(szuBuffer = LocalAlloc(0, (SIZE_T)cszuBuffer))) { goto fail; }
-    for(i = 0, o = 0; (i < pObNtfsMap->cMap) && (o < cszuBuffer - 0x1000); i++) {
+    for(i = 0, o = 0; (i < pObNtfsMap->cMap) && (o < cszu - 0x1000); i++) {
         pe = pObNtfsMap->pMap + i;
         Util_FileTime2String(pe->ftCreate, szTimeCreate);
         Util_FileTime2String(pe->ftModify, szTimeModify);
         o += snprintf(
-            szuBuffer + o,
-            (SIZE_T)(cszuBuffer - o),
+            szu + o,
+            (SIZE_T)(cszu - o),
             "%6llx%12llx%8x%8x %s : %s %12llx %c%c%c%c %s\n",
             pe->qwId,
             pe->pa,
@@ -1725,6 +2503,100 @@ NTSTATUS FcNtfs2_ReadInfoAll(_In_ VMM_HANDLE H, _Out_ PBYTE pb, _In_ DWORD cb, _
             pe->uszText
         );
     }
+    return min(o, cszu);
+}
+
+/*
+* Retrieve a rendered window of FCNTFS2_VFS_WINDOW_RECORDS ntfs_files.txt lines
+* from the window cache, or render it from the record index if not cached.
+* CALLER DECREF: return
+* -- H
+* -- pVfs
+* -- iWindow
+* -- return
+*/
+_Success_(return != NULL)
+POB_FCNTFS2_VFS_WINDOW FcNtfs2_ReadInfoAll_GetWindow(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_VFS pVfs, _In_ QWORD iWindow)
+{
+    QWORD qwIdBase, cId, cszu;
+    PFCOB_MAP_NTFS pObNtfsMap = NULL;
+    POB_FCNTFS2_VFS_WINDOW pObWindow = NULL;
+    if((pObWindow = ObCacheMap_GetByKey(pVfs->pcmWindow, iWindow))) { return pObWindow; }
+    qwIdBase = iWindow * FCNTFS2_VFS_WINDOW_RECORDS;
+    if(qwIdBase >= pVfs->cRecords) { goto fail; }
+    cId = min(FCNTFS2_VFS_WINDOW_RECORDS, pVfs->cRecords - qwIdBase);
+    cszu = pVfs->pqwOlnU[qwIdBase + cId] - pVfs->pqwOlnU[qwIdBase] + 0x2000;
+    if(cszu > 0x01000000) { goto fail; }
+    if(!FcNtfs2_Map_GetFromIdRange(H, pVfs, qwIdBase, cId, &pObNtfsMap) || !pObNtfsMap->cMap) { goto fail; }
+    if(!(pObWindow = Ob_AllocEx(H, OB_TAG_MOD_FCNTFS_CTX, 0, (SIZE_T)(sizeof(OB_FCNTFS2_VFS_WINDOW) + cszu), NULL, NULL))) { goto fail; }
+    pObWindow->cbOffset = pVfs->pqwOlnU[qwIdBase];
+    pObWindow->cb = (DWORD)FcNtfs2_ReadInfoAll_Render(pObNtfsMap, pObWindow->sz, cszu);
+    ObCacheMap_Push(pVfs->pcmWindow, iWindow, pObWindow, 0);
+fail:
+    Ob_DECREF(pObNtfsMap);
+    return pObWindow;
+}
+
+/*
+* Read ntfs_files.txt from the memory resident line offset index. Lines are
+* rendered in cached windows of FCNTFS2_VFS_WINDOW_RECORDS records from the
+* record index (the database is only queried if the record index is missing).
+*/
+NTSTATUS FcNtfs2_ReadInfoAll_FromVfs(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_VFS pVfs, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    QWORD iLo, iHi, iMid, iWindow, oWindow, cbCopy;
+    POB_FCNTFS2_VFS_WINDOW pObWindow = NULL;
+    *pcbRead = 0;
+    if(cbOffset >= pVfs->cbUTF8) { return VMMDLL_STATUS_END_OF_FILE; }
+    cb = (DWORD)min(cb, pVfs->cbUTF8 - cbOffset);
+    // 1: locate record of the first line to read (binary search):
+    iLo = 0;
+    iHi = pVfs->cRecords;
+    while(iHi - iLo > 1) {
+        iMid = (iLo + iHi) / 2;
+        if(pVfs->pqwOlnU[iMid] <= cbOffset) {
+            iLo = iMid;
+        } else {
+            iHi = iMid;
+        }
+    }
+    // 2: copy from rendered windows:
+    iWindow = iLo / FCNTFS2_VFS_WINDOW_RECORDS;
+    while(*pcbRead < cb) {
+        if(!(pObWindow = FcNtfs2_ReadInfoAll_GetWindow(H, pVfs, iWindow))) { break; }
+        oWindow = cbOffset + *pcbRead - pObWindow->cbOffset;
+        if(oWindow >= pObWindow->cb) { break; }
+        cbCopy = min(cb - *pcbRead, pObWindow->cb - oWindow);
+        memcpy(pb + *pcbRead, pObWindow->sz + oWindow, (SIZE_T)cbCopy);
+        *pcbRead += (DWORD)cbCopy;
+        Ob_DECREF_NULL(&pObWindow);
+        iWindow++;
+    }
+    Ob_DECREF(pObWindow);
+    return *pcbRead ? VMMDLL_STATUS_SUCCESS : VMMDLL_STATUS_FILE_INVALID;
+}
+
+NTSTATUS FcNtfs2_ReadInfoAll(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ QWORD cbOffset)
+{
+    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
+    PFCOB_MAP_NTFS pObNtfsMap = NULL;
+    POB_FCNTFS2_VFS pObVfs = NULL;
+    QWORD o, qwIdBase, qwIdTop, cId, cszuBuffer, cbOffsetBuffer;
+    LPSTR szuBuffer = NULL;
+    if((pObVfs = ObContainer_GetOb((POB_CONTAINER)ctxP->ctxM))) {
+        nt = FcNtfs2_ReadInfoAll_FromVfs(H, pObVfs, pb, cb, pcbRead, cbOffset);
+        Ob_DECREF(pObVfs);
+        return nt;
+    }
+    if(!FcNtfs2_GetIdFromPosition(H, cbOffset, FALSE, &qwIdBase)) { goto fail; }
+    if(!FcNtfs2_GetIdFromPosition(H, cbOffset + cb, FALSE, &qwIdTop)) { goto fail; }
+    cId = min(cb / M_NTFS_INFO_LINELENGTH_UTF8, qwIdTop - qwIdBase) + 1;
+    if(!FcNtfs2_Map_GetFromIdRange(H, NULL, qwIdBase, cId, &pObNtfsMap) || !pObNtfsMap->cMap) { goto fail; }
+    cbOffsetBuffer = pObNtfsMap->pMap[0].cszuOffset;
+    if((cbOffsetBuffer > cbOffset) || (cbOffset - cbOffsetBuffer > 0x10000)) { goto fail; }
+    cszuBuffer = 0x01000000;
+    if(!(szuBuffer = LocalAlloc(0, (SIZE_T)cszuBuffer))) { goto fail; }
+    o = FcNtfs2_ReadInfoAll_Render(pObNtfsMap, szuBuffer, cszuBuffer);
     nt = Util_VfsReadFile_FromPBYTE(szuBuffer, o, pb, cb, pcbRead, cbOffset - cbOffsetBuffer);
 fail:
     LocalFree(szuBuffer);
@@ -1784,12 +2656,14 @@ NTSTATUS FcNtfs2_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_
     CHAR uszPathStripped[MAX_PATH];
     PBYTE pbInfoTxt;
     DWORD cbInfoTxt;
+    POB_FCNTFS2_VFS pObVfs = NULL;
     if(!strcmp(ctxP->uszPath, "ntfs_files.txt")) {
-        return FcNtfs2_ReadInfoAll(H, pb, cb, pcbRead, cbOffset);
+        return FcNtfs2_ReadInfoAll(H, ctxP, pb, cb, pcbRead, cbOffset);
     }
     FcNtfs2_PathStripMftInfo(H, ctxP->uszPath, uszPathStripped, &fMeta, NULL, &fMetaTxt, &fMetaMem, &fMetaBin);
     qwHashPath = CharUtil_HashPathFsU(uszPathStripped);
-    if(FcNtfs2_Map_GetFromHash(H, qwHashPath, &pObNtfsMap) && pObNtfsMap->cMap) {
+    pObVfs = ObContainer_GetOb((POB_CONTAINER)ctxP->ctxM);
+    if(FcNtfs2_Map_GetFromHash(H, pObVfs, qwHashPath, &pObNtfsMap) && pObNtfsMap->cMap) {
         peNtfs = pObNtfsMap->pMap + 0;
         if(!fMeta || fMetaBin) {
             if(peNtfs->qwFileSize && (peNtfs->flags & FCNTFS2_FLAG_RESIDENT) && (peNtfs->qwFileSize < 0x400)) {
@@ -1810,10 +2684,18 @@ NTSTATUS FcNtfs2_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_
         }
     }
     Ob_DECREF(pObNtfsMap);
+    Ob_DECREF(pObVfs);
     return nt;
 }
 
-VOID FcNtfs2_ListDirectory(_In_ VMM_HANDLE H, _In_ LPSTR uszPath, _Inout_ PHANDLE pFileList)
+/*
+* List a directory - from the memory resident record index if it exists.
+* -- H
+* -- pVfs
+* -- uszPath
+* -- pFileList
+*/
+VOID FcNtfs2_ListDirectory(_In_ VMM_HANDLE H, _In_opt_ POB_FCNTFS2_VFS pVfs, _In_ LPSTR uszPath, _Inout_ PHANDLE pFileList)
 {
     BOOL fMeta, fEnd, fTxt, fMem, fBin;
     PBYTE pbInfoTxt;
@@ -1830,7 +2712,7 @@ VOID FcNtfs2_ListDirectory(_In_ VMM_HANDLE H, _In_ LPSTR uszPath, _Inout_ PHANDL
     qwHashPath = CharUtil_HashPathFsU(uszNameFix);
     // single mft entry metadata files
     if(fMeta && !fEnd) {
-        if(FcNtfs2_Map_GetFromHash(H, qwHashPath, &pObNtfsMap) && pObNtfsMap->cMap) {
+        if(FcNtfs2_Map_GetFromHash(H, pVfs, qwHashPath, &pObNtfsMap) && pObNtfsMap->cMap) {
             pe = pObNtfsMap->pMap;
             if(pe->pa) {
                 FileExInfo.qwCreationTime = pe->ftCreate;
@@ -1850,7 +2732,7 @@ VOID FcNtfs2_ListDirectory(_In_ VMM_HANDLE H, _In_ LPSTR uszPath, _Inout_ PHANDL
         return;
     }
     // ordinary directory or metadata directory
-    if(!FcNtfs2_Map_GetFromHashParent(H, qwHashPath, &pObNtfsMap)) { return; }
+    if(!FcNtfs2_Map_GetFromHashParent(H, pVfs, qwHashPath, &pObNtfsMap)) { return; }
     if(!fMeta && uszPath[0] && pObNtfsMap->cMap) {
         VMMDLL_VfsList_AddDirectory(pFileList, "$_INFO", NULL);
     }
@@ -1877,13 +2759,23 @@ VOID FcNtfs2_ListDirectory(_In_ VMM_HANDLE H, _In_ LPSTR uszPath, _Inout_ PHANDL
 BOOL FcNtfs2_List(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Inout_ PHANDLE pFileList)
 {
     QWORD cbFileSizeUTF8;
-    FcNtfs2_ListDirectory(H, ctxP->uszPath, pFileList);
-    if(!ctxP->uszPath[0] && FcNtfs2_GetFileSize(H, NULL, &cbFileSizeUTF8, NULL)) {
-        VMMDLL_VfsList_AddFile(pFileList, "ntfs_files.txt", cbFileSizeUTF8, NULL);
+    POB_FCNTFS2_VFS pObVfs = NULL;
+    pObVfs = ObContainer_GetOb((POB_CONTAINER)ctxP->ctxM);
+    FcNtfs2_ListDirectory(H, pObVfs, ctxP->uszPath, pFileList);
+    if(!ctxP->uszPath[0]) {
+        if(FcNtfs2_GetFileSize(H, pObVfs, NULL, &cbFileSizeUTF8, NULL)) {
+            VMMDLL_VfsList_AddFile(pFileList, "ntfs_files.txt", cbFileSizeUTF8, NULL);
+        }
     }
+    Ob_DECREF(pObVfs);
     return TRUE;
 }
 
+VOID FcNtfs2_Close(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
+{
+    Ob_DECREF((POB_CONTAINER)ctxP->ctxM);
+}
+
 VOID FcNtfs2_Notify(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _In_ DWORD fEvent, _In_opt_ PVOID pvEvent, _In_opt_ DWORD cbEvent)
 {
     if(fEvent == VMMDLL_PLUGIN_NOTIFY_FORENSIC_INIT_COMPLETE) {
@@ -1895,12 +2787,14 @@ VOID M_FcNtfs_Initialize(_In_ VMM_HANDLE H, _Inout_ PVMMDLL_PLUGIN_REGINFO pRI)
 {
     if((pRI->magic != VMMDLL_PLUGIN_REGINFO_MAGIC) || (pRI->wVersion != VMMDLL_PLUGIN_REGINFO_VERSION)) { return; }
     if((pRI->tpSystem != VMM_SYSTEM_WINDOWS_64) && (pRI->tpSystem != VMM_SYSTEM_WINDOWS_32)) { return; }
+    if(!(pRI->reg_info.ctxM = (PVMMDLL_PLUGIN_INTERNAL_CONTEXT)ObContainer_New())) { return; }      // Initialize context container
     strcpy_s(pRI->reg_info.uszPathName, 128, "\\forensic\\ntfs");               // module name
     pRI->reg_info.fRootModule = TRUE;                                           // module shows in root directory
     pRI->reg_info.fRootModuleHidden = TRUE;                                     // module hidden by default
     pRI->reg_fn.pfnList = FcNtfs2_List;                                         // List function supported
     pRI->reg_fn.pfnRead = FcNtfs2_Read;                                         // Read function supported
     pRI->reg_fn.pfnNotify = FcNtfs2_Notify;                                     // Notify function supported
+    pRI->reg_fn.pfnClose = FcNtfs2_Close;                                       // Close function supported
     pRI->reg_fnfc.pfnInitialize = FcNtfs2_FcInitialize;                         // Forensic initialize function supported
     pRI->reg_fnfc.pfnIngestPhysmem = FcNtfs2_FcIngestPhysmem;                   // Forensic physmem ingest supported
     pRI->reg_fnfc.pfnIngestFinalize = FcNtfs2_FcIngestFinalize;                 // Forensic ingest finalize function supported
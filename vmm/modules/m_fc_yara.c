@@ -248,7 +248,7 @@ VOID M_FcYara_Initialize(_In_ VMM_HANDLE H, _Inout_ PVMMDLL_PLUGIN_REGINFO pRI)
     // register the user-supplied yara rules:
     if(MFcYara_ExistsRules_User(H)) {
         if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(MFCYARA_CONTEXT)))) { return; }
-        if(!(ctx->pmfObMemFileUser = ObMemFile_New(H, H->vmm.pObCacheMapObCompressedShared))) { return; }
+        if(!(ctx->pmfObMemFileUser = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { return; }
         pRI->reg_info.ctxM = (PVMMDLL_PLUGIN_INTERNAL_CONTEXT)ctx;
         strcpy_s(pRI->reg_info.uszPathName, 128, "\\forensic\\yara");
         pRI->reg_info.fRootModule = TRUE;
@@ -80,8 +80,8 @@ NTSTATUS MHandle_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_
     PVMM_MAP_HANDLEENTRY pe;
     if(VmmMap_GetHandle(H, ctxP->pProcess, &pObHandleMap, TRUE)) {
         if(!_stricmp(ctxP->uszPath, "handles.txt")) {
-            nt = Util_VfsLineFixed_Read(
-                H, (UTIL_VFSLINEFIXED_PFN_CB)MHandle_ReadLine_CB, NULL, MHANDLE_LINELENGTH, MHANDLE_LINEHEADER,
+            nt = Util_VfsLineFixed_ReadCached(
+                H, ctxP->uszPath, pObHandleMap, (UTIL_VFSLINEFIXED_PFN_CB)MHandle_ReadLine_CB, NULL, MHANDLE_LINELENGTH, MHANDLE_LINEHEADER,
                 pObHandleMap->pMap, pObHandleMap->cMap, sizeof(VMM_MAP_HANDLEENTRY),
                 pb, cb, pcbRead, cbOffset
             );
@@ -5,6 +5,7 @@
 //
 
 #include "modules.h"
+#include "../vmmheap.h"
 
 LPCSTR szMHEAP_README =
 "Information about the heap process module                                    \n" \
@@ -152,16 +153,16 @@ NTSTATUS MHeap_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_wr
         return Util_VfsReadFile_FromStrA(szMHEAP_README, pb, cb, pcbRead, cbOffset);
     }
     if(!_stricmp(ctxP->uszPath, "heaps.txt")) {
-        nt = Util_VfsLineFixed_Read(
-            H, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_HeapReadLineCB, &ctx, MHEAP_HEAP_LINELENGTH, MHEAP_HEAP_LINEHEADER,
+        nt = Util_VfsLineFixed_ReadCached(
+            H, ctxP->uszPath, pObHeapMap, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_HeapReadLineCB, &ctx, MHEAP_HEAP_LINELENGTH, MHEAP_HEAP_LINEHEADER,
             pObHeapMap->pMap, pObHeapMap->cMap, sizeof(VMM_MAP_HEAPENTRY),
             pb, cb, pcbRead, cbOffset
         );
         goto finish;
     }
     if(!_stricmp(ctxP->uszPath, "segments.txt")) {
-        nt = Util_VfsLineFixed_Read(
-            H, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_SegmentReadLineCB, &ctx, MHEAP_SEGMENT_LINELENGTH, MHEAP_SEGMENT_LINEHEADER,
+        nt = Util_VfsLineFixed_ReadCached(
+            H, ctxP->uszPath, pObHeapMap, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_SegmentReadLineCB, &ctx, MHEAP_SEGMENT_LINELENGTH, MHEAP_SEGMENT_LINEHEADER,
             pObHeapMap->pSegments, pObHeapMap->cSegments, sizeof(VMM_MAP_HEAP_SEGMENTENTRY),
             pb, cb, pcbRead, cbOffset
         );
@@ -170,8 +171,8 @@ NTSTATUS MHeap_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_wr
     // specific heap
     if(!MHeap_GetAllocPath(H, ctxP, &pObHeapAllocMap, (LPSTR*)&uszPath)) { goto finish; }
     if(!_stricmp(uszPath, "allocations.txt")) {
-        nt = Util_VfsLineFixed_Read(
-            H, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_AllocReadLineCB, &ctx, MHEAP_ALLOC_LINELENGTH, MHEAP_ALLOC_LINEHEADER,
+        nt = Util_VfsLineFixed_ReadCached(
+            H, ctxP->uszPath, pObHeapAllocMap, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_AllocReadLineCB, &ctx, MHEAP_ALLOC_LINELENGTH, MHEAP_ALLOC_LINEHEADER,
             pObHeapAllocMap->pMap, pObHeapAllocMap->cMap, sizeof(VMM_MAP_HEAPALLOCENTRY),
             pb, cb, pcbRead, cbOffset
         );
@@ -179,8 +180,8 @@ NTSTATUS MHeap_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_wr
     }
     if(!_stricmp(uszPath, "allocations-v.txt")) {
         ctx.fVerbose = TRUE;
-        nt = Util_VfsLineFixed_Read(
-            H, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_AllocReadLineCB, &ctx, MHEAP_ALLOCV_LINELENGTH, MHEAP_ALLOCV_LINEHEADER,
+        nt = Util_VfsLineFixed_ReadCached(
+            H, ctxP->uszPath, pObHeapAllocMap, (UTIL_VFSLINEFIXED_PFN_CB)MHeap_AllocReadLineCB, &ctx, MHEAP_ALLOCV_LINELENGTH, MHEAP_ALLOCV_LINEHEADER,
             pObHeapAllocMap->pMap, pObHeapAllocMap->cMap, sizeof(VMM_MAP_HEAPALLOCENTRY),
             pb, cb, pcbRead, cbOffset
         );
@@ -229,6 +230,7 @@ BOOL MHeap_List(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Inout_ PHA
         VMMDLL_VfsList_AddFile(pFileList, "readme.txt", strlen(szMHEAP_README), NULL);
         VMMDLL_VfsList_AddFile(pFileList, "heaps.txt", UTIL_VFSLINEFIXED_LINECOUNT(H, pObHeapMap->cMap) * MHEAP_HEAP_LINELENGTH, NULL);
         VMMDLL_VfsList_AddFile(pFileList, "segments.txt", UTIL_VFSLINEFIXED_LINECOUNT(H, pObHeapMap->cSegments) * MHEAP_SEGMENT_LINELENGTH, NULL);
+        VmmHeapAlloc_InitializeAll(H, ctxP->pProcess);
         goto finish;
     }
     // specific heap
@@ -405,6 +405,10 @@ NTSTATUS LdrModules_Read_ModuleSubFile(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CO
         return LdrModules_ReadFile_Directories(H, pProcess, pModule->vaBase, pb, cb, pcbRead, cbOffset);
     }
     if(!_stricmp(uszPath, "export.txt")) {
+        // batch initialize exports of all modules - the export.txt files of
+        // a process are commonly read one after another. The batch is only
+        // run on the first read of a process per refresh.
+        VmmWinEATIAT_InitializeAll(H, pProcess, TRUE, FALSE);
         if(VmmMap_GetEAT(H, pProcess, pModule, &pObEatMap)) {
             nt = Util_VfsLineFixed_Read(
                 H, (UTIL_VFSLINEFIXED_PFN_CB)LdrModules_ReadLineEAT_CB, pObEatMap, LDRMODULES_LINELENGTH_EAT, LDRMODULES_LINEHEADER_EAT,
@@ -416,6 +420,7 @@ NTSTATUS LdrModules_Read_ModuleSubFile(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CO
         return nt;
     }
     if(!_stricmp(uszPath, "import.txt")) {
+        VmmWinEATIAT_InitializeAll(H, pProcess, FALSE, TRUE);
         if(VmmMap_GetIAT(H, pProcess, pModule, &pObIatMap)) {
             nt = Util_VfsLineFixed_Read(
                 H, (UTIL_VFSLINEFIXED_PFN_CB)LdrModules_ReadLineIAT_CB, pObIatMap, LDRMODULES_LINELENGTH_IAT, LDRMODULES_LINEHEADER_IAT,
@@ -160,8 +160,8 @@ NTSTATUS MemMap_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_w
     // read page table memory map.
     if(!_stricmp(ctxP->uszPath, "pte.txt")) {
         if(VmmMap_GetPte(H, ctxP->pProcess, &pObPteMap, TRUE)) {
-            nt = Util_VfsLineFixed_Read(
-                H, (UTIL_VFSLINEFIXED_PFN_CB)MemMap_PteReadLine_Callback, ctxP->pProcess,
+            nt = Util_VfsLineFixed_ReadCached(
+                H, ctxP->uszPath, pObPteMap, (UTIL_VFSLINEFIXED_PFN_CB)MemMap_PteReadLine_Callback, ctxP->pProcess,
                 (f32 ? MEMMAP_PTE_LINELENGTH_X86 : MEMMAP_PTE_LINELENGTH_X64),
                 (f32 ? MEMMAP_PTE_LINEHEADER_X86 : MEMMAP_PTE_LINEHEADER_X64),
                 pObPteMap->pMap, pObPteMap->cMap, sizeof(VMM_MAP_PTEENTRY),
@@ -173,8 +173,8 @@ NTSTATUS MemMap_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_w
     }
     if(!_stricmp(ctxP->uszPath, "vad.txt")) {
         if(VmmMap_GetVad(H, ctxP->pProcess, &pObVadMap, VMM_VADMAP_TP_FULL)) {
-            nt = Util_VfsLineFixed_Read(
-                H, (UTIL_VFSLINEFIXED_PFN_CB)MemMap_VadReadLineCB, ctxP->pProcess,
+            nt = Util_VfsLineFixed_ReadCached(
+                H, ctxP->uszPath, pObVadMap, (UTIL_VFSLINEFIXED_PFN_CB)MemMap_VadReadLineCB, ctxP->pProcess,
                 (f32 ? MEMMAP_VAD_LINELENGTH_X86 : MEMMAP_VAD_LINELENGTH_X64),
                 (f32 ? MEMMAP_VAD_LINEHEADER_X86 : MEMMAP_VAD_LINEHEADER_X64),
                 pObVadMap->pMap, pObVadMap->cMap, sizeof(VMM_MAP_VADENTRY),
@@ -178,8 +178,8 @@ NTSTATUS MThread_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _Out_
     } else {
         // module root:
         if(CharUtil_StrEquals(ctxP->uszPath, "threads.txt", TRUE)) {
-            nt = Util_VfsLineFixed_Read(
-                H, (UTIL_VFSLINEFIXED_PFN_CB)MThread_ReadLineCB, NULL, MTHREAD_LINELENGTH, MTHREAD_LINEHEADER,
+            nt = Util_VfsLineFixed_ReadCached(
+                H, ctxP->uszPath, pObThreadMap, (UTIL_VFSLINEFIXED_PFN_CB)MThread_ReadLineCB, NULL, MTHREAD_LINELENGTH, MTHREAD_LINEHEADER,
                 pObThreadMap->pMap, pObThreadMap->cMap, sizeof(VMM_MAP_THREADENTRY),
                 pb, cb, pcbRead, cbOffset
             );
@@ -196,6 +196,21 @@ finish:
     return nt;
 }
 
+/*
+* Unwind all thread callstacks of a process in the background once callstack
+* parsing is enabled - this warms the callstack cache in a single batch.
+* -- H
+* -- qwPID
+*/
+VOID MThread_CallstackBatch_ThreadProc(_In_ VMM_HANDLE H, _In_ QWORD qwPID)
+{
+    PVMM_PROCESS pObProcess;
+    if((pObProcess = VmmProcessGet(H, (DWORD)qwPID))) {
+        VmmMap_GetThreadCallstackBatch(H, pObProcess, 0);
+        Ob_DECREF(pObProcess);
+    }
+}
+
 /*
 * Write : function as specified by the module manager. The module manager will
 * call into this callback function whenever a write shall occur from a "file".
@@ -252,6 +267,9 @@ NTSTATUS MThread_Write(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _In_
                     pProcess->pObPersistent->Plugin.flags &= ~VMMOB_PROCESS_PERSISTENT_FLAG_THREAD_CALLSTACK_ENABLE;
                 }
                 ReleaseSRWLockExclusive(&pProcess->pObPersistent->LockUpdateSRW);
+                if(fCsEnableNew) {
+                    VmmWork_Value(H, MThread_CallstackBatch_ThreadProc, pProcess->dwPID, NULL, VMMWORK_FLAG_PRIO_LOW);
+                }
             }
             goto finish;
         }
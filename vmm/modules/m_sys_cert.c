@@ -12,6 +12,7 @@
 #include "../vmmwinreg.h"
 
 #define MSYSCERT_LINE_LENGTH              228ULL
+#define MSYSCERT_WORK_THREADS             8
 
 typedef struct tdMSYSCERT_OB_ENTRY {
     OB ObHdr;
@@ -70,7 +71,7 @@ VOID MSysCert_GetContext_UserAddSingleCert(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_
     if(!(pCertContext = CertCreateCertificateContext(X509_ASN_ENCODING | PKCS_7_ASN_ENCODING, pb + o, cb + 10))) {
         goto fail;
     }
-    if(!(pObResult = Ob_AllocEx(H, OB_TAG_MOD_CERTIFICATES, LMEM_ZEROINIT, sizeof(MSYSCERT_OB_ENTRY), MSysCert_CallbackCleanup, NULL))) {
+    if(!(pObResult = Ob_AllocEx(H, OB_TAG_MOD_CERTIFICATES, LMEM_ZEROINIT, sizeof(MSYSCERT_OB_ENTRY), (OB_CLEANUP_CB)MSysCert_CallbackCleanup, NULL))) {
         goto fail;
     }
     // Subject CN
@@ -120,6 +121,34 @@ VOID MSysCert_GetContext_UserAddCerts(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE
     Ob_DECREF_NULL(&pmkObCertStores);
 }
 
+typedef struct tdMSYSCERT_GETCONTEXT_JOB {
+    POB_REGISTRY_HIVE pObHive;
+    POB_REGISTRY_KEY pObKey;
+    PVMM_MAP_USERENTRY pUser;
+    POB_MAP pmObResult;
+} MSYSCERT_GETCONTEXT_JOB, *PMSYSCERT_GETCONTEXT_JOB;
+
+typedef struct tdMSYSCERT_GETCONTEXT_WORK {
+    LONG iJob;
+    DWORD cJob;
+    MSYSCERT_GETCONTEXT_JOB Job[];
+} MSYSCERT_GETCONTEXT_WORK, *PMSYSCERT_GETCONTEXT_WORK;
+
+/*
+* Worker thread function: parse certificate stores from the shared job list.
+* Each job (a SystemCertificates key of a hive) has its own result map so that
+* the results may be merged in job order afterwards.
+*/
+VOID MSysCert_GetContext_ThreadProc(_In_ VMM_HANDLE H, _In_ PMSYSCERT_GETCONTEXT_WORK pWork)
+{
+    LONG iJob;
+    PMSYSCERT_GETCONTEXT_JOB pJob;
+    while(!H->fAbort && ((iJob = InterlockedIncrement(&pWork->iJob) - 1) < (LONG)pWork->cJob)) {
+        pJob = pWork->Job + iJob;
+        MSysCert_GetContext_UserAddCerts(H, pJob->pObHive, pJob->pObKey, pJob->pUser, pJob->pmObResult);
+    }
+}
+
 /*
 * Retrieve the context map containing information about the certificates.
 * CALLER DECREF: return
@@ -130,39 +159,72 @@ POB_MAP MSysCert_GetContext(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP)
 {
     LPSTR uszCertStoresUSER[] = { "ROOT\\Software\\Microsoft\\SystemCertificates", "ROOT\\Software\\Policies\\Microsoft\\SystemCertificates" };
     LPSTR uszCertStoresSYSTEM[] = { "HKLM\\SOFTWARE\\Microsoft\\SystemCertificates", "HKLM\\SOFTWARE\\Policies\\Microsoft\\SystemCertificates" };
-    DWORD iMap, i;
+    DWORD iMap, i, cWork = 0;
     POB_MAP pObCtx = NULL;
     PVMMOB_MAP_USER pObUserMap = NULL;
-    POB_REGISTRY_KEY pObKey = NULL;
     POB_REGISTRY_HIVE pObHive = NULL;
+    PMSYSCERT_GETCONTEXT_JOB pJob;
+    PMSYSCERT_GETCONTEXT_WORK pWork = NULL;
+    PMSYSCERT_OB_ENTRY pObEntry = NULL;
+    PVOID pvWork[MSYSCERT_WORK_THREADS];
+    PVMM_WORK_START_ROUTINE_PVOID_PFN pfnWork[MSYSCERT_WORK_THREADS];
     POB_CONTAINER ctxM = (POB_CONTAINER)ctxP->ctxM;
     if((pObCtx = ObContainer_GetOb(ctxM))) { return pObCtx; }
     EnterCriticalSection(&H->vmm.LockUpdateModule);
     if((pObCtx = ObContainer_GetOb(ctxM))) { goto finish; }
     if(!(pObCtx = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB))) { goto finish; }
-    // Retrieve system (local machine) certificates:
-    for(i = 0; i < sizeof(uszCertStoresSYSTEM) / sizeof(LPSTR); i++) {
-        if(VmmWinReg_KeyHiveGetByFullPath(H, uszCertStoresSYSTEM[i], &pObHive, &pObKey)) {
-            MSysCert_GetContext_UserAddCerts(H, pObHive, pObKey, NULL, pObCtx);
-            Ob_DECREF_NULL(&pObKey);
-            Ob_DECREF_NULL(&pObHive);
+    VmmMap_GetUser(H, &pObUserMap);
+    i = _countof(uszCertStoresSYSTEM) + (pObUserMap ? pObUserMap->cMap * _countof(uszCertStoresUSER) : 0);
+    if(!(pWork = LocalAlloc(LMEM_ZEROINIT, sizeof(MSYSCERT_GETCONTEXT_WORK) + i * sizeof(MSYSCERT_GETCONTEXT_JOB)))) { goto finish_set; }
+    // 1: collect jobs - system (local machine) certificates:
+    for(i = 0; i < _countof(uszCertStoresSYSTEM); i++) {
+        pJob = pWork->Job + pWork->cJob;
+        if(VmmWinReg_KeyHiveGetByFullPath(H, uszCertStoresSYSTEM[i], &pJob->pObHive, &pJob->pObKey)) {
+            pWork->cJob++;
         }
     }
-    // Retrieve user certificates:
-    if(VmmMap_GetUser(H, &pObUserMap)) {
-        for(iMap = 0; iMap < pObUserMap->cMap; iMap++) {
-            if((pObHive = VmmWinReg_HiveGetByAddress(H, pObUserMap->pMap[iMap].vaRegHive))) {
-                for(i = 0; i < sizeof(uszCertStoresUSER) / sizeof(LPSTR); i++) {
-                    if((pObKey = VmmWinReg_KeyGetByPath(H, pObHive, uszCertStoresUSER[i]))) {
-                        MSysCert_GetContext_UserAddCerts(H, pObHive, pObKey, pObUserMap->pMap + iMap, pObCtx);
-                        Ob_DECREF_NULL(&pObKey);
-                    }
+    // 1: collect jobs - user certificates:
+    for(iMap = 0; pObUserMap && (iMap < pObUserMap->cMap); iMap++) {
+        if((pObHive = VmmWinReg_HiveGetByAddress(H, pObUserMap->pMap[iMap].vaRegHive))) {
+            for(i = 0; i < _countof(uszCertStoresUSER); i++) {
+                pJob = pWork->Job + pWork->cJob;
+                if((pJob->pObKey = VmmWinReg_KeyGetByPath(H, pObHive, uszCertStoresUSER[i]))) {
+                    pJob->pObHive = Ob_INCREF(pObHive);
+                    pJob->pUser = pObUserMap->pMap + iMap;
+                    pWork->cJob++;
                 }
-                Ob_DECREF_NULL(&pObHive);
             }
+            Ob_DECREF_NULL(&pObHive);
         }
-        Ob_DECREF_NULL(&pObUserMap);
     }
+    for(i = 0; i < pWork->cJob; i++) {
+        if(!(pWork->Job[i].pmObResult = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB))) { goto finish_set; }
+    }
+    // 2: parse certificate stores in parallel:
+    cWork = min(MSYSCERT_WORK_THREADS, pWork->cJob);
+    for(i = 0; i < cWork; i++) {
+        pfnWork[i] = (PVMM_WORK_START_ROUTINE_PVOID_PFN)MSysCert_GetContext_ThreadProc;
+        pvWork[i] = pWork;
+    }
+    if(cWork) {
+        VmmWorkWaitMultiple2_Void(H, cWork, pfnWork, pvWork);
+    }
+    // 3: merge job results in job order:
+    for(i = 0; i < pWork->cJob; i++) {
+        while((pObEntry = ObMap_GetNext(pWork->Job[i].pmObResult, pObEntry))) {
+            ObMap_Push(pObCtx, pObEntry->qwIdMapKey, pObEntry);
+        }
+    }
+finish_set:
+    if(pWork) {
+        for(i = 0; i < pWork->cJob; i++) {
+            Ob_DECREF(pWork->Job[i].pmObResult);
+            Ob_DECREF(pWork->Job[i].pObKey);
+            Ob_DECREF(pWork->Job[i].pObHive);
+        }
+        LocalFree(pWork);
+    }
+    Ob_DECREF(pObUserMap);
     ObContainer_SetOb(ctxM, pObCtx);
 finish:
     LeaveCriticalSection(&H->vmm.LockUpdateModule);
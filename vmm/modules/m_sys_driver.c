@@ -183,8 +183,8 @@ NTSTATUS MSysDriver_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _O
     LPCSTR uszPath;
     if(!_stricmp(ctxP->uszPath, "devices.txt")) {
         if(!VmmMap_GetKDevice(H, &pObDevMap)) { goto cleanup; }
-        nt = Util_VfsLineFixed_Read(
-            H, (UTIL_VFSLINEFIXED_PFN_CB)MSysDriver_DevReadLineCB, NULL, MSYSDRIVER_DEV_LINELENGTH, MSYSDRIVER_DEV_LINEHEADER,
+        nt = Util_VfsLineFixed_ReadCached(
+            H, ctxP->uszPath, pObDevMap, (UTIL_VFSLINEFIXED_PFN_CB)MSysDriver_DevReadLineCB, NULL, MSYSDRIVER_DEV_LINELENGTH, MSYSDRIVER_DEV_LINEHEADER,
             pObDevMap->pMap, pObDevMap->cMap, sizeof(VMM_MAP_KDEVICEENTRY),
             pb, cb, pcbRead, cbOffset
         );
@@ -196,8 +196,8 @@ NTSTATUS MSysDriver_Read(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _O
         if(VmmMap_GetModule(H, pObSystemProcess, 0, &pObModuleMap)) {
             VmmMap_GetModuleEntryEx3(H, pObModuleMap, &pmObModuleByVA);
         }
-        nt = Util_VfsLineFixed_Read(
-            H, (UTIL_VFSLINEFIXED_PFN_CB)MSysDriver_DrvReadLineCB, pmObModuleByVA, MSYSDRIVER_DRV_LINELENGTH, MSYSDRIVER_DRV_LINEHEADER,
+        nt = Util_VfsLineFixed_ReadCached(
+            H, ctxP->uszPath, pObDrvMap, (UTIL_VFSLINEFIXED_PFN_CB)MSysDriver_DrvReadLineCB, pmObModuleByVA, MSYSDRIVER_DRV_LINELENGTH, MSYSDRIVER_DRV_LINEHEADER,
             pObDrvMap->pMap, pObDrvMap->cMap, sizeof(VMM_MAP_KDRIVERENTRY),
             pb, cb, pcbRead, cbOffset
         );
@@ -65,7 +65,8 @@ typedef struct tdOB {
         VOID(*_pfnRef_1)(_In_ PVOID pOb);   // callback - when object reach refcount 1 (not initial)
         QWORD _Filler2;
     };
-    DWORD _Filler3[5];
+    DWORD _iPool;                           // allocation size class pool index + 1 (0 = not pooled)
+    DWORD _Filler3[4];
     DWORD _count;                           // reference count
     // external object manager functionality below: (= ok to use)
     union { VMM_HANDLE H; QWORD _Filler4; };// vmm user handle (supplied at alloc)
@@ -140,6 +141,42 @@ VOID Ob_XDECREF_NULL(_In_opt_ PVOID *ppOb);
 */
 BOOL Ob_VALID_TAG(_In_ PVOID pObIn, _In_ DWORD tag);
 
+typedef struct tdOB_CORE_STATISTICS {
+    QWORD cAlloc;                           // total number of object allocations
+    QWORD cAllocPool;                       // allocations served from a size class pool
+    QWORD cFree;                            // total number of object frees
+    QWORD cFreePool;                        // frees returned to a size class pool
+} OB_CORE_STATISTICS, *POB_CORE_STATISTICS;
+
+/*
+* Enable or disable object manager allocation statistics. Statistics counting
+* is reference counted; it's active as long as at least one caller (such as a
+* VMM_HANDLE with function call statistics enabled) has it enabled.
+* -- fEnable
+*/
+VOID Ob_SetStatisticsEnabled(_In_ BOOL fEnable);
+
+/*
+* Retrieve object manager allocation statistics. The statistics are global
+* (shared between all VMM_HANDLEs) and are only counted while enabled.
+* Allocations not served from a pool correspond to a LocalAlloc() call.
+* -- pStatistics
+*/
+VOID Ob_GetStatistics(_Out_ POB_CORE_STATISTICS pStatistics);
+
+/*
+* Activate the size class pools. This is called when a VMM_HANDLE is added.
+* Caller must serialize calls to Ob_PoolInitialize() and Ob_PoolDrain().
+*/
+VOID Ob_PoolInitialize();
+
+/*
+* Deactivate the size class pools and free all objects currently kept in the
+* global pools and the calling thread's cache. Objects freed after this call
+* are returned to LocalFree. This is called when the last VMM_HANDLE is closed.
+*/
+VOID Ob_PoolDrain();
+
 
 
 // ----------------------------------------------------------------------------
@@ -390,6 +427,14 @@ POB_DATA ObSet_GetAll(_In_opt_ POB_SET pvs);
 // functions are called - in which order may change and on-going iterations
 // of the set with ObMap_Get/ObMap_GetNext may fail.
 // The ObMap is an object manager object and must be DECREF'ed when required.
+//
+// A map created with OB_MAP_FLAGS_SHARDED is split into shards by key hash,
+// each with its own lock, to reduce lock contention on heavily used global
+// keyed maps (caches). Sharded maps have relaxed contracts:
+//  - order is only guaranteed within a shard; iteration is shard by shard.
+//  - values are only guaranteed to be unique within a shard.
+//  - ObMap_SortEntryIndex* and ObMap_GetNextByKeySorted are not supported.
+//  - OB_MAP_FLAGS_NOKEY may not be combined with OB_MAP_FLAGS_SHARDED.
 // ----------------------------------------------------------------------------
 
 typedef struct tdOB_MAP *POB_MAP;
@@ -398,6 +443,7 @@ typedef struct tdOB_MAP *POB_MAP;
 #define OB_MAP_FLAGS_OBJECT_OB          0x01
 #define OB_MAP_FLAGS_OBJECT_LOCALFREE   0x02
 #define OB_MAP_FLAGS_NOKEY              0x04
+#define OB_MAP_FLAGS_SHARDED            0x08
 
 typedef struct tdOB_MAP_ENTRY {
     QWORD k;
@@ -1086,6 +1132,21 @@ typedef struct tdOB_COMPRESSED *POB_COMPRESSED;
 #define OB_COMPRESSED_CACHED_ENTRIES_MAX        0x40
 #define OB_COMPRESSED_CACHED_ENTRIES_MAXSIZE    0x00100000
 
+#define OB_COMPRESSED_CODEC_FAST                0   // LZ4 (Linux) / XPRESS (Windows)
+#define OB_COMPRESSED_CODEC_HC                  1   // LZ4-HC (Linux) / XPRESS_HUFF (Windows)
+#define OB_COMPRESSED_CODEC_STORED              2   // (info only) incompressible data stored as-is
+
+typedef struct tdOB_COMPRESSED_INFO {
+    DWORD tpCodec;                  // OB_COMPRESSED_CODEC_*
+    DWORD cObjects;                 // number of compressed objects
+    DWORD cObjectsStored;           // number of objects stored as-is (incompressible)
+    DWORD cDecompress;              // number of decompressions (cache misses)
+    QWORD cbUncompressed;
+    QWORD cbCompressed;
+    QWORD qwCompressUs;             // total compression time in microseconds
+    QWORD qwDecompressUs;           // total decompression time in microseconds
+} OB_COMPRESSED_INFO, *POB_COMPRESSED_INFO;
+
 /*
 * Create a new compressed buffer object from a byte buffer.
 * It's strongly recommended to supply a global cache map to use.
@@ -1099,6 +1160,20 @@ typedef struct tdOB_COMPRESSED *POB_COMPRESSED;
 _Success_(return != NULL)
 POB_COMPRESSED ObCompressed_NewFromByte(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_reads_(cb) PBYTE pb, _In_ DWORD cb);
 
+/*
+* Create a new compressed buffer object from a byte buffer using a specific
+* codec. It's strongly recommended to supply a global cache map to use.
+* CALLER DECREF: return
+* -- H
+* -- pcmg = optional global (per VMM_HANDLE) cache map to use.
+* -- pb
+* -- cb
+* -- tpCodec = OB_COMPRESSED_CODEC_FAST or OB_COMPRESSED_CODEC_HC.
+* -- return
+*/
+_Success_(return != NULL)
+POB_COMPRESSED ObCompressed_NewFromByteEx(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD tpCodec);
+
 /*
 * Create a new compressed buffer object from a zero terminated string.
 * It's strongly recommended to supply a global cache map to use.
@@ -1127,6 +1202,16 @@ DWORD ObCompress_Size(_In_opt_ POB_COMPRESSED pdc);
 _Success_(return != NULL)
 POB_DATA ObCompressed_GetData(_In_opt_ POB_COMPRESSED pdc);
 
+/*
+* Retrieve compression statistics (codec, sizes, compression and decompression
+* times) of the compressed data object.
+* -- pdc
+* -- pInfo
+* -- return
+*/
+_Success_(return)
+BOOL ObCompressed_GetInfo(_In_opt_ POB_COMPRESSED pdc, _Out_ POB_COMPRESSED_INFO pInfo);
+
 
 
 // ----------------------------------------------------------------------------
@@ -1153,6 +1238,28 @@ typedef struct tdOB_MEMFILE *POB_MEMFILE;
 _Success_(return != NULL)
 POB_MEMFILE ObMemFile_New(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg);
 
+/*
+* Create a new empty memory file using a specific compression codec for its
+* blocks. It's strongly recommended to supply a global cache map to use.
+* CALLER DECREF: return
+* -- H
+* -- pcmg = optional global (per VMM_HANDLE) cache map to use.
+* -- tpCodec = OB_COMPRESSED_CODEC_FAST or OB_COMPRESSED_CODEC_HC.
+* -- return
+*/
+_Success_(return != NULL)
+POB_MEMFILE ObMemFile_NewEx(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_ DWORD tpCodec);
+
+/*
+* Retrieve aggregated compression statistics of the compressed blocks of the
+* ObMemFile. The uncompressed tail buffer is not included.
+* -- pmf
+* -- pInfo
+* -- return
+*/
+_Success_(return)
+BOOL ObMemFile_GetCompressionInfo(_In_opt_ POB_MEMFILE pmf, _Out_ POB_COMPRESSED_INFO pInfo);
+
 /*
 * Retrieve byte count of the ObMemFile.
 * -- pmf
@@ -21,7 +21,12 @@ typedef struct tdOB_COMPRESSED {
     DWORD cbCompressed;
     PBYTE pbCompressed;
     USHORT usRtlCompressionFormat;
+    BYTE tpCodec;                   // OB_COMPRESSED_CODEC_*
     POB_CACHEMAP pcm;
+    // statistics (performance counter ticks):
+    QWORD tcCompress;
+    QWORD tcDecompress;
+    DWORD cDecompress;
 } OB_COMPRESSED, *POB_COMPRESSED;
 
 #define OB_COMPRESSED_CALL_SYNCHRONIZED_IMPLEMENTATION_EXCLUSIVE(pm, RetTp, RetValFail, fn) {   \
@@ -63,144 +68,156 @@ typedef NTSTATUS WINAPI OB_COMPRESSED_RtlDecompressBuffer(
     PULONG FinalUncompressedSize
 );
 
+static struct {
+    BOOL fInitialized;
+    SRWLOCK LockSRW;
+    OB_COMPRESSED_RtlCompressBuffer *pfnRtlCompressBuffer;
+    OB_COMPRESSED_RtlDecompressBuffer *pfnRtlDecompressBuffer;
+    USHORT usRtlCompressionFormat[2];   // indexed by OB_COMPRESSED_CODEC_FAST/HC
+    ULONG cbCompressBufferWorkSpace[2];
+} g_ObCompressedRtl = { 0 };
+
 /*
-* Internal helper function to compress bytes.
-* -- H
-* -- pb
-* -- cb
-* -- ppb
-* -- pcb
-* -- pusRtlCompressionFormat
+* Ensure the ntdll.dll compression functions are resolved.
 * -- return
-* CALLER LocalFree: *ppb
 */
 _Success_(return)
-BOOL _ObCompressed_Compress(_In_opt_ VMM_HANDLE H, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PBYTE *ppb, _Out_ PDWORD pcb, _Out_ PUSHORT pusRtlCompressionFormat)
+BOOL _ObCompressed_RtlInitialize()
 {
-    BOOL f;
-    NTSTATUS nt;
-    DWORD cbResult;
-    PBYTE pbResult = NULL, pbBuffer = NULL, pbWorkBuffer = NULL;
-    static OB_COMPRESSED_RtlCompressBuffer *pfnRtlCompressBuffer = NULL;
-    static OB_COMPRESSED_RtlGetCompressionWorkSpaceSize *pfnRtlGetCompressionWorkSpaceSize = NULL;
-    static SRWLOCK InitLockSRW = { 0 };
-    static USHORT usRtlCompressionFormat = 0;
-    static ULONG ulCompressBufferWorkSpaceSize = 0;
-    static ULONG ulCompressFragmentWorkSpaceSize = 0;
+    ULONG i, cbCompressFragmentWorkSpace;
     HANDLE hNtDll = 0;
-    // 1: ensure initialization
-    if(!pfnRtlCompressBuffer) {
-        AcquireSRWLockExclusive(&InitLockSRW);
-        f = !pfnRtlCompressBuffer &&
-            (usRtlCompressionFormat = IsWindows8OrGreater() ? COMPRESSION_FORMAT_XPRESS : COMPRESSION_FORMAT_DEFAULT) &&
-            (hNtDll = LoadLibraryA("ntdll.dll")) &&
-            (pfnRtlGetCompressionWorkSpaceSize = (OB_COMPRESSED_RtlGetCompressionWorkSpaceSize *)GetProcAddress(hNtDll, "RtlGetCompressionWorkSpaceSize")) &&
-            (0 == pfnRtlGetCompressionWorkSpaceSize(usRtlCompressionFormat, &ulCompressBufferWorkSpaceSize, &ulCompressFragmentWorkSpaceSize));
-        if(f) {
-            pfnRtlCompressBuffer = (OB_COMPRESSED_RtlCompressBuffer *)GetProcAddress(hNtDll, "RtlCompressBuffer");
-        }
-        ReleaseSRWLockExclusive(&InitLockSRW);
-        if(hNtDll) {
+    OB_COMPRESSED_RtlGetCompressionWorkSpaceSize *pfnRtlGetCompressionWorkSpaceSize = NULL;
+    if(!g_ObCompressedRtl.fInitialized) {
+        AcquireSRWLockExclusive(&g_ObCompressedRtl.LockSRW);
+        if(!g_ObCompressedRtl.fInitialized && (hNtDll = LoadLibraryA("ntdll.dll"))) {
+            g_ObCompressedRtl.usRtlCompressionFormat[OB_COMPRESSED_CODEC_FAST] = IsWindows8OrGreater() ? COMPRESSION_FORMAT_XPRESS : COMPRESSION_FORMAT_DEFAULT;
+            g_ObCompressedRtl.usRtlCompressionFormat[OB_COMPRESSED_CODEC_HC] = IsWindows8OrGreater() ? COMPRESSION_FORMAT_XPRESS_HUFF : COMPRESSION_FORMAT_DEFAULT;
+            if((pfnRtlGetCompressionWorkSpaceSize = (OB_COMPRESSED_RtlGetCompressionWorkSpaceSize *)GetProcAddress(hNtDll, "RtlGetCompressionWorkSpaceSize"))) {
+                for(i = 0; i < 2; i++) {
+                    if(pfnRtlGetCompressionWorkSpaceSize(g_ObCompressedRtl.usRtlCompressionFormat[i], &g_ObCompressedRtl.cbCompressBufferWorkSpace[i], &cbCompressFragmentWorkSpace)) { break; }
+                }
+                if(i == 2) {
+                    g_ObCompressedRtl.pfnRtlCompressBuffer = (OB_COMPRESSED_RtlCompressBuffer *)GetProcAddress(hNtDll, "RtlCompressBuffer");
+                    g_ObCompressedRtl.pfnRtlDecompressBuffer = (OB_COMPRESSED_RtlDecompressBuffer *)GetProcAddress(hNtDll, "RtlDecompressBuffer");
+                }
+            }
             FreeLibrary(hNtDll);
-            hNtDll = 0;
         }
-        if(!pfnRtlCompressBuffer) { return FALSE; }
+        g_ObCompressedRtl.fInitialized = TRUE;
+        ReleaseSRWLockExclusive(&g_ObCompressedRtl.LockSRW);
     }
-    // 2: compress
-    if(!(pbBuffer = LocalAlloc(0, cb))) { goto fail; }
-    if(!(pbWorkBuffer = LocalAlloc(0, ulCompressBufferWorkSpaceSize))) { goto fail; }
-    nt = pfnRtlCompressBuffer(usRtlCompressionFormat, pb, cb, pbBuffer, cb, 4096, &cbResult, pbWorkBuffer);
-    if(nt) { goto fail; }
-    if(!(pbResult = LocalAlloc(0, cbResult))) { goto fail; }
-    memcpy(pbResult, pbBuffer, cbResult);
-    *pcb = cbResult;
-    *ppb = pbResult;
-    *pusRtlCompressionFormat = usRtlCompressionFormat;
-fail:
-    LocalFree(pbBuffer);
-    LocalFree(pbWorkBuffer);
-    return pbResult ? TRUE : FALSE;
+    return g_ObCompressedRtl.pfnRtlCompressBuffer && g_ObCompressedRtl.pfnRtlDecompressBuffer;
 }
 
 /*
-* Retrieve uncompressed from a compressed data object.
-* CALLER DECREF: return
+* Internal codec function to compress bytes into a destination buffer.
 * -- pdc
+* -- pb
+* -- cb
+* -- pbDst
+* -- cbDst
+* -- return = the compressed size on success, zero on fail.
+*/
+DWORD _ObCompressed_CompressCodec(_In_ POB_COMPRESSED pdc, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_writes_(cbDst) PBYTE pbDst, _In_ DWORD cbDst)
+{
+    NTSTATUS nt;
+    ULONG cbResult = 0;
+    PBYTE pbWorkSpace = NULL;
+    if(!_ObCompressed_RtlInitialize()) { return 0; }
+    pdc->usRtlCompressionFormat = g_ObCompressedRtl.usRtlCompressionFormat[pdc->tpCodec];
+    if(!(pbWorkSpace = LocalAlloc(0, g_ObCompressedRtl.cbCompressBufferWorkSpace[pdc->tpCodec]))) { return 0; }
+    nt = g_ObCompressedRtl.pfnRtlCompressBuffer(pdc->usRtlCompressionFormat, pb, cb, pbDst, cbDst, 4096, &cbResult, pbWorkSpace);
+    LocalFree(pbWorkSpace);
+    return nt ? 0 : cbResult;
+}
+
+/*
+* Internal codec function to decompress the data object into a buffer of
+* size pdc->cbUncompressed.
+* -- pdc
+* -- pbDst
 * -- return
 */
-_Success_(return != NULL)
-POB_DATA _ObCompressed_GetData(_In_ POB_COMPRESSED pdc)
+_Success_(return)
+BOOL _ObCompressed_DecompressCodec(_In_ POB_COMPRESSED pdc, _Out_writes_(pdc->cbUncompressed) PBYTE pbDst)
 {
-    static SRWLOCK InitLockSRW = { 0 };
-    static OB_COMPRESSED_RtlDecompressBuffer *pfnRtlDecompressBuffer = NULL;
-    HANDLE hNtDll = 0;
-    POB_DATA pObData = NULL;
     ULONG ulFinalUncompressedSize = 0;
-    DWORD status;
-    // 1: ensure compress functionality:
-    if(!pfnRtlDecompressBuffer) {
-        AcquireSRWLockExclusive(&InitLockSRW);
-        if(!pfnRtlDecompressBuffer) {
-            if((hNtDll = LoadLibraryA("ntdll.dll"))) {
-                pfnRtlDecompressBuffer = (OB_COMPRESSED_RtlDecompressBuffer *)GetProcAddress(hNtDll, "RtlDecompressBuffer");
-                FreeLibrary(hNtDll);
-            }
-        }
-        ReleaseSRWLockExclusive(&InitLockSRW);
-        if(!pfnRtlDecompressBuffer) { return NULL; }
-    }
-    // 2: fetch from cache (if possible):
-    if((pObData = ObCacheMap_GetByKey(pdc->pcm, pdc->qwCacheKey))) {
-        return pObData;
-    }
-    // 3: decompress and insert into cache
-    if(!(pObData = Ob_AllocEx(pdc->ObHdr.H, OB_TAG_CORE_DATA, 0, sizeof(OB) + pdc->cbUncompressed, NULL, NULL))) {
-        return NULL;
-    }
-    status = pfnRtlDecompressBuffer(pdc->usRtlCompressionFormat, pObData->pb, pdc->cbUncompressed, pdc->pbCompressed, pdc->cbCompressed, &ulFinalUncompressedSize);
-    if(status != 0) {
-        Ob_DECREF(pObData);
-        return NULL;
-    }
-    if(pObData->ObHdr.cbData <= OB_COMPRESSED_CACHED_ENTRIES_MAXSIZE) {    // only cache objects smaller than threshold
-        ObCacheMap_Push(pdc->pcm, pdc->qwCacheKey, pObData, 0);
-    }
-    return pObData;
+    if(!_ObCompressed_RtlInitialize()) { return FALSE; }
+    return 0 == g_ObCompressedRtl.pfnRtlDecompressBuffer(pdc->usRtlCompressionFormat, pbDst, pdc->cbUncompressed, pdc->pbCompressed, pdc->cbCompressed, &ulFinalUncompressedSize);
 }
 
 #endif /* _WIN32 */
 #ifdef LINUX
 
 #include <lz4.h>
+#include <lz4hc.h>
 
 /*
-* Internal helper function to compress bytes.
-* -- H
+* Internal codec function to compress bytes into a destination buffer.
+* -- pdc
+* -- pb
+* -- cb
+* -- pbDst
+* -- cbDst
+* -- return = the compressed size on success, zero on fail.
+*/
+DWORD _ObCompressed_CompressCodec(_In_ POB_COMPRESSED pdc, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_writes_(cbDst) PBYTE pbDst, _In_ DWORD cbDst)
+{
+    int cbResult;
+    if(pdc->tpCodec == OB_COMPRESSED_CODEC_HC) {
+        cbResult = LZ4_compress_HC((const char *)pb, (char *)pbDst, (int)cb, (int)cbDst, LZ4HC_CLEVEL_DEFAULT);
+    } else {
+        cbResult = LZ4_compress_default((const char *)pb, (char *)pbDst, (int)cb, (int)cbDst);
+    }
+    return (cbResult > 0) ? (DWORD)cbResult : 0;
+}
+
+/*
+* Internal codec function to decompress the data object into a buffer of
+* size pdc->cbUncompressed. LZ4 and LZ4-HC share the same block format.
+* -- pdc
+* -- pbDst
+* -- return
+*/
+_Success_(return)
+BOOL _ObCompressed_DecompressCodec(_In_ POB_COMPRESSED pdc, _Out_writes_(pdc->cbUncompressed) PBYTE pbDst)
+{
+    return (int)pdc->cbUncompressed == LZ4_decompress_safe((const char *)pdc->pbCompressed, (char *)pbDst, (int)pdc->cbCompressed, (int)pdc->cbUncompressed);
+}
+
+#endif /* LINUX */
+
+/*
+* Internal helper function to compress bytes into the compressed data object.
+* Data is compressed directly into its final allocation which is shrunk to
+* the compressed size afterwards. Data which does not compress (or if the
+* codec fails) is stored as-is with codec OB_COMPRESSED_CODEC_STORED.
+* -- pdc
 * -- pb
 * -- cb
-* -- ppb
-* -- pcb
-* -- pusRtlCompressionFormat
 * -- return
-* CALLER LocalFree: *ppb
 */
 _Success_(return)
-BOOL _ObCompressed_Compress(_In_opt_ VMM_HANDLE H, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Out_ PBYTE * ppb, _Out_ PDWORD pcb, _Out_ PUSHORT pusRtlCompressionFormat)
+BOOL _ObCompressed_Compress(_In_ POB_COMPRESSED pdc, _In_reads_(cb) PBYTE pb, _In_ DWORD cb)
 {
-    DWORD cbResult = 0;
-    PBYTE pbResult = NULL, pbBuffer = NULL;
-    if(!(pbBuffer = LocalAlloc(0, cb))) { goto fail; }
-    if(!(cbResult = LZ4_compress_default(pb, pbBuffer, cb, cb))) {
-        goto fail;
+    QWORD tcStart, tcEnd;
+    DWORD cbResult;
+    PBYTE pbShrink;
+    QueryPerformanceCounter((PLARGE_INTEGER)&tcStart);
+    if(!(pdc->pbCompressed = LocalAlloc(0, max(1, cb)))) { return FALSE; }
+    cbResult = cb ? _ObCompressed_CompressCodec(pdc, pb, cb, pdc->pbCompressed, cb) : 0;
+    if(!cbResult || (cbResult >= cb)) {
+        memcpy(pdc->pbCompressed, pb, cb);
+        cbResult = cb;
+        pdc->tpCodec = OB_COMPRESSED_CODEC_STORED;
+    } else if((pbShrink = LocalReAlloc(pdc->pbCompressed, cbResult, 0))) {
+        pdc->pbCompressed = pbShrink;
     }
-    if(!(pbResult = LocalAlloc(0, cbResult))) { goto fail; }
-    memcpy(pbResult, pbBuffer, cbResult);
-    *pcb = cbResult;
-    *ppb = pbResult;
-    *pusRtlCompressionFormat = 0;
-fail:
-    LocalFree(pbBuffer);
-    return pbResult ? TRUE : FALSE;
+    pdc->cbCompressed = cbResult;
+    pdc->cbUncompressed = cb;
+    QueryPerformanceCounter((PLARGE_INTEGER)&tcEnd);
+    pdc->tcCompress = tcEnd - tcStart;
+    return TRUE;
 }
 
 /*
@@ -212,27 +229,37 @@ fail:
 _Success_(return != NULL)
 POB_DATA _ObCompressed_GetData(_In_ POB_COMPRESSED pdc)
 {
+    BOOL f;
+    QWORD tcStart, tcEnd;
     POB_DATA pObData = NULL;
-    // 1: ensure compress functionality:
-    // NOT REQUIRED ON LINUX
-    // 2: fetch from cache (if possible):
+    // 1: fetch from cache (if possible):
     if((pObData = ObCacheMap_GetByKey(pdc->pcm, pdc->qwCacheKey))) {
         return pObData;
     }
-    // 3: decompress and insert into cache
-    if(!(pObData = Ob_AllocEx(pdc->ObHdr.H, OB_TAG_CORE_DATA, 0, sizeof(OB) + pdc->cbUncompressed, NULL, NULL))) { return NULL; }
-    if((int)pObData->ObHdr.cbData != LZ4_decompress_safe(pdc->pbCompressed, pObData->pb, pdc->cbCompressed, pdc->cbUncompressed)) {
+    // 2: decompress and insert into cache
+    if(!(pObData = Ob_AllocEx(pdc->ObHdr.H, OB_TAG_CORE_DATA, 0, sizeof(OB) + pdc->cbUncompressed, NULL, NULL))) {
+        return NULL;
+    }
+    QueryPerformanceCounter((PLARGE_INTEGER)&tcStart);
+    if(pdc->tpCodec == OB_COMPRESSED_CODEC_STORED) {
+        memcpy(pObData->pb, pdc->pbCompressed, pdc->cbUncompressed);
+        f = TRUE;
+    } else {
+        f = _ObCompressed_DecompressCodec(pdc, pObData->pb);
+    }
+    QueryPerformanceCounter((PLARGE_INTEGER)&tcEnd);
+    if(!f) {
         Ob_DECREF(pObData);
         return NULL;
     }
-    if(pObData->ObHdr.cbData < OB_COMPRESSED_CACHED_ENTRIES_MAXSIZE) {    // only cache objects smaller than threshold
+    pdc->tcDecompress += tcEnd - tcStart;
+    pdc->cDecompress++;
+    if(pObData->ObHdr.cbData <= OB_COMPRESSED_CACHED_ENTRIES_MAXSIZE) {    // only cache objects smaller than threshold
         ObCacheMap_Push(pdc->pcm, pdc->qwCacheKey, pObData, 0);
     }
     return pObData;
 }
 
-#endif /* LINUX */
-
 /*
 * Retrieve uncompressed from a compressed data object.
 * CALLER DECREF: return
@@ -257,23 +284,25 @@ VOID _ObCompressed_ObCloseCallback(_In_ POB_COMPRESSED pObCompressed)
 }
 
 /*
-* Create a new compressed buffer object from a byte buffer.
-* It's strongly recommended to supply a global cache map to use.
+* Create a new compressed buffer object from a byte buffer using a specific
+* codec. It's strongly recommended to supply a global cache map to use.
 * CALLER DECREF: return
 * -- H
 * -- pcmg = optional global (per VMM_HANDLE) cache map to use.
 * -- pb
 * -- cb
+* -- tpCodec = OB_COMPRESSED_CODEC_FAST or OB_COMPRESSED_CODEC_HC.
 * -- return
 */
 _Success_(return != NULL)
-POB_COMPRESSED ObCompressed_NewFromByte(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_reads_(cb) PBYTE pb, _In_ DWORD cb)
+POB_COMPRESSED ObCompressed_NewFromByteEx(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD tpCodec)
 {
     POB_COMPRESSED pObC = NULL;
+    if((tpCodec != OB_COMPRESSED_CODEC_FAST) && (tpCodec != OB_COMPRESSED_CODEC_HC)) { return NULL; }
     pObC = Ob_AllocEx(H, OB_TAG_CORE_COMPRESSED, LMEM_ZEROINIT, sizeof(OB_COMPRESSED), (OB_CLEANUP_CB)_ObCompressed_ObCloseCallback, NULL);
     if(!pObC) { return NULL; }
-    if(!_ObCompressed_Compress(H, pb, cb, &pObC->pbCompressed, &pObC->cbCompressed, &pObC->usRtlCompressionFormat)) { goto fail; }
-    pObC->cbUncompressed = cb;
+    pObC->tpCodec = (BYTE)tpCodec;
+    if(!_ObCompressed_Compress(pObC, pb, cb)) { goto fail; }
     pObC->qwCacheKey = (QWORD)pObC ^ ((QWORD)pObC << 47) ^ (QWORD)pObC->pbCompressed ^ (QWORD)pb ^ ((QWORD)cb << 31);
     pObC->pcm = Ob_INCREF(pcmg);
     Ob_INCREF(pObC);
@@ -281,6 +310,22 @@ fail:
     return Ob_DECREF(pObC);
 }
 
+/*
+* Create a new compressed buffer object from a byte buffer.
+* It's strongly recommended to supply a global cache map to use.
+* CALLER DECREF: return
+* -- H
+* -- pcmg = optional global (per VMM_HANDLE) cache map to use.
+* -- pb
+* -- cb
+* -- return
+*/
+_Success_(return != NULL)
+POB_COMPRESSED ObCompressed_NewFromByte(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_reads_(cb) PBYTE pb, _In_ DWORD cb)
+{
+    return ObCompressed_NewFromByteEx(H, pcmg, pb, cb, OB_COMPRESSED_CODEC_FAST);
+}
+
 /*
 * Create a new compressed buffer object from a zero terminated string.
 * It's strongly recommended to supply a global cache map to use.
@@ -307,3 +352,40 @@ DWORD ObCompress_Size(_In_opt_ POB_COMPRESSED pdc)
 {
     return OB_COMPRESSED_IS_VALID(pdc) ? pdc->cbUncompressed : 0;
 }
+
+/*
+* Retrieve compression statistics of the compressed data object.
+* -- pdc
+* -- pInfo
+* -- return
+*/
+_Success_(return)
+BOOL _ObCompressed_GetInfo(_In_ POB_COMPRESSED pdc, _Out_ POB_COMPRESSED_INFO pInfo)
+{
+    QWORD qwFreq = 0;
+    QueryPerformanceFrequency((PLARGE_INTEGER)&qwFreq);
+    if(!qwFreq) { qwFreq = 1000000; }
+    ZeroMemory(pInfo, sizeof(OB_COMPRESSED_INFO));
+    pInfo->tpCodec = pdc->tpCodec;
+    pInfo->cObjects = 1;
+    pInfo->cObjectsStored = (pdc->tpCodec == OB_COMPRESSED_CODEC_STORED) ? 1 : 0;
+    pInfo->cbUncompressed = pdc->cbUncompressed;
+    pInfo->cbCompressed = pdc->cbCompressed;
+    pInfo->cDecompress = pdc->cDecompress;
+    pInfo->qwCompressUs = pdc->tcCompress * 1000000 / qwFreq;
+    pInfo->qwDecompressUs = pdc->tcDecompress * 1000000 / qwFreq;
+    return TRUE;
+}
+
+/*
+* Retrieve compression statistics (codec, sizes, compression and decompression
+* times) of the compressed data object. Useful for tuning codec selection.
+* -- pdc
+* -- pInfo
+* -- return
+*/
+_Success_(return)
+BOOL ObCompressed_GetInfo(_In_opt_ POB_COMPRESSED pdc, _Out_ POB_COMPRESSED_INFO pInfo)
+{
+    OB_COMPRESSED_CALL_SYNCHRONIZED_IMPLEMENTATION_EXCLUSIVE(pdc, BOOL, FALSE, _ObCompressed_GetInfo(pdc, pInfo));
+}
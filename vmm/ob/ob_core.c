@@ -24,6 +24,274 @@
 #define OB_DEBUG_FOOTER_SIZE            0x20
 #define OB_DEBUG_FOOTER_MAGIC           0x001122334455667788
 
+//-----------------------------------------------------------------------------
+// SIZE CLASS POOLS:
+// Small objects are frequently allocated and freed on hot paths (sets used in
+// prefetch, work units, scatter wrappers). Freed objects of up to 0x2000 bytes
+// are kept in per size class SLists (up to a max byte budget per class) and
+// re-used by subsequent allocations instead of calling LocalAlloc/LocalFree.
+// Size classes are spaced four per power of two (max 25% overhead).
+// The pools are global and shared between all VMM_HANDLEs. They are active
+// from when the first VMM_HANDLE is added until Ob_PoolDrain() is called when
+// the last VMM_HANDLE is closed; while inactive LocalAlloc/LocalFree is used.
+// On Linux the SList emulation is protected by a lock, each thread therefore
+// keeps a small per size class cache in front of the global SLists. A thread
+// cache is flushed to the global SLists when the thread exits and discarded
+// (freed) on first use after the pools have been drained/re-activated.
+//-----------------------------------------------------------------------------
+
+#define OB_POOL_CLASS_COUNT             25
+#define OB_POOL_CLASS_MAXFREE_BYTES     0x10000
+#define OB_POOL_CLASS_MAXFREE_MIN       0x20
+#define OB_POOL_TCACHE_MAXFREE_BYTES    0x2000
+#define OB_POOL_TCACHE_MAXFREE_MIN      4
+
+static const DWORD OB_POOL_CLASS_SIZE[OB_POOL_CLASS_COUNT] = {
+    0x0080, 0x00a0, 0x00c0, 0x00e0, 0x0100, 0x0140, 0x0180, 0x01c0, 0x0200,
+    0x0280, 0x0300, 0x0380, 0x0400, 0x0500, 0x0600, 0x0700, 0x0800,
+    0x0a00, 0x0c00, 0x0e00, 0x1000, 0x1400, 0x1800, 0x1c00, 0x2000
+};
+static SLIST_HEADER g_ObPoolFree[OB_POOL_CLASS_COUNT]   = { 0 };
+static volatile BOOL g_ObPoolActive                     = FALSE;
+static volatile LONG g_ObPoolGeneration                 = 0;
+static OB_CORE_STATISTICS g_ObStatistics                = { 0 };
+static volatile LONG g_ObStatisticsEnabled              = 0;
+
+#ifdef LINUX
+typedef struct tdOB_POOL_TCACHE {
+    LONG iGeneration;                       // g_ObPoolGeneration when cache was (re-)initialized
+    DWORD c[OB_POOL_CLASS_COUNT];
+    PSLIST_ENTRY pHead[OB_POOL_CLASS_COUNT];
+} OB_POOL_TCACHE, *POB_POOL_TCACHE;
+
+static __thread OB_POOL_TCACHE g_ObPoolTCache           = { 0 };
+static pthread_key_t g_ObPoolTCacheKey;
+static BOOL g_ObPoolTCacheKeyValid                      = FALSE;
+#endif /* LINUX */
+
+/*
+* Enable or disable object manager allocation statistics. Statistics counting
+* is reference counted; it's active as long as at least one caller (such as a
+* VMM_HANDLE with function call statistics enabled) has it enabled.
+* -- fEnable
+*/
+VOID Ob_SetStatisticsEnabled(_In_ BOOL fEnable)
+{
+    if(fEnable) {
+        InterlockedIncrement(&g_ObStatisticsEnabled);
+    } else {
+        InterlockedDecrement(&g_ObStatisticsEnabled);
+    }
+}
+
+/*
+* Retrieve object manager allocation statistics. The statistics are global
+* (shared between all VMM_HANDLEs) and are only counted while enabled.
+* Allocations not served from a pool correspond to a LocalAlloc() call.
+* -- pStatistics
+*/
+VOID Ob_GetStatistics(_Out_ POB_CORE_STATISTICS pStatistics)
+{
+    memcpy(pStatistics, &g_ObStatistics, sizeof(OB_CORE_STATISTICS));
+}
+
+// max number of free objects kept in a global size class pool / thread cache.
+#define Ob_PoolClassMaxFree(iPool)      (max(OB_POOL_CLASS_MAXFREE_MIN, OB_POOL_CLASS_MAXFREE_BYTES / OB_POOL_CLASS_SIZE[iPool]))
+#define Ob_PoolTCacheMaxFree(iPool)     (max(OB_POOL_TCACHE_MAXFREE_MIN, OB_POOL_TCACHE_MAXFREE_BYTES / OB_POOL_CLASS_SIZE[iPool]))
+
+#ifdef LINUX
+/*
+* Empty a thread cache - either to the global pools (if the cache belongs to
+* the current pool generation) or by freeing the objects.
+* -- pTC
+* -- fToGlobal
+*/
+VOID Ob_PoolTCacheFlush(_In_ POB_POOL_TCACHE pTC, _In_ BOOL fToGlobal)
+{
+    DWORD iPool;
+    PSLIST_ENTRY pe;
+    fToGlobal = fToGlobal && g_ObPoolActive && (pTC->iGeneration == g_ObPoolGeneration);
+    for(iPool = 0; iPool < OB_POOL_CLASS_COUNT; iPool++) {
+        while((pe = pTC->pHead[iPool])) {
+            pTC->pHead[iPool] = pe->Next;
+            if(fToGlobal && (QueryDepthSList(&g_ObPoolFree[iPool]) < Ob_PoolClassMaxFree(iPool))) {
+                InterlockedPushEntrySList(&g_ObPoolFree[iPool], pe);
+            } else {
+                LocalFree(pe);
+            }
+        }
+        pTC->c[iPool] = 0;
+    }
+}
+
+/*
+* Thread exit callback: return the exiting thread's cached objects.
+* -- pv = the thread cache of the exiting thread.
+*/
+VOID Ob_PoolTCacheExit(_In_ PVOID pv)
+{
+    POB_POOL_TCACHE pTC = (POB_POOL_TCACHE)pv;
+    Ob_PoolTCacheFlush(pTC, TRUE);
+    // re-register on any later use by other thread exit callbacks:
+    pTC->iGeneration = 0;
+}
+
+/*
+* Retrieve the thread cache of the current thread. A cache belonging to an
+* earlier pool generation is discarded and the cache is (re-)registered for
+* flush on thread exit.
+* -- return
+*/
+POB_POOL_TCACHE Ob_PoolTCache()
+{
+    POB_POOL_TCACHE pTC = &g_ObPoolTCache;
+    LONG iGeneration = g_ObPoolGeneration;
+    if(pTC->iGeneration != iGeneration) {
+        Ob_PoolTCacheFlush(pTC, FALSE);
+        pTC->iGeneration = iGeneration;
+        pthread_setspecific(g_ObPoolTCacheKey, pTC);
+    }
+    return pTC;
+}
+#endif /* LINUX */
+
+/*
+* Activate the size class pools. This is called when a VMM_HANDLE is added.
+* Caller must serialize calls to Ob_PoolInitialize() and Ob_PoolDrain().
+*/
+VOID Ob_PoolInitialize()
+{
+    if(g_ObPoolActive) { return; }
+#ifdef LINUX
+    if(!g_ObPoolTCacheKeyValid) {
+        if(pthread_key_create(&g_ObPoolTCacheKey, Ob_PoolTCacheExit)) { return; }
+        g_ObPoolTCacheKeyValid = TRUE;
+    }
+#endif /* LINUX */
+    InterlockedIncrement(&g_ObPoolGeneration);
+    g_ObPoolActive = TRUE;
+}
+
+/*
+* Deactivate the size class pools and free all objects currently kept in the
+* global pools and the calling thread's cache. Objects freed after this call
+* are returned to LocalFree. This is called when the last VMM_HANDLE is closed.
+*/
+VOID Ob_PoolDrain()
+{
+    DWORD iPool;
+    PSLIST_ENTRY pe;
+    g_ObPoolActive = FALSE;
+#ifdef LINUX
+    Ob_PoolTCacheFlush(&g_ObPoolTCache, FALSE);
+    if(g_ObPoolTCacheKeyValid) {
+        // delete the key to not leave a thread exit callback registered in
+        // case the library is unloaded. caches of other still running threads
+        // are discarded when used next (generation mismatch).
+        pthread_key_delete(g_ObPoolTCacheKey);
+        g_ObPoolTCacheKeyValid = FALSE;
+    }
+#endif /* LINUX */
+    for(iPool = 0; iPool < OB_POOL_CLASS_COUNT; iPool++) {
+        while((pe = InterlockedPopEntrySList(&g_ObPoolFree[iPool]))) {
+            LocalFree(pe);
+        }
+    }
+}
+
+/*
+* Retrieve the size class pool index of an allocation size (binary search).
+* -- cb
+* -- return = pool index, or OB_POOL_CLASS_COUNT if too large to pool.
+*/
+DWORD Ob_PoolClass(_In_ SIZE_T cb)
+{
+    DWORD iLo = 0, iHi = OB_POOL_CLASS_COUNT, iMid;
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) / 2;
+        if(cb <= OB_POOL_CLASS_SIZE[iMid]) {
+            iHi = iMid;
+        } else {
+            iLo = iMid + 1;
+        }
+    }
+    return iLo;
+}
+
+/*
+* Allocate memory for an object - from a size class pool if possible.
+* -- uFlags = flags as given by LocalAlloc.
+* -- cb = bytes to allocate (incl. headers and debug footer).
+* -- return
+*/
+_Success_(return != NULL)
+POB Ob_AllocPool(_In_ UINT uFlags, _In_ SIZE_T cb)
+{
+    POB pOb = NULL;
+    DWORD iPool = Ob_PoolClass(cb);
+    BOOL fStatistics = g_ObStatisticsEnabled ? TRUE : FALSE;
+#ifdef LINUX
+    POB_POOL_TCACHE pTC;
+#endif /* LINUX */
+    if(fStatistics) { InterlockedIncrement64(&g_ObStatistics.cAlloc); }
+    if((iPool < OB_POOL_CLASS_COUNT) && g_ObPoolActive) {
+#ifdef LINUX
+        pTC = Ob_PoolTCache();
+        if((pOb = (POB)pTC->pHead[iPool])) {
+            pTC->pHead[iPool] = ((PSLIST_ENTRY)pOb)->Next;
+            pTC->c[iPool]--;
+        }
+#endif /* LINUX */
+        if(pOb || (pOb = (POB)InterlockedPopEntrySList(&g_ObPoolFree[iPool]))) {
+            if(fStatistics) { InterlockedIncrement64(&g_ObStatistics.cAllocPool); }
+            if(uFlags & LMEM_ZEROINIT) {
+                ZeroMemory(pOb, cb);
+            }
+        } else if(!(pOb = (POB)LocalAlloc(uFlags, OB_POOL_CLASS_SIZE[iPool]))) {
+            return NULL;
+        }
+        pOb->_iPool = iPool + 1;
+        return pOb;
+    }
+    if((pOb = (POB)LocalAlloc(uFlags, cb))) {
+        pOb->_iPool = 0;
+    }
+    return pOb;
+}
+
+/*
+* Free memory of an object - to its size class pool if possible.
+* -- pOb
+*/
+VOID Ob_FreePool(_In_ POB pOb)
+{
+    DWORD iPool = pOb->_iPool;
+    BOOL fStatistics = g_ObStatisticsEnabled ? TRUE : FALSE;
+#ifdef LINUX
+    POB_POOL_TCACHE pTC;
+#endif /* LINUX */
+    if(fStatistics) { InterlockedIncrement64(&g_ObStatistics.cFree); }
+    if(iPool && (iPool <= OB_POOL_CLASS_COUNT) && g_ObPoolActive) {
+        iPool--;
+#ifdef LINUX
+        pTC = Ob_PoolTCache();
+        if(pTC->c[iPool] < Ob_PoolTCacheMaxFree(iPool)) {
+            if(fStatistics) { InterlockedIncrement64(&g_ObStatistics.cFreePool); }
+            ((PSLIST_ENTRY)pOb)->Next = pTC->pHead[iPool];
+            pTC->pHead[iPool] = (PSLIST_ENTRY)pOb;
+            pTC->c[iPool]++;
+            return;
+        }
+#endif /* LINUX */
+        if(QueryDepthSList(&g_ObPoolFree[iPool]) < Ob_PoolClassMaxFree(iPool)) {
+            if(fStatistics) { InterlockedIncrement64(&g_ObStatistics.cFreePool); }
+            InterlockedPushEntrySList(&g_ObPoolFree[iPool], (PSLIST_ENTRY)pOb);
+            return;
+        }
+    }
+    LocalFree(pOb);
+}
+
 /*
 * Allocate a new object manager memory object.
 * -- H = an optional handle to embed as OB.H in the header.
@@ -39,7 +307,7 @@ PVOID Ob_AllocEx(_In_opt_ VMM_HANDLE H, _In_ DWORD tag, _In_ UINT uFlags, _In_ S
 {
     POB pOb;
     if((uBytes > 0x40000000) || (uBytes < sizeof(OB))) { return NULL; }
-    pOb = (POB)LocalAlloc(uFlags, uBytes + OB_DEBUG_FOOTER_SIZE);
+    pOb = Ob_AllocPool(uFlags, uBytes + OB_DEBUG_FOOTER_SIZE);
     if(!pOb) { return NULL; }
     pOb->_magic1 = OB_HEADER_MAGIC;
     pOb->_magic2 = OB_HEADER_MAGIC;
@@ -107,7 +375,7 @@ PVOID Ob_XDECREF(_In_opt_ PVOID pObIn)
 #ifdef OB_DEBUG_MEMZERO
                 ZeroMemory(pOb, sizeof(OB) + pOb->cbData);
 #endif /* OB_DEBUG_MEMZERO */
-                LocalFree(pOb);
+                Ob_FreePool(pOb);
             } else if((c == 1) && pOb->_pfnRef_1) {
                 pOb->_pfnRef_1(pOb);
                 return pOb;
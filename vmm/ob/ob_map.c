@@ -12,6 +12,10 @@
 // of the set with ObMap_Get/ObMap_GetNext may fail.
 // The ObMap is an object manager object and must be DECREF'ed when required.
 //
+// A sharded map (OB_MAP_FLAGS_SHARDED) consists of a number of ordinary maps
+// (shards) selected by key hash. Keyed operations only lock a single shard.
+// Order is only guaranteed within each shard.
+//
 // (c) Ulf Frisk, 2019-2024
 // Author: Ulf Frisk, pcileech@frizk.net
 //
@@ -24,6 +28,10 @@
 #define OB_MAP_TABLE_MAX_CAPACITY   OB_MAP_ENTRIES_DIRECTORY * OB_MAP_ENTRIES_TABLE * OB_MAP_ENTRIES_STORE
 #define OB_MAP_HASH_FUNCTION(v)     (13 * (v + _rotr16((WORD)v, 9) + _rotr((DWORD)v, 17) + _rotr64(v, 31)))
 
+#define OB_MAP_SHARDS               0x10
+#define OB_MAP_SHARD_INDEX(k)       ((DWORD)(OB_MAP_HASH_FUNCTION((QWORD)(k)) >> 20) & (OB_MAP_SHARDS - 1))
+#define OB_MAP_SHARD(pm, k)         (pm->Shard[OB_MAP_SHARD_INDEX(k)])
+
 #define OB_MAP_INDEX_DIRECTORY(i)   ((i >> 17) & (OB_MAP_ENTRIES_DIRECTORY - 1))
 #define OB_MAP_INDEX_TABLE(i)       ((i >> 8) & (OB_MAP_ENTRIES_TABLE - 1))
 #define OB_MAP_INDEX_STORE(i)       (i & (OB_MAP_ENTRIES_STORE - 1))
@@ -38,6 +46,8 @@ typedef struct tdOB_MAP {
     BOOL fKey;
     BOOL fObjectsOb;
     BOOL fObjectsLocalFree;
+    BOOL fSharded;
+    struct tdOB_MAP *Shard[OB_MAP_SHARDS];
     PDWORD pHashMapKey;
     PDWORD pHashMapValue;
     union {
@@ -69,6 +79,10 @@ typedef struct tdOB_MAP {
     return retVal;                                                                      \
 }
 
+#define OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, fn) {                                    \
+    if(OB_MAP_IS_VALID(pm) && pm->fSharded) { return fn; }                              \
+}
+
 /*
 * Ob_DECREF / LocalFree all objects in the map (if required)
 * -- pObMap
@@ -98,6 +112,12 @@ VOID _ObMap_ObFreeAllObjects(_In_ POB_MAP pObMap)
 VOID _ObMap_ObCloseCallback(_In_ POB_MAP pObMap)
 {
     DWORD iDirectory, iTable;
+    if(pObMap->fSharded) {
+        for(iDirectory = 0; iDirectory < OB_MAP_SHARDS; iDirectory++) {
+            Ob_DECREF(pObMap->Shard[iDirectory]);
+        }
+        return;
+    }
     _ObMap_ObFreeAllObjects(pObMap);
     if(pObMap->fLargeMode) {
         for(iDirectory = 0; iDirectory < OB_MAP_ENTRIES_DIRECTORY; iDirectory++) {
@@ -194,6 +214,218 @@ BOOL _ObMap_GetEntryIndexFromKeyOrValue(_In_ POB_MAP pm, _In_ BOOL fValueHash, _
     }
 }
 
+//-----------------------------------------------------------------------------
+// SHARDED MAP FUNCTIONALITY BELOW:
+// The sharded map forwards keyed operations to the shard selected by the key
+// hash. Operations by value or by index are forwarded to the shards in order.
+// Each shard is an ordinary ObMap with its own lock - no lock is held on the
+// sharded map itself.
+//-----------------------------------------------------------------------------
+
+DWORD _ObMapSharded_Size(_In_ POB_MAP pm)
+{
+    DWORD i, c = 0;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        c += ObMap_Size(pm->Shard[i]);
+    }
+    return c;
+}
+
+BOOL _ObMapSharded_Exists(_In_ POB_MAP pm, _In_ PVOID pvObject)
+{
+    DWORD i;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        if(ObMap_Exists(pm->Shard[i], pvObject)) { return TRUE; }
+    }
+    return FALSE;
+}
+
+PVOID _ObMapSharded_GetByIndex(_In_ POB_MAP pm, _In_ DWORD index)
+{
+    DWORD i, c;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        c = ObMap_Size(pm->Shard[i]);
+        if(index < c) {
+            return ObMap_GetByIndex(pm->Shard[i], index);
+        }
+        index -= c;
+    }
+    return NULL;
+}
+
+PVOID _ObMapSharded_GetFirst(_In_ POB_MAP pm, _In_ DWORD iShard)
+{
+    PVOID pv;
+    for(; iShard < OB_MAP_SHARDS; iShard++) {
+        if((pv = ObMap_GetNext(pm->Shard[iShard], NULL))) { return pv; }
+    }
+    return NULL;
+}
+
+PVOID _ObMapSharded_GetNext(_In_ POB_MAP pm, _In_opt_ PVOID pvObject)
+{
+    DWORD i;
+    PVOID pv;
+    if(!pvObject) {
+        return _ObMapSharded_GetFirst(pm, 0);
+    }
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        if(ObMap_Exists(pm->Shard[i], pvObject)) {
+            if((pv = ObMap_GetNext(pm->Shard[i], pvObject))) { return pv; }
+            return _ObMapSharded_GetFirst(pm, i + 1);
+        }
+    }
+    if(pm->fObjectsOb) { Ob_DECREF(pvObject); }
+    return NULL;
+}
+
+PVOID _ObMapSharded_GetNextByKey(_In_ POB_MAP pm, _In_ QWORD qwKey, _In_opt_ PVOID pvObject)
+{
+    PVOID pv;
+    DWORD iShard = OB_MAP_SHARD_INDEX(qwKey);
+    if(!pvObject) {
+        return _ObMapSharded_GetFirst(pm, 0);
+    }
+    if((pv = ObMap_GetNextByKey(pm->Shard[iShard], qwKey, pvObject))) { return pv; }
+    if(!ObMap_ExistsKey(pm->Shard[iShard], qwKey)) { return NULL; }
+    return _ObMapSharded_GetFirst(pm, iShard + 1);
+}
+
+PVOID _ObMapSharded_GetNextByKeySorted(_In_ POB_MAP pm, _In_opt_ PVOID pvObject)
+{
+    // not supported: shards are not sorted amongst each other.
+    if(pm->fObjectsOb) { Ob_DECREF(pvObject); }
+    return NULL;
+}
+
+PVOID _ObMapSharded_GetNextByIndex(_In_ POB_MAP pm, _Inout_ PDWORD pdwIndex, _In_opt_ PVOID pvObject)
+{
+    if(pvObject) {
+        *pdwIndex = *pdwIndex - 1;
+        if(pm->fObjectsOb) { Ob_DECREF(pvObject); }
+    } else {
+        *pdwIndex = _ObMapSharded_Size(pm);
+    }
+    return *pdwIndex ? _ObMapSharded_GetByIndex(pm, *pdwIndex - 1) : NULL;
+}
+
+_Success_(return != 0)
+QWORD _ObMapSharded_GetKey(_In_ POB_MAP pm, _In_ PVOID pvObject)
+{
+    DWORD i;
+    QWORD qwKey;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        if((qwKey = ObMap_GetKey(pm->Shard[i], pvObject))) { return qwKey; }
+    }
+    return 0;
+}
+
+PVOID _ObMapSharded_Peek(_In_ POB_MAP pm, _Out_opt_ PQWORD pKey, _In_ BOOL fPop)
+{
+    DWORD i;
+    PVOID pv;
+    for(i = OB_MAP_SHARDS; i; i--) {
+        if(fPop) {
+            if((pv = ObMap_PopWithKey(pm->Shard[i - 1], pKey))) { return pv; }
+        } else {
+            if((pv = ObMap_Peek(pm->Shard[i - 1]))) {
+                if(pKey) { *pKey = ObMap_PeekKey(pm->Shard[i - 1]); }
+                return pv;
+            }
+        }
+    }
+    if(pKey) { *pKey = 0; }
+    return NULL;
+}
+
+QWORD _ObMapSharded_PeekKey(_In_ POB_MAP pm)
+{
+    QWORD qwKey;
+    PVOID pv = _ObMapSharded_Peek(pm, &qwKey, FALSE);
+    if(pm->fObjectsOb) { Ob_DECREF(pv); }
+    return qwKey;
+}
+
+_Success_(return)
+BOOL _ObMapSharded_Filter(_In_ POB_MAP pm, _In_opt_ PVOID ctx, _In_ OB_MAP_FILTER_PFN_CB pfnFilterCB)
+{
+    DWORD i;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        ObMap_Filter(pm->Shard[i], ctx, pfnFilterCB);
+    }
+    return TRUE;
+}
+
+_Success_(return != NULL)
+POB_SET _ObMapSharded_FilterSet(_In_ POB_MAP pm, _In_opt_ PVOID ctx, _In_ OB_MAP_FILTERSET_PFN_CB pfnFilterSetCB)
+{
+    DWORD i;
+    POB_SET pObSet, pObSetShard;
+    if(!(pObSet = ObSet_New(pm->ObHdr.H))) { return NULL; }
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        if((pObSetShard = ObMap_FilterSet(pm->Shard[i], ctx, pfnFilterSetCB))) {
+            ObSet_PushSet(pObSet, pObSetShard);
+            Ob_DECREF(pObSetShard);
+        }
+    }
+    return pObSet;
+}
+
+PVOID _ObMapSharded_Remove(_In_ POB_MAP pm, _In_ PVOID pvObject)
+{
+    DWORD i;
+    PVOID pv;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        if((pv = ObMap_Remove(pm->Shard[i], pvObject))) { return pv; }
+    }
+    return NULL;
+}
+
+DWORD _ObMapSharded_RemoveByFilter(_In_ POB_MAP pm, _In_opt_ PVOID ctx, _In_ OB_MAP_FILTER_REMOVE_PFN_CB pfnFilterRemoveCB)
+{
+    DWORD i, c = 0;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        c += ObMap_RemoveByFilter(pm->Shard[i], ctx, pfnFilterRemoveCB);
+    }
+    return c;
+}
+
+_Success_(return)
+BOOL _ObMapSharded_Clear(_In_ POB_MAP pm)
+{
+    DWORD i;
+    for(i = 0; i < OB_MAP_SHARDS; i++) {
+        ObMap_Clear(pm->Shard[i]);
+    }
+    return TRUE;
+}
+
+_Success_(return)
+BOOL _ObMapSharded_PushAll(_In_ POB_MAP pmDst, _In_ POB_MAP pmSrc)
+{
+    DWORD i;
+    POB_MAP_ENTRY pe;
+    if(!OB_MAP_IS_VALID(pmSrc) || (pmDst == pmSrc) || (pmDst->fObjectsOb != pmSrc->fObjectsOb) || pmDst->fObjectsLocalFree || pmSrc->fObjectsLocalFree) { return FALSE; }
+    if(pmSrc->fSharded) {
+        for(i = 0; i < OB_MAP_SHARDS; i++) {
+            ObMap_PushAll(pmDst, pmSrc->Shard[i]);
+        }
+        return TRUE;
+    }
+    if(pmDst->fSharded) {
+        AcquireSRWLockShared(&pmSrc->LockSRW);
+        for(i = 1; i < pmSrc->c; i++) {
+            pe = _ObMap_GetFromIndex(pmSrc, i);
+            ObMap_Push(OB_MAP_SHARD(pmDst, pe->k), pe->k, pe->v);
+        }
+        ReleaseSRWLockShared(&pmSrc->LockSRW);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+
+
 //-----------------------------------------------------------------------------
 // RETRIEVE/GET FUNCTIONALITY BELOW:
 // ObMap_Size,   ObMap_Exists,  ObMap_ExistsKey, ObMap_GetByIndex,
@@ -214,6 +446,7 @@ BOOL _ObMap_Exists(_In_ POB_MAP pm, _In_ BOOL fValueHash, _In_ QWORD kv)
 */
 DWORD ObMap_Size(_In_opt_ POB_MAP pm)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Size(pm))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, DWORD, 0, pm->c - 1)
 }
 
@@ -225,6 +458,7 @@ DWORD ObMap_Size(_In_opt_ POB_MAP pm)
 */
 BOOL ObMap_Exists(_In_opt_ POB_MAP pm, _In_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Exists(pm, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, BOOL, FALSE, _ObMap_Exists(pm, TRUE, (QWORD)pvObject))
 }
 
@@ -236,6 +470,7 @@ BOOL ObMap_Exists(_In_opt_ POB_MAP pm, _In_ PVOID pvObject)
 */
 BOOL ObMap_ExistsKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, ObMap_ExistsKey(OB_MAP_SHARD(pm, qwKey), qwKey))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, BOOL, FALSE, _ObMap_Exists(pm, FALSE, qwKey))
 }
 
@@ -410,6 +645,7 @@ POB_SET _ObMap_FilterSet(_In_ POB_MAP pm, _In_opt_ PVOID ctx, _In_ OB_MAP_FILTER
 */
 PVOID ObMap_GetByIndex(_In_opt_ POB_MAP pm, _In_ DWORD index)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_GetByIndex(pm, index))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetByEntryIndex(pm, index + 1))  // (+1 == account/adjust for index 0 (reserved))
 }
 
@@ -422,6 +658,7 @@ PVOID ObMap_GetByIndex(_In_opt_ POB_MAP pm, _In_ DWORD index)
 */
 PVOID ObMap_GetByKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, ObMap_GetByKey(OB_MAP_SHARD(pm, qwKey), qwKey))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetByKey(pm, qwKey))
 }
 
@@ -438,6 +675,7 @@ PVOID ObMap_GetByKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey)
 */
 PVOID ObMap_GetNext(_In_opt_ POB_MAP pm, _In_opt_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_GetNext(pm, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetNext(pm, pvObject))
 }
 
@@ -458,6 +696,7 @@ PVOID ObMap_GetNext(_In_opt_ POB_MAP pm, _In_opt_ PVOID pvObject)
 */
 PVOID ObMap_GetNextByKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_opt_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_GetNextByKey(pm, qwKey, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetNextByKey(pm, qwKey, pvObject))
 }
 
@@ -476,6 +715,7 @@ PVOID ObMap_GetNextByKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_opt_ PVOID p
 */
 PVOID ObMap_GetNextByKeySorted(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_opt_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_GetNextByKeySorted(pm, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetNextByKeySorted(pm, qwKey, pvObject))
 }
 
@@ -497,6 +737,7 @@ PVOID ObMap_GetNextByKeySorted(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_opt_ P
 */
 PVOID ObMap_GetNextByIndex(_In_opt_ POB_MAP pm, _Inout_ PDWORD pdwIndex, _In_opt_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_GetNextByIndex(pm, pdwIndex, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetNextByIndex(pm, pdwIndex, pvObject))
 }
 
@@ -509,6 +750,7 @@ PVOID ObMap_GetNextByIndex(_In_opt_ POB_MAP pm, _Inout_ PDWORD pdwIndex, _In_opt
 _Success_(return != 0)
 QWORD ObMap_GetKey(_In_opt_ POB_MAP pm, _In_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_GetKey(pm, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, QWORD, 0, _ObMap_GetKey(pm, pvObject))
 }
 
@@ -520,6 +762,7 @@ QWORD ObMap_GetKey(_In_opt_ POB_MAP pm, _In_ PVOID pvObject)
 */
 PVOID ObMap_Peek(_In_opt_ POB_MAP pm)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Peek(pm, NULL, FALSE))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, PVOID, NULL, _ObMap_GetByEntryIndex(pm, pm->c - 1))
 }
 
@@ -530,6 +773,7 @@ PVOID ObMap_Peek(_In_opt_ POB_MAP pm)
 */
 QWORD ObMap_PeekKey(_In_opt_ POB_MAP pm)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_PeekKey(pm))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, QWORD, 0, _ObMap_GetFromEntryIndex(pm, FALSE, pm->c - 1))
 }
 
@@ -544,6 +788,7 @@ _Success_(return)
 BOOL ObMap_Filter(_In_opt_ POB_MAP pm, _In_opt_ PVOID ctx, _In_opt_ OB_MAP_FILTER_PFN_CB pfnFilterCB)
 {
     if(!pfnFilterCB) { return FALSE; }
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Filter(pm, ctx, pfnFilterCB))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, BOOL, FALSE, _ObMap_Filter(pm, ctx, pfnFilterCB));
 }
 
@@ -559,6 +804,7 @@ _Success_(return != NULL)
 POB_SET ObMap_FilterSet(_In_opt_ POB_MAP pm, _In_opt_ PVOID ctx, _In_opt_ OB_MAP_FILTERSET_PFN_CB pfnFilterSetCB)
 {
     if(!pfnFilterSetCB) { return NULL; }
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_FilterSet(pm, ctx, pfnFilterSetCB))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pm, POB_SET, NULL, _ObMap_FilterSet(pm, ctx, pfnFilterSetCB));
 }
 
@@ -640,6 +886,7 @@ DWORD _ObMap_RemoveByFilter(_In_ POB_MAP pm, _In_opt_ PVOID ctx, _In_ OB_MAP_FIL
 _Success_(return != NULL)
 PVOID ObMap_Pop(_In_opt_ POB_MAP pm)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Peek(pm, NULL, TRUE))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, PVOID, NULL, _ObMap_RetrieveAndRemoveByEntryIndex(pm, pm->c - 1, NULL))
 }
 
@@ -653,6 +900,7 @@ PVOID ObMap_Pop(_In_opt_ POB_MAP pm)
 _Success_(return != NULL)
 PVOID ObMap_PopWithKey(_In_opt_ POB_MAP pm, _Out_opt_ PQWORD pKey)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Peek(pm, pKey, TRUE))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, PVOID, NULL, _ObMap_RetrieveAndRemoveByEntryIndex(pm, pm->c - 1, pKey))
 }
 
@@ -665,6 +913,7 @@ PVOID ObMap_PopWithKey(_In_opt_ POB_MAP pm, _Out_opt_ PQWORD pKey)
 */
 PVOID ObMap_Remove(_In_opt_ POB_MAP pm, _In_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Remove(pm, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, PVOID, NULL, _ObMap_RemoveOrRemoveByKey(pm, TRUE, (QWORD)pvObject))
 }
 
@@ -678,6 +927,7 @@ PVOID ObMap_Remove(_In_opt_ POB_MAP pm, _In_ PVOID pvObject)
 */
 PVOID ObMap_RemoveByKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, ObMap_RemoveByKey(OB_MAP_SHARD(pm, qwKey), qwKey))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, PVOID, NULL, _ObMap_RemoveOrRemoveByKey(pm, FALSE, qwKey))
 }
 
@@ -691,6 +941,7 @@ PVOID ObMap_RemoveByKey(_In_opt_ POB_MAP pm, _In_ QWORD qwKey)
 DWORD ObMap_RemoveByFilter(_In_opt_ POB_MAP pm, _In_opt_ PVOID ctx, _In_opt_ OB_MAP_FILTER_REMOVE_PFN_CB pfnFilterRemoveCB)
 {
     if(!pfnFilterRemoveCB) { return 0; }
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_RemoveByFilter(pm, ctx, pfnFilterRemoveCB))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, DWORD, 0, _ObMap_RemoveByFilter(pm, ctx, pfnFilterRemoveCB));
 }
 
@@ -703,6 +954,7 @@ DWORD ObMap_RemoveByFilter(_In_opt_ POB_MAP pm, _In_opt_ PVOID ctx, _In_opt_ OB_
 _Success_(return)
 BOOL ObMap_Clear(_In_opt_ POB_MAP pm)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, _ObMapSharded_Clear(pm))
     if(!OB_MAP_IS_VALID(pm) || (pm->c <= 1)) { return TRUE; }
     AcquireSRWLockExclusive(&pm->LockSRW);
     if(pm->c <= 1) {
@@ -772,6 +1024,7 @@ int _ObMap_SortEntryIndexByKey_CmpSort(_In_ POB_MAP_ENTRY e1, _In_ POB_MAP_ENTRY
 _Success_(return)
 BOOL ObMap_SortEntryIndex(_In_opt_ POB_MAP pm, _In_ OB_MAP_SORT_COMPARE_FUNCTION pfnSort)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, FALSE)   // not supported on sharded maps
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, BOOL, FALSE, _ObMap_SortEntryIndex(pm, pfnSort))
 }
 
@@ -898,6 +1151,7 @@ BOOL _ObMap_PushAll(_In_ POB_MAP pm, _In_ POB_MAP pmSrc)
 _Success_(return)
 BOOL ObMap_Push(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_ PVOID pvObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, ObMap_Push(OB_MAP_SHARD(pm, qwKey), qwKey, pvObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, BOOL, FALSE, _ObMap_Push(pm, qwKey, pvObject))
 }
 
@@ -914,6 +1168,7 @@ BOOL ObMap_Push(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_ PVOID pvObject)
 _Success_(return)
 BOOL ObMap_PushCopy(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_ PVOID pvObject, _In_ SIZE_T cbObject)
 {
+    OB_MAP_CALL_SHARDED_IMPLEMENTATION(pm, ObMap_PushCopy(OB_MAP_SHARD(pm, qwKey), qwKey, pvObject, cbObject))
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pm, BOOL, FALSE, _ObMap_PushCopy(pm, qwKey, pvObject, cbObject))
 }
 
@@ -927,6 +1182,9 @@ BOOL ObMap_PushCopy(_In_opt_ POB_MAP pm, _In_ QWORD qwKey, _In_ PVOID pvObject,
 _Success_(return)
 BOOL ObMap_PushAll(_In_opt_ POB_MAP pmDst, _In_ POB_MAP pmSrc)
 {
+    if(OB_MAP_IS_VALID(pmDst) && OB_MAP_IS_VALID(pmSrc) && (pmDst->fSharded || pmSrc->fSharded)) {
+        return _ObMapSharded_PushAll(pmDst, pmSrc);
+    }
     OB_MAP_CALL_SYNCHRONIZED_IMPLEMENTATION_WRITE(pmDst, BOOL, FALSE, _ObMap_PushAll(pmDst, pmSrc))
 }
 
@@ -941,8 +1199,10 @@ BOOL ObMap_PushAll(_In_opt_ POB_MAP pmDst, _In_ POB_MAP pmSrc)
 */
 POB_MAP ObMap_New(_In_opt_ VMM_HANDLE H, _In_ QWORD flags)
 {
+    DWORD i;
     POB_MAP pObMap;
     if((flags & OB_MAP_FLAGS_OBJECT_OB) && (flags & OB_MAP_FLAGS_OBJECT_LOCALFREE)) { return NULL; }
+    if((flags & OB_MAP_FLAGS_SHARDED) && (flags & OB_MAP_FLAGS_NOKEY)) { return NULL; }
     pObMap = Ob_AllocEx(H, OB_TAG_CORE_MAP, LMEM_ZEROINIT, sizeof(OB_MAP), (OB_CLEANUP_CB)_ObMap_ObCloseCallback, NULL);
     if(!pObMap) { return NULL; }
     InitializeSRWLock(&pObMap->LockSRW);
@@ -956,5 +1216,14 @@ POB_MAP ObMap_New(_In_opt_ VMM_HANDLE H, _In_ QWORD flags)
     pObMap->cHashMax = 0x100;
     pObMap->cHashGrowThreshold = 0xc0;
     pObMap->pHashMapKey = pObMap->pHashMapValue + pObMap->cHashMax;
+    if(flags & OB_MAP_FLAGS_SHARDED) {
+        pObMap->fSharded = TRUE;
+        for(i = 0; i < OB_MAP_SHARDS; i++) {
+            if(!(pObMap->Shard[i] = ObMap_New(H, flags & ~OB_MAP_FLAGS_SHARDED))) {
+                Ob_DECREF(pObMap);
+                return NULL;
+            }
+        }
+    }
     return pObMap;
 }
@@ -33,6 +33,7 @@ typedef struct tdOB_MEMFILE {
     SRWLOCK LockSRW;
     QWORD cb;
     POB_CACHEMAP pcm;
+    DWORD tpCodec;
     POB_COMPRESSED* Directory[OB_MEMFILE_ENTRIES_DIRECTORY];
     POB_COMPRESSED Table0[OB_MEMFILE_ENTRIES_TABLE];
     BYTE pbBuffer[OB_MEMFILE_BUFSIZE];
@@ -132,7 +133,7 @@ BOOL _ObMemFile_Compress(_In_ POB_MEMFILE pmf)
         pmf->Directory[iDirectory] = LocalAlloc(LMEM_ZEROINIT, OB_MEMFILE_ENTRIES_TABLE * sizeof(POB_COMPRESSED));
         if(!pmf->Directory[iDirectory]) { goto fail; }
     }
-    pmf->Directory[iDirectory][iTable] = ObCompressed_NewFromByte(pmf->ObHdr.H, pmf->pcm, pmf->pbBuffer, OB_MEMFILE_BUFSIZE);
+    pmf->Directory[iDirectory][iTable] = ObCompressed_NewFromByteEx(pmf->ObHdr.H, pmf->pcm, pmf->pbBuffer, OB_MEMFILE_BUFSIZE, pmf->tpCodec);
     if(!pmf->Directory[iDirectory][iTable]) { goto fail; }
     return TRUE;
 fail:
@@ -262,21 +263,74 @@ QWORD ObMemFile_Size(_In_opt_ POB_MEMFILE pmf)
     OB_MEMFILE_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pmf, QWORD, 0, pmf->cb);
 }
 
+_Success_(return)
+BOOL _ObMemFile_GetCompressionInfo(_In_ POB_MEMFILE pmf, _Out_ POB_COMPRESSED_INFO pInfo)
+{
+    QWORD o, oMax;
+    OB_COMPRESSED_INFO e;
+    ZeroMemory(pInfo, sizeof(OB_COMPRESSED_INFO));
+    pInfo->tpCodec = pmf->tpCodec;
+    oMax = pmf->cb & ~(OB_MEMFILE_BUFSIZE - 1);
+    for(o = 0; o < oMax; o += OB_MEMFILE_BUFSIZE) {
+        if(ObCompressed_GetInfo(pmf->Directory[OB_MEMFILE_INDEX_DIRECTORY(o)][OB_MEMFILE_INDEX_TABLE(o)], &e)) {
+            pInfo->cObjects++;
+            pInfo->cObjectsStored += e.cObjectsStored;
+            pInfo->cDecompress += e.cDecompress;
+            pInfo->cbUncompressed += e.cbUncompressed;
+            pInfo->cbCompressed += e.cbCompressed;
+            pInfo->qwCompressUs += e.qwCompressUs;
+            pInfo->qwDecompressUs += e.qwDecompressUs;
+        }
+    }
+    return TRUE;
+}
+
 /*
-* Create a new empty memory file.
-* It's strongly recommended to supply a global cache map to use.
+* Retrieve aggregated compression statistics of the compressed blocks of the
+* ObMemFile. The uncompressed tail buffer is not included.
+* -- pmf
+* -- pInfo
+* -- return
+*/
+_Success_(return)
+BOOL ObMemFile_GetCompressionInfo(_In_opt_ POB_MEMFILE pmf, _Out_ POB_COMPRESSED_INFO pInfo)
+{
+    OB_MEMFILE_CALL_SYNCHRONIZED_IMPLEMENTATION_READ(pmf, BOOL, FALSE, _ObMemFile_GetCompressionInfo(pmf, pInfo));
+}
+
+/*
+* Create a new empty memory file using a specific compression codec for its
+* blocks. It's strongly recommended to supply a global cache map to use.
 * CALLER DECREF: return
 * -- H
 * -- pcmg = optional global (per VMM_HANDLE) cache map to use.
+* -- tpCodec = OB_COMPRESSED_CODEC_FAST or OB_COMPRESSED_CODEC_HC.
 * -- return
 */
 _Success_(return != NULL)
-POB_MEMFILE ObMemFile_New(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg)
+POB_MEMFILE ObMemFile_NewEx(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg, _In_ DWORD tpCodec)
 {
-    POB_MEMFILE pObMemFile = Ob_AllocEx(H, OB_TAG_CORE_MEMFILE, LMEM_ZEROINIT, sizeof(OB_MEMFILE), (OB_CLEANUP_CB)_ObMemFile_ObCloseCallback, NULL);
+    POB_MEMFILE pObMemFile;
+    if((tpCodec != OB_COMPRESSED_CODEC_FAST) && (tpCodec != OB_COMPRESSED_CODEC_HC)) { return NULL; }
+    pObMemFile = Ob_AllocEx(H, OB_TAG_CORE_MEMFILE, LMEM_ZEROINIT, sizeof(OB_MEMFILE), (OB_CLEANUP_CB)_ObMemFile_ObCloseCallback, NULL);
     if(pObMemFile) {
         pObMemFile->Directory[0] = pObMemFile->Table0;
         pObMemFile->pcm = Ob_INCREF(pcmg);
+        pObMemFile->tpCodec = tpCodec;
     }
     return pObMemFile;
 }
+
+/*
+* Create a new empty memory file.
+* It's strongly recommended to supply a global cache map to use.
+* CALLER DECREF: return
+* -- H
+* -- pcmg = optional global (per VMM_HANDLE) cache map to use.
+* -- return
+*/
+_Success_(return != NULL)
+POB_MEMFILE ObMemFile_New(_In_opt_ VMM_HANDLE H, _In_opt_ POB_CACHEMAP pcmg)
+{
+    return ObMemFile_NewEx(H, pcmg, OB_COMPRESSED_CODEC_FAST);
+}
@@ -13,6 +13,7 @@
 #define OB_TAG_FC_SCANVIRTMEM_CTX       'FvmC'
 #define OB_TAG_FC_SCANVIRTMEM_ENTRY     'FvmE'
 #define OB_TAG_FC_SCANOBJECT_ENTRY      'FobE'
+#define OB_TAG_HEAPALLOC_INITALL_CTX    'HpIA'
 #define OB_TAG_INFODB_CTX               'IDBC'
 #define OB_TAG_INFODB_YARA_RULES        'IDBY'
 #define OB_TAG_MAP_PTE                  'Mpte'
@@ -35,6 +36,7 @@
 #define OB_TAG_MAP_USER                 'Musr'
 #define OB_TAG_MAP_SERVICE              'Msvc'
 #define OB_TAG_MAP_NET                  'Mnet'
+#define OB_TAG_MAP_PEMETA               'Mpem'
 #define OB_TAG_MAP_PFN                  'Mpfn'
 #define OB_TAG_MAP_EVIL                 'Mevl'
 #define OB_TAG_MAP_TASK                 'Mtsk'
@@ -51,6 +53,7 @@
 #define OB_TAG_OBJ_FILE                 'Ofil'
 #define OB_TAG_OBJ_DISPLAY              'Odis'
 #define OB_TAG_OBJ_SHARED_CACHE_MAP     'Oscc'
+#define OB_TAG_OBJ_VACB_RUNLIST         'Ovac'
 #define OB_TAG_PDB_CTX                  'PdbC'
 #define OB_TAG_PDB_ENTRY                'PdbE'
 #define OB_TAG_PDB_KERNEL_CONTEXT       'PdbK'
@@ -60,7 +63,9 @@
 #define OB_TAG_REG_HIVE                 'Rhve'
 #define OB_TAG_REG_KEY                  'Rkey'
 #define OB_TAG_REG_KEYVALUE             'Rval'
+#define OB_TAG_REG_PATH                 'Rpth'
 #define OB_TAG_THREAD_CALLSTACK         'ThCS'
+#define OB_TAG_UTIL_VFSTEXTCACHE       'UvTC'
 #define OB_TAG_VAD_MEM                  'MmSt'
 #define OB_TAG_WORK_PER_PROCESS         'WrkP'
 #define OB_TAG_WORK_WORKUNIT            'WrkU'
@@ -47,6 +47,7 @@ int LZ4_decompress_safe(const char *src, char *dst, int compressedSize, int dstC
 #include <dlfcn.h>
 #include <fcntl.h>
 #include <link.h>
+#include <malloc.h>
 #include <poll.h>
 #include <stdatomic.h>
 #include <sys/ioctl.h>
@@ -70,6 +71,16 @@ HANDLE LocalAlloc(DWORD uFlags, SIZE_T uBytes)
     return h;
 }
 
+HANDLE LocalReAlloc(HANDLE hMem, SIZE_T uBytes, DWORD uFlags)
+{
+    SIZE_T cbOld = hMem ? malloc_usable_size(hMem) : 0;
+    HANDLE h = realloc(hMem, uBytes);
+    if(h && (uFlags & LMEM_ZEROINIT) && (uBytes > cbOld)) {
+        memset((PBYTE)h + cbOld, 0, uBytes - cbOld);
+    }
+    return h;
+}
+
 VOID LocalFree(HANDLE hMem)
 {
     free(hMem);
@@ -199,6 +210,7 @@ typedef struct tdHANDLE_INTERNAL_THREAD {
     DWORD magic;
     DWORD type;
     pthread_t thread;
+    BOOL fDetached;
 } HANDLE_INTERNAL_THREAD, *PHANDLE_INTERNAL_THREAD;
 
 BOOL CloseHandle(_In_ HANDLE hObject)
@@ -207,7 +219,9 @@ BOOL CloseHandle(_In_ HANDLE hObject)
     if(hi->magic != OSCOMPATIBILITY_HANDLE_INTERNAL) { return FALSE; }
     switch(hi->type) {
         case OSCOMPATIBILITY_HANDLE_TYPE_THREAD:
-            pthread_join(((PHANDLE_INTERNAL_THREAD)hi)->thread, NULL);
+            if(!((PHANDLE_INTERNAL_THREAD)hi)->fDetached) {
+                pthread_join(((PHANDLE_INTERNAL_THREAD)hi)->thread, NULL);
+            }
             break;
         case OSCOMPATIBILITY_HANDLE_TYPE_EVENT:
             SetEvent(hObject);
@@ -258,6 +272,10 @@ HANDLE CreateThread(
     ph->magic = OSCOMPATIBILITY_HANDLE_INTERNAL;
     ph->type = OSCOMPATIBILITY_HANDLE_TYPE_THREAD;
     ph->thread = thread;
+    ph->fDetached = (dwCreationFlags & CREATE_THREAD_DETACHED) ? TRUE : FALSE;
+    if(ph->fDetached) {
+        pthread_detach(thread);
+    }
     return (HANDLE)ph;
 }
 
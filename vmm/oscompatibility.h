@@ -18,6 +18,7 @@
 #define STATUS_END_OF_FILE                  ((NTSTATUS)0xC0000011L)
 #define STATUS_FILE_INVALID                 ((NTSTATUS)0xC0000098L)
 #define STATUS_FILE_SYSTEM_LIMITATION       ((NTSTATUS)0xC0000427L)
+#define CREATE_THREAD_DETACHED              0
 typedef unsigned __int64                    QWORD, *PQWORD;
 _Ret_maybenull_ HMODULE WINAPI LoadLibraryU(_In_ LPCSTR lpLibFileName);
 int LZ4_decompress_safe(const char *src, char *dst, int compressedSize, int dstCapacity);
@@ -217,6 +218,8 @@ typedef int(*_CoreCrtNonSecureSearchSortCompareFunction)(void const *, void cons
 #define _fileno(f)                          (fileno(f))
 #define InterlockedAdd64(p, v)              (__sync_add_and_fetch_8(p, v))
 #define InterlockedIncrement64(p)           (__sync_add_and_fetch_8(p, 1))
+#define InterlockedExchange64(p, v)         (__atomic_exchange_n(p, v, __ATOMIC_SEQ_CST))
+#define InterlockedCompareExchange64(p, x, c) (__sync_val_compare_and_swap(p, c, x))
 #define InterlockedIncrement(p)             (__sync_add_and_fetch_4(p, 1))
 #define InterlockedDecrement(p)             (__sync_sub_and_fetch_4(p, 1))
 #define GetCurrentProcess()					((HANDLE)-1)
@@ -267,6 +270,7 @@ typedef struct _WIN32_FIND_DATAA {
 HANDLE FindFirstFileA(LPSTR lpFileName, LPWIN32_FIND_DATAA lpFindFileData);
 BOOL FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
 HANDLE LocalAlloc(DWORD uFlags, SIZE_T uBytes);
+HANDLE LocalReAlloc(HANDLE hMem, SIZE_T uBytes, DWORD uFlags);
 VOID LocalFree(HANDLE hMem);
 DWORD GetModuleFileNameA(_In_opt_ HMODULE hModule, _Out_ LPSTR lpFilename, _In_ DWORD nSize);
 HMODULE GetModuleHandleA(_In_opt_ LPCSTR lpModuleName);
@@ -290,6 +294,10 @@ HANDLE CreateThread(
     PDWORD    lpThreadId
 );
 
+// CreateThread() flag: CloseHandle() on a linux thread handle waits for the
+// thread to exit - unless the thread was created with CREATE_THREAD_DETACHED.
+#define CREATE_THREAD_DETACHED              0x80000000
+
 BOOL CloseHandle(_In_ HANDLE hObject);
 BOOL ResetEvent(_In_ HANDLE hEventIngestPhys);
 BOOL SetEvent(_In_ HANDLE hEventIngestPhys);
@@ -25,10 +25,12 @@ VOID Statistics_CallSetEnabled(_In_ VMM_HANDLE H, _In_ BOOL fEnabled)
     if(fEnabled && H->statistics_call) { return; }
     if(!fEnabled && !H->statistics_call) { return; }
     if(fEnabled) {
-        H->statistics_call = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMSTATISTICS_CALL_CONTEXT));
+        if(!(H->statistics_call = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMSTATISTICS_CALL_CONTEXT)))) { return; }
+        Ob_SetStatisticsEnabled(TRUE);
     } else {
         LocalFree(H->statistics_call);
         H->statistics_call = NULL;
+        Ob_SetStatisticsEnabled(FALSE);
     }
 }
 
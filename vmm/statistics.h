@@ -40,6 +40,7 @@ typedef enum tdSTATISTICS_ID {
     STATISTICS_ID_VMMDLL_MemCallback,
     STATISTICS_ID_VMMDLL_MemSearch,
     STATISTICS_ID_VMMDLL_MemPrefetchPages,
+    STATISTICS_ID_VMMDLL_MemReadMulti,
     STATISTICS_ID_VMMDLL_PidList,
     STATISTICS_ID_VMMDLL_PidGetFromName,
     STATISTICS_ID_VMMDLL_ProcessGetInformation,
@@ -131,6 +132,7 @@ static LPCSTR STATISTICS_ID_STR[STATISTICS_ID_MAX] = {
     [STATISTICS_ID_VMMDLL_MemCallback]              = "VMMDLL_MemCallback",
     [STATISTICS_ID_VMMDLL_MemSearch]                = "VMMDLL_MemSearch",
     [STATISTICS_ID_VMMDLL_MemPrefetchPages]         = "VMMDLL_MemPrefetchPages",
+    [STATISTICS_ID_VMMDLL_MemReadMulti]             = "VMMDLL_MemReadMulti",
     [STATISTICS_ID_VMMDLL_PidList]                  = "VMMDLL_PidList",
     [STATISTICS_ID_VMMDLL_PidGetFromName]           = "VMMDLL_PidGetFromName",
     [STATISTICS_ID_VMMDLL_ProcessGetInformation]    = "VMMDLL_ProcessGetInformation",
@@ -8,6 +8,13 @@
 #include "ext/miniz.h"
 #include "ext/sha256.h"
 #include <math.h>
+#if defined(_M_X64) || defined(__amd64__) || defined(__SSE2__)
+#define UTIL_HEXASCII_SSE2
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define UTIL_HEXASCII_NEON
+#include <arm_neon.h>
+#endif
 
 /*
 * Calculate the number of digits of an integer number.
@@ -28,6 +35,85 @@ QWORD Util_GetNumericA(_In_ LPCSTR sz)
 
 #define Util_2HexChar(x) (((((x) & 0xf) <= 9) ? '0' : ('a' - 10)) + ((x) & 0xf))
 
+/*
+* Render the hex and ascii part of a full 16-byte hex dump row (excluding the
+* address prefix) into sz. Exactly UTIL_HEXASCII_ROWLENGTH chars are written
+* (no null terminator). Output is identical to the per-byte rendering in the
+* Util_FillHexAscii* functions. SSE2 (x64) and NEON (arm64) are part of the
+* base instruction sets so no runtime cpu feature detection is required.
+* -- pb = 16 bytes of data.
+* -- sz
+*/
+#define UTIL_HEXASCII_ROWLENGTH     68
+
+VOID Util_FillHexAscii_Row(_In_reads_(16) PBYTE pb, _Out_writes_(UTIL_HEXASCII_ROWLENGTH) LPSTR sz)
+{
+#if defined(UTIL_HEXASCII_SSE2)
+    DWORD k;
+    __m128i v, hi, lo, m, c, n9, na, sp;
+    CHAR szHex[32];
+    v = _mm_loadu_si128((const __m128i*)pb);
+    m = _mm_set1_epi8(0x0f);
+    c = _mm_set1_epi8('0');
+    n9 = _mm_set1_epi8(9);
+    na = _mm_set1_epi8('a' - '0' - 10);
+    hi = _mm_and_si128(_mm_srli_epi16(v, 4), m);
+    lo = _mm_and_si128(v, m);
+    hi = _mm_add_epi8(_mm_add_epi8(hi, c), _mm_and_si128(_mm_cmpgt_epi8(hi, n9), na));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, c), _mm_and_si128(_mm_cmpgt_epi8(lo, n9), na));
+    _mm_storeu_si128((__m128i*)szHex, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i*)(szHex + 16), _mm_unpackhi_epi8(hi, lo));
+    for(k = 0; k < 16; k++) {
+        sz[3 * k + (k >> 3) + 0] = szHex[2 * k + 0];
+        sz[3 * k + (k >> 3) + 1] = szHex[2 * k + 1];
+        sz[3 * k + (k >> 3) + 2] = ' ';
+    }
+    sz[24] = ' ';
+    // ascii: printable 0x20-0x7e, 0x7f is rendered as space, others as '.'
+    m = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)), _mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)));
+    c = _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, _mm_set1_epi8('.')));
+    sp = _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f));
+    c = _mm_or_si128(_mm_and_si128(sp, _mm_set1_epi8(' ')), _mm_andnot_si128(sp, c));
+    sz[49] = ' ';
+    sz[50] = ' ';
+    _mm_storeu_si128((__m128i*)(sz + 51), c);
+#elif defined(UTIL_HEXASCII_NEON)
+    static const BYTE pbHexTable[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+    uint8x16_t v, tbl, hi, lo, a;
+    uint8x8x3_t r;
+    v = vld1q_u8(pb);
+    tbl = vld1q_u8(pbHexTable);
+    hi = vqtbl1q_u8(tbl, vshrq_n_u8(v, 4));
+    lo = vqtbl1q_u8(tbl, vandq_u8(v, vdupq_n_u8(0x0f)));
+    r.val[2] = vdup_n_u8(' ');
+    r.val[0] = vget_low_u8(hi);
+    r.val[1] = vget_low_u8(lo);
+    vst3_u8((uint8_t*)sz, r);
+    sz[24] = ' ';
+    r.val[0] = vget_high_u8(hi);
+    r.val[1] = vget_high_u8(lo);
+    vst3_u8((uint8_t*)sz + 25, r);
+    // ascii: printable 0x20-0x7e, 0x7f is rendered as space, others as '.'
+    a = vbslq_u8(vandq_u8(vcgeq_u8(v, vdupq_n_u8(0x20)), vcleq_u8(v, vdupq_n_u8(0x7e))), v, vdupq_n_u8('.'));
+    a = vbslq_u8(vceqq_u8(v, vdupq_n_u8(0x7f)), vdupq_n_u8(' '), a);
+    sz[49] = ' ';
+    sz[50] = ' ';
+    vst1q_u8((uint8_t*)sz + 51, a);
+#else
+    DWORD k;
+    for(k = 0; k < 16; k++) {
+        sz[3 * k + (k >> 3) + 0] = Util_2HexChar(pb[k] >> 4);
+        sz[3 * k + (k >> 3) + 1] = Util_2HexChar(pb[k]);
+        sz[3 * k + (k >> 3) + 2] = ' ';
+        sz[51 + k] = UTIL_PRINTASCII[pb[k]];
+    }
+    sz[24] = ' ';
+    sz[49] = ' ';
+    sz[50] = ' ';
+#endif
+    sz[67] = '\n';
+}
+
 _Success_(return)
 BOOL Util_FillHexAscii(_In_reads_opt_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD cbInitialOffset, _Out_writes_opt_(*pcsz) LPSTR sz, _Inout_ PDWORD pcsz)
 {
@@ -54,6 +140,13 @@ BOOL Util_FillHexAscii(_In_reads_opt_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD cb
             sz[o++] = ' ';
             sz[o++] = ' ';
             sz[o++] = ' ';
+            // full row fast path
+            if(i + 16 <= cb) {
+                Util_FillHexAscii_Row(pb + i, sz + o);
+                o += UTIL_HEXASCII_ROWLENGTH;
+                i += 15;
+                continue;
+            }
         } else if(0 == i % 8) {
             sz[o++] = ' ';
         }
@@ -110,6 +203,13 @@ BOOL Util_FillHexAscii_WithAddress(_In_reads_opt_(cb) PBYTE pb, _In_ DWORD cb, _
             sz[o++] = ' ';
             sz[o++] = ' ';
             sz[o++] = ' ';
+            // full row fast path
+            if(i + 16 <= cb) {
+                Util_FillHexAscii_Row(pb + i, sz + o);
+                o += UTIL_HEXASCII_ROWLENGTH;
+                i += 15;
+                continue;
+            }
         } else if(0 == i % 8) {
             sz[o++] = ' ';
         }
@@ -898,6 +998,95 @@ NTSTATUS Util_VfsLineFixed_Read(
     return nt;
 }
 
+#define UTIL_VFSTEXTCACHE_MAXSIZE       0x02000000
+#define UTIL_VFSTEXTCACHE_RENDERSIZE    0x00100000
+
+typedef struct tdOB_UTIL_VFSTEXTCACHE_ENTRY {
+    OB ObHdr;
+    PVOID pvObMap;                  // referenced map object (cache identity)
+    POB_MEMFILE pmf;                // compressed rendered text
+} OB_UTIL_VFSTEXTCACHE_ENTRY, *POB_UTIL_VFSTEXTCACHE_ENTRY;
+
+VOID Util_VfsLineFixed_ReadCached_CleanupCB(_In_ POB_UTIL_VFSTEXTCACHE_ENTRY pOb)
+{
+    Ob_DECREF(pOb->pvObMap);
+    Ob_DECREF(pOb->pmf);
+}
+
+/*
+* FixedLineRead: Read from a file dynamically created from a map/array object
+* using a callback function to populate individual lines (excluding header).
+* If the opt-in vfs text cache is enabled (-vfs-textcache) the file is fully
+* rendered on first read and stored compressed in a size-bounded cache keyed
+* by (path, map object). Subsequent reads are served from the cache until the
+* next process refresh. The map object is referenced by the cache entry.
+* Same parameters as Util_VfsLineFixed_Read() with the addition of:
+* -- uszPath = path of the file (used as part of the cache key).
+* -- pvObMap = object manager map object containing the pMap array.
+*/
+NTSTATUS Util_VfsLineFixed_ReadCached(
+    _In_ VMM_HANDLE H,
+    _In_ LPCSTR uszPath,
+    _In_ PVOID pvObMap,
+    _In_ UTIL_VFSLINEFIXED_PFN_CB pfnCallback,
+    _Inout_opt_ PVOID ctx,
+    _In_ DWORD cbLineLength,
+    _In_opt_ LPCSTR uszHeader,
+    _In_ PVOID pMap,
+    _In_ DWORD cMap,
+    _In_ DWORD cbEntry,
+    _Out_writes_to_(cb, *pcbRead) PBYTE pb,
+    _In_ DWORD cb,
+    _Out_ PDWORD pcbRead,
+    _In_ QWORD cbOffset
+) {
+    NTSTATUS nt;
+    QWORD qwKey, o, cbTotal;
+    DWORD cbRender, cbRendered;
+    PBYTE pbRender = NULL;
+    POB_UTIL_VFSTEXTCACHE_ENTRY peOb = NULL;
+    if(!H->cfg.fVfsTextCache || !pvObMap) { goto uncached; }
+    cbTotal = ((uszHeader && H->cfg.fFileInfoHeader) ? 2ULL + cMap : cMap) * (QWORD)cbLineLength;
+    if(!cbTotal || (cbTotal > UTIL_VFSTEXTCACHE_MAXSIZE)) { goto uncached; }
+    // 1: fetch from cache:
+    qwKey = CharUtil_Hash64U(uszPath, TRUE);
+    qwKey = (qwKey ^ (QWORD)pvObMap) * 0x100000001b3;
+    qwKey = (qwKey ^ (QWORD)pMap) * 0x100000001b3;
+    qwKey = (qwKey ^ (QWORD)pfnCallback) * 0x100000001b3;
+    qwKey = (qwKey ^ cbTotal) * 0x100000001b3;
+    qwKey = (qwKey ^ ((QWORD)cMap << 32) ^ cbLineLength) * 0x100000001b3;
+    if((peOb = ObCacheMap_GetByKey(H->vmm.pObCacheMapVfsText, qwKey))) {
+        if((peOb->pvObMap == pvObMap) && (ObMemFile_Size(peOb->pmf) == cbTotal)) {
+            *pcbRead = 0;
+            nt = ObMemFile_ReadFile(peOb->pmf, pb, cb, pcbRead, cbOffset);
+            Ob_DECREF(peOb);
+            return nt;
+        }
+        Ob_DECREF_NULL(&peOb);
+    }
+    // 2: render full file in chunks into a new compressed memory file:
+    if(!(pbRender = LocalAlloc(0, UTIL_VFSTEXTCACHE_RENDERSIZE))) { goto uncached; }
+    if(!(peOb = Ob_AllocEx(H, OB_TAG_UTIL_VFSTEXTCACHE, LMEM_ZEROINIT, sizeof(OB_UTIL_VFSTEXTCACHE_ENTRY), (OB_CLEANUP_CB)Util_VfsLineFixed_ReadCached_CleanupCB, NULL))) { goto uncached; }
+    if(!(peOb->pmf = ObMemFile_NewEx(H, H->vmm.pObCacheMapObCompressedShared, VMM_CFG_COMPRESSED_CODEC(H)))) { goto uncached; }
+    peOb->pvObMap = Ob_INCREF(pvObMap);
+    for(o = 0; o < cbTotal; o += cbRendered) {
+        cbRender = (DWORD)min(UTIL_VFSTEXTCACHE_RENDERSIZE, cbTotal - o);
+        nt = Util_VfsLineFixed_Read(H, pfnCallback, ctx, cbLineLength, uszHeader, pMap, cMap, cbEntry, pbRender, cbRender, &cbRendered, o);
+        if((nt != VMMDLL_STATUS_SUCCESS) || (cbRendered != cbRender)) { goto uncached; }
+        if(!ObMemFile_Append(peOb->pmf, pbRender, cbRendered)) { goto uncached; }
+    }
+    ObCacheMap_Push(H->vmm.pObCacheMapVfsText, qwKey, peOb, 0);
+    *pcbRead = 0;
+    nt = ObMemFile_ReadFile(peOb->pmf, pb, cb, pcbRead, cbOffset);
+    LocalFree(pbRender);
+    Ob_DECREF(peOb);
+    return nt;
+uncached:
+    LocalFree(pbRender);
+    Ob_DECREF(peOb);
+    return Util_VfsLineFixed_Read(H, pfnCallback, ctx, cbLineLength, uszHeader, pMap, cMap, cbEntry, pb, cb, pcbRead, cbOffset);
+}
+
 /*
 * FixedLineRead: Read from a file dynamically created from a custom generator
 * callback function using using a callback function to populate individual lines
@@ -392,6 +392,34 @@ NTSTATUS Util_VfsLineFixed_Read(
     _In_ QWORD cbOffset
 );
 
+/*
+* FixedLineRead: Read from a file dynamically created from a map/array object
+* using a callback function to populate individual lines (excluding header).
+* If the opt-in vfs text cache is enabled (-vfs-textcache) the file is fully
+* rendered on first read and stored compressed in a size-bounded cache keyed
+* by (path, map object). Subsequent reads are served from the cache until the
+* next process refresh. The map object is referenced by the cache entry.
+* Same parameters as Util_VfsLineFixed_Read() with the addition of:
+* -- uszPath = path of the file (used as part of the cache key).
+* -- pvObMap = object manager map object containing the pMap array.
+*/
+NTSTATUS Util_VfsLineFixed_ReadCached(
+    _In_ VMM_HANDLE H,
+    _In_ LPCSTR uszPath,
+    _In_ PVOID pvObMap,
+    _In_ UTIL_VFSLINEFIXED_PFN_CB pfnCallback,
+    _Inout_opt_ PVOID ctx,
+    _In_ DWORD cbLineLength,
+    _In_opt_ LPCSTR uszHeader,
+    _In_ PVOID pMap,
+    _In_ DWORD cMap,
+    _In_ DWORD cbEntry,
+    _Out_writes_to_(cb, *pcbRead) PBYTE pb,
+    _In_ DWORD cb,
+    _Out_ PDWORD pcbRead,
+    _In_ QWORD cbOffset
+);
+
 /*
 * Util_VfsLineFixedMapCustom_Read: Callback function to retrieve an entry.
 * -- H
@@ -1848,8 +1848,13 @@ VOID VmmClose(_In_ VMM_HANDLE H)
     Ob_DECREF_NULL(&H->vmm.pObCCachePrefetchRegistry);
     Ob_DECREF_NULL(&H->vmm.pObCacheMapEAT);
     Ob_DECREF_NULL(&H->vmm.pObCacheMapIAT);
+    Ob_DECREF_NULL(&H->vmm.psObEATIATInitAllPID);
+    Ob_DECREF_NULL(&H->vmm.pObCacheMapPeMeta);
+    Ob_DECREF_NULL(&H->vmm.pObCacheMapEATShared);
     Ob_DECREF_NULL(&H->vmm.pObCacheMapHeapAlloc);
+    Ob_DECREF_NULL(&H->vmm.psObHeapAllocWarmPID);
     Ob_DECREF_NULL(&H->vmm.pObCacheMapWinObjDisplay);
+    Ob_DECREF_NULL(&H->vmm.pObCacheMapVfsText);
     Ob_DECREF_NULL(&H->vmm.pObCacheMapObCompressedShared);
     Ob_DECREF_NULL(&H->vmm.pmObThreadCallback);
     DeleteCriticalSection(&H->vmm.LockMaster);
@@ -2185,7 +2190,7 @@ BOOL VmmInitialize(_In_ VMM_HANDLE H)
     if(!H->vmm.Cache.PAGING.fActive) { goto fail; }
     if(!(H->vmm.Cache.PAGING_FAILED = ObSet_New(H))) { goto fail; }
     // 6: CACHE INIT: Prototype PTE Cache Map
-    if(!(H->vmm.Cache.pmPrototypePte = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB))) { goto fail; }
+    if(!(H->vmm.Cache.pmPrototypePte = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB | OB_MAP_FLAGS_SHARDED))) { goto fail; }
     // 7: OTHER INIT:
     H->vmm.pObCMapPhysMem = ObContainer_New();
     H->vmm.pObCMapEvil = ObContainer_New();
@@ -2203,7 +2208,10 @@ BOOL VmmInitialize(_In_ VMM_HANDLE H)
     H->vmm.pObCCachePrefetchEPROCESS = ObContainer_New();
     H->vmm.pObCCachePrefetchRegistry = ObContainer_New();
     H->vmm.pObCacheMapObCompressedShared = ObCacheMap_New(H, OB_COMPRESSED_CACHED_ENTRIES_MAX, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB);
-    H->vmm.pmObThreadCallback = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB);
+    H->vmm.pObCacheMapVfsText = ObCacheMap_New(H, 0x40, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB);
+    H->vmm.pObCacheMapPeMeta = ObCacheMap_New(H, 0x400, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB);
+    H->vmm.pObCacheMapEATShared = ObCacheMap_New(H, 0x200, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB);
+    H->vmm.pmObThreadCallback = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB | OB_MAP_FLAGS_SHARDED);
     InitializeCriticalSection(&H->vmm.LockMaster);
     InitializeCriticalSection(&H->vmm.LockPlugin);
     InitializeCriticalSection(&H->vmm.LockUpdateVM);
@@ -3271,6 +3279,20 @@ BOOL VmmMap_GetThreadCallstack(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _I
     return VmmWinThreadCs_GetCallstack(H, pProcess, pThread, flags, ppObThreadCallstackMap);
 }
 
+/*
+* Unwind the callstacks of all threads in a process (or in all processes) as a
+* batch and put them into the callstack cache. Subsequent calls to function
+* VmmMap_GetThreadCallstack() for these threads will be served from the cache.
+* Use with caution (see VmmMap_GetThreadCallstack)!
+* -- H
+* -- pProcessOpt = process to unwind threads of, NULL for all processes.
+* -- flags = VMM_FLAG_NOCACHE (do not use cache)
+*/
+VOID VmmMap_GetThreadCallstackBatch(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pProcessOpt, _In_ DWORD flags)
+{
+    VmmWinThreadCs_GetCallstackBatch(H, pProcessOpt, flags);
+}
+
 /*
 * Retrieve the HANDLE map
 * CALLER DECREF: ppObHandleMap
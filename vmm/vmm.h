@@ -48,6 +48,11 @@
 #define VMM_MEMMAP_FLAG_ALL                     (VMM_MEMMAP_FLAG_MODULES | VMM_MEMMAP_FLAG_SCAN_PE)
 
 #define VMM_WORK_THREADPOOL_NUM_THREADS         0x20
+#define VMM_THREADCALLBACK_LOCK_STRIPES         0x10
+#define VMM_HEAPALLOC_LOCK_STRIPES              0x10
+
+// compression codec of forensic / cached text ObMemFiles (-compress-hc option).
+#define VMM_CFG_COMPRESSED_CODEC(H)             ((H)->cfg.fCompressHC ? OB_COMPRESSED_CODEC_HC : OB_COMPRESSED_CODEC_FAST)
 
 #define VMM_FLAG_NOCACHE                        0x00000001  // do not use the data cache (force reading from memory acquisition device).
 #define VMM_FLAG_ZEROPAD_ON_FAIL                0x00000002  // zero pad failed physical memory reads and report success if read within range of physical memory.
@@ -1249,6 +1254,8 @@ typedef struct tdVMMCONFIG {
     BOOL fVMNested;                     // parse virtual machines (very resource intensive)
     BOOL fVMPhysicalOnly;               // parse virtual machines as physical memory only (less resource intense)
     BOOL fMemMapAuto;
+    BOOL fVfsTextCache;                 // cache fully rendered fixed-line vfs text files (compressed)
+    BOOL fCompressHC;                   // compress forensic/cached text with the high compression codec
     // values below:
     DWORD dwPteQualityThreshold;        // max number of allowed invalid PTE entries in a page table (default: 0x20)
     QWORD tcTimeStart;                  // start time GetTickCount64()
@@ -1262,6 +1269,8 @@ typedef struct tdVMMCONFIG {
     CHAR szLogLevel[MAX_PATH];
     CHAR szPathLibraryVmm[MAX_PATH];
     CHAR szForensicYaraRules[MAX_PATH];
+    CHAR szRegistryIndexPath[MAX_PATH];         // directory of on-disk registry hive key indexes (optional)
+    CHAR szEatIndexPath[MAX_PATH];              // directory of on-disk module export directory (EAT) indexes (optional)
     // allocated strings below:
     struct {
         DWORD cusz;
@@ -1650,7 +1659,9 @@ typedef struct tdVMM_CONTEXT {
         SRWLOCK ModuleMiscWeb;
         SRWLOCK WinObjDisplay;
         SRWLOCK PluginMgr;
-        SRWLOCK ThreadCallback;
+        SRWLOCK ThreadCallback[VMM_THREADCALLBACK_LOCK_STRIPES];   // striped by (PID, TID)
+        SRWLOCK HeapAlloc[VMM_HEAPALLOC_LOCK_STRIPES];             // striped by (PID, heap)
+        SRWLOCK WinObjVacb;
     } LockSRW;
     POB_CONTAINER pObCMapPhysMem;
     POB_CONTAINER pObCMapEvil;
@@ -1669,9 +1680,14 @@ typedef struct tdVMM_CONTEXT {
     POB_CONTAINER pObCCachePrefetchRegistry;
     POB_CACHEMAP pObCacheMapEAT;
     POB_CACHEMAP pObCacheMapIAT;
+    POB_SET psObEATIATInitAllPID;      // PID|(1=EAT,2=IAT)<<32 of processes with batched EAT/IAT initialization done (cleared on medium refresh).
+    POB_CACHEMAP pObCacheMapPeMeta;     // content addressed (name/TimeDateStamp/SizeOfImage) PE metadata - shared between processes.
+    POB_CACHEMAP pObCacheMapEATShared;  // content addressed (export directory sha256 + image base) EAT maps - shared between processes.
     POB_CACHEMAP pObCacheMapHeapAlloc;
+    POB_SET psObHeapAllocWarmPID;      // PIDs with a queued background heap allocation map build (cleared on refresh).
     POB_CACHEMAP pObCacheMapWinObjDisplay;
     POB_CACHEMAP pObCacheMapObCompressedShared;
+    POB_CACHEMAP pObCacheMapVfsText;
     POB_MAP pmObThreadCallback;
     // page caches
     struct {
@@ -2877,6 +2893,17 @@ PVMM_MAP_THREADENTRY VmmMap_GetThreadEntry(_In_ VMM_HANDLE H, _In_ PVMMOB_MAP_TH
 _Success_(return)
 BOOL VmmMap_GetThreadCallstack(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_THREADENTRY pThread, _In_ DWORD flags, _Out_ PVMMOB_MAP_THREADCALLSTACK *ppObThreadCallstackMap);
 
+/*
+* Unwind the callstacks of all threads in a process (or in all processes) as a
+* batch and put them into the callstack cache. Subsequent calls to function
+* VmmMap_GetThreadCallstack() for these threads will be served from the cache.
+* Use with caution (see VmmMap_GetThreadCallstack)!
+* -- H
+* -- pProcessOpt = process to unwind threads of, NULL for all processes.
+* -- flags = VMM_FLAG_NOCACHE (do not use cache)
+*/
+VOID VmmMap_GetThreadCallstackBatch(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pProcessOpt, _In_ DWORD flags);
+
 /*
 * Retrieve the HANDLE map
 * CALLER DECREF: ppObHandleMap
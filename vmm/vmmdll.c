@@ -770,6 +770,159 @@ BOOL VMMDLL_MemReadPage(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ ULONG64 qwA, _
     return VMMDLL_MemReadEx(H, dwPID, qwA, pbPage, 4096, &dwRead, 0) && (dwRead == 4096);
 }
 
+#define VMMDLL_MEM_READ_MULTI_MAX_SIZE      0x40000000
+
+/*
+* Read all ranges belonging to a single PID in one merged scatter read.
+* Pages shared between ranges are only read once. Pages fully covered by a
+* range are read directly into the destination arena, remaining pages are read
+* into a temporary buffer and copied into place afterwards.
+* -- H
+* -- dwPID
+* -- pRanges
+* -- cRanges
+* -- pbArena
+* -- pmMEMs = map used for page de-duplication (cleared by function).
+* -- ppMEMs = pre-allocated MEM pointer array sized to hold all pages.
+* -- pMEMs = pre-allocated MEM array sized to hold all pages.
+* -- flags
+* -- return = number of ranges (for dwPID) read in full.
+*/
+DWORD VMMDLL_MemReadMulti_DoWork(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _Inout_updates_(cRanges) PVMMDLL_MEM_READ_RANGE pRanges, _In_ DWORD cRanges, _Out_ PBYTE pbArena, _In_ POB_MAP pmMEMs, _In_ PPMEM_SCATTER ppMEMs, _In_ PMEM_SCATTER pMEMs, _In_ DWORD flags)
+{
+    QWORD va, vaPage;
+    DWORD i, iMEM, cMEMs = 0, cMEMsTemp = 0, cbChunk, cRangesRead = 0;
+    PBYTE pb, pbTemp = NULL;
+    PMEM_SCATTER pMEM;
+    PVMMDLL_MEM_READ_RANGE pr;
+    PVMM_PROCESS pObProcess = NULL;
+    if(dwPID != (DWORD)-1) {
+        if(!(pObProcess = VmmProcessGet(H, dwPID))) { return 0; }
+    }
+    ObMap_Clear(pmMEMs);
+    // 1: populate de-duplicated page-sized MEMs:
+    for(i = 0; i < cRanges; i++) {
+        pr = pRanges + i;
+        if((pr->dwPID != dwPID) || !pr->cb) { continue; }
+        for(vaPage = pr->qwA & ~0xfff; vaPage < pr->qwA + pr->cb; vaPage += 0x1000) {
+            if(!(pMEM = ObMap_GetByKey(pmMEMs, vaPage | 1))) {
+                pMEM = pMEMs + cMEMs;
+                ZeroMemory(pMEM, sizeof(MEM_SCATTER));
+                pMEM->version = MEM_SCATTER_VERSION;
+                pMEM->qwA = vaPage;
+                pMEM->cb = 0x1000;
+                if(!ObMap_Push(pmMEMs, vaPage | 1, pMEM)) { goto fail; }
+                ppMEMs[cMEMs++] = pMEM;
+            }
+            if(!pMEM->pb && (vaPage >= pr->qwA) && (vaPage + 0x1000 <= pr->qwA + pr->cb)) {
+                pMEM->pb = pbArena + pr->oDst + (vaPage - pr->qwA);
+            }
+        }
+    }
+    if(!cMEMs) { goto fail; }
+    // 2: assign temporary buffers to MEMs not backed by the arena:
+    for(iMEM = 0; iMEM < cMEMs; iMEM++) {
+        if(!ppMEMs[iMEM]->pb) { cMEMsTemp++; }
+    }
+    if(cMEMsTemp) {
+        if(!(pbTemp = LocalAlloc(0, (SIZE_T)cMEMsTemp * 0x1000))) { goto fail; }
+        for(iMEM = 0, pb = pbTemp; iMEM < cMEMs; iMEM++) {
+            if(!ppMEMs[iMEM]->pb) {
+                ppMEMs[iMEM]->pb = pb;
+                pb += 0x1000;
+            }
+        }
+    }
+    // 3: read:
+    if(pObProcess) {
+        VmmReadScatterVirtual(H, pObProcess, ppMEMs, cMEMs, flags);
+    } else {
+        VmmReadScatterPhysical(H, ppMEMs, cMEMs, flags);
+    }
+    // 4: copy into arena (if required) and calculate per-range result:
+    for(i = 0; i < cRanges; i++) {
+        pr = pRanges + i;
+        if((pr->dwPID != dwPID) || !pr->cb) { continue; }
+        va = pr->qwA;
+        pb = pbArena + pr->oDst;
+        while(va < pr->qwA + pr->cb) {
+            cbChunk = (DWORD)min(pr->qwA + pr->cb - va, 0x1000 - (va & 0xfff));
+            pMEM = ObMap_GetByKey(pmMEMs, (va & ~0xfff) | 1);
+            if(pMEM && pMEM->f) {
+                if(pb != pMEM->pb + (va & 0xfff)) {
+                    memcpy(pb, pMEM->pb + (va & 0xfff), cbChunk);
+                }
+                pr->cbRead += cbChunk;
+            } else {
+                ZeroMemory(pb, cbChunk);
+            }
+            pb += cbChunk;
+            va += cbChunk;
+        }
+        if(pr->cbRead == pr->cb) {
+            cRangesRead++;
+        }
+    }
+fail:
+    LocalFree(pbTemp);
+    Ob_DECREF(pObProcess);
+    return cRangesRead;
+}
+
+DWORD VMMDLL_MemReadMulti_Impl(_In_ VMM_HANDLE H, _Inout_updates_(cRanges) PVMMDLL_MEM_READ_RANGE pRanges, _In_ DWORD cRanges, _Out_writes_(cbArena) PBYTE pbArena, _In_ QWORD cbArena, _In_ DWORD flags)
+{
+    QWORD qwPID, cMEMsMax = 0;
+    DWORD i, cRangesRead = 0;
+    PBYTE pbMEMs = NULL;
+    PVMMDLL_MEM_READ_RANGE pr;
+    POB_SET psObPID = NULL;
+    POB_MAP pmObMEMs = NULL;
+    if(!cRanges) { return 0; }
+    if(!(psObPID = ObSet_New(H)) || !(pmObMEMs = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID))) { goto fail; }
+    // validate ranges and count the upper bound of required pages:
+    for(i = 0; i < cRanges; i++) {
+        pr = pRanges + i;
+        pr->cbRead = 0;
+        if(pr->cb > VMMDLL_MEM_READ_MULTI_MAX_SIZE) { goto fail; }
+        if((pr->qwA + pr->cb < pr->qwA) || (pr->oDst + pr->cb < pr->oDst) || (pr->oDst + pr->cb > cbArena)) { goto fail; }
+        if(!pr->cb) { continue; }
+        ZeroMemory(pbArena + pr->oDst, pr->cb);
+        cMEMsMax += ((pr->qwA & 0xfff) + pr->cb + 0xfff) >> 12;
+        ObSet_Push(psObPID, 0x100000000 | pr->dwPID);
+    }
+    if(!cMEMsMax || (cMEMsMax > 0x01000000)) { goto fail; }
+    if(!(pbMEMs = LocalAlloc(0, (SIZE_T)cMEMsMax * (sizeof(PMEM_SCATTER) + sizeof(MEM_SCATTER))))) { goto fail; }
+    // read one merged scatter per unique PID:
+    while((qwPID = ObSet_Pop(psObPID))) {
+        cRangesRead += VMMDLL_MemReadMulti_DoWork(
+            H,
+            (DWORD)qwPID,
+            pRanges,
+            cRanges,
+            pbArena,
+            pmObMEMs,
+            (PPMEM_SCATTER)pbMEMs,
+            (PMEM_SCATTER)(pbMEMs + cMEMsMax * sizeof(PMEM_SCATTER)),
+            flags
+        );
+    }
+fail:
+    LocalFree(pbMEMs);
+    Ob_DECREF(psObPID);
+    Ob_DECREF(pmObMEMs);
+    return cRangesRead;
+}
+
+DWORD VMMDLL_MemReadMulti(_In_ VMM_HANDLE H, _Inout_updates_(cRanges) PVMMDLL_MEM_READ_RANGE pRanges, _In_ DWORD cRanges, _Out_writes_(cbArena) PBYTE pbArena, _In_ QWORD cbArena, _In_ DWORD flags)
+{
+    CALL_IMPLEMENTATION_VMM_RETURN(
+        H,
+        STATISTICS_ID_VMMDLL_MemReadMulti,
+        DWORD,
+        0,
+        VMMDLL_MemReadMulti_Impl(H, pRanges, cRanges, pbArena, cbArena, flags))
+}
+
 _Success_(return)
 BOOL VMMDLL_MemPrefetchPages_Impl(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_reads_(cPrefetchAddresses) PULONG64 pPrefetchAddresses, _In_ DWORD cPrefetchAddresses)
 {
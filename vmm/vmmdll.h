@@ -58,6 +58,7 @@ typedef const uint16_t                      *LPCWSTR;
 #define _Inout_
 #define _Inout_bytecount_(x)
 #define _Inout_opt_
+#define _Inout_updates_(x)
 #define _Inout_updates_opt_(x)
 #define _Out_
 #define _Out_opt_
@@ -112,6 +113,20 @@ typedef BYTE                    OPAQUE_OB_HEADER[0x40];
 *              This parameter will take precedence over registry settings.
 *    -disable-symbols = disable symbol lookups from .pdb files.
 *    -disable-infodb = disable the infodb and any symbol lookups via it.
+*    -vfs-textcache = cache fully rendered static text files, such as
+*              drivers.txt and handles.txt, compressed in memory. Beneficial
+*              for repeated reads of memory dump files.
+*    -compress-hc = compress forensic output files and the vfs text cache with
+*              a slower high compression codec (LZ4-HC / XPRESS_HUFF). Reduces
+*              memory use of large forensic timelines and JSON files.
+*    -registry-index = directory in which registry hive key indexes are stored
+*              and re-used by later runs over the same memory dump file. Not
+*              used for volatile memory.
+*              Example: -registry-index "C:\Temp\RegIndex"
+*    -eat-index = directory in which module export directories are stored and
+*              re-used by later runs over the same memory dump file. Speeds up
+*              export (EAT) parsing. Not used for volatile memory.
+*              Example: -eat-index "C:\Temp\EatIndex"
 *    -waitinitialize = Wait for initialization to complete before returning.
 *              Normal use is that some initialization is done asynchronously
 *              and may not be completed when initialization call is completed.
@@ -848,6 +863,34 @@ BOOL VMMDLL_MemRead(_In_ VMM_HANDLE hVMM, _In_ DWORD dwPID, _In_ ULONG64 qwA, _O
 EXPORTED_FUNCTION _Success_(return)
 BOOL VMMDLL_MemReadEx(_In_ VMM_HANDLE hVMM, _In_ DWORD dwPID, _In_ ULONG64 qwA, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _Out_opt_ PDWORD pcbReadOpt, _In_ ULONG64 flags);
 
+typedef struct tdVMMDLL_MEM_READ_RANGE {
+    DWORD dwPID;        // PID of target process, (DWORD)-1 to read physical memory.
+    DWORD cb;           // number of bytes to read (max 1GB per range).
+    QWORD qwA;          // address to read.
+    QWORD oDst;         // byte offset into the destination arena.
+    DWORD cbRead;       // [out] number of bytes successfully read.
+    DWORD _Reserved;
+} VMMDLL_MEM_READ_RANGE, *PVMMDLL_MEM_READ_RANGE;
+
+/*
+* Read multiple non-contigious memory ranges, possibly from different processes,
+* in one single call. Ranges targeting the same PID are merged (overlapping
+* pages are de-duplicated) and read in a single scatter operation.
+* Memory is read into the destination arena at the offset given by each range
+* descriptor. Destination ranges must not overlap. Unread bytes are zeroed.
+* This function exists for performance reasons - primarily for use by language
+* bindings which would otherwise have to make one call per range.
+* -- hVMM
+* -- pRanges = array of range descriptors; cbRead is populated on return.
+* -- cRanges = count of pRanges.
+* -- pbArena = destination arena.
+* -- cbArena = byte size of destination arena.
+* -- flags = flags as in VMMDLL_FLAG_*
+* -- return = the number of ranges read in full, 0 on fail or invalid ranges.
+*/
+EXPORTED_FUNCTION
+DWORD VMMDLL_MemReadMulti(_In_ VMM_HANDLE hVMM, _Inout_updates_(cRanges) PVMMDLL_MEM_READ_RANGE pRanges, _In_ DWORD cRanges, _Out_writes_(cbArena) PBYTE pbArena, _In_ QWORD cbArena, _In_ DWORD flags);
+
 /*
 * Prefetch a number of addresses (specified in the pA array) into the memory
 * cache. This function is to be used to batch larger known reads into local
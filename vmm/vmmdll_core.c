@@ -167,6 +167,7 @@ BOOL VmmDllCore_HandleAdd(_In_ VMM_HANDLE H)
     if(g_VMMDLL_CORE_HANDLE_COUNT < VMM_HANDLE_MAX_COUNT) {
         g_VMMDLL_CORE_HANDLES[g_VMMDLL_CORE_HANDLE_COUNT] = H;
         g_VMMDLL_CORE_HANDLE_COUNT++;
+        Ob_PoolInitialize();
         return TRUE;
     }
     return FALSE;
@@ -352,6 +353,12 @@ VOID VmmDllCore_CloseHandle(_In_opt_ _Post_ptr_invalid_ VMM_HANDLE H, _In_ BOOL
     VmmLog_Close(H);
     LocalFree(H->cfg.ForensicProcessSkipList.pusz);
     LocalFree(H);
+    // Release pooled object manager allocations if this was the last handle.
+    EnterCriticalSection(&g_VMMDLL_CORE_LOCK);
+    if(0 == g_VMMDLL_CORE_HANDLE_COUNT) {
+        Ob_PoolDrain();
+    }
+    LeaveCriticalSection(&g_VMMDLL_CORE_LOCK);
 }
 
 /*
@@ -560,6 +567,12 @@ BOOL VmmDllCore_InitializeConfig(_In_ VMM_HANDLE H, _In_ DWORD argc, _In_ const
         } else if(0 == _stricmp(argv[i], "-version")) {
             H->cfg.fDisplayVersion = TRUE;
             i++; continue;
+        } else if(0 == _stricmp(argv[i], "-vfs-textcache")) {
+            H->cfg.fVfsTextCache = TRUE;
+            i++; continue;
+        } else if(0 == _stricmp(argv[i], "-compress-hc")) {
+            H->cfg.fCompressHC = TRUE;
+            i++; continue;
         } else if(0 == _stricmp(argv[i], "-waitinitialize")) {
             H->cfg.fWaitInitialize = TRUE;
             i++; continue;
@@ -641,6 +654,12 @@ BOOL VmmDllCore_InitializeConfig(_In_ VMM_HANDLE H, _In_ DWORD argc, _In_ const
             H->cfg.fWaitInitialize = TRUE;
             strcpy_s(H->cfg.szPythonExecuteFile, MAX_PATH, argv[i + 1]);
             i += 2; continue;
+        } else if(0 == _stricmp(argv[i], "-registry-index")) {
+            strcpy_s(H->cfg.szRegistryIndexPath, MAX_PATH, argv[i + 1]);
+            i += 2; continue;
+        } else if(0 == _stricmp(argv[i], "-eat-index")) {
+            strcpy_s(H->cfg.szEatIndexPath, MAX_PATH, argv[i + 1]);
+            i += 2; continue;
         } else if(0 == _stricmp(argv[i], "-pythonpath")) {
             strcpy_s(H->cfg.szPythonPath, MAX_PATH, argv[i + 1]);
             i += 2; continue;
@@ -13,6 +13,12 @@
 #define VMMDLL_VFS_INITIALIZEBLOB_MAX_ARGC              64
 #define VMMDLL_VFS_CONSOLE_RSP_VERSION                  0xf00f0001
 
+#define VMMDLL_REMOTE_READAHEAD_CHUNK                   0x00100000
+#define VMMDLL_REMOTE_READAHEAD_SLOTS                   8
+#define VMMDLL_REMOTE_READAHEAD_DEPTH                   4
+#define VMMDLL_REMOTE_READAHEAD_MAXAGE_MS               1000
+#define VMMDLL_REMOTE_READAHEAD_STREAMS                 4
+
 typedef struct tdVMMDLL_VFS_CONSOLE_RSP {
     // core:
     DWORD dwVersion;                        // VMMDLL_VFS_KEEPALIVE_RSP_VERSION
@@ -23,6 +29,22 @@ typedef struct tdVMMDLL_VFS_CONSOLE_RSP {
     BYTE pbBuffer[0];
 } VMMDLL_VFS_CONSOLE_RSP, *PVMMDLL_VFS_CONSOLE_RSP;
 
+typedef struct tdVMMDLL_REMOTE_READAHEAD_SLOT {
+    QWORD qwHash;                           // path hash (0 = slot unused)
+    QWORD qwOffset;
+    QWORD tcComplete;                       // tickcount64 at read completion
+    BOOL fPending;                          // read is outstanding in a worker thread
+    NTSTATUS nt;
+    DWORD cb;
+    PLC_CMD_AGENT_VFS_RSP pRsp;             // remote response, owned by slot
+} VMMDLL_REMOTE_READAHEAD_SLOT, *PVMMDLL_REMOTE_READAHEAD_SLOT;
+
+typedef struct tdVMMDLL_REMOTE_READAHEAD_STREAM {
+    QWORD qwHash;                           // path hash (0 = stream unused)
+    QWORD qwOffsetEnd;                      // end offset of most recent read
+    QWORD tcLast;                           // tickcount64 of most recent read
+} VMMDLL_REMOTE_READAHEAD_STREAM, *PVMMDLL_REMOTE_READAHEAD_STREAM;
+
 typedef struct tdVMMDLL_REMOTE_HANDLE {
     // core:
     QWORD magic;
@@ -39,8 +61,22 @@ typedef struct tdVMMDLL_REMOTE_HANDLE {
     // leechcore & config
     HANDLE hLC;
     LC_CONFIG dev;
+    // vfs read-ahead / pipelining:
+    struct {
+        SRWLOCK LockSRW;
+        DWORD cPending;                     // outstanding read-ahead requests
+        VMMDLL_REMOTE_READAHEAD_STREAM Stream[VMMDLL_REMOTE_READAHEAD_STREAMS];
+        VMMDLL_REMOTE_READAHEAD_SLOT Slot[VMMDLL_REMOTE_READAHEAD_SLOTS];
+        HANDLE hEventSlot[VMMDLL_REMOTE_READAHEAD_SLOTS];   // manual reset, set when slot is not pending
+    } RA;
 } *VMMDLL_REMOTE_HANDLE;
 
+typedef struct tdVMMDLL_REMOTE_READAHEAD_CONTEXT {
+    VMMDLL_REMOTE_HANDLE HR;
+    PVMMDLL_REMOTE_READAHEAD_SLOT pSlot;
+    CHAR uszPathFile[2*MAX_PATH];
+} VMMDLL_REMOTE_READAHEAD_CONTEXT, *PVMMDLL_REMOTE_READAHEAD_CONTEXT;
+
 /*
 * Remote initialization struct (shared between vmmdll_remote.c and leechagent_procchild.c).
 */
@@ -185,6 +221,7 @@ BOOL VmmDllRemote_HandleAdd(_In_ VMMDLL_REMOTE_HANDLE HR)
 */
 VOID VmmDllRemote_CloseHandle(_In_opt_ _Post_ptr_invalid_ VMM_HANDLE H, _In_ BOOL fForceCloseAll)
 {
+    DWORD i;
     BOOL fCloseHandle = FALSE;
     VMMDLL_REMOTE_HANDLE HR = NULL;
     // Verify & decrement handle count.
@@ -222,6 +259,10 @@ VOID VmmDllRemote_CloseHandle(_In_opt_ _Post_ptr_invalid_ VMM_HANDLE H, _In_ BOO
     }
     // Close leechcore
     LcClose(HR->hLC);
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+        LocalFree(HR->RA.Slot[i].pRsp);
+        if(HR->RA.hEventSlot[i]) { CloseHandle(HR->RA.hEventSlot[i]); }
+    }
     LocalFree(HR);
 }
 
@@ -338,25 +379,359 @@ fail:
     return TRUE;
 }
 
+//-----------------------------------------------------------------------------
+// VFS READ FUNCTIONALITY BELOW:
+// 
+// Each remote read is a full round-trip to the LeechAgent. Sequential reads of
+// the same file (typical for FUSE/Dokan which split reads into small chunks)
+// are detected and served from a small per-handle read-ahead cache which is
+// kept filled by up to VMMDLL_REMOTE_READAHEAD_DEPTH outstanding reads issued
+// by short-lived worker threads. Random access is forwarded to the remote as
+// before and is not cached.
+//-----------------------------------------------------------------------------
+
 /*
-* Remote VMMDLL_VfsReadU().
+* Perform a single remote VFS read and verify the response.
+* CALLER LocalFree: *ppRsp
+* -- HR
+* -- uszPathFile = path already in remote (LC_CMD_AGENT_VFS_REQ) format.
+* -- cb
+* -- cbOffset
+* -- ppRsp
+* -- return
 */
-NTSTATUS VmmDllRemote_VfsReadU(_In_ VMM_HANDLE H, _In_ LPCSTR uszFileName, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset)
+_Success_(return)
+BOOL VmmDllRemote_VfsReadRemote(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ LPCSTR uszPathFile, _In_ DWORD cb, _In_ ULONG64 cbOffset, _Out_ PLC_CMD_AGENT_VFS_RSP *ppRsp)
 {
-    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
     LC_CMD_AGENT_VFS_REQ Req;
     PLC_CMD_AGENT_VFS_RSP pRsp = NULL;
-    VMMDLL_REMOTE_HANDLE HR = NULL;
     DWORD cbRsp;
-    if(!(HR = VmmDllRemote_HandleReserveExternal(H))) { return VMMDLL_STATUS_FILE_INVALID; }
-    // Remote MemProcFS below:
+    *ppRsp = NULL;
     ZeroMemory(&Req, sizeof(LC_CMD_AGENT_VFS_REQ));
     Req.dwVersion = LC_CMD_AGENT_VFS_REQ_VERSION;
     Req.qwOffset = cbOffset;
     Req.dwLength = cb;
-    if(!CharUtil_UtoU(uszFileName, -1, Req.uszPathFile, sizeof(Req.uszPathFile), NULL, NULL, CHARUTIL_FLAG_STR_BUFONLY)) { goto fail; }
+    strncpy_s(Req.uszPathFile, sizeof(Req.uszPathFile), uszPathFile, _TRUNCATE);
     if(!LcCommand(HR->hLC, LC_CMD_AGENT_VFS_READ, sizeof(LC_CMD_AGENT_VFS_REQ), (PBYTE)&Req, (PBYTE*)&pRsp, &cbRsp) || !pRsp) { goto fail; }
     if((cbRsp < sizeof(LC_CMD_AGENT_VFS_RSP)) || (pRsp->dwVersion != LC_CMD_AGENT_VFS_RSP_VERSION) || (cbRsp < sizeof(LC_CMD_AGENT_VFS_RSP) + pRsp->cb)) { goto fail; }
+    *ppRsp = pRsp;
+    return TRUE;
+fail:
+    LocalFree(pRsp);
+    return FALSE;
+}
+
+/*
+* Check whether a read continues a tracked sequential stream of the file.
+* NB! Function is to be called behind lock HR->RA.LockSRW.
+* -- HR
+* -- qwHash
+* -- qwOffset
+* -- return
+*/
+BOOL VmmDllRemote_ReadAhead_StreamIsSequential(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ QWORD qwHash, _In_ QWORD qwOffset)
+{
+    DWORD i;
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_STREAMS; i++) {
+        if((HR->RA.Stream[i].qwHash == qwHash) && (HR->RA.Stream[i].qwOffsetEnd == qwOffset)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*
+* Update the stream of a file with the end offset of its most recent read. If
+* the file is not tracked the least recently used stream is replaced.
+* NB! Function is to be called behind exclusive lock HR->RA.LockSRW.
+* -- HR
+* -- qwHash
+* -- qwOffsetEnd
+*/
+VOID VmmDllRemote_ReadAhead_StreamUpdate(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ QWORD qwHash, _In_ QWORD qwOffsetEnd)
+{
+    DWORD i;
+    PVMMDLL_REMOTE_READAHEAD_STREAM pe = NULL;
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_STREAMS; i++) {
+        if(HR->RA.Stream[i].qwHash == qwHash) {
+            pe = &HR->RA.Stream[i];
+            break;
+        }
+        if(!pe || (HR->RA.Stream[i].tcLast < pe->tcLast)) {
+            pe = &HR->RA.Stream[i];
+        }
+    }
+    pe->qwHash = qwHash;
+    pe->qwOffsetEnd = qwOffsetEnd;
+    pe->tcLast = GetTickCount64();
+}
+
+/*
+* Retrieve a read-ahead slot for re-use. The slot is cleared and marked with
+* the hash/offset given. Pending slots are never evicted.
+* NB! Function is to be called behind exclusive lock HR->RA.LockSRW.
+* -- HR
+* -- qwHash
+* -- qwOffset
+* -- return = the slot, or NULL if all slots are pending.
+*/
+PVMMDLL_REMOTE_READAHEAD_SLOT VmmDllRemote_ReadAhead_SlotGet(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ QWORD qwHash, _In_ QWORD qwOffset)
+{
+    DWORD i;
+    PVMMDLL_REMOTE_READAHEAD_SLOT pe, peLRU = NULL;
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+        pe = &HR->RA.Slot[i];
+        if(pe->fPending) { continue; }
+        if(!pe->qwHash) {
+            peLRU = pe;
+            break;
+        }
+        if(!peLRU || (pe->tcComplete < peLRU->tcComplete)) {
+            peLRU = pe;
+        }
+    }
+    if(peLRU) {
+        LocalFree(peLRU->pRsp);
+        ZeroMemory(peLRU, sizeof(VMMDLL_REMOTE_READAHEAD_SLOT));
+        peLRU->qwHash = qwHash;
+        peLRU->qwOffset = qwOffset;
+    }
+    return peLRU;
+}
+
+/*
+* Complete a read-ahead slot with the result of a remote read. Readers waiting
+* on a pending slot are woken up.
+* NB! Function is to be called behind exclusive lock HR->RA.LockSRW.
+* -- HR
+* -- pSlot
+* -- pRsp = the remote response, ownership is transferred to the slot.
+*/
+VOID VmmDllRemote_ReadAhead_SlotComplete(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ PVMMDLL_REMOTE_READAHEAD_SLOT pSlot, _In_opt_ PLC_CMD_AGENT_VFS_RSP pRsp)
+{
+    if(pSlot->fPending) {
+        pSlot->fPending = FALSE;
+        SetEvent(HR->RA.hEventSlot[pSlot - HR->RA.Slot]);
+    }
+    pSlot->tcComplete = GetTickCount64();
+    if(pRsp) {
+        pSlot->nt = pRsp->dwStatus;
+        pSlot->cb = min(VMMDLL_REMOTE_READAHEAD_CHUNK, pRsp->cb);
+        pSlot->pRsp = pRsp;
+    } else {
+        pSlot->qwHash = 0;
+    }
+}
+
+/*
+* Worker thread: perform a read-ahead read into a pending slot.
+*/
+DWORD WINAPI VmmDllRemote_ReadAhead_ThreadProc(_In_ PVMMDLL_REMOTE_READAHEAD_CONTEXT ctx)
+{
+    VMMDLL_REMOTE_HANDLE HR = ctx->HR;
+    PLC_CMD_AGENT_VFS_RSP pRsp = NULL;
+    if(!HR->fAbort) {
+        VmmDllRemote_VfsReadRemote(HR, ctx->uszPathFile, VMMDLL_REMOTE_READAHEAD_CHUNK, ctx->pSlot->qwOffset, &pRsp);
+    }
+    AcquireSRWLockExclusive(&HR->RA.LockSRW);
+    VmmDllRemote_ReadAhead_SlotComplete(HR, ctx->pSlot, pRsp);
+    HR->RA.cPending--;
+    ReleaseSRWLockExclusive(&HR->RA.LockSRW);
+    LocalFree(ctx);
+    InterlockedDecrement(&HR->cThreadInternal);
+    return 1;
+}
+
+/*
+* Schedule read-ahead of the chunks following qwOffset (which should be chunk
+* aligned to a previously read slot) unless they are already cached/pending.
+* NB! Function is to be called behind exclusive lock HR->RA.LockSRW.
+* -- HR
+* -- uszPathFile
+* -- qwHash
+* -- qwOffset = offset of the first chunk to read ahead.
+*/
+VOID VmmDllRemote_ReadAhead_Schedule(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ LPCSTR uszPathFile, _In_ QWORD qwHash, _In_ QWORD qwOffset)
+{
+    DWORD i, iChunk;
+    BOOL fExists;
+    HANDLE hThread;
+    PVMMDLL_REMOTE_READAHEAD_SLOT pe;
+    PVMMDLL_REMOTE_READAHEAD_CONTEXT ctx;
+    for(iChunk = 0; (iChunk < VMMDLL_REMOTE_READAHEAD_DEPTH) && (HR->RA.cPending < VMMDLL_REMOTE_READAHEAD_DEPTH); iChunk++, qwOffset += VMMDLL_REMOTE_READAHEAD_CHUNK) {
+        for(i = 0, fExists = FALSE; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+            pe = &HR->RA.Slot[i];
+            if((pe->qwHash == qwHash) && (pe->qwOffset == qwOffset)) {
+                // stop on cached end-of-file:
+                if(!pe->fPending && (pe->cb < VMMDLL_REMOTE_READAHEAD_CHUNK)) { return; }
+                fExists = TRUE;
+                break;
+            }
+        }
+        if(fExists) { continue; }
+        if(!(ctx = LocalAlloc(0, sizeof(VMMDLL_REMOTE_READAHEAD_CONTEXT)))) { return; }
+        if(!(pe = VmmDllRemote_ReadAhead_SlotGet(HR, qwHash, qwOffset))) {
+            LocalFree(ctx);
+            return;
+        }
+        pe->fPending = TRUE;
+        ResetEvent(HR->RA.hEventSlot[pe - HR->RA.Slot]);
+        ctx->HR = HR;
+        ctx->pSlot = pe;
+        strncpy_s(ctx->uszPathFile, sizeof(ctx->uszPathFile), uszPathFile, _TRUNCATE);
+        HR->RA.cPending++;
+        InterlockedIncrement(&HR->cThreadInternal);
+        hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)VmmDllRemote_ReadAhead_ThreadProc, (LPVOID)ctx, CREATE_THREAD_DETACHED, NULL);
+        if(!hThread) {
+            InterlockedDecrement(&HR->cThreadInternal);
+            HR->RA.cPending--;
+            VmmDllRemote_ReadAhead_SlotComplete(HR, pe, NULL);
+            LocalFree(ctx);
+            return;
+        }
+        CloseHandle(hThread);
+    }
+}
+
+/*
+* Invalidate all read-ahead slots related to a file (after a write).
+* -- HR
+* -- qwHash
+*/
+VOID VmmDllRemote_ReadAhead_Invalidate(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ QWORD qwHash)
+{
+    DWORD i;
+    PVMMDLL_REMOTE_READAHEAD_SLOT pe;
+    AcquireSRWLockExclusive(&HR->RA.LockSRW);
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+        pe = &HR->RA.Slot[i];
+        if((pe->qwHash == qwHash) && !pe->fPending) {
+            LocalFree(pe->pRsp);
+            ZeroMemory(pe, sizeof(VMMDLL_REMOTE_READAHEAD_SLOT));
+        }
+    }
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_STREAMS; i++) {
+        if(HR->RA.Stream[i].qwHash == qwHash) {
+            ZeroMemory(&HR->RA.Stream[i], sizeof(VMMDLL_REMOTE_READAHEAD_STREAM));
+        }
+    }
+    ReleaseSRWLockExclusive(&HR->RA.LockSRW);
+}
+
+/*
+* Try to serve a read from the read-ahead cache. If the read is sequential and
+* not yet cached the chunk is read synchronously and further read-ahead reads
+* are scheduled. Waits for pending slots covering the read to complete.
+* -- HR
+* -- uszPathFile
+* -- qwHash
+* -- pb
+* -- cb
+* -- pcbRead
+* -- cbOffset
+* -- pnt
+* -- return = TRUE if read was served, FALSE if caller should read directly.
+*/
+_Success_(return)
+BOOL VmmDllRemote_ReadAhead_Read(_In_ VMMDLL_REMOTE_HANDLE HR, _In_ LPCSTR uszPathFile, _In_ QWORD qwHash, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset, _Out_ NTSTATUS *pnt)
+{
+    DWORD i, cbChunk, cbReadTotal = 0;
+    BOOL fSequential = FALSE, fNextChunk;
+    QWORD tcNow;
+    HANDLE hEventWait;
+    PVMMDLL_REMOTE_READAHEAD_SLOT pe;
+    PLC_CMD_AGENT_VFS_RSP pRsp = NULL;
+    while(!HR->fAbort) {
+        fNextChunk = FALSE;
+        hEventWait = NULL;
+        tcNow = GetTickCount64();
+        AcquireSRWLockExclusive(&HR->RA.LockSRW);
+        if(!cbReadTotal) {
+            fSequential = VmmDllRemote_ReadAhead_StreamIsSequential(HR, qwHash, cbOffset);
+        }
+        for(i = 0; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+            pe = &HR->RA.Slot[i];
+            if((pe->qwHash != qwHash) || (cbOffset < pe->qwOffset) || (cbOffset >= pe->qwOffset + VMMDLL_REMOTE_READAHEAD_CHUNK)) { continue; }
+            if(pe->fPending) {
+                hEventWait = HR->RA.hEventSlot[i];
+                break;
+            }
+            if(tcNow > pe->tcComplete + VMMDLL_REMOTE_READAHEAD_MAXAGE_MS) { continue; }
+            // copy the part of the read covered by the slot:
+            cbChunk = (cbOffset < pe->qwOffset + pe->cb) ? (DWORD)min(cb, pe->qwOffset + pe->cb - cbOffset) : 0;
+            memcpy(pb, pe->pRsp->pb + (cbOffset - pe->qwOffset), cbChunk);
+            pb += cbChunk;
+            cb -= cbChunk;
+            cbOffset += cbChunk;
+            cbReadTotal += cbChunk;
+            VmmDllRemote_ReadAhead_StreamUpdate(HR, qwHash, cbOffset);
+            VmmDllRemote_ReadAhead_Schedule(HR, uszPathFile, qwHash, pe->qwOffset + VMMDLL_REMOTE_READAHEAD_CHUNK);
+            if(!cb || (pe->cb < VMMDLL_REMOTE_READAHEAD_CHUNK)) {
+                // read completed or end-of-file reached:
+                *pcbRead = cbReadTotal;
+                *pnt = (cbReadTotal || (pe->cb == VMMDLL_REMOTE_READAHEAD_CHUNK)) ? VMMDLL_STATUS_SUCCESS : (pe->nt ? pe->nt : VMMDLL_STATUS_END_OF_FILE);
+                ReleaseSRWLockExclusive(&HR->RA.LockSRW);
+                return TRUE;
+            }
+            // remainder of read is located in the following chunk:
+            fNextChunk = TRUE;
+            break;
+        }
+        if(!hEventWait && !fNextChunk) {
+            if(!cbReadTotal) {
+                VmmDllRemote_ReadAhead_StreamUpdate(HR, qwHash, cbOffset + cb);
+            }
+            ReleaseSRWLockExclusive(&HR->RA.LockSRW);
+            break;
+        }
+        ReleaseSRWLockExclusive(&HR->RA.LockSRW);
+        if(hEventWait) {
+            // wait for the pending slot to complete. The slot event is owned
+            // by the handle and is only closed at handle close so it's safe
+            // to wait on it outside of the lock.
+            WaitForSingleObject(hEventWait, INFINITE);
+        }
+    }
+    if(!fSequential || HR->fAbort) { return FALSE; }
+    // sequential read not in cache - read chunk synchronously and schedule
+    // read-ahead of the following chunks:
+    if(!VmmDllRemote_VfsReadRemote(HR, uszPathFile, VMMDLL_REMOTE_READAHEAD_CHUNK, cbOffset, &pRsp)) { return FALSE; }
+    cbChunk = min(cb, pRsp->cb);
+    memcpy(pb, pRsp->pb, cbChunk);
+    *pcbRead = cbReadTotal + cbChunk;
+    *pnt = cbReadTotal ? VMMDLL_STATUS_SUCCESS : pRsp->dwStatus;
+    AcquireSRWLockExclusive(&HR->RA.LockSRW);
+    VmmDllRemote_ReadAhead_StreamUpdate(HR, qwHash, cbOffset + cbChunk);
+    if((pe = VmmDllRemote_ReadAhead_SlotGet(HR, qwHash, cbOffset))) {
+        VmmDllRemote_ReadAhead_SlotComplete(HR, pe, pRsp);
+        pRsp = NULL;
+        if(pe->cb == VMMDLL_REMOTE_READAHEAD_CHUNK) {
+            VmmDllRemote_ReadAhead_Schedule(HR, uszPathFile, qwHash, cbOffset + VMMDLL_REMOTE_READAHEAD_CHUNK);
+        }
+    }
+    ReleaseSRWLockExclusive(&HR->RA.LockSRW);
+    LocalFree(pRsp);
+    return TRUE;
+}
+
+/*
+* Remote VMMDLL_VfsReadU().
+*/
+NTSTATUS VmmDllRemote_VfsReadU(_In_ VMM_HANDLE H, _In_ LPCSTR uszFileName, _Out_writes_to_(cb, *pcbRead) PBYTE pb, _In_ DWORD cb, _Out_ PDWORD pcbRead, _In_ ULONG64 cbOffset)
+{
+    NTSTATUS nt = VMMDLL_STATUS_FILE_INVALID;
+    PLC_CMD_AGENT_VFS_RSP pRsp = NULL;
+    VMMDLL_REMOTE_HANDLE HR = NULL;
+    CHAR uszPathFile[2*MAX_PATH];
+    QWORD qwHash;
+    if(!(HR = VmmDllRemote_HandleReserveExternal(H))) { return VMMDLL_STATUS_FILE_INVALID; }
+    // Remote MemProcFS below:
+    if(!CharUtil_UtoU(uszFileName, -1, uszPathFile, sizeof(uszPathFile), NULL, NULL, CHARUTIL_FLAG_STR_BUFONLY)) { goto fail; }
+    if(cb < VMMDLL_REMOTE_READAHEAD_CHUNK) {
+        qwHash = CharUtil_Hash64U(uszPathFile, FALSE) | 1;
+        if(VmmDllRemote_ReadAhead_Read(HR, uszPathFile, qwHash, pb, cb, pcbRead, cbOffset, &nt)) { goto fail; }
+    }
+    if(!VmmDllRemote_VfsReadRemote(HR, uszPathFile, cb, cbOffset, &pRsp)) { goto fail; }
     nt = pRsp->dwStatus;
     *pcbRead = min(cb, pRsp->cb);
     memcpy(pb, pRsp->pb, *pcbRead);
@@ -387,6 +762,7 @@ NTSTATUS VmmDllRemote_VfsWriteU(_In_ VMM_HANDLE H, _In_ LPCSTR uszFileName, _In_
     pReq->cb = cb;
     memcpy(pReq->pb, pb, cb);
     if(!CharUtil_UtoU(uszFileName, -1, pReq->uszPathFile, sizeof(pReq->uszPathFile), NULL, NULL, CHARUTIL_FLAG_STR_BUFONLY)) { goto fail; }
+    VmmDllRemote_ReadAhead_Invalidate(HR, CharUtil_Hash64U(pReq->uszPathFile, FALSE) | 1);
     if(!LcCommand(HR->hLC, LC_CMD_AGENT_VFS_WRITE, sizeof(LC_CMD_AGENT_VFS_REQ) + cb, (PBYTE)pReq, (PBYTE*)&pRsp, &cbRsp) || !pRsp) { goto fail; }
     if((cbRsp < sizeof(LC_CMD_AGENT_VFS_RSP)) || (pRsp->dwVersion != LC_CMD_AGENT_VFS_RSP_VERSION)) { goto fail; }
     nt = pRsp->dwStatus;
@@ -596,7 +972,7 @@ VMM_HANDLE VmmDllRemote_Initialize(_In_ DWORD argc, _In_ LPCSTR argv[], _Out_opt
     HANDLE hThread = NULL;
     VMMDLL_REMOTE_HANDLE HR = NULL;
     PVMMDLL_VFS_INITIALIZEBLOB pVfsInitBlob = NULL;
-    DWORD cbLcErrorInfo = 0;
+    DWORD i, cbLcErrorInfo = 0;
     PLC_CONFIG_ERRORINFO pLcErrorInfo = NULL;
     LPSTR uszUserText;
     BYTE pbBuffer[3 * MAX_PATH];
@@ -606,6 +982,10 @@ VMM_HANDLE VmmDllRemote_Initialize(_In_ DWORD argc, _In_ LPCSTR argv[], _Out_opt
     if(!(HR = LocalAlloc(LMEM_ZEROINIT, sizeof(struct tdVMMDLL_REMOTE_HANDLE)))) { goto fail_prelock; }
     HR->magic = VMMDLL_REMOTE_MAGIC;
     HR->dwHandleCount = 1;
+    InitializeSRWLock(&HR->RA.LockSRW);
+    for(i = 0; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+        if(!(HR->RA.hEventSlot[i] = CreateEvent(NULL, TRUE, TRUE, NULL))) { goto fail_prelock; }
+    }
     // 2: initialize config:
     if(!VmmDllRemote_InitializeConfig(HR, argc, argv, &pVfsInitBlob)) {
         VmmDllRemote_printf(HR, "MemProcFS: Unable to parse remote command line.\n");
@@ -657,7 +1037,7 @@ VMM_HANDLE VmmDllRemote_Initialize(_In_ DWORD argc, _In_ LPCSTR argv[], _Out_opt
     }
     // 7: Set up background keep-alive thread:
     InterlockedIncrement(&HR->cThreadInternal);
-    hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)VmmDllRemote_KeepAlive_ThreadProc, (LPVOID)HR, 0, NULL);
+    hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE)VmmDllRemote_KeepAlive_ThreadProc, (LPVOID)HR, CREATE_THREAD_DETACHED, NULL);
     if(hThread) { CloseHandle(hThread); }
     // 8: finish and return handle (as a "fake" VMM_HANDLE).
     LeaveCriticalSection(&g_VMMDLL_REMOTE_LOCK);
@@ -675,6 +1055,11 @@ fail:
     return NULL;
 fail_prelock:
     LocalFree(pVfsInitBlob);
+    if(HR) {
+        for(i = 0; i < VMMDLL_REMOTE_READAHEAD_SLOTS; i++) {
+            if(HR->RA.hEventSlot[i]) { CloseHandle(HR->RA.hEventSlot[i]); }
+        }
+    }
     LocalFree(HR);
     return NULL;
 }
@@ -140,6 +140,27 @@ typedef struct tdVMMWINHEAP_CTX_STORE {
     VMM_MAP_HEAPALLOCENTRY e[VMMWINHEAP_CTX_STORE_MAX];
 } VMMWINHEAP_CTX_STORE, *PVMMWINHEAP_CTX_STORE;
 
+#define VMMHEAPALLOC_WORK_THREADS           4
+#define VMMHEAPALLOC_PREFETCH_PAGES         0x2000      // max # pages prefetched per discovery round.
+#define VMMHEAPALLOC_CACHEMAP_MAX           0x10        // max # cached heap allocation maps (all processes).
+#define VMMHEAPALLOC_WARM_MAX               4           // max # heaps built per process by background build.
+
+typedef struct tdVMMHEAPALLOC_SEGMENT_JOB {
+    QWORD va;
+    DWORD cb;
+    DWORD dwParam;                          // nt heap: offset of first entry, segment heap: segment context index.
+} VMMHEAPALLOC_SEGMENT_JOB, *PVMMHEAPALLOC_SEGMENT_JOB;
+
+struct tdVMMHEAPNT_CTX;
+typedef VOID(*PVMMHEAPALLOC_SEGMENT_PFN)(_In_ VMM_HANDLE H, _In_ struct tdVMMHEAPNT_CTX *ctx, _In_ PVMMHEAPALLOC_SEGMENT_JOB pJob, _In_ PBYTE pb);
+
+typedef struct tdVMMHEAPALLOC_WORK {
+    PVMMHEAPALLOC_SEGMENT_PFN pfn;
+    PVMMHEAPALLOC_SEGMENT_JOB pJob;
+    DWORD cJob;
+    volatile LONG iJob;
+} VMMHEAPALLOC_WORK, *PVMMHEAPALLOC_WORK;
+
 typedef struct tdVMMHEAPNT_CTX {
     PVMM_PROCESS pProcess;
     PVMMOB_MAP_HEAP pHeapMap;
@@ -159,6 +180,9 @@ typedef struct tdVMMHEAPNT_CTX {
         UCHAR ucUnitShift;
         UCHAR ucFirstDescriptorIndex;
     } segctx[2];
+    // parallel segment processing:
+    PVMMHEAPALLOC_WORK pWork;
+    BOOL fSerial;                           // parse segments on the calling thread only.
 
 } VMMHEAPNT_CTX, *PVMMHEAPNT_CTX;
 
@@ -207,6 +231,18 @@ VOID VmmHeapAlloc_PushLarge(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx, _In_ PVM
     _HEAPENTRY eH;
     QWORD cbAlloc;
     PVMM_MAP_HEAP_SEGMENTENTRY peSegment;
+    POB_SET psObPrefetch = NULL;
+    // prefetch large allocation headers in one scatter read:
+    if(ctx->qwHeapEncoding && (psObPrefetch = ObSet_New(H))) {
+        for(i = 0; i < pHeapMap->cSegments; i++) {
+            peSegment = pHeapMap->pSegments + i;
+            if((peSegment->iHeap == peHeap->iHeap) && (peSegment->tp == VMM_HEAP_SEGMENT_TP_NT_LARGE)) {
+                ObSet_Push(psObPrefetch, peSegment->va);
+            }
+        }
+        VmmCachePrefetchPages3(H, ctx->pProcess, psObPrefetch, sizeof(pbBuffer), 0);
+        Ob_DECREF_NULL(&psObPrefetch);
+    }
     for(i = 0; i < pHeapMap->cSegments; i++) {
         peSegment = pHeapMap->pSegments + i;
         if(peSegment->iHeap == peHeap->iHeap) {
@@ -231,6 +267,116 @@ VOID VmmHeapAlloc_PushLarge(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx, _In_ PVM
     }
 }
 
+/*
+* Splice the store list of a worker onto the store list of the heap context.
+* The entry counts (cPrevious) of the spliced stores are adjusted so that the
+* total entry count is still kept in the topmost store.
+*/
+VOID VmmHeapAlloc_StoreMerge(_Inout_ PVMMWINHEAP_CTX_STORE *ppStoreDst, _In_ PVMMWINHEAP_CTX_STORE pStoreSrc)
+{
+    DWORD cTotal;
+    PVMMWINHEAP_CTX_STORE pStore;
+    if(!pStoreSrc) { return; }
+    cTotal = pStoreSrc->c + pStoreSrc->cPrevious + (*ppStoreDst)->c + (*ppStoreDst)->cPrevious;
+    for(pStore = pStoreSrc; pStore; pStore = pStore->pNext) {
+        cTotal -= pStore->c;
+        pStore->cPrevious = cTotal;
+        if(!pStore->pNext) {
+            pStore->pNext = *ppStoreDst;
+            break;
+        }
+    }
+    *ppStoreDst = pStoreSrc;
+}
+
+/*
+* Worker thread function: process heap segments from the shared job list.
+* Each worker has its own copy of the heap context with a private store.
+*/
+VOID VmmHeapAlloc_SegmentWork_ThreadProc(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctxW)
+{
+    PBYTE pb = NULL;
+    DWORD cb = 0;
+    LONG iJob;
+    PVMMHEAPALLOC_SEGMENT_JOB pJob;
+    PVMMHEAPALLOC_WORK pWork = ctxW->pWork;
+    while(!H->fAbort && ((iJob = InterlockedIncrement(&pWork->iJob) - 1) < (LONG)pWork->cJob)) {
+        pJob = pWork->pJob + iJob;
+        if(pJob->cb > cb) {
+            LocalFree(pb);
+            cb = pJob->cb;
+            if(!(pb = LocalAlloc(0, cb))) { return; }
+        }
+        VmmReadEx(H, ctxW->pProcess, pJob->va, pb, pJob->cb, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
+        pWork->pfn(H, ctxW, pJob, pb);
+    }
+    LocalFree(pb);
+}
+
+/*
+* Process heap segments in discovery rounds. Each round prefetches the pages of
+* as many segments as fits within VMMHEAPALLOC_PREFETCH_PAGES in one scatter
+* read and then parses the segments in parallel on the worker pool.
+* -- H
+* -- ctx
+* -- cJob
+* -- pJob
+* -- pfn = segment parse function.
+*/
+VOID VmmHeapAlloc_SegmentWork(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx, _In_ DWORD cJob, _In_reads_(cJob) PVMMHEAPALLOC_SEGMENT_JOB pJob, _In_ PVMMHEAPALLOC_SEGMENT_PFN pfn)
+{
+    QWORD va;
+    DWORD i, iJobBase = 0, cPages, cPagesJob, cWork;
+    VMMHEAPALLOC_WORK Work = { 0 };
+    VMMHEAPNT_CTX ctxW[VMMHEAPALLOC_WORK_THREADS];
+    PVOID pvWork[VMMHEAPALLOC_WORK_THREADS];
+    PVMM_WORK_START_ROUTINE_PVOID_PFN pfnWork[VMMHEAPALLOC_WORK_THREADS];
+    POB_SET psObPrefetch = NULL;
+    if(!cJob || !(psObPrefetch = ObSet_New(H))) { goto fail; }
+    Work.pfn = pfn;
+    while((iJobBase < cJob) && !H->fAbort) {
+        // 1: collect the pages of the next round of segments and prefetch them:
+        ObSet_Clear(psObPrefetch);
+        for(i = iJobBase, cPages = 0; i < cJob; i++) {
+            cPagesJob = (DWORD)(((pJob[i].va + pJob[i].cb + 0xfff) >> 12) - (pJob[i].va >> 12));
+            if(cPages && (cPages + cPagesJob > VMMHEAPALLOC_PREFETCH_PAGES)) { break; }
+            for(va = pJob[i].va & ~0xfff; va < pJob[i].va + pJob[i].cb; va += 0x1000) {
+                ObSet_Push(psObPrefetch, va);
+            }
+            cPages += cPagesJob;
+        }
+        VmmCachePrefetchPages(H, ctx->pProcess, psObPrefetch, 0);
+        // 2: parse the segments of the round in parallel:
+        Work.pJob = pJob + iJobBase;
+        Work.cJob = i - iJobBase;
+        Work.iJob = 0;
+        iJobBase = i;
+        cWork = ctx->fSerial ? 1 : min(VMMHEAPALLOC_WORK_THREADS, Work.cJob);
+        for(i = 0; i < cWork; i++) {
+            memcpy(&ctxW[i], ctx, sizeof(VMMHEAPNT_CTX));
+            ctxW[i].pWork = &Work;
+            ctxW[i].pStore = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINHEAP_CTX_STORE));
+            pfnWork[i] = (PVMM_WORK_START_ROUTINE_PVOID_PFN)VmmHeapAlloc_SegmentWork_ThreadProc;
+            pvWork[i] = &ctxW[i];
+        }
+        for(i = 0; i < cWork; i++) {
+            if(!ctxW[i].pStore) { goto fail_round; }
+        }
+        if(cWork == 1) {
+            VmmHeapAlloc_SegmentWork_ThreadProc(H, &ctxW[0]);
+        } else {
+            VmmWorkWaitMultiple2_Void(H, cWork, pfnWork, pvWork);
+        }
+fail_round:
+        // 3: merge worker results:
+        for(i = 0; i < cWork; i++) {
+            VmmHeapAlloc_StoreMerge(&ctx->pStore, ctxW[i].pStore);
+        }
+    }
+fail:
+    Ob_DECREF(psObPrefetch);
+}
+
 /*
 * Fetch LFH / Heap key from symbols.
 * -- H
@@ -297,14 +443,15 @@ VOID VmmHeapAlloc_CloseObCallback(_In_ PVOID pVmmOb)
 
 /*
 * Initialize a new heap allocation map.
-* This function is called in a single-threaded process lock.
+* This function is called in the (PID, heap) striped heap allocation lock.
 * -- H
 * -- pProcess
 * -- vaHeap = va of heap or heap id.
+* -- fSerial = parse segments on the calling thread (caller is a pool worker).
 * -- return
 */
 _Success_(return != NULL)
-PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Init_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD vaHeap)
+PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Init_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD vaHeap, _In_ BOOL fSerial)
 {
     PVMMHEAPNT_CTX ctx = NULL;
     PVMMWINHEAP_CTX_STORE pStore;
@@ -322,6 +469,7 @@ PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Init_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCE
     ctx->po = ctx->f32 ? &H->vmm.offset.HEAP32 : &H->vmm.offset.HEAP64;
     if(!(ctx->pStore = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINHEAP_CTX_STORE)))) { goto fail; }
     ctx->pProcess = pProcess;
+    ctx->fSerial = fSerial;
     // 2: dispatch to nt/segment heap subsystems
     if(ctx->pHeapEntry->tp == VMM_HEAP_TP_NT) {
         VmmHeapAlloc_NtInit(H, ctx);
@@ -367,37 +515,72 @@ fail:
 VOID VmmHeapAlloc_Refresh(_In_ VMM_HANDLE H)
 {
     ObCacheMap_Clear(H->vmm.pObCacheMapHeapAlloc);
+    ObSet_Clear(H->vmm.psObHeapAllocWarmPID);
+}
+
+/*
+* Ensure the heap allocation map cache (and the set of processes for which a
+* background build has been queued) exists.
+* -- H
+* -- return
+*/
+_Success_(return)
+BOOL VmmHeapAlloc_InitializeCache(_In_ VMM_HANDLE H)
+{
+    if(!H->vmm.pObCacheMapHeapAlloc) {
+        EnterCriticalSection(&H->vmm.LockPlugin);
+        if(!H->vmm.psObHeapAllocWarmPID) {
+            H->vmm.psObHeapAllocWarmPID = ObSet_New(H);
+        }
+        if(!H->vmm.pObCacheMapHeapAlloc && H->vmm.psObHeapAllocWarmPID) {
+            H->vmm.pObCacheMapHeapAlloc = ObCacheMap_New(H, VMMHEAPALLOC_CACHEMAP_MAX, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB);
+        }
+        LeaveCriticalSection(&H->vmm.LockPlugin);
+    }
+    return H->vmm.pObCacheMapHeapAlloc ? TRUE : FALSE;
+}
+
+/*
+* Retrieve the lock serializing the allocation map build of a single heap.
+* Locks are striped by (PID, heap) so that independent heaps - also within
+* the same process - may be built in parallel.
+* -- H
+* -- dwPID
+* -- vaHeap
+* -- return
+*/
+PSRWLOCK VmmHeapAlloc_GetLock(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ QWORD vaHeap)
+{
+    return &H->vmm.LockSRW.HeapAlloc[(dwPID ^ (DWORD)vaHeap ^ (DWORD)(vaHeap >> 16)) % VMM_HEAPALLOC_LOCK_STRIPES];
 }
 
 /*
 * Retrive the heap allocation map for the specific heap.
-* The map is cached up until a total process refresh is made (medium refresh).
 * CALLER DECREF: return
 * -- H
 * -- pProcess
 * -- vaHeap = va of heap or heap id.
+* -- fSerial = parse segments on the calling thread (caller is a pool worker).
 * -- return
 */
-PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD vaHeap)
+PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Initialize2(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD vaHeap, _In_ BOOL fSerial)
 {
+    PSRWLOCK pLockSRW;
     PVMMOB_MAP_HEAPALLOC pObHeapAlloc = NULL;
     // 1: ensure cache map exists (or init)
-    if(!H->vmm.pObCacheMapHeapAlloc) {
-        EnterCriticalSection(&H->vmm.LockPlugin);
-        if(!H->vmm.pObCacheMapHeapAlloc) {
-            H->vmm.pObCacheMapHeapAlloc = ObCacheMap_New(H, 0x10, NULL, OB_CACHEMAP_FLAGS_OBJECT_OB);
-        }
-        LeaveCriticalSection(&H->vmm.LockPlugin);
-    }
+    if(!VmmHeapAlloc_InitializeCache(H)) { return NULL; }
     // 2: try fetch from cache map
     if(!(pObHeapAlloc = ObCacheMap_GetByKey(H->vmm.pObCacheMapHeapAlloc, vaHeap + pProcess->dwPID))) {
-        EnterCriticalSection(&pProcess->LockUpdate);
+        // NB! the process update lock must not be held since heap segments are
+        // parsed by worker threads which may require it to resolve memory.
+        pLockSRW = VmmHeapAlloc_GetLock(H, pProcess->dwPID, vaHeap);
+        AcquireSRWLockExclusive(pLockSRW);
         if(!(pObHeapAlloc = ObCacheMap_GetByKey(H->vmm.pObCacheMapHeapAlloc, vaHeap + pProcess->dwPID))) {
-            if((pObHeapAlloc = VmmHeapAlloc_Init_DoWork(H, pProcess, vaHeap))) {
+            if((pObHeapAlloc = VmmHeapAlloc_Init_DoWork(H, pProcess, vaHeap, fSerial))) {
                 ObCacheMap_Push(H->vmm.pObCacheMapHeapAlloc, vaHeap + pProcess->dwPID, pObHeapAlloc, 0);
             }
         }
-        LeaveCriticalSection(&pProcess->LockUpdate);
+        ReleaseSRWLockExclusive(pLockSRW);
     }
     // 3: on fail, create dummy map and push to cache
     if(!pObHeapAlloc && (pObHeapAlloc = Ob_AllocEx(H, OB_TAG_MAP_HEAPALLOC, LMEM_ZEROINIT, sizeof(VMMOB_MAP_HEAPALLOC), NULL, NULL))) {
@@ -406,6 +589,82 @@ PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCES
     return pObHeapAlloc;
 }
 
+/*
+* Retrive the heap allocation map for the specific heap.
+* The map is cached up until a total process refresh is made (medium refresh).
+* CALLER DECREF: return
+* -- H
+* -- pProcess
+* -- vaHeap = va of heap or heap id.
+* -- return
+*/
+PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD vaHeap)
+{
+    return VmmHeapAlloc_Initialize2(H, pProcess, vaHeap, FALSE);
+}
+
+typedef struct tdOB_VMMHEAPALLOC_INITALL_CTX {
+    OB ObHdr;
+    PVMM_PROCESS pProcess;
+    DWORD cHeap;
+    volatile LONG iHeap;
+    DWORD iHeaps[VMMHEAPALLOC_WARM_MAX];
+} OB_VMMHEAPALLOC_INITALL_CTX, *POB_VMMHEAPALLOC_INITALL_CTX;
+
+VOID VmmHeapAlloc_InitializeAll_CleanupCB(_In_ POB_VMMHEAPALLOC_INITALL_CTX pOb)
+{
+    Ob_DECREF(pOb->pProcess);
+}
+
+/*
+* Worker thread function: build heap allocation maps from the shared heap list.
+* Segments are parsed serially on the worker since the heaps themselves run in
+* parallel - the worker never waits for other work items.
+*/
+VOID VmmHeapAlloc_InitializeAll_ThreadProc(_In_ VMM_HANDLE H, _In_ POB_VMMHEAPALLOC_INITALL_CTX ctx)
+{
+    LONG iHeap;
+    while(!H->fAbort && ((iHeap = InterlockedIncrement(&ctx->iHeap) - 1) < (LONG)ctx->cHeap)) {
+        Ob_DECREF(VmmHeapAlloc_Initialize2(H, ctx->pProcess, ctx->iHeaps[iHeap], TRUE));
+    }
+}
+
+/*
+* Queue a background build of the heap allocation maps of a process. The heaps
+* are built in parallel on the worker pool and pushed to the heap allocation
+* cache. The function does not wait for the build to complete.
+* The build is only queued once per process and refresh. Heaps already in the
+* cache are skipped and at most VMMHEAPALLOC_WARM_MAX heaps, limited to the free
+* entries of the cache, are built so that other cached maps are not evicted.
+* -- H
+* -- pProcess
+*/
+VOID VmmHeapAlloc_InitializeAll(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess)
+{
+    DWORD i, cWork, cFree;
+    PVMMOB_MAP_HEAP pObHeapMap = NULL;
+    POB_VMMHEAPALLOC_INITALL_CTX pObCtx = NULL;
+    if(!VmmHeapAlloc_InitializeCache(H)) { return; }
+    if(!ObSet_Push(H->vmm.psObHeapAllocWarmPID, pProcess->dwPID)) { return; }
+    cFree = VMMHEAPALLOC_CACHEMAP_MAX - min(VMMHEAPALLOC_CACHEMAP_MAX, ObCacheMap_Size(H->vmm.pObCacheMapHeapAlloc));
+    if(!cFree) { return; }
+    if(!VmmMap_GetHeap(H, pProcess, &pObHeapMap)) { goto fail; }
+    if(!(pObCtx = Ob_AllocEx(H, OB_TAG_HEAPALLOC_INITALL_CTX, LMEM_ZEROINIT, sizeof(OB_VMMHEAPALLOC_INITALL_CTX), (OB_CLEANUP_CB)VmmHeapAlloc_InitializeAll_CleanupCB, NULL))) { goto fail; }
+    pObCtx->pProcess = Ob_INCREF(pProcess);
+    for(i = 0; (i < pObHeapMap->cMap) && (pObCtx->cHeap < min(cFree, VMMHEAPALLOC_WARM_MAX)); i++) {
+        if(!ObCacheMap_ExistsKey(H->vmm.pObCacheMapHeapAlloc, pObHeapMap->pMap[i].iHeap + pProcess->dwPID)) {
+            pObCtx->iHeaps[pObCtx->cHeap++] = pObHeapMap->pMap[i].iHeap;
+        }
+    }
+    cWork = min(VMMHEAPALLOC_WORK_THREADS, pObCtx->cHeap);
+    for(i = 0; i < cWork; i++) {
+        VmmWork_Ob(H, (PVMM_WORK_START_ROUTINE_OB_PFN)VmmHeapAlloc_InitializeAll_ThreadProc, (POB)pObCtx, NULL, VMMWORK_FLAG_PRIO_LOW);
+    }
+fail:
+    Ob_DECREF(pObCtx);
+    Ob_DECREF(pObHeapMap);
+}
+
 
 
 // ----------------------------------------------------------------------------
@@ -564,18 +823,30 @@ DWORD VmmHeapAlloc_SegRangeDescriptor(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx
     return ucUnitSize;
 }
 
+/*
+* Parse a single segment heap page segment job (called by the segment worker
+* threads) by walking its range descriptors.
+*/
+VOID VmmHeapAlloc_SegInitJob(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx, _In_ PVMMHEAPALLOC_SEGMENT_JOB pJob, _In_ PBYTE pb)
+{
+    DWORD iRD = ctx->segctx[pJob->dwParam].ucFirstDescriptorIndex;
+    while(iRD < 256) {
+        iRD += VmmHeapAlloc_SegRangeDescriptor(H, ctx, pJob->dwParam, pJob->va, pb, pJob->cb, iRD);
+    }
+}
+
 /*
 * Init Segment heap entries (excl. large entries)
 */
 VOID VmmHeapAlloc_SegInit(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx)
 {
     BOOL f32 = ctx->f32;
-    DWORD i, o, iCtx, iRD;
+    DWORD i, o, iCtx, cJob = 0;
     QWORD vaSignature;
-    DWORD cbPgSeg;
-    PBYTE pbPgSeg = NULL;
-    BYTE pbSegHdr[0x400];
+    BYTE pbSegHdr[0x400], pbPgSegHdr[0x20];
     PVMM_MAP_HEAP_SEGMENTENTRY peSegment;
+    PVMMHEAPALLOC_SEGMENT_JOB pJobs = NULL;
+    POB_SET psObPrefetch = NULL;
     // 1: init
     if(H->vmm.kernel.dwVersionBuild < 16299) {
         VmmLog(H, MID_HEAP, LOGLEVEL_5_DEBUG, "FAIL: Segment Heap not supported below Win10 1709 / 16299");
@@ -598,32 +869,41 @@ VOID VmmHeapAlloc_SegInit(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx)
         ctx->segctx[i].ucUnitShift = *(PUCHAR)(pbSegHdr + o + ctx->po->seg.HEAP_SEG_CONTEXT.UnitShift);
         ctx->segctx[i].ucFirstDescriptorIndex = *(PUCHAR)(pbSegHdr + o + ctx->po->seg.HEAP_SEG_CONTEXT.FirstDescriptorIndex);
     }
-    // 4: walk segments and process them!
+    // 4: prefetch segment headers and collect segments with valid signature:
+    if(!(psObPrefetch = ObSet_New(H))) { goto fail; }
     for(i = 0; i < ctx->pHeapMap->cSegments; i++) {
         peSegment = ctx->pHeapMap->pSegments + i;
-        if(peSegment->iHeap == ctx->pHeapEntry->iHeap) {
-            if(peSegment->tp == VMM_HEAP_SEGMENT_TP_SEG_SEGMENT) {
-                // alloc & read
-                LocalFree(pbPgSeg);
-                cbPgSeg = peSegment->cb;
-                if(!(pbPgSeg = LocalAlloc(0, cbPgSeg))) { goto fail; }
-                VmmRead2(H, ctx->pProcess, peSegment->va, pbPgSeg, cbPgSeg, VMM_FLAG_ZEROPAD_ON_FAIL);
-                // signature check:
-                vaSignature = VMM_PTR_OFFSET_DUAL(f32, pbPgSeg, 8, 16) ^ peSegment->va ^ ctx->qwSegHeapGbl ^ ctx->po->seg.HEAP_PAGE_SEGMENT.qwSignatureStaticKey;
-                iCtx = (DWORD)-1;
-                if(ctx->segctx[0].va == vaSignature) { iCtx = 0; }
-                if(ctx->segctx[1].va == vaSignature) { iCtx = 1; }
-                if(iCtx > 1) { continue; }
-                // walk range descriptors:
-                iRD = ctx->segctx[iCtx].ucFirstDescriptorIndex;
-                while(iRD < 256) {
-                    iRD += VmmHeapAlloc_SegRangeDescriptor(H, ctx, iCtx, peSegment->va, pbPgSeg, cbPgSeg, iRD);
-                }
+        if((peSegment->iHeap == ctx->pHeapEntry->iHeap) && (peSegment->tp == VMM_HEAP_SEGMENT_TP_SEG_SEGMENT)) {
+            ObSet_Push(psObPrefetch, peSegment->va);
+        }
+    }
+    if(!ObSet_Size(psObPrefetch)) { goto fail; }
+    if(!(pJobs = LocalAlloc(0, ObSet_Size(psObPrefetch) * sizeof(VMMHEAPALLOC_SEGMENT_JOB)))) { goto fail; }
+    VmmCachePrefetchPages3(H, ctx->pProcess, psObPrefetch, sizeof(pbPgSegHdr), 0);
+    for(i = 0; i < ctx->pHeapMap->cSegments; i++) {
+        peSegment = ctx->pHeapMap->pSegments + i;
+        if((peSegment->iHeap == ctx->pHeapEntry->iHeap) && (peSegment->tp == VMM_HEAP_SEGMENT_TP_SEG_SEGMENT)) {
+            // signature check:
+            if(!VmmRead(H, ctx->pProcess, peSegment->va, pbPgSegHdr, sizeof(pbPgSegHdr))) { continue; }
+            vaSignature = VMM_PTR_OFFSET_DUAL(f32, pbPgSegHdr, 8, 16) ^ peSegment->va ^ ctx->qwSegHeapGbl ^ ctx->po->seg.HEAP_PAGE_SEGMENT.qwSignatureStaticKey;
+            iCtx = (DWORD)-1;
+            if(ctx->segctx[0].va == vaSignature) { iCtx = 0; }
+            if(ctx->segctx[1].va == vaSignature) { iCtx = 1; }
+            if(iCtx > 1) { continue; }
+            // add segment job
+            if(cJob < ObSet_Size(psObPrefetch)) {
+                pJobs[cJob].va = peSegment->va;
+                pJobs[cJob].cb = peSegment->cb;
+                pJobs[cJob].dwParam = iCtx;
+                cJob++;
             }
         }
     }
+    // 5: prefetch and process the segments in parallel:
+    VmmHeapAlloc_SegmentWork(H, ctx, cJob, pJobs, VmmHeapAlloc_SegInitJob);
 fail:
-    LocalFree(pbPgSeg);
+    Ob_DECREF(psObPrefetch);
+    LocalFree(pJobs);
 }
 
 
@@ -770,16 +1050,25 @@ VOID VmmHeapAlloc_NtInitSeg(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx, _In_ QWO
     }
 }
 
+/*
+* Parse a single NT heap segment job (called by the segment worker threads).
+*/
+VOID VmmHeapAlloc_NtInitSegJob(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx, _In_ PVMMHEAPALLOC_SEGMENT_JOB pJob, _In_ PBYTE pb)
+{
+    VmmHeapAlloc_NtInitSeg(H, ctx, pJob->va, pb, pJob->cb, pJob->dwParam);
+}
+
 /*
 * Init NT heap entries (excl. large entries)
 */
 VOID VmmHeapAlloc_NtInit(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx)
 {
-    DWORD i, cbSegment, dwSegmentSignature;
+    DWORD i, cbSegment, dwSegmentSignature, cJob = 0;
     BYTE pbSegmentHdr[0x80];
-    PBYTE pbSegment;
     QWORD vaFirstEntry, vaLastEntry;
     PVMM_MAP_HEAP_SEGMENTENTRY peSegment;
+    PVMMHEAPALLOC_SEGMENT_JOB pJobs = NULL;
+    POB_SET psObPrefetch = NULL;
     if(H->vmm.kernel.dwVersionBuild <= 2600) {
         VmmLog(H, MID_HEAP, LOGLEVEL_5_DEBUG, "FAIL: HeapAlloc not supported on WinXP");
         return;
@@ -791,12 +1080,17 @@ VOID VmmHeapAlloc_NtInit(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx)
         }
     }
     // 2: walk segments to find any LFH area, this is required for LFH decode:
+    //    also collect segment headers for prefetch.
+    if(!(psObPrefetch = ObSet_New(H))) { goto fail; }
     for(i = 0; i < ctx->pHeapMap->cSegments; i++) {
         peSegment = ctx->pHeapMap->pSegments + i;
         if(peSegment->iHeap == ctx->pHeapEntry->iHeap) {
             if(peSegment->tp == VMM_HEAP_SEGMENT_TP_NT_LFH) {
                 ctx->vaLfh = peSegment->va;
             }
+            if(peSegment->tp == VMM_HEAP_SEGMENT_TP_NT_SEGMENT) {
+                ObSet_Push(psObPrefetch, peSegment->va);
+            }
         }
     }
     // 3: fetch Lfh Key if LFH area exists
@@ -804,7 +1098,10 @@ VOID VmmHeapAlloc_NtInit(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx)
         VmmHeapAlloc_GetHeapKeys(H, ctx->pProcess, ctx->f32, NULL, NULL, NULL, &ctx->dwLfhKey);
         VmmLog(H, MID_HEAP, LOGLEVEL_6_TRACE, "%s LFH KEY: %x ", (ctx->dwLfhKey ? "LOAD" : "FAIL"), ctx->dwLfhKey);
     }
-    // 4: walk segments and process them!
+    // 4: prefetch segment headers and collect valid segments:
+    if(!ObSet_Size(psObPrefetch)) { goto fail; }
+    if(!(pJobs = LocalAlloc(0, ObSet_Size(psObPrefetch) * sizeof(VMMHEAPALLOC_SEGMENT_JOB)))) { goto fail; }
+    VmmCachePrefetchPages3(H, ctx->pProcess, psObPrefetch, sizeof(pbSegmentHdr), 0);
     for(i = 0; i < ctx->pHeapMap->cSegments; i++) {
         peSegment = ctx->pHeapMap->pSegments + i;
         if(peSegment->iHeap == ctx->pHeapEntry->iHeap) {
@@ -820,15 +1117,21 @@ VOID VmmHeapAlloc_NtInit(_In_ VMM_HANDLE H, _In_ PVMMHEAPNT_CTX ctx)
                 // segment size check
                 cbSegment = (DWORD)((vaLastEntry + 0xfff - peSegment->va) & ~0xfff);
                 if(cbSegment > peSegment->cb) { continue; }
-                // read/alloc and dispatch
-                if((pbSegment = LocalAlloc(0, cbSegment))) {
-                    VmmReadEx(H, ctx->pProcess, peSegment->va, pbSegment, cbSegment, NULL, VMM_FLAG_ZEROPAD_ON_FAIL);
-                    VmmHeapAlloc_NtInitSeg(H, ctx, peSegment->va, pbSegment, cbSegment, (DWORD)(vaFirstEntry - peSegment->va));
-                    LocalFree(pbSegment);
+                // add segment job
+                if(cJob < ObSet_Size(psObPrefetch)) {
+                    pJobs[cJob].va = peSegment->va;
+                    pJobs[cJob].cb = cbSegment;
+                    pJobs[cJob].dwParam = (DWORD)(vaFirstEntry - peSegment->va);
+                    cJob++;
                 }
             }
         }
     }
+    // 5: prefetch and process the segments in parallel:
+    VmmHeapAlloc_SegmentWork(H, ctx, cJob, pJobs, VmmHeapAlloc_NtInitSegJob);
+fail:
+    Ob_DECREF(psObPrefetch);
+    LocalFree(pJobs);
 }
 
 
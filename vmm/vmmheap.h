@@ -35,4 +35,14 @@ VOID VmmHeapAlloc_Refresh(_In_ VMM_HANDLE H);
 */
 PVMMOB_MAP_HEAPALLOC VmmHeapAlloc_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_opt_ QWORD vaHeap);
 
+/*
+* Queue a background build of the heap allocation maps of a process. The build
+* is queued at most once per process and refresh and only fills free entries
+* of the heap allocation cache, from where the maps are later retrieved by
+* VmmHeapAlloc_Initialize(). The function does not wait for completion.
+* -- H
+* -- pProcess
+*/
+VOID VmmHeapAlloc_InitializeAll(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess);
+
 #endif /* __VMMHEAP_H__ */
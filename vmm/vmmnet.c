@@ -80,8 +80,17 @@ typedef struct tdVMMNET_CONTEXT {
     VMMNET_OFFSET_IPpa oIPpa;
     QWORD vaTcpPortPool;
     QWORD vaUdpPortPool;
+    DWORD oInPA;
+    POB_MAP pmObCache;              // completed entries of previous refresh by vaObj (PVMMNET_CACHE_ENTRY)
 } VMMNET_CONTEXT, *PVMMNET_CONTEXT;
 
+// net entry as kept in enumeration maps; the hash covers the parsed fields of
+// the underlying kernel object and allows re-use of the entry on refresh.
+typedef struct tdVMMNET_CACHE_ENTRY {
+    VMM_MAP_NETENTRY e;
+    QWORD qwHash;
+} VMMNET_CACHE_ENTRY, *PVMMNET_CACHE_ENTRY;
+
 typedef struct tdVMMNET_ASYNC_CONTEXT {
     PVMMNET_CONTEXT ctx;
     POB_MAP pmNetEntries;
@@ -93,6 +102,60 @@ typedef struct tdVMMNET_ASYNC_CONTEXT {
 #define VMMNET_PARTITIONTABLE_OFFSET18(pbPT, vaPT)      (*(PQWORD)pbPT && !*(PQWORD)(pbPT + 0x28) && ((vaPT + 0x18) == *(PQWORD)(pbPT + 0x18)) && ((vaPT + 0x18) == *(PQWORD)(pbPT + 0x20)))
 #define VMMNET_PARTITIONTABLE_WIN10_1903_ABOVE(pbPT)    (VMM_KADDR64_16(*(PQWORD)(pbPT + 0x00)) && VMM_KADDR64_16(*(PQWORD)(pbPT + 0x08)) && VMM_KADDR64_16(*(PQWORD)(pbPT + 0x10)) && (*(PQWORD)(pbPT + 0x08) - *(PQWORD)(pbPT + 0x00) < 0x200) && (*(PQWORD)(pbPT + 0x10) - *(PQWORD)(pbPT + 0x08) < 0x200))
 
+// ----------------------------------------------------------------------------
+// NET ENTRY REFRESH CACHE FUNCTIONALITY BELOW:
+// Network connection objects are mostly static once set up. Entries from the
+// previous refresh are kept together with a hash of the object fields parsed.
+// If the fields are unchanged on refresh the completed entry is re-used and
+// the dependent pointer chasing (address family, addresses, process) skipped.
+// ----------------------------------------------------------------------------
+
+/*
+* Add a parsed value to a net entry object hash.
+* -- qwHash
+* -- qw
+* -- return
+*/
+QWORD VmmNet_Cache_Hash(_In_ QWORD qwHash, _In_ QWORD qw)
+{
+    return ((qwHash >> 13) | (qwHash << 51)) + qw;
+}
+
+/*
+* Retrieve a copy of a completed net entry from the previous refresh if the
+* object hash is unchanged.
+* CALLER LocalFree: return
+* -- ctx
+* -- vaObj
+* -- qwHash
+* -- return = entry on success, NULL if not cached or changed.
+*/
+PVMM_MAP_NETENTRY VmmNet_Cache_Reuse(_In_ PVMMNET_CONTEXT ctx, _In_ QWORD vaObj, _In_ QWORD qwHash)
+{
+    PVMMNET_CACHE_ENTRY peCache, pe;
+    if(!ctx->pmObCache || !(peCache = ObMap_GetByKey(ctx->pmObCache, vaObj))) { return NULL; }
+    if((peCache->qwHash != qwHash) || !peCache->e.Src.fValid) { return NULL; }
+    if(!(pe = LocalAlloc(0, sizeof(VMMNET_CACHE_ENTRY)))) { return NULL; }
+    memcpy(pe, peCache, sizeof(VMMNET_CACHE_ENTRY));
+    pe->e._Reserved1 = 0;
+    pe->e._Reserved2 = 0;
+    return &pe->e;
+}
+
+/*
+* Push a re-used net entry onto the result map.
+* -- pmNetEntries
+* -- pe
+*/
+VOID VmmNet_Cache_Push(_Inout_ POB_MAP pmNetEntries, _In_ PVMM_MAP_NETENTRY pe)
+{
+    if(!ObMap_Push(pmNetEntries, pe->vaObj, pe)) {
+        LocalFree(pe);
+    }
+}
+
+
+
 // ----------------------------------------------------------------------------
 // TCP ENDPOINT FUNCTIONALITY BELOW:
 // ----------------------------------------------------------------------------
@@ -339,7 +402,7 @@ _Success_(return)
 BOOL VmmNet_TcpE_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET ps_TcpE_TTcb, _Inout_ POB_MAP pm_TcpE_TTcb)
 {
     BOOL f, fResult = FALSE;
-    QWORD va, ftTime, vaEPROCESS;
+    QWORD va, ftTime, vaEPROCESS, qwHash;
     DWORD c = 0, i;
     BYTE pb[0x400] = { 0 };
     PVMM_MAP_NETENTRY pe;
@@ -357,7 +420,16 @@ BOOL VmmNet_TcpE_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVM
         ftTime = *(PQWORD)(pb + po->Time);
         if(ftTime > 0x0200000000000000) { continue; }
         if(!VMM_KADDR64_8(*(PQWORD)(pb + po->EProcess)) || !VMM_KADDR64_8(*(PQWORD)(pb + po->INET_AF)) || !VMM_KADDR64_8(*(PQWORD)(pb + po->INET_Addr))) { continue; }
-        if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_MAP_NETENTRY)))) { continue; }
+        qwHash = VmmNet_Cache_Hash(ftTime, *(PQWORD)(pb + po->EProcess));
+        qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->INET_AF));
+        qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->INET_Addr));
+        qwHash = VmmNet_Cache_Hash(qwHash, ((QWORD)*(PWORD)(pb + po->State) << 32) | ((QWORD)*(PWORD)(pb + po->PortSrc) << 16) | *(PWORD)(pb + po->PortDst));
+        if((pe = VmmNet_Cache_Reuse(ctx, va, qwHash))) {
+            VmmNet_Cache_Push(pm_TcpE_TTcb, pe);
+            continue;
+        }
+        if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMNET_CACHE_ENTRY)))) { continue; }
+        ((PVMMNET_CACHE_ENTRY)pe)->qwHash = qwHash;
         pe->dwPoolTag = 'TcpE';
         pe->Dst.port = _byteswap_ushort(*(PWORD)(pb + po->PortDst));
         pe->Src.port = _byteswap_ushort(*(PWORD)(pb + po->PortSrc));
@@ -382,6 +454,7 @@ BOOL VmmNet_TcpE_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVM
     if(!(pObPrefetch = ObSet_New(H))) { goto fail; }
     for(i = 0, c = ObMap_Size(pm_TcpE_TTcb); i < c; i++) {
         pe = ObMap_GetByIndex(pm_TcpE_TTcb, i);
+        if(!pe->_Reserved1) { continue; }   // re-used or already processed entry
         vaINET_AF = pe->_Reserved1;
         vaINET_Addr = pe->_Reserved2;
         pe->_Reserved1 = 0;
@@ -413,6 +486,7 @@ BOOL VmmNet_TcpE_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVM
     VmmCachePrefetchPages3(H, pSystemProcess, pObPrefetch, 0x18, 0);
     for(i = 0, c = ObMap_Size(pm_TcpE_TTcb); i < c; i++) {
         pe = ObMap_GetByIndex(pm_TcpE_TTcb, i);
+        if(!pe->_Reserved1) { continue; }
         vaINET_Src = pe->_Reserved1;
         vaINET_Dst = pe->_Reserved2;
         pe->_Reserved1 = 0;
@@ -446,7 +520,7 @@ _Success_(return)
 BOOL VmmNet_TcpTW_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_SET pSet_TcpTW, _Inout_ POB_MAP pmTcpE)
 {
     BOOL f;
-    QWORD va;
+    QWORD va, qwHash;
     DWORD c = 0, i;
     BYTE pb[0x400] = { 0 };
     PVMM_MAP_NETENTRY pe;
@@ -462,7 +536,17 @@ BOOL VmmNet_TcpTW_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PV
         if(!VMM_KADDR64_8(*(PQWORD)(pb + po->INET_AF)) || !VMM_KADDR64_8(*(PQWORD)(pb + po->INET_Addr))) {
             continue;
         }
-        if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_MAP_NETENTRY)))) { continue; }
+        qwHash = VmmNet_Cache_Hash(*(PQWORD)(pb + po->Time), *(PQWORD)(pb + po->INET_AF));
+        qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->INET_Addr));
+        qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->AddrDst));
+        qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->AddrDst + 8));
+        qwHash = VmmNet_Cache_Hash(qwHash, ((QWORD)*(PWORD)(pb + po->PortSrc) << 16) | *(PWORD)(pb + po->PortDst));
+        if((pe = VmmNet_Cache_Reuse(ctx, va, qwHash))) {
+            VmmNet_Cache_Push(pmTcpE, pe);
+            continue;
+        }
+        if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMNET_CACHE_ENTRY)))) { continue; }
+        ((PVMMNET_CACHE_ENTRY)pe)->qwHash = qwHash;
         pe->dwPoolTag = 'TcTW';
         pe->Dst.fValid = TRUE;
         memcpy(pe->Dst.pbAddr, pb + po->AddrDst, 16);
@@ -483,6 +567,7 @@ BOOL VmmNet_TcpTW_Enumerate(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PV
     if(!(pObPrefetch = ObSet_New(H))) { goto fail; }
     for(i = 0, c = ObMap_Size(pmTcpE); i < c; i++) {
         pe = ObMap_GetByIndex(pmTcpE, i);
+        if(!pe->_Reserved1) { continue; }   // re-used or already processed entry
         vaINET_AF = pe->_Reserved1;
         vaINET_Addr = pe->_Reserved2;
         pe->_Reserved1 = 0;
@@ -694,12 +779,13 @@ PVMM_MAP_NETENTRY VmmNet_InPP_TcpE(_In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS p
 }
 
 /*
-* Enumerate PortPool UdpA / TcpL entries.
+* Enumerate PortPool UdpA / TcpL entries. Unchanged entries from the previous
+* refresh are pushed directly onto the completed map pmNetEntries.
 */
-PVMM_MAP_NETENTRY VmmNet_InPP_TcpL_UdpA(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ DWORD dwPoolTag, PVMMNET_OFFSET_TcpL_UdpA po, _In_ QWORD vaTcpL_UdpA, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Inout_ POB_SET psEP_Next)
+PVMM_MAP_NETENTRY VmmNet_InPP_TcpL_UdpA(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ DWORD dwPoolTag, PVMMNET_OFFSET_TcpL_UdpA po, _In_ QWORD vaTcpL_UdpA, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _Inout_ POB_SET psEP_Next, _Inout_ POB_MAP pmNetEntries)
 {
     DWORD c = 0;
-    QWORD ftTime, vaNext, vaEPROCESS, vaIPpa;
+    QWORD ftTime, vaNext, vaEPROCESS, vaIPpa, qwHash;
     PVMM_MAP_NETENTRY pe;
     PVMM_PROCESS pObProcess = NULL;
     vaNext = *(PQWORD)(pb + po->FLink);
@@ -707,7 +793,18 @@ PVMM_MAP_NETENTRY VmmNet_InPP_TcpL_UdpA(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT
         ObSet_Push(psEP_Next, (vaNext & ~7) - VMMNET_EP_OFFSET);
     }
     if(!VMM_KADDR64_8(*(PQWORD)(pb + po->INET_AF))) { return NULL; }
-    if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMM_MAP_NETENTRY)))) { return NULL; }
+    qwHash = VmmNet_Cache_Hash(dwPoolTag, *(PQWORD)(pb + po->INET_AF));
+    qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->SrcAddr));
+    qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->EProcess));
+    qwHash = VmmNet_Cache_Hash(qwHash, *(PQWORD)(pb + po->Time));
+    qwHash = VmmNet_Cache_Hash(qwHash, po->DstAddr ? *(PQWORD)(pb + po->DstAddr) : 0);
+    qwHash = VmmNet_Cache_Hash(qwHash, ((QWORD)*(PWORD)(pb + po->SrcPort) << 16) | (po->DstPort ? *(PWORD)(pb + po->DstPort) : 0));
+    if((pe = VmmNet_Cache_Reuse(ctx, vaTcpL_UdpA, qwHash))) {
+        VmmNet_Cache_Push(pmNetEntries, pe);
+        return NULL;
+    }
+    if(!(pe = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMNET_CACHE_ENTRY)))) { return NULL; }
+    ((PVMMNET_CACHE_ENTRY)pe)->qwHash = qwHash;
     pe->dwPoolTag = dwPoolTag;
     pe->dwState = (dwPoolTag == 'TcpL') ? 1 : 13;
     pe->Src.port = _byteswap_ushort(*(PWORD)(pb + po->SrcPort));
@@ -742,22 +839,22 @@ PVMM_MAP_NETENTRY VmmNet_InPP_TcpL_UdpA(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT
 /*
 * Dispatch a PortPool entry to its enumeration function.
 */
-VOID VmmNet_InPP_Dispatch(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ DWORD tag, _In_ QWORD va, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD oFLink, _Inout_ POB_SET psEP_Next, _Inout_ POB_MAP pmNetEntriesPre)
+VOID VmmNet_InPP_Dispatch(_In_ VMM_HANDLE H, _In_ PVMMNET_CONTEXT ctx, _In_ PVMM_PROCESS pSystemProcess, _In_ DWORD tag, _In_ QWORD va, _In_reads_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD oFLink, _Inout_ POB_SET psEP_Next, _Inout_ POB_MAP pmNetEntriesPre, _Inout_ POB_MAP pmNetEntries)
 {
     PVMM_MAP_NETENTRY pe;
     PVMMNET_OFFSET_TcpL_UdpA po = &ctx->oTcpL;
-    if(ObMap_ExistsKey(pmNetEntriesPre, va)) { return; }
+    if(ObMap_ExistsKey(pmNetEntriesPre, va) || ObMap_ExistsKey(pmNetEntries, va)) { return; }
     if(tag == 'TcpE') {
         // TODO: IMPLEMENT SUPPORT FOR InPP-TcpE
         VmmNet_InPP_TcpE(ctx, pSystemProcess, va, pb, cb, psEP_Next);
     }
     if(tag == 'TcpL') {
-        if((pe = VmmNet_InPP_TcpL_UdpA(H, ctx, pSystemProcess, 'TcpL', &ctx->oTcpL, va, pb, cb, psEP_Next))) {
+        if((pe = VmmNet_InPP_TcpL_UdpA(H, ctx, pSystemProcess, 'TcpL', &ctx->oTcpL, va, pb, cb, psEP_Next, pmNetEntries))) {
             ObMap_Push(pmNetEntriesPre, va, pe);
         }
     }
     if(tag == 'UdpA') {
-        if((pe = VmmNet_InPP_TcpL_UdpA(H, ctx, pSystemProcess, 'UdpA', &ctx->oUdpA, va, pb, cb, psEP_Next))) {
+        if((pe = VmmNet_InPP_TcpL_UdpA(H, ctx, pSystemProcess, 'UdpA', &ctx->oUdpA, va, pb, cb, psEP_Next, pmNetEntries))) {
             ObMap_Push(pmNetEntriesPre, va, pe);
         }
     }
@@ -775,7 +872,7 @@ DWORD VmmNet_InPP_DoWork(_In_ VMM_HANDLE H, PVOID lpThreadParameter)
     PVMMNET_CONTEXT ctx = actx->ctx;
     PVMM_PROCESS pSystemProcess = actx->pSystemProcess;
     POB_MAP pmNetEntries = actx->pmNetEntries;
-    DWORD cbInPPe, oInPPe, oInPA = 0, o, oFLink, tag, iEntry;
+    DWORD cbInPPe, oInPPe, oInPA = ctx->oInPA, o, oFLink, tag, iEntry;
     QWORD i, j, va;
     BYTE pb[0x2000], pb2[0x20];
     POB_SET psObPA = NULL, psObPreEP = NULL, psObEP = NULL, psObEP_Next = NULL, psObEP_SWAP;
@@ -811,6 +908,7 @@ DWORD VmmNet_InPP_DoWork(_In_ VMM_HANDLE H, PVOID lpThreadParameter)
                 }
             }
             if(!oInPA) { goto fail; }
+            ctx->oInPA = oInPA;
         }
         for(j = 0; j < 256; j++) {
             va = *(PQWORD)(pb + oInPA + j * 8);
@@ -872,7 +970,7 @@ DWORD VmmNet_InPP_DoWork(_In_ VMM_HANDLE H, PVOID lpThreadParameter)
                 if(VMM_POOLTAG_PREPENDED(f32, pb, o, 'TcpE')) { tag = 'TcpE'; }
                 if(VMM_POOLTAG_PREPENDED(f32, pb, o, 'UdpA')) { tag = 'UdpA'; }
                 if(tag) {
-                    VmmNet_InPP_Dispatch(H, ctx, pSystemProcess, tag, va + o, pb + o, VMMNET_EP_SIZE - 8 - o, oFLink - o, psObEP_Next, pmObNetEntriesPre);
+                    VmmNet_InPP_Dispatch(H, ctx, pSystemProcess, tag, va + o, pb + o, VMMNET_EP_SIZE - 8 - o, oFLink - o, psObEP_Next, pmObNetEntriesPre, pmNetEntries);
                     break;
                 }
             }
@@ -1168,6 +1266,9 @@ PVMMOB_MAP_NET VmmNet_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSy
     }
     ObStrMap_FinalizeAllocU_DECREF_NULL(&psmOb, &pObNet->pbMultiText, &pObNet->cbMultiText);
     qsort(pObNet->pMap, pObNet->cMap, sizeof(VMM_MAP_NETENTRY), (int(*)(void const*, void const*))VmmNet_TcpE_CmpSort);
+    // keep completed entries for re-use on next refresh:
+    Ob_DECREF(ctx->pmObCache);
+    ctx->pmObCache = (POB_MAP)Ob_INCREF(pmObNetEntries);
     Ob_INCREF(pObNet);
 fail:
     Ob_DECREF(actx.pPoolMap);
@@ -1213,13 +1314,17 @@ PVMMOB_MAP_NET VmmNet_Initialize(_In_ VMM_HANDLE H)
 VOID VmmNet_Close(_In_ VMM_HANDLE H)
 {
     EnterCriticalSection(&H->vmm.LockMaster);
+    if(H->vmm.pNetContext) {
+        Ob_DECREF(((PVMMNET_CONTEXT)H->vmm.pNetContext)->pmObCache);
+    }
     LocalFree(H->vmm.pNetContext);
     H->vmm.pNetContext = NULL;
     LeaveCriticalSection(&H->vmm.LockMaster);
 }
 
 /*
-* Refresh the network connection map.
+* Refresh the network connection map. The network context (offsets and the
+* entry cache) is kept and allows for an incremental rebuild on next access.
 * -- H
 */
 VOID VmmNet_Refresh(_In_ VMM_HANDLE H)
@@ -149,6 +149,7 @@ BOOL VmmProcRefresh_Fast(_In_ VMM_HANDLE H)
         VmmLog(H, MID_CORE, LOGLEVEL_CRITICAL, "Failed to refresh MemProcFS - aborting!");
         return FALSE;
     }
+    ObCacheMap_Clear(H->vmm.pObCacheMapVfsText);
     PluginManager_Notify(H, VMMDLL_PLUGIN_NOTIFY_REFRESH_FAST, NULL, 0);
     LeaveCriticalSection(&H->vmm.LockMaster);
     return TRUE;
@@ -168,6 +169,8 @@ BOOL VmmProcRefresh_Medium(_In_ VMM_HANDLE H)
     VmmWinObj_Refresh(H);
     MmPfn_Refresh(H);
     VmmHeapAlloc_Refresh(H);
+    ObSet_Clear(H->vmm.psObEATIATInitAllPID);
+    ObCacheMap_Clear(H->vmm.pObCacheMapVfsText);
     PluginManager_Notify(H, VMMDLL_PLUGIN_NOTIFY_REFRESH_MEDIUM, NULL, 0);
     LeaveCriticalSection(&H->vmm.LockMaster);
     return TRUE;
@@ -49,11 +49,159 @@ int VmmWin_HashTableLookup_CmpSort(PDWORD pdw1, PDWORD pdw2)
     return (*pdw1 < *pdw2) ? -1 : ((*pdw1 > *pdw2) ? 1 : 0);
 }
 
+// ----------------------------------------------------------------------------
+// WINDOWS SPECIFIC PROCESS RELATED FUNCTIONALITY BELOW:
+//    CONTENT ADDRESSED PE METADATA CACHE
+// ----------------------------------------------------------------------------
+
+#define VMMWINPEMETA_TP_DEBUGINFO       1
+#define VMMWINPEMETA_TP_VERSIONINFO     2
+
+typedef struct tdOB_VMMWIN_PEMETA {
+    OB ObHdr;
+    VMM_MAP_MODULEENTRY_DEBUGINFO DebugInfo;
+    VMM_MAP_MODULEENTRY_VERSIONINFO VersionInfo;
+    PBYTE pbMultiText;
+    DWORD cbMultiText;
+} OB_VMMWIN_PEMETA, *POB_VMMWIN_PEMETA;
+
+VOID VmmWinPeMeta_CleanupCB(_In_ POB_VMMWIN_PEMETA pOb)
+{
+    LocalFree(pOb->pbMultiText);
+}
+
+/*
+* Retrieve the content key of a loaded module image. The key is derived from
+* the module name, TimeDateStamp and SizeOfImage which are identical for all
+* mappings of the same image (such as ntdll.dll) in different processes.
+* -- H
+* -- pProcess
+* -- pModule
+* -- tp = VMMWINPEMETA_TP_*
+* -- pqwKey
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinPeMeta_GetKey(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule, _In_ DWORD tp, _Out_ PQWORD pqwKey)
+{
+    BYTE pbModuleHeader[0x1000];
+    BOOL fHdr32;
+    DWORD dwTimeDateStamp, cbSizeOfImage;
+    PIMAGE_NT_HEADERS64 ntHeader64;
+    if(!H->vmm.pObCacheMapPeMeta || !pModule->uszText) { return FALSE; }
+    if(!(ntHeader64 = (PIMAGE_NT_HEADERS64)VmmWin_GetVerifyHeaderPE(H, pProcess, pModule->vaBase, pbModuleHeader, &fHdr32))) { return FALSE; }
+    dwTimeDateStamp = ntHeader64->FileHeader.TimeDateStamp;
+    cbSizeOfImage = fHdr32 ? ((PIMAGE_NT_HEADERS32)ntHeader64)->OptionalHeader.SizeOfImage : ntHeader64->OptionalHeader.SizeOfImage;
+    if(!dwTimeDateStamp || !cbSizeOfImage) { return FALSE; }
+    *pqwKey = (CharUtil_Hash64U(pModule->uszText, TRUE) ^ (((QWORD)dwTimeDateStamp << 32) | cbSizeOfImage)) + tp;
+    return TRUE;
+}
+
+/*
+* Retrieve the debug info (CodeView PDB info) of a module. The result is taken
+* from the content addressed cache if the same image was already parsed in any
+* process; otherwise it's parsed and, on success, put into the cache.
+* CALLER DECREF: return
+* -- H
+* -- pProcess
+* -- pModule
+* -- return
+*/
+_Success_(return != NULL)
+POB_VMMWIN_PEMETA VmmWinPeMeta_GetDebugInfo(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule)
+{
+    static const LPCSTR szHEX_ALPHABET = "0123456789ABCDEF";
+    BOOL fKey, fValid;
+    BYTE b;
+    DWORD j, k;
+    QWORD qwKey = 0;
+    CHAR szGUID[33] = { 0 };
+    PE_CODEVIEW_INFO CodeViewInfo;
+    POB_STRMAP psmOb = NULL;
+    POB_VMMWIN_PEMETA pObMeta = NULL;
+    fKey = VmmWinPeMeta_GetKey(H, pProcess, pModule, VMMWINPEMETA_TP_DEBUGINFO, &qwKey);
+    if(fKey && (pObMeta = ObCacheMap_GetByKey(H->vmm.pObCacheMapPeMeta, qwKey))) { return pObMeta; }
+    if(!(psmOb = ObStrMap_New(H, OB_STRMAP_FLAGS_CASE_SENSITIVE))) { goto fail; }
+    if(!(pObMeta = Ob_AllocEx(H, OB_TAG_MAP_PEMETA, LMEM_ZEROINIT, sizeof(OB_VMMWIN_PEMETA), (OB_CLEANUP_CB)VmmWinPeMeta_CleanupCB, NULL))) { goto fail; }
+    if((fValid = PE_GetCodeViewInfo(H, pProcess, pModule->vaBase, NULL, &CodeViewInfo))) {
+        // guid -> hex
+        for(k = 0, j = 0; k < 16; k++) {
+            b = CodeViewInfo.CodeView.Guid[k];
+            szGUID[j++] = szHEX_ALPHABET[b >> 4];
+            szGUID[j++] = szHEX_ALPHABET[b & 7];
+        }
+        pObMeta->DebugInfo.dwAge = CodeViewInfo.CodeView.Age;
+        memcpy(pObMeta->DebugInfo.Guid, CodeViewInfo.CodeView.Guid, sizeof(pObMeta->DebugInfo.Guid));
+        ObStrMap_PushPtrAU(psmOb, szGUID, &pObMeta->DebugInfo.uszGuid, NULL);
+        ObStrMap_PushPtrUU(psmOb, CodeViewInfo.CodeView.PdbFileName, &pObMeta->DebugInfo.uszPdbFilename, NULL);
+    }
+    ObStrMap_FinalizeAllocU_DECREF_NULL(&psmOb, &pObMeta->pbMultiText, &pObMeta->cbMultiText);
+    if(!pObMeta->DebugInfo.uszGuid)        { pObMeta->DebugInfo.uszGuid = "";         }
+    if(!pObMeta->DebugInfo.uszPdbFilename) { pObMeta->DebugInfo.uszPdbFilename = "";  }
+    if(fKey && fValid) {
+        ObCacheMap_Push(H->vmm.pObCacheMapPeMeta, qwKey, pObMeta, 0);
+    }
+fail:
+    Ob_DECREF(psmOb);
+    return pObMeta;
+}
+
+/*
+* Retrieve the version info (VS_VERSIONINFO) of a module. The result is taken
+* from the content addressed cache if the same image was already parsed in any
+* process; otherwise it's parsed and, on success, put into the cache.
+* CALLER DECREF: return
+* -- H
+* -- pProcess
+* -- pModule
+* -- return
+*/
+_Success_(return != NULL)
+POB_VMMWIN_PEMETA VmmWinPeMeta_GetVersionInfo(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule)
+{
+    BOOL fKey, fValid;
+    QWORD qwKey = 0;
+    POB_STRMAP psmOb = NULL;
+    POB_VMMWIN_PEMETA pObMeta = NULL;
+    PVMM_MAP_MODULEENTRY_VERSIONINFO pVI;
+    fKey = VmmWinPeMeta_GetKey(H, pProcess, pModule, VMMWINPEMETA_TP_VERSIONINFO, &qwKey);
+    if(fKey && (pObMeta = ObCacheMap_GetByKey(H->vmm.pObCacheMapPeMeta, qwKey))) { return pObMeta; }
+    if(!(psmOb = ObStrMap_New(H, OB_STRMAP_FLAGS_CASE_SENSITIVE))) { goto fail; }
+    if(!(pObMeta = Ob_AllocEx(H, OB_TAG_MAP_PEMETA, LMEM_ZEROINIT, sizeof(OB_VMMWIN_PEMETA), (OB_CLEANUP_CB)VmmWinPeMeta_CleanupCB, NULL))) { goto fail; }
+    pVI = &pObMeta->VersionInfo;
+    fValid = PE_VsGetVersionInfo(H, pProcess, pModule->vaBase, psmOb, pVI);
+    ObStrMap_FinalizeAllocU_DECREF_NULL(&psmOb, &pObMeta->pbMultiText, &pObMeta->cbMultiText);
+    if(!pVI->uszCompanyName)       { pVI->uszCompanyName = "";      }
+    if(!pVI->uszFileDescription)   { pVI->uszFileDescription = "";  }
+    if(!pVI->uszFileVersion)       { pVI->uszFileVersion = "";      }
+    if(!pVI->uszInternalName)      { pVI->uszInternalName = "";     }
+    if(!pVI->uszLegalCopyright)    { pVI->uszLegalCopyright = "";   }
+    if(!pVI->uszOriginalFilename)  { pVI->uszOriginalFilename = ""; }
+    if(!pVI->uszProductName)       { pVI->uszProductName = "";      }
+    if(!pVI->uszProductVersion)    { pVI->uszProductVersion = "";   }
+    if(fKey && fValid) {
+        ObCacheMap_Push(H->vmm.pObCacheMapPeMeta, qwKey, pObMeta, 0);
+    }
+fail:
+    Ob_DECREF(psmOb);
+    return pObMeta;
+}
+
+
+
 // ----------------------------------------------------------------------------
 // WINDOWS SPECIFIC PROCESS RELATED FUNCTIONALITY BELOW:
 //    IMPORT/EXPORT DIRECTORY PARSING
 // ----------------------------------------------------------------------------
 
+// NB! cache map size should be >= VMMPROCWINDOWS_MAX_MODULES so that the batched
+// initialization of one process never evicts its own freshly built maps. The
+// cache map is shared between processes - older entries of other processes may
+// still be evicted and will in that case be re-created on demand.
+#define VMMWINEATIAT_CACHEMAP_MAX               0x200
+#define VMMWINEATIAT_PREFETCH_MAX_PAGES         0x1000
+#define VMMWINEATIAT_CACHEMAP_KEY(pProcess, va) ((pProcess)->dwPID ^ ((QWORD)(pProcess)->dwPID << 48) ^ (va))
+
 /*
 * Callback function for cache map entry validity - an entry is valid
 * if it's in the same medium refresh tickcount.
@@ -69,44 +217,193 @@ VOID VmmWinEAT_ObCloseCallback(_In_ PVMMOB_MAP_EAT pObEAT)
 }
 
 /*
-* Helper function for EAT initialization.
-* CALLER DECREF: return
+* The export directory of a module may optionally be saved to an on-disk EAT
+* index (-eat-index) and re-used by later runs over the same memory dump file.
+* Index files are tied to the device, the process (PID and DTB) and the module
+* base address; the export directory is verified against its stored sha256.
+* Index files are not used for volatile memory.
+*/
+#define VMMWINEAT_INDEX_MAGIC           0x58444945          // 'EIDX'
+#define VMMWINEAT_INDEX_VERSION         1
+
+typedef struct tdVMMWINEAT_INDEX_HDR {
+    DWORD dwMagic;
+    DWORD dwVersion;
+    QWORD qwIdentity;
+    QWORD paDTB;
+    QWORD vaModuleBase;
+    DWORD oExpDir;
+    DWORD cbExpDir;
+    BYTE pbHash[32];            // sha256 of the export directory following the header
+} VMMWINEAT_INDEX_HDR, *PVMMWINEAT_INDEX_HDR;
+
+/*
+* Retrieve the EAT index file path and identity of a module.
 * -- H
 * -- pProcess
 * -- pModule
+* -- uszPath
+* -- pqwIdentity
 * -- return
 */
-PVMMOB_MAP_EAT VmmWinEAT_Initialize_DoWork(_In_ VMM_HANDLE H,  _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule)
+_Success_(return)
+BOOL VmmWinEAT_Index_GetPath(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule, _Out_writes_(MAX_PATH) LPSTR uszPath, _Out_ PQWORD pqwIdentity)
+{
+    SIZE_T cch;
+    QWORD qwIdentity;
+    if(!H->cfg.szEatIndexPath[0] || H->dev.fVolatile) { return FALSE; }
+    qwIdentity = CharUtil_Hash64U(H->dev.szDevice, FALSE);
+    qwIdentity = ((qwIdentity >> 13) | (qwIdentity << 51)) + H->dev.paMax;
+    *pqwIdentity = qwIdentity;
+    cch = strlen(H->cfg.szEatIndexPath);
+    return _snprintf_s(uszPath, MAX_PATH, _TRUNCATE, "%s%svmm-eatindex-%016llx-%x-%016llx.bin",
+        H->cfg.szEatIndexPath,
+        ((H->cfg.szEatIndexPath[cch - 1] == '\\') || (H->cfg.szEatIndexPath[cch - 1] == '/')) ? "" : "/",
+        qwIdentity,
+        pProcess->dwPID,
+        pModule->vaBase
+    ) > 0;
+}
+
+/*
+* Read the export directory of a module from its EAT index file (if any).
+* -- H
+* -- pProcess
+* -- pModule
+* -- oExpDir
+* -- cbExpDir
+* -- pbExpDir
+* -- pbHash = sha256 of the export directory.
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinEAT_Index_Read(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule, _In_ DWORD oExpDir, _In_ DWORD cbExpDir, _Out_writes_(cbExpDir) PBYTE pbExpDir, _Out_writes_(32) PBYTE pbHash)
+{
+    BOOL f;
+    FILE *hFile = NULL;
+    QWORD qwIdentity;
+    CHAR uszPath[MAX_PATH];
+    VMMWINEAT_INDEX_HDR hdr = { 0 };
+    if(!VmmWinEAT_Index_GetPath(H, pProcess, pModule, uszPath, &qwIdentity)) { return FALSE; }
+    if(fopen_s(&hFile, uszPath, "rb") || !hFile) { return FALSE; }
+    f = (fread(&hdr, 1, sizeof(VMMWINEAT_INDEX_HDR), hFile) == sizeof(VMMWINEAT_INDEX_HDR)) &&
+        (hdr.dwMagic == VMMWINEAT_INDEX_MAGIC) && (hdr.dwVersion == VMMWINEAT_INDEX_VERSION) &&
+        (hdr.qwIdentity == qwIdentity) && (hdr.paDTB == pProcess->paDTB) && (hdr.vaModuleBase == pModule->vaBase) &&
+        (hdr.oExpDir == oExpDir) && (hdr.cbExpDir == cbExpDir) &&
+        (fread(pbExpDir, 1, cbExpDir, hFile) == cbExpDir) &&
+        Util_HashSHA256(pbExpDir, cbExpDir, pbHash) &&
+        !memcmp(pbHash, hdr.pbHash, 32);
+    fclose(hFile);
+    return f;
+}
+
+/*
+* Save the export directory of a module to its EAT index file (if configured).
+* -- H
+* -- pProcess
+* -- pModule
+* -- oExpDir
+* -- cbExpDir
+* -- pbExpDir
+* -- pbHash = sha256 of the export directory.
+*/
+VOID VmmWinEAT_Index_Save(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule, _In_ DWORD oExpDir, _In_ DWORD cbExpDir, _In_reads_(cbExpDir) PBYTE pbExpDir, _In_reads_(32) PBYTE pbHash)
+{
+    BOOL f;
+    FILE *hFile = NULL;
+    CHAR uszPath[MAX_PATH];
+    VMMWINEAT_INDEX_HDR hdr = { 0 };
+    if(!VmmWinEAT_Index_GetPath(H, pProcess, pModule, uszPath, &hdr.qwIdentity)) { return; }
+    hdr.dwMagic = VMMWINEAT_INDEX_MAGIC;
+    hdr.dwVersion = VMMWINEAT_INDEX_VERSION;
+    hdr.paDTB = pProcess->paDTB;
+    hdr.vaModuleBase = pModule->vaBase;
+    hdr.oExpDir = oExpDir;
+    hdr.cbExpDir = cbExpDir;
+    memcpy(hdr.pbHash, pbHash, 32);
+    if(fopen_s(&hFile, uszPath, "wb") || !hFile) {
+        VmmLog(H, MID_PROCESS, LOGLEVEL_6_TRACE, "EAT INDEX SAVE FAIL: unable to create file '%s'", uszPath);
+        return;
+    }
+    f = (fwrite(&hdr, 1, sizeof(VMMWINEAT_INDEX_HDR), hFile) == sizeof(VMMWINEAT_INDEX_HDR)) &&
+        (fwrite(pbExpDir, 1, cbExpDir, hFile) == cbExpDir);
+    fclose(hFile);
+    if(!f) {
+        remove(uszPath);
+        VmmLog(H, MID_PROCESS, LOGLEVEL_6_TRACE, "EAT INDEX SAVE FAIL: unable to write file '%s'", uszPath);
+    }
+}
+
+/*
+* Read the export directory of a module - from the EAT index file if one is
+* configured and valid, otherwise from memory. The sha256 of the export
+* directory is returned as well; it's the content key of shared EAT maps.
+* CALLER LocalFree: return
+* -- H
+* -- pProcess
+* -- pModule
+* -- poExpDir
+* -- pcbExpDir
+* -- pbHash
+* -- return = export directory buffer of *pcbExpDir + 1 bytes (null terminated).
+*/
+_Success_(return != NULL)
+PBYTE VmmWinEAT_ReadExportDirectory(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule, _Out_ PDWORD poExpDir, _Out_ PDWORD pcbExpDir, _Out_writes_(32) PBYTE pbHash)
 {
     BYTE pbModuleHeader[0x1000] = { 0 };
     PIMAGE_NT_HEADERS64 ntHeader64;
     PIMAGE_NT_HEADERS32 ntHeader32;
-    QWORD vaExpDir, vaExpDirTop, vaAddressOfNames, vaAddressOfNameOrdinals, vaAddressOfFunctions;
-    DWORD i, oExpDir, cbExpDir, cForwardedFunctions = 0;
-    PWORD pwNameOrdinals;
-    PDWORD pdwRvaNames, pdwRvaFunctions;
+    DWORD oExpDir, cbExpDir;
     PBYTE pbExpDir = NULL;
-    PIMAGE_EXPORT_DIRECTORY pExpDir;
     BOOL fHdr32;
-    POB_STRMAP pObStrMap = NULL;
-    PVMMOB_MAP_EAT pObEAT = NULL;
-    PVMM_MAP_EATENTRY pe;
     // load both 32/64 bit ntHeader (only one will be valid)
     if(!(ntHeader64 = (PIMAGE_NT_HEADERS64)VmmWin_GetVerifyHeaderPE(H, pProcess, pModule->vaBase, pbModuleHeader, &fHdr32))) { goto fail; }
     ntHeader32 = (PIMAGE_NT_HEADERS32)ntHeader64;
-    // load Export Address Table (EAT)
     oExpDir = fHdr32 ?
         ntHeader32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress :
         ntHeader64->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress;
     cbExpDir = fHdr32 ?
         ntHeader32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].Size :
         ntHeader64->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].Size;
-    vaExpDir = pModule->vaBase + oExpDir;
-    vaExpDirTop = vaExpDir + cbExpDir - 1;
     if(!oExpDir || !cbExpDir || cbExpDir > 0x01000000) { goto fail; }
     if(!(pbExpDir = LocalAlloc(0, cbExpDir + 1ULL))) { goto fail; }
-    if(!VmmRead(H, pProcess, vaExpDir, pbExpDir, cbExpDir)) { goto fail; }
+    if(!VmmWinEAT_Index_Read(H, pProcess, pModule, oExpDir, cbExpDir, pbExpDir, pbHash)) {
+        if(!VmmRead(H, pProcess, pModule->vaBase + oExpDir, pbExpDir, cbExpDir)) { goto fail; }
+        if(!Util_HashSHA256(pbExpDir, cbExpDir, pbHash)) { goto fail; }
+        VmmWinEAT_Index_Save(H, pProcess, pModule, oExpDir, cbExpDir, pbExpDir, pbHash);
+    }
     pbExpDir[cbExpDir] = 0;
+    *poExpDir = oExpDir;
+    *pcbExpDir = cbExpDir;
+    return pbExpDir;
+fail:
+    LocalFree(pbExpDir);
+    return NULL;
+}
+
+/*
+* Helper function for EAT initialization. Build the EAT map of a module from
+* its export directory.
+* CALLER DECREF: return
+* -- H
+* -- pModule
+* -- oExpDir
+* -- cbExpDir
+* -- pbExpDir = export directory (cbExpDir + 1 bytes, null terminated).
+* -- return
+*/
+PVMMOB_MAP_EAT VmmWinEAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_MAP_MODULEENTRY pModule, _In_ DWORD oExpDir, _In_ DWORD cbExpDir, _In_reads_(cbExpDir + 1) PBYTE pbExpDir)
+{
+    QWORD vaExpDir, vaExpDirTop, vaAddressOfNames, vaAddressOfNameOrdinals, vaAddressOfFunctions;
+    DWORD i, cForwardedFunctions = 0;
+    PWORD pwNameOrdinals;
+    PDWORD pdwRvaNames, pdwRvaFunctions;
+    PIMAGE_EXPORT_DIRECTORY pExpDir;
+    POB_STRMAP pObStrMap = NULL;
+    PVMMOB_MAP_EAT pObEAT = NULL;
+    PVMM_MAP_EATENTRY pe;
+    vaExpDir = pModule->vaBase + oExpDir;
+    vaExpDirTop = vaExpDir + cbExpDir - 1;
     // sanity check EAT
     pExpDir = (PIMAGE_EXPORT_DIRECTORY)pbExpDir;
     if(!pExpDir->NumberOfFunctions || (pExpDir->NumberOfFunctions > 0xffff)) { goto fail; }
@@ -168,11 +465,9 @@ PVMMOB_MAP_EAT VmmWinEAT_Initialize_DoWork(_In_ VMM_HANDLE H,  _In_ PVMM_PROCESS
     }
     // sort hashtable, cleanup, return
     qsort(pObEAT->pHashTableLookup, pObEAT->cMap, sizeof(QWORD), (int(*)(const void *, const void *))VmmWin_HashTableLookup_CmpSort);
-    LocalFree(pbExpDir);
     return pObEAT;
 fail:
     Ob_DECREF(pObStrMap);
-    LocalFree(pbExpDir);
     return Ob_AllocEx(H, OB_TAG_MAP_EAT, LMEM_ZEROINIT, sizeof(VMMOB_MAP_EAT), NULL, NULL);
 }
 
@@ -188,16 +483,37 @@ _Success_(return != NULL)
 PVMMOB_MAP_EAT VmmWinEAT_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule)
 {
     BOOL f;
+    BYTE pbHash[32];
+    DWORD oExpDir, cbExpDir;
+    PBYTE pbExpDir = NULL;
     PVMMOB_MAP_EAT pObMap = NULL;
-    QWORD qwKey = (pProcess->dwPID ^ ((QWORD)pProcess->dwPID << 48) ^ pModule->vaBase);
+    QWORD qwKeyShared, qwKey = VMMWINEATIAT_CACHEMAP_KEY(pProcess, pModule->vaBase);
     f = H->vmm.pObCacheMapEAT ||
-        (H->vmm.pObCacheMapEAT = ObCacheMap_New(H, 0x20, VmmWinEATIAT_Callback_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB));
+        (H->vmm.pObCacheMapEAT = ObCacheMap_New(H, VMMWINEATIAT_CACHEMAP_MAX, VmmWinEATIAT_Callback_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB));
     if(!f) { return NULL; }
     if((pObMap = ObCacheMap_GetByKey(H->vmm.pObCacheMapEAT, qwKey))) { return pObMap; }
     EnterCriticalSection(&pProcess->LockUpdate);
     pObMap = ObCacheMap_GetByKey(H->vmm.pObCacheMapEAT, qwKey);
-    if(!pObMap && (pObMap = VmmWinEAT_Initialize_DoWork(H, pProcess, pModule))) {
-        ObCacheMap_Push(H->vmm.pObCacheMapEAT, qwKey, pObMap, H->vmm.tcRefreshMedium);
+    if(!pObMap) {
+        // identical export directory at the same base address in another
+        // process -> identical EAT. The shared map is keyed on the contents of
+        // the export directory so that an EAT patched in one process is never
+        // served to another process.
+        if((pbExpDir = VmmWinEAT_ReadExportDirectory(H, pProcess, pModule, &oExpDir, &cbExpDir, pbHash))) {
+            qwKeyShared = *(PQWORD)pbHash + pModule->vaBase + oExpDir;
+            f = H->vmm.pObCacheMapEATShared != NULL;
+            if(!f || !(pObMap = ObCacheMap_GetByKey(H->vmm.pObCacheMapEATShared, qwKeyShared))) {
+                if((pObMap = VmmWinEAT_Initialize_DoWork(H, pModule, oExpDir, cbExpDir, pbExpDir)) && f && pObMap->cMap) {
+                    ObCacheMap_Push(H->vmm.pObCacheMapEATShared, qwKeyShared, pObMap, 0);
+                }
+            }
+            LocalFree(pbExpDir);
+        } else {
+            pObMap = Ob_AllocEx(H, OB_TAG_MAP_EAT, LMEM_ZEROINIT, sizeof(VMMOB_MAP_EAT), NULL, NULL);
+        }
+        if(pObMap) {
+            ObCacheMap_Push(H->vmm.pObCacheMapEAT, qwKey, pObMap, H->vmm.tcRefreshMedium);
+        }
     }
     LeaveCriticalSection(&pProcess->LockUpdate);
     return pObMap;
@@ -208,8 +524,68 @@ VOID VmmWinIAT_ObCloseCallback(_In_ PVMMOB_MAP_IAT pObIAT)
     LocalFree(pObIAT->pbMultiText);
 }
 
+typedef struct tdVMMWINIAT_IMAGE {
+    PVMM_PROCESS pProcess;
+    QWORD vaBase;
+    DWORD cbImage;
+    DWORD cbRead;
+    PBYTE pb;               // image sized buffer - only loaded pages are valid (others are zero).
+    PBYTE pbPageMap;        // bitmap of pages loaded into pb.
+} VMMWINIAT_IMAGE, *PVMMWINIAT_IMAGE;
+
+/*
+* Helper function for IAT initialization. Ensure the image pages of the range
+* [rva, rva + cb) are loaded into the image buffer. Each page is read at most
+* once - pages which fail to read are left zero.
+* -- H
+* -- pImg
+* -- rva
+* -- cb
+*/
+VOID VmmWinIAT_ImageLoad(_In_ VMM_HANDLE H, _Inout_ PVMMWINIAT_IMAGE pImg, _In_ QWORD rva, _In_ DWORD cb)
+{
+    DWORD iPage, iPageEnd, iRun, cbRead;
+    QWORD oPage;
+    if(!cb || (rva >= pImg->cbImage)) { return; }
+    iPage = (DWORD)(rva >> 12);
+    iPageEnd = (DWORD)((min(rva + cb, pImg->cbImage) + 0xfff) >> 12);
+    while(iPage < iPageEnd) {
+        if(pImg->pbPageMap[iPage >> 3] & (1 << (iPage & 7))) {
+            iPage++;
+            continue;
+        }
+        for(iRun = iPage; (iRun < iPageEnd) && !(pImg->pbPageMap[iRun >> 3] & (1 << (iRun & 7))); iRun++) {
+            pImg->pbPageMap[iRun >> 3] |= 1 << (iRun & 7);
+        }
+        oPage = (QWORD)iPage << 12;
+        VmmReadEx(H, pImg->pProcess, pImg->vaBase + oPage, pImg->pb + oPage, (DWORD)min(pImg->cbImage - oPage, (QWORD)(iRun - iPage) << 12), &cbRead, 0);
+        pImg->cbRead += cbRead;
+        iPage = iRun;
+    }
+    pImg->pb[pImg->cbImage - 1] = 0;
+}
+
+/*
+* Helper function for IAT initialization. Ensure the null-terminated string at
+* rva is loaded into the image buffer - page by page until its terminator.
+* -- H
+* -- pImg
+* -- rva
+*/
+VOID VmmWinIAT_ImageLoadString(_In_ VMM_HANDLE H, _Inout_ PVMMWINIAT_IMAGE pImg, _In_ QWORD rva)
+{
+    QWORD o, cb;
+    for(o = rva; o < pImg->cbImage; o = (o & ~0xfff) + 0x1000) {
+        cb = min(0x1000 - (o & 0xfff), pImg->cbImage - o);
+        VmmWinIAT_ImageLoad(H, pImg, o, (DWORD)cb);
+        if(strnlen((LPSTR)(pImg->pb + o), (SIZE_T)cb) < cb) { break; }
+    }
+}
+
 /*
 * Helper function for IAT initialization.
+* Only the image pages holding the import descriptors, thunks and names are
+* read - not the whole image.
 * CALLER DECREF: return
 * -- H
 * -- pProcess
@@ -226,17 +602,21 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS
     PQWORD pIAT64, pHNA64;
     PDWORD pIAT32, pHNA32;
     PBYTE pbModule = NULL;
-    DWORD c, j, cbModule, cbRead;
+    DWORD c, j, cbModule;
     BOOL fHdr32, fNameFn, fNameMod;
     POB_STRMAP pObStrMap = NULL;
     PVMMOB_MAP_IAT pObIAT = NULL;
     PVMM_MAP_IATENTRY pe;
-    // Load the module
+    VMMWINIAT_IMAGE Img = { 0 };
+    // Allocate the image buffer (pages are loaded on demand)
     if(pModule->cbImageSize > PE_MAX_SUPPORTED_SIZE) { goto fail; }    // above max supported size (may be indication of corrupt data)
     cbModule = pModule->cbImageSize;
     if(!(pbModule = LocalAlloc(LMEM_ZEROINIT, cbModule))) { goto fail; }
-    VmmReadEx(H, pProcess, pModule->vaBase, pbModule, cbModule, &cbRead, 0);
-    if(cbRead <= 0x2000) { goto fail; }
+    if(!(Img.pbPageMap = LocalAlloc(LMEM_ZEROINIT, ((cbModule + 0xfff) >> 15) + 1))) { goto fail; }
+    Img.pProcess = pProcess;
+    Img.vaBase = pModule->vaBase;
+    Img.cbImage = cbModule;
+    Img.pb = pbModule;
     pbModule[cbModule - 1] = 0;
     // load both 32/64 bit ntHeader (only one will be valid)
     if(!(ntHeader64 = (PIMAGE_NT_HEADERS64)VmmWin_GetVerifyHeaderPE(H, pProcess, pModule->vaBase, pbModuleHeader, &fHdr32))) { goto fail; }
@@ -245,6 +625,8 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS
         ntHeader32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress :
         ntHeader64->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress;
     if(!oImportDirectory || (oImportDirectory >= cbModule)) { goto fail; }
+    VmmWinIAT_ImageLoad(H, &Img, oImportDirectory, sizeof(IMAGE_IMPORT_DESCRIPTOR));
+    if(!Img.cbRead) { goto fail; }
     // Allocate IAT-MAP
     if(!(pObStrMap = ObStrMap_New(H, OB_STRMAP_FLAGS_CASE_SENSITIVE))) { goto fail; }
     if(!(pObIAT = Ob_AllocEx(H, OB_TAG_MAP_IAT, LMEM_ZEROINIT, sizeof(VMMOB_MAP_IAT) + pModule->cIAT * sizeof(VMM_MAP_IATENTRY), (OB_CLEANUP_CB)VmmWinIAT_ObCloseCallback, NULL))) { goto fail; }
@@ -253,9 +635,12 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS
     // Walk imported modules / functions
     pIID = (PIMAGE_IMPORT_DESCRIPTOR)(pbModule + oImportDirectory);
     i = 0, c = 0;
-    while((oImportDirectory + (i + 1) * sizeof(IMAGE_IMPORT_DESCRIPTOR) < cbModule) && pIID[i].FirstThunk) {
+    while(oImportDirectory + (i + 1) * sizeof(IMAGE_IMPORT_DESCRIPTOR) < cbModule) {
+        VmmWinIAT_ImageLoad(H, &Img, oImportDirectory + i * sizeof(IMAGE_IMPORT_DESCRIPTOR), sizeof(IMAGE_IMPORT_DESCRIPTOR));
+        if(!pIID[i].FirstThunk) { break; }
         if(c >= pObIAT->cMap) { break; }
         if(pIID[i].Name > cbModule - 64) { i++; continue; }
+        VmmWinIAT_ImageLoadString(H, &Img, pIID[i].Name);
         if(fHdr32) {
             // 32-bit PE
             j = 0;
@@ -265,10 +650,16 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS
                 if(c >= pObIAT->cMap) { break; }
                 if((QWORD)(pIAT32 + j) + sizeof(DWORD) - (QWORD)pbModule > cbModule) { break; }
                 if((QWORD)(pHNA32 + j) + sizeof(DWORD) - (QWORD)pbModule > cbModule) { break; }
+                VmmWinIAT_ImageLoad(H, &Img, pIID[i].FirstThunk + j * sizeof(DWORD), sizeof(DWORD));
+                VmmWinIAT_ImageLoad(H, &Img, pIID[i].OriginalFirstThunk + j * sizeof(DWORD), sizeof(DWORD));
                 if(!pIAT32[j]) { break; }
                 if(!pHNA32[j]) { break; }
                 fNameFn = (pHNA32[j] < cbModule);
                 fNameMod = (pIID[i].Name < cbModule);
+                if(fNameFn) {
+                    VmmWinIAT_ImageLoad(H, &Img, pHNA32[j], sizeof(WORD));
+                    VmmWinIAT_ImageLoadString(H, &Img, (QWORD)pHNA32[j] + 2);
+                }
                 // store
                 pe = pObIAT->pMap + c;
                 pe->vaFunction = pIAT32[j];
@@ -292,10 +683,16 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS
                 if(c >= pObIAT->cMap) { break; }
                 if((QWORD)(pIAT64 + j) + sizeof(QWORD) - (QWORD)pbModule > cbModule) { break; }
                 if((QWORD)(pHNA64 + j) + sizeof(QWORD) - (QWORD)pbModule > cbModule) { break; }
+                VmmWinIAT_ImageLoad(H, &Img, pIID[i].FirstThunk + j * sizeof(QWORD), sizeof(QWORD));
+                VmmWinIAT_ImageLoad(H, &Img, pIID[i].OriginalFirstThunk + j * sizeof(QWORD), sizeof(QWORD));
                 if(!pIAT64[j] || (!VMM_UADDR64(pIAT64[j]) && !VMM_KADDR64(pIAT64[j]))) { break; }
                 if(!pHNA64[j]) { break; }
                 fNameFn = (pHNA64[j] < cbModule);
                 fNameMod = (pIID[i].Name < cbModule);
+                if(fNameFn) {
+                    VmmWinIAT_ImageLoad(H, &Img, pHNA64[j], sizeof(WORD));
+                    VmmWinIAT_ImageLoadString(H, &Img, pHNA64[j] + 2);
+                }
                 // store
                 pe = pObIAT->pMap + c;
                 pe->vaFunction = pIAT64[j];
@@ -326,9 +723,11 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize_DoWork(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS
             pe->uszFunction = (LPSTR)pObIAT->pbMultiText;
         }
     }
+    LocalFree(Img.pbPageMap);
     LocalFree(pbModule);
     return pObIAT;
 fail:
+    LocalFree(Img.pbPageMap);
     LocalFree(pbModule);
     Ob_DECREF(pObStrMap);
     return Ob_AllocEx(H, OB_TAG_MAP_IAT, LMEM_ZEROINIT, sizeof(VMMOB_MAP_IAT), NULL, NULL);
@@ -347,9 +746,9 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProces
 {
     BOOL f;
     PVMMOB_MAP_IAT pObMap = NULL;
-    QWORD qwKey = (pProcess->dwPID ^ ((QWORD)pProcess->dwPID << 48) ^ pModule->vaBase);
+    QWORD qwKey = VMMWINEATIAT_CACHEMAP_KEY(pProcess, pModule->vaBase);
     f = H->vmm.pObCacheMapIAT ||
-        (H->vmm.pObCacheMapIAT = ObCacheMap_New(H, 0x20, VmmWinEATIAT_Callback_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB));
+        (H->vmm.pObCacheMapIAT = ObCacheMap_New(H, VMMWINEATIAT_CACHEMAP_MAX, VmmWinEATIAT_Callback_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB));
     if(!f) { return NULL; }
     if((pObMap = ObCacheMap_GetByKey(H->vmm.pObCacheMapIAT, qwKey))) { return pObMap; }
     EnterCriticalSection(&pProcess->LockUpdate);
@@ -363,6 +762,197 @@ PVMMOB_MAP_IAT VmmWinIAT_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProces
 
 
 
+/*
+* Helper function for batched IAT initialization. Push the image pages needed
+* to resolve the next level of the import data of a module to the prefetch
+* set. The import descriptors and the import address table (level 0) are
+* pushed by the caller, the deeper levels are resolved from cached pages:
+*   1 = import name table (OriginalFirstThunk arrays) and module names.
+*   2 = hint/name entries of the imported functions.
+* -- H
+* -- pProcess
+* -- pModule
+* -- pbModuleHeader
+* -- iLevel
+* -- psPrefetch
+*/
+VOID VmmWinIAT_PrefetchLevel(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule, _In_reads_(0x1000) PBYTE pbModuleHeader, _In_ DWORD iLevel, _In_ POB_SET psPrefetch)
+{
+    BOOL fHdr32;
+    QWORD qwThunk;
+    DWORD i, j, oDir, cbDir, oIat, cbIat = 0, cbThunk, cThunk;
+    PBYTE pbIat = NULL, pbThunk = NULL;
+    PIMAGE_IMPORT_DESCRIPTOR pIID = NULL;
+    if(!VmmWin_GetVerifyHeaderPE(H, pProcess, 0, pbModuleHeader, &fHdr32)) { return; }
+    cbThunk = fHdr32 ? sizeof(DWORD) : sizeof(QWORD);
+    if(!(oDir = PE_DirectoryGetOffset(H, pProcess, 0, pbModuleHeader, IMAGE_DIRECTORY_ENTRY_IMPORT, &cbDir))) { return; }
+    if((cbDir < sizeof(IMAGE_IMPORT_DESCRIPTOR)) || (cbDir > 0x00100000)) { return; }
+    if(!(pIID = LocalAlloc(LMEM_ZEROINIT, cbDir))) { goto fail; }
+    VmmReadEx(H, pProcess, pModule->vaBase + oDir, (PBYTE)pIID, cbDir, NULL, VMM_FLAG_FORCECACHE_READ);
+    oIat = PE_DirectoryGetOffset(H, pProcess, 0, pbModuleHeader, IMAGE_DIRECTORY_ENTRY_IAT, &cbIat);
+    if(!oIat || (cbIat > 0x00100000)) { oIat = 0, cbIat = 0; }
+    if(cbIat && (pbIat = LocalAlloc(LMEM_ZEROINIT, cbIat))) {
+        VmmReadEx(H, pProcess, pModule->vaBase + oIat, pbIat, cbIat, NULL, VMM_FLAG_FORCECACHE_READ);
+    }
+    for(i = 0; (i < cbDir / sizeof(IMAGE_IMPORT_DESCRIPTOR)) && pIID[i].FirstThunk; i++) {
+        if(ObSet_Size(psPrefetch) >= VMMWINEATIAT_PREFETCH_MAX_PAGES) { break; }
+        if(!pIID[i].OriginalFirstThunk || (pIID[i].OriginalFirstThunk >= pModule->cbImageSize)) { continue; }
+        // number of thunks is taken from the cached FirstThunk array (if
+        // located in the IAT directory) otherwise the first page is used.
+        cThunk = (0x1000 - (pIID[i].OriginalFirstThunk & 0xfff)) / cbThunk;
+        if(pbIat && (pIID[i].FirstThunk >= oIat) && (pIID[i].FirstThunk < oIat + cbIat)) {
+            for(cThunk = 0, j = pIID[i].FirstThunk - oIat; (j + cbThunk <= cbIat) && (fHdr32 ? *(PDWORD)(pbIat + j) : *(PQWORD)(pbIat + j)); j += cbThunk) {
+                cThunk++;
+            }
+        }
+        if(iLevel == 1) {
+            ObSet_Push_PageAlign(psPrefetch, pModule->vaBase + pIID[i].OriginalFirstThunk, (cThunk + 1) * cbThunk);
+            if(pIID[i].Name < pModule->cbImageSize) {
+                ObSet_Push_PageAlign(psPrefetch, pModule->vaBase + pIID[i].Name, 1);
+            }
+            continue;
+        }
+        if(!cThunk || !(pbThunk = LocalAlloc(LMEM_ZEROINIT, cThunk * cbThunk))) { continue; }
+        VmmReadEx(H, pProcess, pModule->vaBase + pIID[i].OriginalFirstThunk, pbThunk, cThunk * cbThunk, NULL, VMM_FLAG_FORCECACHE_READ);
+        for(j = 0; j < cThunk; j++) {
+            qwThunk = fHdr32 ? ((PDWORD)pbThunk)[j] : ((PQWORD)pbThunk)[j];
+            if(!qwThunk) { break; }
+            if(qwThunk < pModule->cbImageSize) {
+                ObSet_Push_PageAlign(psPrefetch, pModule->vaBase + qwThunk, sizeof(WORD) + 1);
+            }
+        }
+        LocalFree(pbThunk);
+        pbThunk = NULL;
+    }
+fail:
+    LocalFree(pbIat);
+    LocalFree(pIID);
+}
+
+/*
+* Helper function for batched EAT/IAT initialization. Build the maps of the
+* modules in the range [iModule, iModule + cModule) from prefetched pages.
+*/
+VOID VmmWinEATIAT_InitializeAll_Build(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMMOB_MAP_MODULE pModuleMap, _In_ DWORD iModule, _In_ DWORD cModule, _In_ POB_SET psPrefetch, _In_ BOOL fEAT, _In_ BOOL fIAT)
+{
+    BYTE pbModuleHeader[0x1000];
+    DWORD i, iLevel;
+    PVMM_MAP_MODULEENTRY pe;
+    VmmCachePrefetchPages(H, pProcess, psPrefetch, 0);
+    ObSet_Clear(psPrefetch);
+    // resolve import name tables / names from the cached import descriptors
+    for(iLevel = 1; fIAT && (iLevel <= 2); iLevel++) {
+        for(i = iModule; i < iModule + cModule; i++) {
+            pe = pModuleMap->pMap + i;
+            if(!pe->cIAT || ObCacheMap_ExistsKey(H->vmm.pObCacheMapIAT, VMMWINEATIAT_CACHEMAP_KEY(pProcess, pe->vaBase))) { continue; }
+            if(!VmmRead2(H, pProcess, pe->vaBase, pbModuleHeader, 0x1000, VMM_FLAG_FORCECACHE_READ)) { continue; }
+            VmmWinIAT_PrefetchLevel(H, pProcess, pe, pbModuleHeader, iLevel, psPrefetch);
+        }
+        VmmCachePrefetchPages(H, pProcess, psPrefetch, 0);
+        ObSet_Clear(psPrefetch);
+    }
+    for(i = iModule; i < iModule + cModule; i++) {
+        if(fEAT) { Ob_DECREF(VmmWinEAT_Initialize(H, pProcess, pModuleMap->pMap + i)); }
+        if(fIAT) { Ob_DECREF(VmmWinIAT_Initialize(H, pProcess, pModuleMap->pMap + i)); }
+    }
+}
+
+/*
+* Initialize EAT and/or IAT maps for all modules of a process in a batched way.
+* PE headers of all modules not already cached are prefetched in one scatter
+* round, the export directories (including name/ordinal tables), the import
+* descriptors and the import address tables in a second round. The import
+* name tables and the imported names are prefetched in two more rounds after
+* which the maps are built from cached data and put into the EAT/IAT cache
+* maps. The rounds are split into chunks of max VMMWINEATIAT_PREFETCH_MAX_PAGES
+* pages to avoid evicting prefetched pages.
+* The batched initialization is done at most once per process per medium
+* refresh - modules evicted from the cache maps are re-created on demand.
+* -- H
+* -- pProcess
+* -- fEAT
+* -- fIAT
+*/
+VOID VmmWinEATIAT_InitializeAll(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ BOOL fEAT, _In_ BOOL fIAT)
+{
+    BYTE pbModuleHeader[0x1000];
+    BOOL fEATi, fIATi;
+    DWORD i, iChunk = 0, oDir = 0, cbDir = 0, oImp = 0, cbImp = 0, oIat = 0, cbIat = 0, cbPages;
+    QWORD qwKey;
+    PVMM_MAP_MODULEENTRY pe;
+    POB_SET psObPrefetch = NULL;
+    PVMMOB_MAP_MODULE pObModuleMap = NULL;
+    if(!H->vmm.pObCacheMapEAT || !H->vmm.pObCacheMapIAT || !H->vmm.psObEATIATInitAllPID) {
+        EnterCriticalSection(&H->vmm.LockUpdateMap);
+        if(!H->vmm.pObCacheMapEAT) {
+            H->vmm.pObCacheMapEAT = ObCacheMap_New(H, VMMWINEATIAT_CACHEMAP_MAX, VmmWinEATIAT_Callback_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB);
+        }
+        if(!H->vmm.pObCacheMapIAT) {
+            H->vmm.pObCacheMapIAT = ObCacheMap_New(H, VMMWINEATIAT_CACHEMAP_MAX, VmmWinEATIAT_Callback_ValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB);
+        }
+        if(!H->vmm.psObEATIATInitAllPID) {
+            H->vmm.psObEATIATInitAllPID = ObSet_New(H);
+        }
+        LeaveCriticalSection(&H->vmm.LockUpdateMap);
+        if(!H->vmm.pObCacheMapEAT || !H->vmm.pObCacheMapIAT || !H->vmm.psObEATIATInitAllPID) { return; }
+    }
+    // once per process (and EAT/IAT) per medium refresh:
+    if(fEAT && !ObSet_Push(H->vmm.psObEATIATInitAllPID, ((QWORD)1 << 32) | pProcess->dwPID)) { fEAT = FALSE; }
+    if(fIAT && !ObSet_Push(H->vmm.psObEATIATInitAllPID, ((QWORD)2 << 32) | pProcess->dwPID)) { fIAT = FALSE; }
+    if(!fEAT && !fIAT) { return; }
+    if(!VmmMap_GetModule(H, pProcess, 0, &pObModuleMap)) { goto fail; }
+    if(!(psObPrefetch = ObSet_New(H))) { goto fail; }
+    // 1: prefetch pe headers of modules not already cached
+    for(i = 0; i < pObModuleMap->cMap; i++) {
+        qwKey = VMMWINEATIAT_CACHEMAP_KEY(pProcess, pObModuleMap->pMap[i].vaBase);
+        if((fEAT && !ObCacheMap_ExistsKey(H->vmm.pObCacheMapEAT, qwKey)) || (fIAT && !ObCacheMap_ExistsKey(H->vmm.pObCacheMapIAT, qwKey))) {
+            ObSet_Push(psObPrefetch, pObModuleMap->pMap[i].vaBase);
+        }
+    }
+    if(!ObSet_Size(psObPrefetch)) { goto fail; }
+    VmmCachePrefetchPages(H, pProcess, psObPrefetch, 0);
+    ObSet_Clear(psObPrefetch);
+    // 2: prefetch directory pages in chunks and build maps from cache
+    for(i = 0; i < pObModuleMap->cMap; i++) {
+        pe = pObModuleMap->pMap + i;
+        qwKey = VMMWINEATIAT_CACHEMAP_KEY(pProcess, pe->vaBase);
+        fEATi = fEAT && !ObCacheMap_ExistsKey(H->vmm.pObCacheMapEAT, qwKey);
+        fIATi = fIAT && !ObCacheMap_ExistsKey(H->vmm.pObCacheMapIAT, qwKey);
+        if(!fEATi && !fIATi) { continue; }
+        if(!VmmRead2(H, pProcess, pe->vaBase, pbModuleHeader, 0x1000, VMM_FLAG_FORCECACHE_READ)) { continue; }
+        cbPages = 0, oDir = 0, cbDir = 0, oImp = 0, cbImp = 0, oIat = 0, cbIat = 0;
+        if(fIATi && (oImp = PE_DirectoryGetOffset(H, pProcess, 0, pbModuleHeader, IMAGE_DIRECTORY_ENTRY_IMPORT, &cbImp)) && (cbImp <= 0x00100000)) {
+            cbPages += cbImp;
+            if((oIat = PE_DirectoryGetOffset(H, pProcess, 0, pbModuleHeader, IMAGE_DIRECTORY_ENTRY_IAT, &cbIat)) && (cbIat <= 0x00100000)) {
+                cbPages += cbIat;
+            }
+        }
+        if(fEATi && (oDir = PE_DirectoryGetOffset(H, pProcess, 0, pbModuleHeader, IMAGE_DIRECTORY_ENTRY_EXPORT, &cbDir)) && (cbDir <= 0x01000000)) {
+            cbPages += cbDir;
+        }
+        if(cbPages > VMMWINEATIAT_PREFETCH_MAX_PAGES * 0x1000) { continue; }   // too large - read on demand
+        if((ObSet_Size(psObPrefetch) + (cbPages >> 12) + 2 > VMMWINEATIAT_PREFETCH_MAX_PAGES) && ObSet_Size(psObPrefetch)) {
+            VmmWinEATIAT_InitializeAll_Build(H, pProcess, pObModuleMap, iChunk, i - iChunk, psObPrefetch, fEAT, fIAT);
+            iChunk = i;
+        }
+        if(fIATi && oImp && (cbImp <= 0x00100000)) {
+            ObSet_Push_PageAlign(psObPrefetch, pe->vaBase + oImp, cbImp);
+            if(oIat && (cbIat <= 0x00100000)) {
+                ObSet_Push_PageAlign(psObPrefetch, pe->vaBase + oIat, cbIat);
+            }
+        }
+        if(fEATi && oDir && (cbDir <= 0x01000000)) {
+            ObSet_Push_PageAlign(psObPrefetch, pe->vaBase + oDir, cbDir);
+        }
+    }
+    VmmWinEATIAT_InitializeAll_Build(H, pProcess, pObModuleMap, iChunk, pObModuleMap->cMap - iChunk, psObPrefetch, fEAT, fIAT);
+fail:
+    Ob_DECREF(psObPrefetch);
+    Ob_DECREF(pObModuleMap);
+}
+
+
+
 // ----------------------------------------------------------------------------
 // WINDOWS SPECIFIC PROCESS RELATED FUNCTIONALITY BELOW:
 //    PEB/LDR USER MODE PARSING CODE (64-bit and 32-bit)
@@ -921,15 +1511,12 @@ VOID VmmWinLdrModule_Enrich_Prefetch(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProce
 
 VOID VmmWinLdrModule_EnrichDebugInfo(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess)
 {
-    static const LPCSTR szHEX_ALPHABET = "0123456789ABCDEF";
     PVMMOB_MAP_MODULE pModuleMap = pProcess->Map.pObModule;
     PVMM_MAP_MODULEENTRY_DEBUGINFO pDebugInfo;
     PVMM_MAP_MODULEENTRY pe;
     POB_STRMAP psmOb = NULL;
-    DWORD i, j, k, cbMultiStr;
-    BYTE b;
-    CHAR szGUID[33] = { 0 };
-    PE_CODEVIEW_INFO CodeViewInfo;
+    POB_VMMWIN_PEMETA pObMeta = NULL;
+    DWORD i, cbMultiStr;
     VMMSTATISTICS_LOG Statistics = { 0 };
     if(!pModuleMap || pModuleMap->fDebugInfo) { return; }
     EnterCriticalSection(&pProcess->LockUpdate);
@@ -946,18 +1533,12 @@ VOID VmmWinLdrModule_EnrichDebugInfo(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProce
         pe = pModuleMap->pMap + i;
         pDebugInfo = ((PVMM_MAP_MODULEENTRY_DEBUGINFO)pModuleMap->pbDebugInfo1) + i;
         pe->pExDebugInfo = pDebugInfo;
-        if(PE_GetCodeViewInfo(H, pProcess, pe->vaBase, NULL, &CodeViewInfo)) {
-            // guid -> hex
-            for(k = 0, j = 0; k < 16; k++) {
-                b = CodeViewInfo.CodeView.Guid[k];
-                szGUID[j++] = szHEX_ALPHABET[b >> 4];
-                szGUID[j++] = szHEX_ALPHABET[b & 7];
-            }
-            // populate ExDebugInfo
-            pDebugInfo->dwAge = CodeViewInfo.CodeView.Age;
-            memcpy(pDebugInfo->Guid, CodeViewInfo.CodeView.Guid, sizeof(pDebugInfo->Guid));
-            ObStrMap_PushPtrAU(psmOb, szGUID, &pDebugInfo->uszGuid, NULL);
-            ObStrMap_PushPtrUU(psmOb, CodeViewInfo.CodeView.PdbFileName, &pDebugInfo->uszPdbFilename, NULL);
+        if((pObMeta = VmmWinPeMeta_GetDebugInfo(H, pProcess, pe))) {
+            pDebugInfo->dwAge = pObMeta->DebugInfo.dwAge;
+            memcpy(pDebugInfo->Guid, pObMeta->DebugInfo.Guid, sizeof(pDebugInfo->Guid));
+            ObStrMap_PushPtrUU(psmOb, pObMeta->DebugInfo.uszGuid, &pDebugInfo->uszGuid, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->DebugInfo.uszPdbFilename, &pDebugInfo->uszPdbFilename, NULL);
+            Ob_DECREF_NULL(&pObMeta);
         }
     }
     // finish str alloc:
@@ -981,6 +1562,7 @@ VOID VmmWinLdrModule_EnrichVersionInfo(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pPro
     PVMM_MAP_MODULEENTRY_VERSIONINFO pVersionInfo;
     PVMM_MAP_MODULEENTRY pe;
     POB_STRMAP psmOb = NULL;
+    POB_VMMWIN_PEMETA pObMeta = NULL;
     DWORD i, cbMultiStr;
     VMMSTATISTICS_LOG Statistics = { 0 };
     if(!pModuleMap || pModuleMap->fVersionInfo) { return; }
@@ -998,7 +1580,17 @@ VOID VmmWinLdrModule_EnrichVersionInfo(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pPro
         pe = pModuleMap->pMap + i;
         pVersionInfo = ((PVMM_MAP_MODULEENTRY_VERSIONINFO)pModuleMap->pbVersionInfo1) + i;
         pe->pExVersionInfo = pVersionInfo;
-        PE_VsGetVersionInfo(H, pProcess, pe->vaBase, psmOb, pVersionInfo);
+        if((pObMeta = VmmWinPeMeta_GetVersionInfo(H, pProcess, pe))) {
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszCompanyName, &pVersionInfo->uszCompanyName, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszFileDescription, &pVersionInfo->uszFileDescription, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszFileVersion, &pVersionInfo->uszFileVersion, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszInternalName, &pVersionInfo->uszInternalName, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszLegalCopyright, &pVersionInfo->uszLegalCopyright, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszOriginalFilename, &pVersionInfo->uszOriginalFilename, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszProductName, &pVersionInfo->uszProductName, NULL);
+            ObStrMap_PushPtrUU(psmOb, pObMeta->VersionInfo.uszProductVersion, &pVersionInfo->uszProductVersion, NULL);
+            Ob_DECREF_NULL(&pObMeta);
+        }
     }
     // finish str alloc:
     ObStrMap_FinalizeAllocU_DECREF_NULL(&psmOb, &pModuleMap->pbVersionInfo2, &cbMultiStr);
@@ -30,6 +30,19 @@ PVMMOB_MAP_EAT VmmWinEAT_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProces
 _Success_(return != NULL)
 PVMMOB_MAP_IAT VmmWinIAT_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_MODULEENTRY pModule);
 
+/*
+* Initialize EAT and/or IAT maps for all modules of a process in a batched way
+* (prefetching PE headers, directory, thunk and name pages of all modules in
+* scatter rounds) into the EAT/IAT caches. Useful before iterating exports or
+* imports of all modules of a process. Done at most once per process per
+* medium refresh - subsequent calls return immediately.
+* -- H
+* -- pProcess
+* -- fEAT
+* -- fIAT
+*/
+VOID VmmWinEATIAT_InitializeAll(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ BOOL fEAT, _In_ BOOL fIAT);
+
 /*
 * Try initialize PteMap text descriptions. This function will first try to pop-
 * ulate the pre-existing VMMOB_MAP_PTE object in pProcess with module names and
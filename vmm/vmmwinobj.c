@@ -260,6 +260,11 @@ fail:
     Ob_DECREF(hObScatterSEG);
 }
 
+VOID VmmWinObj_ObSharedCacheMap_CleanupCB(POB_VMMWINOBJ_SHARED_CACHE_MAP pOb)
+{
+    Ob_DECREF(pOb->pObRunList);
+}
+
 /*
 * Initialize shared cache map information from the addresses in psvaSharedCacheMap.
 * Successful entries will be pused to the ctx->pmSharedCacheMap map.
@@ -298,12 +303,13 @@ static VOID VmmWinObjFile_Initialize_SharedCacheMap_New(_In_ VMM_HANDLE H, _In_
         cbSectionSize = *(PQWORD)(pb + po->_SHARED_CACHE_MAP.oSectionSize);
         cbFileSizeValid = *(PQWORD)(pb + po->_SHARED_CACHE_MAP.oValidDataLength);
         if(!VMM_KADDR_4_8(f32, vaVacbs) || (cbFileSize > 0x0000ffffffffffff) || (cbFileSizeValid > 0x0000ffffffffffff)) { goto fail_entry_scm; }
-        if((peOb = Ob_AllocEx(H, OB_TAG_OBJ_SHARED_CACHE_MAP, 0, sizeof(OB_VMMWINOBJ_SHARED_CACHE_MAP), NULL, NULL))) {
+        if((peOb = Ob_AllocEx(H, OB_TAG_OBJ_SHARED_CACHE_MAP, 0, sizeof(OB_VMMWINOBJ_SHARED_CACHE_MAP), (OB_CLEANUP_CB)VmmWinObj_ObSharedCacheMap_CleanupCB, NULL))) {
             peOb->va = va;
             peOb->vaVacbs = vaVacbs;
             peOb->cbFileSize = cbFileSize;
             peOb->cbFileSizeValid = cbFileSizeValid;
             peOb->cbSectionSize = cbSectionSize;
+            peOb->pObRunList = NULL;
             ObMap_Push(ctx->pmSharedCacheMap, va, peOb);
             Ob_DECREF(peOb);
         }
@@ -860,10 +866,146 @@ QWORD VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsection(_In_ VMM_HANDL
     return pte;
 }
 
+/*
+* Helper function to retrieve a range of Page Table Entries (PTEs) from a
+* _SUBSECTION prototype PTE array in one single read.
+* -- H
+* -- pSystemProcess
+* -- vaPteBase
+* -- iPte = index of the first PTE to retrieve.
+* -- cPte = number of PTEs to retrieve.
+* -- pqwPte = buffer of cPte QWORDs to receive the PTEs (zero on fail).
+* -- fVmmRead = VMM_FLAGS_* flags.
+*/
+VOID VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsectionRange(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD vaPteBase, _In_ QWORD iPte, _In_ DWORD cPte, _Out_writes_(cPte) PQWORD pqwPte, _In_ QWORD fVmmRead)
+{
+    DWORD i;
+    if(H->vmm.tpMemoryModel == VMMDLL_MEMORYMODEL_X86) {
+        // 32-bit ptes are read into the start of the buffer and expanded backwards in-place:
+        VmmReadEx(H, pSystemProcess, vaPteBase + iPte * 4, (PBYTE)pqwPte, cPte * 4, NULL, fVmmRead);
+        for(i = cPte; i; i--) {
+            pqwPte[i - 1] = ((PDWORD)pqwPte)[i - 1];
+        }
+    } else {
+        VmmReadEx(H, pSystemProcess, vaPteBase + iPte * 8, (PBYTE)pqwPte, cPte * 8, NULL, fVmmRead);
+    }
+}
+
+/*
+* Create a run-list mapping file pages to virtual addresses in the cache from
+* the _VACB array of a _SHARED_CACHE_MAP. All _VACBs are read in one pass and
+* adjacent _VACBs mapping contiguous virtual memory are merged into one run.
+* Each _VACB is verified to still belong to the _SHARED_CACHE_MAP. The run-list
+* is only marked complete (cacheable) if all reads succeeded without relying on
+* VMM_FLAG_FORCECACHE_READ.
+* CALLER DECREF: return
+* -- H
+* -- pSystemProcess
+* -- pCache
+* -- fVmmRead = VMM_FLAGS_* flags.
+* -- return
+*/
+_Success_(return != NULL)
+POB_VMMWINOBJ_VACB_RUNLIST VmmWinObjFile_SharedCache_RunListCreate(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_VMMWINOBJ_SHARED_CACHE_MAP pCache, _In_ QWORD fVmmRead)
+{
+    BOOL f, f32 = H->vmm.f32;
+    BYTE pbVacb[0x40];
+    DWORD iVacb, cVacb, cbPtr = f32 ? 4 : 8;
+    QWORD va, vaVacb, iPte, cPte;
+    PBYTE pbVacbs = NULL;
+    POB_SET psObPrefetch = NULL;
+    PVMMWINOBJ_VACB_RUN pRun = NULL;
+    POB_VMMWINOBJ_VACB_RUNLIST pObRunList = NULL;
+    PVMM_OFFSET_FILE po = &H->vmm.offset.FILE;
+    if((pCache->cbSectionSize < 0x1000) || (po->_VACB.cb > sizeof(pbVacb))) { goto fail; }
+    cVacb = (DWORD)min(VMMWINOBJ_FILE_OBJECT_VACB_MAX, (pCache->cbFileSize + pCache->cbSectionSize - 1) / pCache->cbSectionSize);
+    if(!(pObRunList = Ob_AllocEx(H, OB_TAG_OBJ_VACB_RUNLIST, LMEM_ZEROINIT, sizeof(OB_VMMWINOBJ_VACB_RUNLIST) + cVacb * sizeof(VMMWINOBJ_VACB_RUN), NULL, NULL))) { goto fail; }
+    pObRunList->tcRefreshMEM = H->vmm.tcRefreshMEM;
+    if(!cVacb) {
+        pObRunList->fComplete = TRUE;
+        goto fail;
+    }
+    if(!(pbVacbs = LocalAlloc(0, (SIZE_T)cVacb * cbPtr))) { goto fail; }
+    if(!(psObPrefetch = ObSet_New(H))) { goto fail; }
+    // 1: read the _VACB pointer array and prefetch all _VACBs:
+    if(!VmmRead2(H, pSystemProcess, pCache->vaVacbs, pbVacbs, cVacb * cbPtr, fVmmRead)) { goto fail; }
+    for(iVacb = 0; iVacb < cVacb; iVacb++) {
+        vaVacb = VMM_PTR_OFFSET(f32, pbVacbs, (SIZE_T)iVacb * cbPtr);
+        if(VMM_KADDR_4_8(f32, vaVacb)) {
+            ObSet_Push(psObPrefetch, vaVacb);
+        }
+    }
+    VmmCachePrefetchPages3(H, pSystemProcess, psObPrefetch, po->_VACB.cb, fVmmRead);
+    // 2: resolve _VACBs into runs (drop _VACBs re-used by other cache maps):
+    pObRunList->fComplete = !(fVmmRead & VMM_FLAG_FORCECACHE_READ);
+    for(iVacb = 0; iVacb < cVacb; iVacb++) {
+        vaVacb = VMM_PTR_OFFSET(f32, pbVacbs, (SIZE_T)iVacb * cbPtr);
+        if(!VMM_KADDR_4_8(f32, vaVacb)) { continue; }
+        if(!VmmRead2(H, pSystemProcess, vaVacb, pbVacb, po->_VACB.cb, fVmmRead)) {
+            pObRunList->fComplete = FALSE;
+            continue;
+        }
+        f = (pCache->va == VMM_PTR_OFFSET(f32, pbVacb, po->_VACB.oSharedCacheMap)) &&
+            (va = VMM_PTR_OFFSET(f32, pbVacb, po->_VACB.oBaseAddress));
+        if(!f) { continue; }
+        iPte = (iVacb * pCache->cbSectionSize) >> 12;
+        cPte = pCache->cbSectionSize >> 12;
+        va += iPte << 12;
+        if(pRun && (pRun->iPte + pRun->cPte == iPte) && (pRun->va + (pRun->cPte << 12) == va)) {
+            pRun->cPte += cPte;
+            continue;
+        }
+        pRun = pObRunList->pRun + pObRunList->cRun++;
+        pRun->iPte = iPte;
+        pRun->cPte = cPte;
+        pRun->va = va;
+    }
+fail:
+    LocalFree(pbVacbs);
+    Ob_DECREF(psObPrefetch);
+    return pObRunList;
+}
+
+/*
+* Retrieve the _VACB run-list of a _SHARED_CACHE_MAP. The run-list is created
+* lazily and kept in the shared cache map object until the next memory refresh
+* (tcRefreshMEM) since the cache manager frequently re-uses _VACBs. Incomplete
+* run-lists (failed reads / VMM_FLAG_FORCECACHE_READ) are returned to the caller
+* but never cached. If VMM_FLAG_NOCACHE is set a new uncached run-list is created.
+* CALLER DECREF: return
+* -- H
+* -- pCache
+* -- fVmmRead = VMM_FLAGS_* flags.
+* -- return
+*/
+_Success_(return != NULL)
+POB_VMMWINOBJ_VACB_RUNLIST VmmWinObjFile_SharedCache_GetRunList(_In_ VMM_HANDLE H, _In_ POB_VMMWINOBJ_SHARED_CACHE_MAP pCache, _In_ QWORD fVmmRead)
+{
+    POB_VMMWINOBJ_VACB_RUNLIST pObRunList = NULL;
+    if(fVmmRead & VMM_FLAG_NOCACHE) {
+        return VmmWinObjFile_SharedCache_RunListCreate(H, PVMM_PROCESS_SYSTEM, pCache, fVmmRead);
+    }
+    AcquireSRWLockShared(&H->vmm.LockSRW.WinObjVacb);
+    if(pCache->pObRunList && (pCache->pObRunList->tcRefreshMEM == H->vmm.tcRefreshMEM)) {
+        pObRunList = Ob_INCREF(pCache->pObRunList);
+    }
+    ReleaseSRWLockShared(&H->vmm.LockSRW.WinObjVacb);
+    if(pObRunList) { return pObRunList; }
+    pObRunList = VmmWinObjFile_SharedCache_RunListCreate(H, PVMM_PROCESS_SYSTEM, pCache, fVmmRead);
+    if(pObRunList && pObRunList->fComplete) {
+        AcquireSRWLockExclusive(&H->vmm.LockSRW.WinObjVacb);
+        if(!pCache->pObRunList || (pCache->pObRunList->tcRefreshMEM < pObRunList->tcRefreshMEM)) {
+            Ob_DECREF(pCache->pObRunList);
+            pCache->pObRunList = Ob_INCREF(pObRunList);
+        }
+        ReleaseSRWLockExclusive(&H->vmm.LockSRW.WinObjVacb);
+    }
+    return pObRunList;
+}
+
 /*
 * Helper function to retrieve the virtual address of a _SHARED_CACHE_MAP entry.
-* Retrieval is done in a performance intensive (non-cached) way, but it's
-* assumed this function won't be heavily called.
+* The address is looked up in the cached _VACB run-list of the file.
 * -- H
 * -- pSystemProcess
 * -- pFile
@@ -873,27 +1015,35 @@ QWORD VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsection(_In_ VMM_HANDL
 */
 QWORD VmmWinObjFile_ReadSubsectionAndSharedCache_GetVaSharedCache(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ POB_VMMWINOBJ_FILE pFile, _In_ QWORD iPte, _In_ QWORD fVmmRead)
 {
-    BOOL f, f32 = H->vmm.f32;
-    BYTE pbVacb[0x40];
-    QWORD va, iVacb, vaVacbs, vaVacb;
-    PVMM_OFFSET_FILE po = &H->vmm.offset.FILE;
+    QWORD va = 0;
+    DWORD iLo, iHi, iMid;
+    PVMMWINOBJ_VACB_RUN pRun;
+    POB_VMMWINOBJ_VACB_RUNLIST pObRunList = NULL;
     if(!pFile->pCache) { return 0; }
-    iVacb = (iPte << 12) / pFile->pCache->cbSectionSize;
-    vaVacbs = pFile->pCache->vaVacbs + iVacb * (f32 ? 4 : 8);
-    f = VmmRead2(H, pSystemProcess, vaVacbs, pbVacb, 8, fVmmRead) &&
-        (vaVacb = VMM_PTR_OFFSET(f32, pbVacb, 0)) &&
-        VMM_KADDR_4_8(f32, vaVacb) &&
-        VmmRead2(H, pSystemProcess, vaVacb, pbVacb, po->_VACB.cb, fVmmRead) &&
-        (pFile->pCache->va == VMM_PTR_OFFSET(f32, pbVacb, po->_VACB.oSharedCacheMap)) &&
-        (va = VMM_PTR_OFFSET(f32, pbVacb, po->_VACB.oBaseAddress));
-    return f ? (va + (iPte << 12)) : 0;
+    if(!(pObRunList = VmmWinObjFile_SharedCache_GetRunList(H, pFile->pCache, fVmmRead))) { return 0; }
+    iLo = 0;
+    iHi = pObRunList->cRun;
+    while(iLo < iHi) {
+        iMid = (iLo + iHi) / 2;
+        pRun = pObRunList->pRun + iMid;
+        if(iPte < pRun->iPte) {
+            iHi = iMid;
+        } else if(iPte >= pRun->iPte + pRun->cPte) {
+            iLo = iMid + 1;
+        } else {
+            va = pRun->va + ((iPte - pRun->iPte) << 12);
+            break;
+        }
+    }
+    Ob_DECREF(pObRunList);
+    return va;
 }
 
 /*
 * Read data from a single _FILE_OBJECT _SUBSECTION and/or a _SHARED_CACHE_MAP.
-* Function is very similar to the VmmReadEx() function. Reading is not yet
-* optimized, but the assumption is the function won't be called frequently so
-* any inefficencies should only have a minor performance impact.
+* Function is very similar to the VmmReadEx() function. Page sources are taken
+* from the cached _VACB run-list and from ranged reads of the _SUBSECTION
+* prototype PTEs. Each source is then read in one single scatter batch.
 * -- H
 * -- pFile
 * -- iSubsection
@@ -909,24 +1059,29 @@ _Success_(return != 0)
 DWORD VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ VMM_HANDLE H, _In_ POB_VMMWINOBJ_FILE pFile, _In_ DWORD iSubsection, _In_ QWORD cbOffset, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _In_ QWORD fVmmRead, _In_ VMMWINOBJ_FILE_TP tp)
 {
     BOOL fReadImageSubsection = FALSE, fReadSharedCacheMap = FALSE, fReadDataSubsection = FALSE;
-    DWORD cbP, cMEMs, cMEMsAlloc, cbRead = 0, iSS;
+    DWORD cbP, cMEMs, cMEMsAlloc, cbRead = 0, iSS, iRun;
     PBYTE pbBuffer;
     PMEM_SCATTER pMEM, pMEMs, *ppMEMs;
-    QWORD i, oA, iPte;
+    QWORD i, iEnd, oA, iPteBase, iPteStart, iPteEnd;
+    PQWORD pqwPte;
     PVMMWINOBJ_FILE_SUBSECTION pSS = NULL;
+    PVMMWINOBJ_VACB_RUN pRun;
+    POB_VMMWINOBJ_VACB_RUNLIST pObRunList = NULL;
     POB_VMMWINOBJ_CONTROL_AREA pCA = NULL, pControlArea = NULL;
     if(tp == VMMWINOBJ_FILE_TP_DEFAULT) { return 0; }
     if(!cb) { return 0; }
     cMEMs = (DWORD)(((cbOffset & 0xfff) + cb + 0xfff) >> 12);
     cMEMsAlloc = cMEMs + VMMWINOBJ_FILE_OBJECT_SUBSECTION_MAX;
-    pbBuffer = (PBYTE)LocalAlloc(LMEM_ZEROINIT, 0x2000 + cMEMsAlloc * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER)));
+    pbBuffer = (PBYTE)LocalAlloc(LMEM_ZEROINIT, 0x2000 + cMEMsAlloc * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER) + sizeof(QWORD)));
     if(!pbBuffer) {
         ZeroMemory(pb, cb);
         return 0;
     }
     pMEMs = (PMEM_SCATTER)(pbBuffer + 0x2000);
     ppMEMs = (PPMEM_SCATTER)(pbBuffer + 0x2000 + cMEMsAlloc * sizeof(MEM_SCATTER));
+    pqwPte = (PQWORD)(pbBuffer + 0x2000 + cMEMsAlloc * (sizeof(MEM_SCATTER) + sizeof(PMEM_SCATTER)));
     oA = cbOffset & 0xfff;
+    iPteBase = (cbOffset - oA) >> 12;
     // prepare "middle" pages
     for(i = 0; i < cMEMs; i++) {
         pMEM = ppMEMs[i] = &pMEMs[i];
@@ -942,16 +1097,18 @@ DWORD VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ VMM_HANDLE H, _In_ POB_VMM
         pMEMs[cMEMs - 1].pb = pbBuffer + 0x1000;
     }
     // Read from _SHARED_CACHE_MAP
-    if((tp & VMMWINOBJ_FILE_TP_CACHE) && pFile->pCache) {
-        for(i = 0; i < cMEMs; i++) {
-            iPte = i + ((cbOffset - oA) >> 12);
-            pMEM = pMEMs + i;
-            if(pMEM->f) { continue; }
-            pMEM->qwA = VmmWinObjFile_ReadSubsectionAndSharedCache_GetVaSharedCache(H, PVMM_PROCESS_SYSTEM, pFile, iPte, fVmmRead);
-            if(pMEM->qwA) {
+    if((tp & VMMWINOBJ_FILE_TP_CACHE) && pFile->pCache && (pObRunList = VmmWinObjFile_SharedCache_GetRunList(H, pFile->pCache, fVmmRead))) {
+        for(iRun = 0; iRun < pObRunList->cRun; iRun++) {
+            pRun = pObRunList->pRun + iRun;
+            if(pRun->iPte + pRun->cPte <= iPteBase) { continue; }
+            if(pRun->iPte >= iPteBase + cMEMs) { break; }
+            iEnd = min(pRun->iPte + pRun->cPte, iPteBase + cMEMs) - iPteBase;
+            for(i = max(pRun->iPte, iPteBase) - iPteBase; i < iEnd; i++) {
+                pMEMs[i].qwA = pRun->va + ((iPteBase + i - pRun->iPte) << 12);
                 fReadSharedCacheMap = TRUE;
             }
         }
+        Ob_DECREF_NULL(&pObRunList);
         if(fReadSharedCacheMap) {
             VmmReadScatterVirtual(H, PVMM_PROCESS_SYSTEM, ppMEMs, cMEMs, fVmmRead);
         }
@@ -959,20 +1116,21 @@ DWORD VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ VMM_HANDLE H, _In_ POB_VMM
     // Read from _DATA
     if((tp & VMMWINOBJ_FILE_TP_DATA) && pFile->pData && pFile->pData->cSUBSECTION) {
         pCA = pFile->pData;
-        iSS = 0;
         for(i = 0; i < cMEMs; i++) {
-            iPte = i + ((cbOffset - oA) >> 12);
-            pMEM = pMEMs + i;
-            if(pMEM->f) { continue; }
-            // move to correct subsection:
-            while((iPte >= pCA->pSUBSECTION[iSS].dwStartingSector + pCA->pSUBSECTION[iSS].dwPtesInSubsection) && (iSS < pCA->cSUBSECTION)) {
-                iSS++;
-            }
+            if(!pMEMs[i].f) { pMEMs[i].qwA = 0; }
+        }
+        for(iSS = 0; iSS < pCA->cSUBSECTION; iSS++) {
             pSS = pCA->pSUBSECTION + iSS;
-            if((iPte < pSS->dwStartingSector) || (iPte >= pSS->dwStartingSector + pSS->dwPtesInSubsection)) { break; }
-            // fetch pte:
-            pMEM->qwA = VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsection(H, PVMM_PROCESS_SYSTEM, pSS->vaSubsectionBase, (iPte - pSS->dwStartingSector), fVmmRead);
-            fReadDataSubsection = TRUE;
+            iPteStart = max(pSS->dwStartingSector, iPteBase);
+            iPteEnd = min((QWORD)pSS->dwStartingSector + pSS->dwPtesInSubsection, iPteBase + cMEMs);
+            if(iPteStart >= iPteEnd) { continue; }
+            VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsectionRange(H, PVMM_PROCESS_SYSTEM, pSS->vaSubsectionBase, iPteStart - pSS->dwStartingSector, (DWORD)(iPteEnd - iPteStart), pqwPte + (iPteStart - iPteBase), fVmmRead);
+            for(i = iPteStart - iPteBase; i < iPteEnd - iPteBase; i++) {
+                if(!pMEMs[i].f && pqwPte[i]) {
+                    pMEMs[i].qwA = pqwPte[i];
+                    fReadDataSubsection = TRUE;
+                }
+            }
         }
         if(fReadDataSubsection) {
             VmmReadScatterVirtual(H, PVMM_PROCESS_SYSTEM, ppMEMs, cMEMs, fVmmRead | VMM_FLAG_ALTADDR_VA_PTE);
@@ -983,12 +1141,16 @@ DWORD VmmWinObjFile_ReadSubsectionAndSharedCache(_In_ VMM_HANDLE H, _In_ POB_VMM
         pCA = pFile->pImage;
         pSS = pCA->pSUBSECTION + iSubsection;
         for(i = 0; i < cMEMs; i++) {
-            iPte = i + ((cbOffset - oA) >> 12);
-            pMEM = pMEMs + i;
-            if(pMEM->f) { continue; }
-            pMEM->qwA = (iPte < pSS->dwPtesInSubsection) ? VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsection(H, PVMM_PROCESS_SYSTEM, pSS->vaSubsectionBase, iPte, fVmmRead) : 0;
-            if(pMEM->qwA) {
-                fReadImageSubsection = TRUE;
+            if(!pMEMs[i].f) { pMEMs[i].qwA = 0; }
+        }
+        iPteEnd = min(pSS->dwPtesInSubsection, iPteBase + cMEMs);
+        if(iPteBase < iPteEnd) {
+            VmmWinObjFile_ReadSubsectionAndSharedCache_GetPteSubsectionRange(H, PVMM_PROCESS_SYSTEM, pSS->vaSubsectionBase, iPteBase, (DWORD)(iPteEnd - iPteBase), pqwPte, fVmmRead);
+            for(i = 0; i < iPteEnd - iPteBase; i++) {
+                if(!pMEMs[i].f && pqwPte[i]) {
+                    pMEMs[i].qwA = pqwPte[i];
+                    fReadImageSubsection = TRUE;
+                }
             }
         }
         if(fReadImageSubsection) {
@@ -9,6 +9,7 @@
 #include "vmm.h"
 
 #define VMMWINOBJ_FILE_OBJECT_SUBSECTION_MAX    0x20
+#define VMMWINOBJ_FILE_OBJECT_VACB_MAX          0x4000
 
 typedef enum {
     VMMWINOBJ_TYPE_NONE = 0,
@@ -29,6 +30,20 @@ typedef struct tVMMWINOBJ_FILE_SUBSECTION {
     DWORD dwPtesInSubsection;
 } VMMWINOBJ_FILE_SUBSECTION, *PVMMWINOBJ_FILE_SUBSECTION;
 
+typedef struct tVMMWINOBJ_VACB_RUN {
+    QWORD iPte;                     // first file page in run
+    QWORD cPte;                     // number of file pages in run
+    QWORD va;                       // virtual address of first page in run
+} VMMWINOBJ_VACB_RUN, *PVMMWINOBJ_VACB_RUN;
+
+typedef struct tdOB_VMMWINOBJ_VACB_RUNLIST {
+    OB ObHdr;
+    QWORD tcRefreshMEM;             // H->vmm.tcRefreshMEM at creation time
+    BOOL fComplete;                 // all _VACBs read successfully (cacheable)
+    DWORD cRun;
+    VMMWINOBJ_VACB_RUN pRun[];      // sorted by iPte
+} OB_VMMWINOBJ_VACB_RUNLIST, *POB_VMMWINOBJ_VACB_RUNLIST;
+
 typedef struct tdOB_VMMWINOBJ_SHARED_CACHE_MAP {
     OB ObHdr;
     QWORD va;
@@ -36,6 +51,7 @@ typedef struct tdOB_VMMWINOBJ_SHARED_CACHE_MAP {
     QWORD cbFileSize;
     QWORD cbFileSizeValid;
     QWORD cbSectionSize;
+    POB_VMMWINOBJ_VACB_RUNLIST pObRunList;  // lazy init - file offset -> va
 } OB_VMMWINOBJ_SHARED_CACHE_MAP, *POB_VMMWINOBJ_SHARED_CACHE_MAP;
 
 typedef struct tdOB_VMMWINOBJ_CONTROL_AREA {
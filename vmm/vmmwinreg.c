@@ -13,6 +13,11 @@
 #include "charutil.h"
 #include "util.h"
 #include "vmmwin.h"
+#ifdef LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* LINUX */
 
 #define REG_SIGNATURE_HBIN      0x6e696268
 
@@ -47,6 +52,8 @@ typedef struct tdVMMWIN_REGISTRY_OFFSET {
 
 typedef struct tdVMMWIN_REGISTRY_CONTEXT {
     POB_CONTAINER pObCHiveMap;
+    POB_CACHEMAP pObCacheMapPath;   // full path -> OB_REGISTRY_PATHENTRY
+    DWORD dwPathCacheGeneration;    // incremented on each registry refresh
     CRITICAL_SECTION LockUpdate;
     VMMWIN_REGISTRY_OFFSET Offset;
 } VMMWIN_REGISTRY_CONTEXT, *PVMMWIN_REGISTRY_CONTEXT;
@@ -679,13 +686,20 @@ cleanup:
 // Enumeration/ListTraversal is done both 'efficiently' and 'lazy' on-demand.
 //-----------------------------------------------------------------------------
 
+VOID VmmWinReg_Index_Close(_In_opt_ struct tdVMMWINREG_INDEX *pIndex);
+
 VOID VmmWinReg_CallbackCleanup_ObRegistryHive(POB_REGISTRY_HIVE pOb)
 {
     DeleteCriticalSection(&pOb->LockUpdate);
     Ob_DECREF(pOb->Snapshot.pmKeyHash);
     Ob_DECREF(pOb->Snapshot.pmKeyOffset);
-    LocalFree(pOb->Snapshot._DUAL[0].pb);
-    LocalFree(pOb->Snapshot._DUAL[1].pb);
+    if(pOb->Snapshot.pIndex) {
+        // hive snapshot data points into the mapped index
+        VmmWinReg_Index_Close(pOb->Snapshot.pIndex);
+    } else {
+        LocalFree(pOb->Snapshot._DUAL[0].pb);
+        LocalFree(pOb->Snapshot._DUAL[1].pb);
+    }
 }
 
 /*
@@ -979,6 +993,9 @@ POB_MAP VmmWinReg_HiveMap(_In_ VMM_HANDLE H)
 
 _Success_(return)
 BOOL VmmWinReg_KeyInitialize(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive);
+_Success_(return)
+BOOL VmmWinReg_Index_Load(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive);
+VOID VmmWinReg_Index_Save(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive);
 
 /*
 * Ensure a registry hive snapshot is taken of the hive and stored within the
@@ -986,6 +1003,8 @@ BOOL VmmWinReg_KeyInitialize(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive);
 * memory and performing analysis on it to generate a key tree for convenient
 * parsing of the keys. Any keys derived from the hive must never be used after
 * Ob_DECREF has been called on the hive.
+* If a registry index directory is configured a previously saved snapshot and
+* key index is memory-mapped instead; keys are then created on-demand.
 * -- H
 * -- pHive
 * -- return
@@ -1008,12 +1027,18 @@ BOOL VmmWinReg_HiveSnapshotEnsure(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHiv
     pHive->Snapshot.pmKeyHash = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB);
     pHive->Snapshot.pmKeyOffset = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB);
     if(!pHive->Snapshot.pmKeyHash || !pHive->Snapshot.pmKeyOffset) { goto fail; }
+    if(VmmWinReg_Index_Load(H, pHive)) {
+        pHive->Snapshot.fInitialized = TRUE;
+        LeaveCriticalSection(&pHive->LockUpdate);
+        return TRUE;
+    }
     for(i = 0; i < 2; i++) {
         pHive->Snapshot._DUAL[i].cb = pHive->_DUAL[i].cb;
         if(!(pHive->Snapshot._DUAL[i].pb = LocalAlloc(0, pHive->Snapshot._DUAL[i].cb))) { goto fail; }
         VmmWinReg_HiveReadEx(H, pHive, (i ? 0x80000000 : 0), pHive->Snapshot._DUAL[i].pb, pHive->Snapshot._DUAL[i].cb, &cbRead, VMM_FLAG_ZEROPAD_ON_FAIL);
     }
     if(!VmmWinReg_KeyInitialize(H, pHive)) { goto fail; }
+    VmmWinReg_Index_Save(H, pHive);
     pHive->Snapshot.fInitialized = TRUE;
     LeaveCriticalSection(&pHive->LockUpdate);
     return TRUE;
@@ -1030,6 +1055,105 @@ fail:
 
 
 
+//-----------------------------------------------------------------------------
+// REGISTRY FULL PATH LOOKUP CACHE FUNCTIONALITY BELOW:
+// Plugins and the forensic mode repeatedly resolve the same full registry
+// paths (HKLM\..., HKU\..., by-hive\0x...). Resolved hives, keys and values
+// are kept in a bounded ObCacheMap keyed on the path hash. Entries hold a
+// reference to the hive (which keeps any derived keys and values valid) and
+// are invalidated on registry refresh. Failed lookups are never cached.
+//-----------------------------------------------------------------------------
+
+#define VMMWINREG_PATHCACHE_MAX_ENTRIES         0x400
+#define VMMWINREG_PATHCACHE_TP_HIVE             1
+#define VMMWINREG_PATHCACHE_TP_KEY              2
+#define VMMWINREG_PATHCACHE_TP_VALUE            3
+
+typedef struct tdOB_REGISTRY_PATHENTRY {
+    OB ObHdr;
+    POB_REGISTRY_HIVE pObHive;
+    POB_REGISTRY_KEY pObKey;                // TP_KEY only
+    POB_REGISTRY_VALUE pObValue;            // TP_VALUE only
+    CHAR uszPathKeyValue[MAX_PATH];         // TP_HIVE only
+    CHAR uszPathFull[MAX_PATH];
+} OB_REGISTRY_PATHENTRY, *POB_REGISTRY_PATHENTRY;
+
+VOID VmmWinReg_CallbackCleanup_ObRegPathEntry(POB_REGISTRY_PATHENTRY pOb)
+{
+    Ob_DECREF(pOb->pObValue);
+    Ob_DECREF(pOb->pObKey);
+    Ob_DECREF(pOb->pObHive);
+}
+
+BOOL VmmWinReg_PathCache_CallbackValidEntry(_In_ VMM_HANDLE H, _Inout_ PQWORD qwContext, _In_ QWORD qwKey, _In_ PVOID pvObject)
+{
+    return H->vmm.pRegistry && (*qwContext == H->vmm.pRegistry->dwPathCacheGeneration);
+}
+
+/*
+* Retrieve the current path cache generation. The generation must be fetched
+* before the lookup is made and then be supplied to VmmWinReg_PathCache_Push()
+* so that lookups racing a registry refresh are not cached as valid.
+* -- H
+* -- return
+*/
+DWORD VmmWinReg_PathCache_Generation(_In_ VMM_HANDLE H)
+{
+    return H->vmm.pRegistry ? H->vmm.pRegistry->dwPathCacheGeneration : 0;
+}
+
+/*
+* Retrieve a cached path lookup entry.
+* CALLER DECREF: return
+* -- H
+* -- uszPathFull
+* -- tp = VMMWINREG_PATHCACHE_TP_*
+* -- return
+*/
+_Success_(return != NULL)
+POB_REGISTRY_PATHENTRY VmmWinReg_PathCache_Get(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _In_ DWORD tp)
+{
+    POB_REGISTRY_PATHENTRY pObEntry;
+    if(!H->vmm.pRegistry) { return NULL; }
+    pObEntry = ObCacheMap_GetByKey(H->vmm.pRegistry->pObCacheMapPath, (CharUtil_Hash64U(uszPathFull, FALSE) << 2) | tp);
+    if(pObEntry && !strcmp(pObEntry->uszPathFull, uszPathFull)) {
+        return pObEntry;
+    }
+    Ob_DECREF(pObEntry);
+    return NULL;
+}
+
+/*
+* Push a successful path lookup into the path cache. Paths too long to be
+* stored are silently not cached.
+* -- H
+* -- uszPathFull
+* -- tp = VMMWINREG_PATHCACHE_TP_*
+* -- dwGeneration = generation as retrieved before the lookup was made.
+* -- pHive
+* -- pKeyOpt
+* -- pValueOpt
+* -- uszPathKeyValueOpt
+*/
+VOID VmmWinReg_PathCache_Push(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _In_ DWORD tp, _In_ DWORD dwGeneration, _In_ POB_REGISTRY_HIVE pHive, _In_opt_ POB_REGISTRY_KEY pKeyOpt, _In_opt_ POB_REGISTRY_VALUE pValueOpt, _In_opt_ LPCSTR uszPathKeyValueOpt)
+{
+    POB_REGISTRY_PATHENTRY pObEntry;
+    if(!H->vmm.pRegistry || (strlen(uszPathFull) >= MAX_PATH)) { return; }
+    pObEntry = Ob_AllocEx(H, OB_TAG_REG_PATH, LMEM_ZEROINIT, sizeof(OB_REGISTRY_PATHENTRY), (OB_CLEANUP_CB)VmmWinReg_CallbackCleanup_ObRegPathEntry, NULL);
+    if(!pObEntry) { return; }
+    pObEntry->pObHive = Ob_INCREF(pHive);
+    pObEntry->pObKey = Ob_INCREF(pKeyOpt);
+    pObEntry->pObValue = Ob_INCREF(pValueOpt);
+    if(uszPathKeyValueOpt) {
+        strncpy_s(pObEntry->uszPathKeyValue, _countof(pObEntry->uszPathKeyValue), uszPathKeyValueOpt, _TRUNCATE);
+    }
+    strncpy_s(pObEntry->uszPathFull, _countof(pObEntry->uszPathFull), uszPathFull, _TRUNCATE);
+    ObCacheMap_Push(H->vmm.pRegistry->pObCacheMapPath, (CharUtil_Hash64U(uszPathFull, FALSE) << 2) | tp, pObEntry, dwGeneration);
+    Ob_DECREF(pObEntry);
+}
+
+
+
 //-----------------------------------------------------------------------------
 // EXPORTED INITIALIZATION/REFRESH/CLOSE FUNCTIONALITY BELOW:
 //-----------------------------------------------------------------------------
@@ -1039,11 +1163,13 @@ VOID VmmWinReg_Initialize(_In_ VMM_HANDLE H)
     PVMMWIN_REGISTRY_CONTEXT ctx;
     if(!(ctx = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWIN_REGISTRY_CONTEXT)))) { goto fail; }
     if(!(ctx->pObCHiveMap = ObContainer_New())) { goto fail; }
+    if(!(ctx->pObCacheMapPath = ObCacheMap_New(H, VMMWINREG_PATHCACHE_MAX_ENTRIES, VmmWinReg_PathCache_CallbackValidEntry, OB_CACHEMAP_FLAGS_OBJECT_OB))) { goto fail; }
     InitializeCriticalSection(&ctx->LockUpdate);
     H->vmm.pRegistry = ctx;
     return;
 fail:
     if(ctx) {
+        Ob_DECREF(ctx->pObCacheMapPath);
         Ob_DECREF(ctx->pObCHiveMap);
         LocalFree(ctx);
     }
@@ -1052,6 +1178,7 @@ fail:
 VOID VmmWinReg_Close(_In_ VMM_HANDLE H)
 {
     if(H->vmm.pRegistry) {
+        Ob_DECREF(H->vmm.pRegistry->pObCacheMapPath);
         Ob_DECREF(H->vmm.pRegistry->pObCHiveMap);
         DeleteCriticalSection(&H->vmm.pRegistry->LockUpdate);
         LocalFree(H->vmm.pRegistry);
@@ -1063,6 +1190,8 @@ VOID VmmWinReg_Refresh(_In_ VMM_HANDLE H)
 {
     if(H->vmm.pRegistry) {
         ObContainer_SetOb(H->vmm.pRegistry->pObCHiveMap, NULL);
+        InterlockedIncrement(&H->vmm.pRegistry->dwPathCacheGeneration);
+        ObCacheMap_Clear(H->vmm.pRegistry->pObCacheMapPath);
     }
 }
 
@@ -1704,23 +1833,516 @@ success:
 }
 
 
-
 //-----------------------------------------------------------------------------
-// EXTERNAL REGISTRY KEY AND VALUE FUNCTIONALITY:
+// REGISTRY HIVE KEY INDEX FUNCTIONALITY BELOW:
+// Building the key tree requires a full copy of the hive and a walk of all its
+// cells. If a registry index directory is configured (-registry-index) the
+// resulting snapshot is saved to disk together with a key index. Later runs
+// over the same memory dump memory-map the saved snapshot and create the key
+// objects on-demand from the index. Index files are only used for non-volatile
+// memory; they are tied to the device, the hive address, and the contents of
+// the hive base pages.
+// File layout (all sections 8-byte aligned):
+//   [header page][hive static data][hive volatile data][keys][keys sorted by
+//   cell offset][keys sorted by hash][child cell offsets]
 //-----------------------------------------------------------------------------
 
+#define VMMWINREG_INDEX_MAGIC           0x58444952          // 'RIDX'
+#define VMMWINREG_INDEX_VERSION         1
+#define VMMWINREG_INDEX_MAX_SIZE        0x40000000
+
+typedef struct tdVMMWINREG_INDEX_HDR {
+    DWORD dwMagic;
+    DWORD dwVersion;
+    QWORD qwIdentity;
+    QWORD cbFile;
+    BYTE pbHashBase[32];        // sha256 of hive base pages at index creation
+    DWORD cbDual[2];
+    QWORD oDual[2];             // hive snapshot data (page aligned)
+    DWORD cKey;
+    DWORD cChild;
+    QWORD oKey;                 // VMMWINREG_INDEX_KEY[cKey] in key creation order (0=ROOT, 1=ORPHAN)
+    QWORD oOffset;              // VMMWINREG_INDEX_OFFSET[cKey] sorted by cell offset
+    QWORD oHash;                // VMMWINREG_INDEX_HASH[cKey] sorted by key hash
+    QWORD oChild;               // DWORD[cChild] child cell offsets (parent/child adjacency)
+} VMMWINREG_INDEX_HDR, *PVMMWINREG_INDEX_HDR;
+
+typedef struct tdVMMWINREG_INDEX_KEY {
+    DWORD oCell;
+    DWORD dwCellHead;
+    WORD cbCell;
+    WORD iSuffix;
+    DWORD iChild;
+    DWORD cChild;
+    DWORD _Filler;
+    QWORD qwHashKeyParent;
+    QWORD qwHashKeyThis;
+} VMMWINREG_INDEX_KEY, *PVMMWINREG_INDEX_KEY;
+
+typedef struct tdVMMWINREG_INDEX_OFFSET {
+    DWORD oCell;
+    DWORD iKey;
+} VMMWINREG_INDEX_OFFSET, *PVMMWINREG_INDEX_OFFSET;
+
+typedef struct tdVMMWINREG_INDEX_HASH {
+    QWORD qwHash;
+    DWORD iKey;
+    DWORD _Filler;
+} VMMWINREG_INDEX_HASH, *PVMMWINREG_INDEX_HASH;
+
+typedef struct tdVMMWINREG_INDEX {
+    PBYTE pb;                   // memory-mapped index file
+    QWORD cb;
+    PVMMWINREG_INDEX_HDR pHdr;
+    PVMMWINREG_INDEX_KEY pKey;
+    PVMMWINREG_INDEX_OFFSET pOffset;
+    PVMMWINREG_INDEX_HASH pHash;
+    PDWORD pChild;
+} VMMWINREG_INDEX, *PVMMWINREG_INDEX;
+
 /*
-* Retrieve registry hive and key/value path from a "full" path starting with:
-* '0x...', 'by-hive\0x...' or 'HKLM\'
-* CALLER DECREF: *ppObHive
+* Retrieve the index file path of a hive. Index files are only used if a
+* registry index directory is configured and the memory is non-volatile.
 * -- H
-* -- uszPathFull
-* -- ppObHive
-* -- uszPathKeyValue
+* -- pHive
+* -- uszPath
 * -- return
 */
 _Success_(return)
-BOOL VmmWinReg_PathHiveGetByFullPath(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _Out_ POB_REGISTRY_HIVE *ppHive, _Out_writes_(MAX_PATH) LPSTR uszPathKeyValue)
+BOOL VmmWinReg_Index_GetPath(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _Out_writes_(MAX_PATH) LPSTR uszPath)
+{
+    SIZE_T cch;
+    QWORD qwIdentity;
+    if(!H->cfg.szRegistryIndexPath[0] || H->dev.fVolatile) { return FALSE; }
+    qwIdentity = CharUtil_Hash64U(H->dev.szDevice, FALSE);
+    qwIdentity = ((qwIdentity >> 13) | (qwIdentity << 51)) + H->dev.paMax;
+    qwIdentity = ((qwIdentity >> 13) | (qwIdentity << 51)) + pHive->vaCMHIVE;
+    cch = strlen(H->cfg.szRegistryIndexPath);
+    return _snprintf_s(uszPath, MAX_PATH, _TRUNCATE, "%s%svmm-regindex-%016llx-%016llx.bin",
+        H->cfg.szRegistryIndexPath,
+        ((H->cfg.szRegistryIndexPath[cch - 1] == '\\') || (H->cfg.szRegistryIndexPath[cch - 1] == '/')) ? "" : "/",
+        qwIdentity,
+        pHive->vaCMHIVE
+    ) > 0;
+}
+
+/*
+* Hash the hive base pages as read from memory. Used to verify that an index
+* file still belongs to the hive.
+* -- H
+* -- pHive
+* -- pbHash
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinReg_Index_HashBase(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _Out_writes_(32) PBYTE pbHash)
+{
+    BOOL fResult;
+    DWORD i, cbRead;
+    PBYTE pb;
+    if(!(pb = LocalAlloc(LMEM_ZEROINIT, 0x2000))) { return FALSE; }
+    for(i = 0; i < 2; i++) {
+        if(pHive->_DUAL[i].cb) {
+            VmmWinReg_HiveReadEx(H, pHive, (i ? 0x80000000 : 0), pb + i * 0x1000ULL, min(0x1000, pHive->_DUAL[i].cb), &cbRead, VMM_FLAG_ZEROPAD_ON_FAIL);
+        }
+    }
+    fResult = Util_HashSHA256(pb, 0x2000, pbHash);
+    LocalFree(pb);
+    return fResult;
+}
+
+/*
+* Close a memory-mapped index file.
+* -- pIndex
+*/
+VOID VmmWinReg_Index_Close(_In_opt_ PVMMWINREG_INDEX pIndex)
+{
+    if(!pIndex) { return; }
+#ifdef _WIN32
+    UnmapViewOfFile(pIndex->pb);
+#endif /* _WIN32 */
+#ifdef LINUX
+    munmap(pIndex->pb, pIndex->cb);
+#endif /* LINUX */
+    LocalFree(pIndex);
+}
+
+/*
+* Memory-map an index file read-only.
+* CALLER VmmWinReg_Index_Close: return
+* -- uszPath
+* -- return
+*/
+PVMMWINREG_INDEX VmmWinReg_Index_Open(_In_ LPCSTR uszPath)
+{
+    PVMMWINREG_INDEX pIndex = NULL;
+#ifdef _WIN32
+    HANDLE hFile = INVALID_HANDLE_VALUE, hMap = NULL;
+    LARGE_INTEGER qwFileSize;
+    if(!(pIndex = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINREG_INDEX)))) { goto fail; }
+    hFile = CreateFileA(uszPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(hFile == INVALID_HANDLE_VALUE) { goto fail; }
+    if(!GetFileSizeEx(hFile, &qwFileSize) || (qwFileSize.QuadPart < 0x1000) || (qwFileSize.QuadPart > VMMWINREG_INDEX_MAX_SIZE)) { goto fail; }
+    pIndex->cb = qwFileSize.QuadPart;
+    if(!(hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL))) { goto fail; }
+    pIndex->pb = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+fail:
+    if(hMap) { CloseHandle(hMap); }
+    if(hFile != INVALID_HANDLE_VALUE) { CloseHandle(hFile); }
+#endif /* _WIN32 */
+#ifdef LINUX
+    int hFile = -1;
+    struct stat st;
+    PVOID pvMap;
+    if(!(pIndex = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMWINREG_INDEX)))) { goto fail; }
+    if((hFile = open(uszPath, O_RDONLY)) < 0) { goto fail; }
+    if(fstat(hFile, &st) || (st.st_size < 0x1000) || (st.st_size > VMMWINREG_INDEX_MAX_SIZE)) { goto fail; }
+    pIndex->cb = st.st_size;
+    pvMap = mmap(NULL, pIndex->cb, PROT_READ, MAP_PRIVATE, hFile, 0);
+    pIndex->pb = (pvMap == MAP_FAILED) ? NULL : (PBYTE)pvMap;
+fail:
+    if(hFile >= 0) { close(hFile); }
+#endif /* LINUX */
+    if(pIndex && !pIndex->pb) {
+        LocalFree(pIndex);
+        pIndex = NULL;
+    }
+    return pIndex;
+}
+
+/*
+* Check that an index file section lies within the mapped file.
+*/
+#define VMMWINREG_INDEX_IN_RANGE(pIdx, oSection, cbSection)     (!((oSection) & 7) && ((oSection) <= (pIdx)->cb) && ((QWORD)(cbSection) <= (pIdx)->cb - (oSection)))
+
+/*
+* Assign the child key offsets of a key from the index.
+* -- pIndex
+* -- pKey
+* -- iKey
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinReg_Index_KeySetChild(_In_ PVMMWINREG_INDEX pIndex, _In_ POB_REGISTRY_KEY pKey, _In_ DWORD iKey)
+{
+    PVMMWINREG_INDEX_KEY pe = pIndex->pKey + iKey;
+    if((QWORD)pe->iChild + pe->cChild > pIndex->pHdr->cChild) { return FALSE; }
+    if(!pe->cChild) { return TRUE; }
+    if(!(pKey->Child.po = LocalAlloc(0, pe->cChild * sizeof(DWORD)))) { return FALSE; }
+    memcpy(pKey->Child.po, pIndex->pChild + pe->iChild, pe->cChild * sizeof(DWORD));
+    pKey->Child.c = pe->cChild;
+    pKey->Child.cMax = pe->cChild;
+    return TRUE;
+}
+
+/*
+* Create a registry key object on-demand from a memory-mapped index entry.
+* CALLER DECREF: return
+* -- H
+* -- pHive
+* -- iKey
+* -- return
+*/
+POB_REGISTRY_KEY VmmWinReg_Index_KeyCreate(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ DWORD iKey)
+{
+    PVMMWINREG_INDEX pIndex = pHive->Snapshot.pIndex;
+    PVMMWINREG_INDEX_KEY pe;
+    PREG_CM_KEY_NODE pnk;
+    POB_REGISTRY_KEY pObKey = NULL;
+    if((iKey < 2) || (iKey >= pIndex->pHdr->cKey)) { return NULL; }     // ROOT and ORPHAN always exist
+    pe = pIndex->pKey + iKey;
+    if(!VmmWinReg_KeyValidateCellSize(pHive, pe->oCell, REG_CM_KEY_NODE_SIZEOF + 4, 0x1000)) { return NULL; }
+    pnk = (PREG_CM_KEY_NODE)(pHive->Snapshot._DUAL[REG_CELL_SV(pe->oCell)].pb + REG_CELL_ORAW(pe->oCell) + 4);
+    if(pnk->Signature != REG_CM_KEY_SIGNATURE_KEYNODE) { return NULL; }
+    EnterCriticalSection(&pHive->LockUpdate);
+    if((pObKey = ObMap_GetByKey(pHive->Snapshot.pmKeyOffset, pe->oCell))) { goto finish; }     // created by other thread
+    if(!(pObKey = Ob_AllocEx(H, OB_TAG_REG_KEY, LMEM_ZEROINIT, sizeof(OB_REGISTRY_KEY), (OB_CLEANUP_CB)VmmWinReg_CallbackCleanup_ObRegKey, NULL))) { goto finish; }
+    pObKey->dwCellHead = pe->dwCellHead;
+    pObKey->iSuffix = pe->iSuffix;
+    pObKey->oCell = pe->oCell;
+    pObKey->cbCell = pe->cbCell;
+    pObKey->pKey = pnk;
+    pObKey->qwHashKeyParent = pe->qwHashKeyParent;
+    pObKey->qwHashKeyThis = pe->qwHashKeyThis;
+    if(!VmmWinReg_Index_KeySetChild(pIndex, pObKey, iKey) || !ObMap_Push(pHive->Snapshot.pmKeyOffset, pObKey->oCell, pObKey)) {
+        Ob_DECREF_NULL(&pObKey);
+        goto finish;
+    }
+    ObMap_Push(pHive->Snapshot.pmKeyHash, pObKey->qwHashKeyThis, pObKey);
+finish:
+    LeaveCriticalSection(&pHive->LockUpdate);
+    return pObKey;
+}
+
+/*
+* Retrieve a registry key by its cell offset from the key maps or, if not yet
+* created, from the memory-mapped index.
+* CALLER DECREF: return
+* -- H
+* -- pHive
+* -- oCell
+* -- return
+*/
+POB_REGISTRY_KEY VmmWinReg_KeyGetByOffsetInternal(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ DWORD oCell)
+{
+    POB_REGISTRY_KEY pObKey;
+    PVMMWINREG_INDEX pIndex = pHive->Snapshot.pIndex;
+    PVMMWINREG_INDEX_OFFSET pe;
+    if((pObKey = ObMap_GetByKey(pHive->Snapshot.pmKeyOffset, oCell)) || !pIndex) { return pObKey; }
+    pe = Util_qfind(oCell, pIndex->pHdr->cKey, pIndex->pOffset, sizeof(VMMWINREG_INDEX_OFFSET), Util_qfind_CmpFindTableDWORD);
+    return pe ? VmmWinReg_Index_KeyCreate(H, pHive, pe->iKey) : NULL;
+}
+
+/*
+* Retrieve a registry key by its hash from the key maps or, if not yet created,
+* from the memory-mapped index.
+* CALLER DECREF: return
+* -- H
+* -- pHive
+* -- qwHash
+* -- return
+*/
+POB_REGISTRY_KEY VmmWinReg_KeyGetByHashInternal(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ QWORD qwHash)
+{
+    POB_REGISTRY_KEY pObKey;
+    PVMMWINREG_INDEX pIndex = pHive->Snapshot.pIndex;
+    PVMMWINREG_INDEX_HASH pe;
+    if((pObKey = ObMap_GetByKey(pHive->Snapshot.pmKeyHash, qwHash)) || !pIndex) { return pObKey; }
+    pe = Util_qfind(qwHash, pIndex->pHdr->cKey, pIndex->pHash, sizeof(VMMWINREG_INDEX_HASH), Util_qfind_CmpFindTableQWORD);
+    return pe ? VmmWinReg_Index_KeyCreate(H, pHive, pe->iKey) : NULL;
+}
+
+/*
+* Retrieve the number of registry keys in a hive snapshot.
+* -- pHive
+* -- return
+*/
+DWORD VmmWinReg_KeyCountInternal(_In_ POB_REGISTRY_HIVE pHive)
+{
+    return pHive->Snapshot.pIndex ? pHive->Snapshot.pIndex->pHdr->cKey : ObMap_Size(pHive->Snapshot.pmKeyOffset);
+}
+
+/*
+* Retrieve a registry key by its index (0 = ROOT, 1 = ORPHAN).
+* CALLER DECREF: return
+* -- H
+* -- pHive
+* -- iKey
+* -- return
+*/
+POB_REGISTRY_KEY VmmWinReg_KeyGetByIndexInternal(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ DWORD iKey)
+{
+    PVMMWINREG_INDEX pIndex = pHive->Snapshot.pIndex;
+    if(!pIndex || (iKey < 2)) {
+        return ObMap_GetByIndex(pHive->Snapshot.pmKeyOffset, iKey);
+    }
+    if(iKey >= pIndex->pHdr->cKey) { return NULL; }
+    return VmmWinReg_KeyGetByOffsetInternal(H, pHive, pIndex->pKey[iKey].oCell);
+}
+
+/*
+* Try to load a hive snapshot and key index from a previously saved index file.
+* On success the snapshot data points into the memory-mapped file and only the
+* ROOT and ORPHAN keys are created; other keys are created on-demand.
+* NB! must be called with pHive->LockUpdate held and with empty key maps.
+* -- H
+* -- pHive
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinReg_Index_Load(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive)
+{
+    BOOL f;
+    DWORD i;
+    CHAR uszPath[MAX_PATH];
+    BYTE pbHashBase[32];
+    POB_REGISTRY_KEY pObKey = NULL;
+    PVMMWINREG_INDEX pIndex = NULL;
+    PVMMWINREG_INDEX_HDR pHdr;
+    if(!VmmWinReg_Index_GetPath(H, pHive, uszPath)) { return FALSE; }
+    if(!(pIndex = VmmWinReg_Index_Open(uszPath))) { return FALSE; }
+    // 1: validate header
+    pHdr = (PVMMWINREG_INDEX_HDR)pIndex->pb;
+    f = (pHdr->dwMagic == VMMWINREG_INDEX_MAGIC) &&
+        (pHdr->dwVersion == VMMWINREG_INDEX_VERSION) &&
+        (pHdr->cbFile == pIndex->cb) &&
+        (pHdr->cbDual[0] == pHive->_DUAL[0].cb) &&
+        (pHdr->cbDual[1] == pHive->_DUAL[1].cb) &&
+        (pHdr->cKey >= 2) &&
+        VMMWINREG_INDEX_IN_RANGE(pIndex, pHdr->oDual[0], pHdr->cbDual[0]) &&
+        VMMWINREG_INDEX_IN_RANGE(pIndex, pHdr->oDual[1], pHdr->cbDual[1]) &&
+        VMMWINREG_INDEX_IN_RANGE(pIndex, pHdr->oKey, (QWORD)pHdr->cKey * sizeof(VMMWINREG_INDEX_KEY)) &&
+        VMMWINREG_INDEX_IN_RANGE(pIndex, pHdr->oOffset, (QWORD)pHdr->cKey * sizeof(VMMWINREG_INDEX_OFFSET)) &&
+        VMMWINREG_INDEX_IN_RANGE(pIndex, pHdr->oHash, (QWORD)pHdr->cKey * sizeof(VMMWINREG_INDEX_HASH)) &&
+        VMMWINREG_INDEX_IN_RANGE(pIndex, pHdr->oChild, (QWORD)pHdr->cChild * sizeof(DWORD)) &&
+        VmmWinReg_Index_HashBase(H, pHive, pbHashBase) &&
+        !memcmp(pHdr->pbHashBase, pbHashBase, sizeof(pbHashBase));
+    if(!f) {
+        VmmLog(H, MID_REGISTRY, LOGLEVEL_5_DEBUG, "INDEX MISMATCH: Hive=%016llx File='%s'", pHive->vaCMHIVE, uszPath);
+        goto fail;
+    }
+    pIndex->pHdr = pHdr;
+    pIndex->pKey = (PVMMWINREG_INDEX_KEY)(pIndex->pb + pHdr->oKey);
+    pIndex->pOffset = (PVMMWINREG_INDEX_OFFSET)(pIndex->pb + pHdr->oOffset);
+    pIndex->pHash = (PVMMWINREG_INDEX_HASH)(pIndex->pb + pHdr->oHash);
+    pIndex->pChild = (PDWORD)(pIndex->pb + pHdr->oChild);
+    // 2: assign snapshot data
+    pHive->Snapshot.pIndex = pIndex;
+    for(i = 0; i < 2; i++) {
+        pHive->Snapshot._DUAL[i].cb = pHdr->cbDual[i];
+        pHive->Snapshot._DUAL[i].pb = pIndex->pb + pHdr->oDual[i];
+    }
+    // 3: create ROOT and ORPHAN keys up-front
+    if(!VmmWinReg_KeyInitializeRootKey(H, pHive)) { goto fail; }
+    for(i = 0; i < 2; i++) {
+        f = (pObKey = ObMap_GetByIndex(pHive->Snapshot.pmKeyOffset, i)) &&
+            (pObKey->oCell == pIndex->pKey[i].oCell) &&
+            (pObKey->qwHashKeyThis == pIndex->pKey[i].qwHashKeyThis) &&
+            VmmWinReg_Index_KeySetChild(pIndex, pObKey, i);
+        Ob_DECREF_NULL(&pObKey);
+        if(!f) { goto fail; }
+    }
+    VmmLog(H, MID_REGISTRY, LOGLEVEL_5_DEBUG, "INDEX LOAD: Hive=%016llx Keys=%i File='%s'", pHive->vaCMHIVE, pHdr->cKey, uszPath);
+    return TRUE;
+fail:
+    ObMap_Clear(pHive->Snapshot.pmKeyHash);
+    ObMap_Clear(pHive->Snapshot.pmKeyOffset);
+    ZeroMemory(pHive->Snapshot._DUAL, sizeof(pHive->Snapshot._DUAL));
+    pHive->Snapshot.pIndex = NULL;
+    VmmWinReg_Index_Close(pIndex);
+    return FALSE;
+}
+
+/*
+* Write a section to an index file and pad it to the given alignment.
+* -- hFile
+* -- pb
+* -- cb
+* -- cbAlign
+* -- pbZero = zero buffer of at least cbAlign bytes.
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinReg_Index_SaveSection(_In_ FILE *hFile, _In_reads_(cb) PBYTE pb, _In_ QWORD cb, _In_ DWORD cbAlign, _In_ PBYTE pbZero)
+{
+    DWORD cbPad = (DWORD)((cbAlign - (cb % cbAlign)) % cbAlign);
+    if(cb && (fwrite(pb, 1, (SIZE_T)cb, hFile) != cb)) { return FALSE; }
+    if(cbPad && (fwrite(pbZero, 1, cbPad, hFile) != cbPad)) { return FALSE; }
+    return TRUE;
+}
+
+/*
+* Save the hive snapshot and its key index to an index file (if configured).
+* The header is written last so that partially written files are rejected.
+* NB! must be called with pHive->LockUpdate held after a successful
+* VmmWinReg_KeyInitialize().
+* -- H
+* -- pHive
+*/
+VOID VmmWinReg_Index_Save(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive)
+{
+    BOOL f;
+    FILE *hFile = NULL;
+    DWORD i, j, cKey, cChild = 0;
+    QWORD o;
+    CHAR uszPath[MAX_PATH];
+    PBYTE pbZero = NULL;
+    PDWORD pChild = NULL;
+    POB_REGISTRY_KEY pObKey;
+    PVMMWINREG_INDEX_KEY pKeys = NULL;
+    PVMMWINREG_INDEX_OFFSET pOffsets = NULL;
+    PVMMWINREG_INDEX_HASH pHashes = NULL;
+    VMMWINREG_INDEX_HDR hdr = { 0 };
+    if(!VmmWinReg_Index_GetPath(H, pHive, uszPath)) { return; }
+    // 1: build key index
+    if(!(cKey = ObMap_Size(pHive->Snapshot.pmKeyOffset))) { goto fail; }
+    if(!(pbZero = LocalAlloc(LMEM_ZEROINIT, 0x1000))) { goto fail; }
+    if(!(pKeys = LocalAlloc(LMEM_ZEROINIT, cKey * sizeof(VMMWINREG_INDEX_KEY)))) { goto fail; }
+    if(!(pOffsets = LocalAlloc(LMEM_ZEROINIT, cKey * sizeof(VMMWINREG_INDEX_OFFSET)))) { goto fail; }
+    if(!(pHashes = LocalAlloc(LMEM_ZEROINIT, cKey * sizeof(VMMWINREG_INDEX_HASH)))) { goto fail; }
+    for(i = 0; i < cKey; i++) {
+        if(!(pObKey = ObMap_GetByIndex(pHive->Snapshot.pmKeyOffset, i))) { goto fail; }
+        pKeys[i].oCell = pObKey->oCell;
+        pKeys[i].dwCellHead = pObKey->dwCellHead;
+        pKeys[i].cbCell = pObKey->cbCell;
+        pKeys[i].iSuffix = pObKey->iSuffix;
+        pKeys[i].iChild = cChild;
+        pKeys[i].cChild = pObKey->Child.c;
+        pKeys[i].qwHashKeyParent = pObKey->qwHashKeyParent;
+        pKeys[i].qwHashKeyThis = pObKey->qwHashKeyThis;
+        pOffsets[i].oCell = pObKey->oCell;
+        pOffsets[i].iKey = i;
+        pHashes[i].qwHash = pObKey->qwHashKeyThis;
+        pHashes[i].iKey = i;
+        cChild += pObKey->Child.c;
+        Ob_DECREF(pObKey);
+    }
+    if(!(pChild = LocalAlloc(0, max(1, cChild) * sizeof(DWORD)))) { goto fail; }
+    for(i = 0; i < cKey; i++) {
+        if(!(pObKey = ObMap_GetByIndex(pHive->Snapshot.pmKeyOffset, i))) { goto fail; }
+        for(j = 0; (j < pKeys[i].cChild) && (j < pObKey->Child.c); j++) {
+            pChild[pKeys[i].iChild + j] = pObKey->Child.po[j];
+        }
+        Ob_DECREF(pObKey);
+    }
+    qsort(pOffsets, cKey, sizeof(VMMWINREG_INDEX_OFFSET), Util_qsort_DWORD);
+    qsort(pHashes, cKey, sizeof(VMMWINREG_INDEX_HASH), Util_qsort_QWORD);
+    // 2: prepare header
+    hdr.dwMagic = VMMWINREG_INDEX_MAGIC;
+    hdr.dwVersion = VMMWINREG_INDEX_VERSION;
+    if(!VmmWinReg_Index_HashBase(H, pHive, hdr.pbHashBase)) { goto fail; }
+    o = 0x1000;
+    for(i = 0; i < 2; i++) {
+        hdr.cbDual[i] = pHive->Snapshot._DUAL[i].cb;
+        hdr.oDual[i] = o;
+        o += (hdr.cbDual[i] + 0xfff) & ~0xfff;
+    }
+    hdr.cKey = cKey;
+    hdr.cChild = cChild;
+    hdr.oKey = o;       o += cKey * sizeof(VMMWINREG_INDEX_KEY);
+    hdr.oOffset = o;    o += cKey * sizeof(VMMWINREG_INDEX_OFFSET);
+    hdr.oHash = o;      o += cKey * sizeof(VMMWINREG_INDEX_HASH);
+    hdr.oChild = o;     o += (cChild * sizeof(DWORD) + 7) & ~7;
+    hdr.cbFile = o;
+    if(hdr.cbFile > VMMWINREG_INDEX_MAX_SIZE) { goto fail; }
+    // 3: write file
+    if(fopen_s(&hFile, uszPath, "wb") || !hFile) {
+        hFile = NULL;
+        VmmLog(H, MID_REGISTRY, LOGLEVEL_4_VERBOSE, "INDEX SAVE FAIL: unable to create file '%s'", uszPath);
+        goto fail;
+    }
+    f = VmmWinReg_Index_SaveSection(hFile, pbZero, 0x1000, 0x1000, pbZero) &&
+        VmmWinReg_Index_SaveSection(hFile, pHive->Snapshot._DUAL[0].pb, hdr.cbDual[0], 0x1000, pbZero) &&
+        VmmWinReg_Index_SaveSection(hFile, pHive->Snapshot._DUAL[1].pb, hdr.cbDual[1], 0x1000, pbZero) &&
+        VmmWinReg_Index_SaveSection(hFile, (PBYTE)pKeys, cKey * sizeof(VMMWINREG_INDEX_KEY), 8, pbZero) &&
+        VmmWinReg_Index_SaveSection(hFile, (PBYTE)pOffsets, cKey * sizeof(VMMWINREG_INDEX_OFFSET), 8, pbZero) &&
+        VmmWinReg_Index_SaveSection(hFile, (PBYTE)pHashes, cKey * sizeof(VMMWINREG_INDEX_HASH), 8, pbZero) &&
+        VmmWinReg_Index_SaveSection(hFile, (PBYTE)pChild, cChild * sizeof(DWORD), 8, pbZero) &&
+        !fseek(hFile, 0, SEEK_SET) &&
+        (fwrite(&hdr, 1, sizeof(VMMWINREG_INDEX_HDR), hFile) == sizeof(VMMWINREG_INDEX_HDR));
+    fclose(hFile);
+    if(!f) {
+        remove(uszPath);
+        VmmLog(H, MID_REGISTRY, LOGLEVEL_4_VERBOSE, "INDEX SAVE FAIL: unable to write file '%s'", uszPath);
+        goto fail;
+    }
+    VmmLog(H, MID_REGISTRY, LOGLEVEL_5_DEBUG, "INDEX SAVE: Hive=%016llx Keys=%i File='%s'", pHive->vaCMHIVE, cKey, uszPath);
+fail:
+    LocalFree(pbZero);
+    LocalFree(pKeys);
+    LocalFree(pOffsets);
+    LocalFree(pHashes);
+    LocalFree(pChild);
+}
+
+
+
+//-----------------------------------------------------------------------------
+// EXTERNAL REGISTRY KEY AND VALUE FUNCTIONALITY:
+//-----------------------------------------------------------------------------
+
+_Success_(return)
+BOOL VmmWinReg_PathHiveGetByFullPath_DoWork(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _Out_ POB_REGISTRY_HIVE *ppHive, _Out_writes_(MAX_PATH) LPSTR uszPathKeyValue)
 {
     BOOL fUser = FALSE, fUserSystem = FALSE, fOrphan = FALSE;
     DWORD i;
@@ -1795,6 +2417,33 @@ BOOL VmmWinReg_PathHiveGetByFullPath(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull,
     return TRUE;    // CALLER DECREF: *ppHive
 }
 
+/*
+* Retrieve registry hive and key/value path from a "full" path starting with:
+* '0x...', 'by-hive\0x...' or 'HKLM\'
+* CALLER DECREF: *ppObHive
+* -- H
+* -- uszPathFull
+* -- ppObHive
+* -- uszPathKeyValue
+* -- return
+*/
+_Success_(return)
+BOOL VmmWinReg_PathHiveGetByFullPath(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _Out_ POB_REGISTRY_HIVE *ppHive, _Out_writes_(MAX_PATH) LPSTR uszPathKeyValue)
+{
+    DWORD dwGeneration;
+    POB_REGISTRY_PATHENTRY pObEntry;
+    if((pObEntry = VmmWinReg_PathCache_Get(H, uszPathFull, VMMWINREG_PATHCACHE_TP_HIVE))) {
+        *ppHive = Ob_INCREF(pObEntry->pObHive);
+        strncpy_s(uszPathKeyValue, MAX_PATH, pObEntry->uszPathKeyValue, _TRUNCATE);
+        Ob_DECREF(pObEntry);
+        return TRUE;    // CALLER DECREF: *ppHive
+    }
+    dwGeneration = VmmWinReg_PathCache_Generation(H);
+    if(!VmmWinReg_PathHiveGetByFullPath_DoWork(H, uszPathFull, ppHive, uszPathKeyValue)) { return FALSE; }
+    VmmWinReg_PathCache_Push(H, uszPathFull, VMMWINREG_PATHCACHE_TP_HIVE, dwGeneration, *ppHive, NULL, NULL, uszPathKeyValue);
+    return TRUE;        // CALLER DECREF: *ppHive
+}
+
 /*
 * Retrieve registry hive and key from a "full" path starting with:
 * '0x...', 'by-hive\0x...' or 'HKLM\'
@@ -1808,10 +2457,22 @@ BOOL VmmWinReg_PathHiveGetByFullPath(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull,
 _Success_(return)
 BOOL VmmWinReg_KeyHiveGetByFullPath(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _Out_ POB_REGISTRY_HIVE *ppObHive, _Out_opt_ POB_REGISTRY_KEY *ppObKey)
 {
+    DWORD dwGeneration;
     CHAR uszPathKey[MAX_PATH];
+    POB_REGISTRY_PATHENTRY pObEntry;
+    if(ppObKey && (pObEntry = VmmWinReg_PathCache_Get(H, uszPathFull, VMMWINREG_PATHCACHE_TP_KEY))) {
+        *ppObHive = Ob_INCREF(pObEntry->pObHive);
+        *ppObKey = Ob_INCREF(pObEntry->pObKey);
+        Ob_DECREF(pObEntry);
+        return TRUE;
+    }
+    dwGeneration = VmmWinReg_PathCache_Generation(H);
     if(!VmmWinReg_PathHiveGetByFullPath(H, uszPathFull, ppObHive, uszPathKey)) { return FALSE; }
     if(!ppObKey) { return TRUE; }
-    if((*ppObKey = VmmWinReg_KeyGetByPath(H, *ppObHive, uszPathKey))) { return TRUE; }
+    if((*ppObKey = VmmWinReg_KeyGetByPath(H, *ppObHive, uszPathKey))) {
+        VmmWinReg_PathCache_Push(H, uszPathFull, VMMWINREG_PATHCACHE_TP_KEY, dwGeneration, *ppObHive, *ppObKey, NULL, NULL);
+        return TRUE;
+    }
     Ob_DECREF_NULL(ppObHive);
     return FALSE;
 }
@@ -1829,7 +2490,7 @@ _Success_(return != NULL)
 POB_REGISTRY_KEY VmmWinReg_KeyGetByPath(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ LPCSTR uszPath)
 {
     if(!VmmWinReg_HiveSnapshotEnsure(H, pHive)) { return NULL; }
-    return (POB_REGISTRY_KEY)ObMap_GetByKey(pHive->Snapshot.pmKeyHash, CharUtil_HashPathFsU(uszPath));
+    return VmmWinReg_KeyGetByHashInternal(H, pHive, CharUtil_HashPathFsU(uszPath));
 }
 
 /*
@@ -1846,7 +2507,7 @@ _Success_(return != NULL)
 POB_REGISTRY_KEY VmmWinReg_KeyGetByChildName(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pParentKey, _In_ LPSTR uszChildName)
 {
     if(!VmmWinReg_HiveSnapshotEnsure(H, pHive)) { return NULL; }
-    return (POB_REGISTRY_KEY)ObMap_GetByKey(pHive->Snapshot.pmKeyHash, VmmWinReg_KeyHashChildName(pParentKey, uszChildName));
+    return VmmWinReg_KeyGetByHashInternal(H, pHive, VmmWinReg_KeyHashChildName(pParentKey, uszChildName));
 }
 
 /*
@@ -1862,7 +2523,7 @@ _Success_(return != NULL)
 POB_REGISTRY_KEY VmmWinReg_KeyGetByCellOffset(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ DWORD raCellOffset)
 {
     if(!VmmWinReg_HiveSnapshotEnsure(H, pHive)) { return NULL; }
-    return (POB_REGISTRY_KEY)ObMap_GetByKey(pHive->Snapshot.pmKeyOffset, raCellOffset);
+    return VmmWinReg_KeyGetByOffsetInternal(H, pHive, raCellOffset);
 }
 
 /*
@@ -1884,7 +2545,7 @@ POB_MAP VmmWinReg_KeyList(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_o
     if(!(pmObSubkeys = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB | OB_MAP_FLAGS_NOKEY))) { return NULL; }
     if(pKeyParent) {
         for(i = 0; i < pKeyParent->Child.c; i++) {
-            pKeyChild = ObMap_GetByKey(pHive->Snapshot.pmKeyOffset, pKeyParent->Child.po[i]);
+            pKeyChild = VmmWinReg_KeyGetByOffsetInternal(H, pHive, pKeyParent->Child.po[i]);
             ObMap_Push(pmObSubkeys, 0, pKeyChild);
             Ob_DECREF(pKeyChild);
         }
@@ -1938,7 +2599,7 @@ VOID VmmWinReg_KeyInfo2(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ PO
     if(!(ps = ObSet_New(H))) { return; }
     ObSet_Push(ps, (QWORD)Ob_INCREF(pKey));
     qwHashKeyParent = pKey->qwHashKeyParent;
-    while((pObKey = ObMap_GetByKey(pHive->Snapshot.pmKeyHash, qwHashKeyParent))) {
+    while((pObKey = VmmWinReg_KeyGetByHashInternal(H, pHive, qwHashKeyParent))) {
         ObSet_Push(ps, (QWORD)pObKey);
         qwHashKeyParent = pObKey->qwHashKeyParent;
     }
@@ -2094,10 +2755,34 @@ _Success_(return)
 BOOL VmmWinReg_ValueQuery2(_In_ VMM_HANDLE H, _In_ LPCSTR uszFullPathKeyValue, _Out_opt_ PDWORD pdwType, _Out_writes_opt_(cbData) PBYTE pbData, _In_ DWORD cbData, _Out_opt_ PDWORD pcbData)
 {
     BOOL f;
-    CHAR uszPathKeyValue[MAX_PATH];
+    DWORD dwGeneration;
+    LPSTR uszValueName;
+    CHAR uszPathKeyValue[MAX_PATH], uszPathKey[MAX_PATH];
     POB_REGISTRY_HIVE pObHive = NULL;
-    f = VmmWinReg_PathHiveGetByFullPath(H, uszFullPathKeyValue, &pObHive, uszPathKeyValue) &&
-        VmmWinReg_ValueQuery1(H, pObHive, uszPathKeyValue, pdwType, NULL, pbData, cbData, pcbData, 0);
+    POB_REGISTRY_KEY pObKey = NULL;
+    POB_REGISTRY_VALUE pObKeyValue = NULL;
+    POB_REGISTRY_PATHENTRY pObEntry;
+    if(pcbData) { *pcbData = 0; }
+    if((pObEntry = VmmWinReg_PathCache_Get(H, uszFullPathKeyValue, VMMWINREG_PATHCACHE_TP_VALUE))) {
+        pObHive = Ob_INCREF(pObEntry->pObHive);
+        pObKeyValue = Ob_INCREF(pObEntry->pObValue);
+        Ob_DECREF(pObEntry);
+    } else {
+        dwGeneration = VmmWinReg_PathCache_Generation(H);
+        f = VmmWinReg_PathHiveGetByFullPath(H, uszFullPathKeyValue, &pObHive, uszPathKeyValue) &&
+            VmmWinReg_HiveSnapshotEnsure(H, pObHive) &&
+            (uszValueName = CharUtil_PathSplitLastEx(uszPathKeyValue, uszPathKey, sizeof(uszPathKey))) &&
+            (pObKey = VmmWinReg_KeyGetByPath(H, pObHive, uszPathKey)) &&
+            (pObKeyValue = VmmWinReg_ValueByKeyAndName(H, pObHive, pObKey, uszValueName));
+        Ob_DECREF_NULL(&pObKey);
+        if(!f) { goto fail; }
+        VmmWinReg_PathCache_Push(H, uszFullPathKeyValue, VMMWINREG_PATHCACHE_TP_VALUE, dwGeneration, pObHive, NULL, pObKeyValue, NULL);
+    }
+    f = pbData ?
+        VmmWinReg_ValueQueryInternal(pObHive, pObKeyValue, pdwType, NULL, NULL, pbData, cbData, pcbData, 0) :
+        VmmWinReg_ValueQueryInternal(pObHive, pObKeyValue, pdwType, NULL, pcbData, NULL, 0, NULL, 0);
+fail:
+    Ob_DECREF(pObKeyValue);
     Ob_DECREF(pObHive);
     return f;
 }
@@ -2235,13 +2920,14 @@ fail:
 /*
 * Create a full path given a registry key. This string format is primarily used
 * for forensic storage purposes.
+* -- H
 * -- pHive
 * -- pKey
 * -- uszHivePrefix
 * -- uszHiveName
 * -- uszFullPath
 */
-VOID VmmWinReg_KeyFullPath(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pKey, _In_ LPSTR uszHivePrefix, _In_ LPSTR uszHiveName, _Out_writes_(1024) LPSTR uszFullPath)
+VOID VmmWinReg_KeyFullPath(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pKey, _In_ LPSTR uszHivePrefix, _In_ LPSTR uszHiveName, _Out_writes_(1024) LPSTR uszFullPath)
 {
     CONST BYTE pbTEXT_ROOT[] = { '\\', 0, 'R', 0, 'O', 0, 'O', 0, 'T', 0 };
     BOOL fResult = TRUE, fSkip = TRUE;
@@ -2250,7 +2936,7 @@ VOID VmmWinReg_KeyFullPath(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY p
     POB_REGISTRY_KEY pk, ppObKey[0x40];
     // fetch parents (max depth: 0x40)
     ppObKey[iKey++] = Ob_INCREF(pKey);
-    while((iKey < 0x40) && (ppObKey[iKey] = ObMap_GetByKey(pHive->Snapshot.pmKeyHash, ppObKey[iKey - 1]->qwHashKeyParent))) {
+    while((iKey < 0x40) && (ppObKey[iKey] = VmmWinReg_KeyGetByHashInternal(H, pHive, ppObKey[iKey - 1]->qwHashKeyParent))) {
         iKey++;
     }
     // unwind, copy name
@@ -2328,10 +3014,10 @@ VOID VmmWinReg_ForensicGetAllKeysAndValues(
             oHive += 5;
             uszHivePrefix = "HKU\\";
         }
-        c = ObMap_Size(pHive->Snapshot.pmKeyOffset);
+        c = VmmWinReg_KeyCountInternal(pHive);
         for(i = 0; ((i < c) && !H->fAbort); i++) {
-            if((pObKey = ObMap_GetByIndex(pHive->Snapshot.pmKeyOffset, i))) {
-                VmmWinReg_KeyFullPath(pHive, pObKey, uszHivePrefix, pHive->uszHiveRootPath + oHive, uszFullPath);
+            if((pObKey = VmmWinReg_KeyGetByIndexInternal(H, pHive, i))) {
+                VmmWinReg_KeyFullPath(H, pHive, pObKey, uszHivePrefix, pHive->uszHiveRootPath + oHive, uszFullPath);
                 // registry timeline:
                 pfnKeyCB(H, hCallback1, hCallback2, uszFullPath, pHive->vaCMHIVE, pObKey->oCell, pObKey->pKey->Parent, pObKey->pKey->LastWriteTime);
                 // registry json data:
@@ -29,6 +29,7 @@ typedef struct tdOB_REGISTRY_HIVE {
         BOOL fInitialized;
         POB_MAP pmKeyHash;      // object map for POB_REG_KEY keyed by hash
         POB_MAP pmKeyOffset;    // object map for POB_REG_KEY keyed by offset
+        struct tdVMMWINREG_INDEX *pIndex;   // memory-mapped on-disk key index (if any) - keys created on-demand
         struct {
             DWORD cb;
             PBYTE pb;
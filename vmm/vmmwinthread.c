@@ -10,6 +10,7 @@
 #include "charutil.h"
 #include "pdb.h"
 #include "pe.h"
+#include "util.h"
 
 // ----------------------------------------------------------------------------
 // THREADING FUNCTIONALITY BELOW:
@@ -204,6 +205,8 @@ BOOL VmmWinThread_Initialize(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess)
 #define UNW_FLAG_CHAININFO      0x4
 
 #define VMMWINTHREADCS_MAX_DEPTH 0x80
+#define VMMWINTHREADCS_BATCH_PREFETCH_STACK 0x4000
+#define VMMWINTHREADCS_BATCH_PREFETCH_PDATA 0x20000
 
 typedef struct tdVMMWINTHREAD_SYMBOL {
     CHAR szModule[MAX_PATH];
@@ -541,40 +544,38 @@ VOID VmmWinThreadCs_CleanupCB(PVMMOB_MAP_THREADCALLSTACK pOb)
 
 #define VMMWINTHREADCS_BUFFER_USERTEXT 0x10000
 
+typedef struct tdVMMWINTHREADCS_BATCH_SYMBOL {
+    QWORD va;                           // return address (sort key - must be first)
+    BOOL fValid;
+    VMMWINTHREAD_SYMBOL Symbol;
+} VMMWINTHREADCS_BATCH_SYMBOL, *PVMMWINTHREADCS_BATCH_SYMBOL;
+
 /*
-* Retrieve a new callstack object for the specified thread.
-* CALLER DECREF: return
+* Unwind the callstack frames of the specified thread.
 * -- H
 * -- pProcess
 * -- pThread
-* -- return
+* -- pFullCallStack = buffer of VMMWINTHREADCS_MAX_DEPTH frames to receive the frames.
+* -- return = the number of frames, 0 on fail.
 */
-PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_UnwindScanCallstack(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_THREADENTRY pThread)
+DWORD VmmWinThreadCs_UnwindFrames(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_THREADENTRY pThread, _Out_writes_(VMMWINTHREADCS_MAX_DEPTH) PVMMWINTHREAD_FRAME pFullCallStack)
 {
     VMMWINTHREAD_FRAME sFrameInit, sCurrentFrame = { 0 };
-    DWORD i, dwIterFrame, cboText = 0;
-    PVMMWINTHREAD_FRAME peFrame, peSrc, pFullCallStack = NULL; 
-    BOOL fResultDisplay = FALSE;
+    DWORD dwIterFrame;
+    PVMMWINTHREAD_FRAME peFrame;
     QWORD qwLimitKernel = 0x00007FFFFFFF0000;
-    PVMMOB_MAP_THREADCALLSTACK pObCS = NULL;
-    PVMM_MAP_THREADCALLSTACKENTRY peDst;
-    POB_STRMAP psmOb = NULL;
-    VMMWINTHREAD_SYMBOL sCurrentSymbol;
-    LPSTR uszText = NULL;
-
-    if(H->vmm.tpMemoryModel != VMM_MEMORYMODEL_X64) { return NULL; }
 
-    pFullCallStack = LocalAlloc(LMEM_ZEROINIT, VMMWINTHREADCS_MAX_DEPTH * sizeof(VMMWINTHREAD_FRAME));
-    if(!pFullCallStack) { return NULL; }
+    ZeroMemory(pFullCallStack, VMMWINTHREADCS_MAX_DEPTH * sizeof(VMMWINTHREAD_FRAME));
 
     // checking condition before starting to unwind
-    if(!VmmWinThreadCs_ValidateThreadBeforeUnwind(H, pProcess, pThread)) { goto end; }
+    if(!VmmWinThreadCs_ValidateThreadBeforeUnwind(H, pProcess, pThread)) { return 0; }
 
     VmmLog(H, MID_THREADCS, LOGLEVEL_6_TRACE, " START: RIP:[%016llx] PID:[%u] TID:[%u]", pThread->vaRIP, pProcess->dwPID, pThread->dwTID);
     sFrameInit.vaRetAddr = pThread->vaRIP;
     // setting RSP as 0 as we are not unwinding kernel stack
     sFrameInit.vaRSP = 0;
     sFrameInit.vaBaseSP = 0;
+    sFrameInit.fRegPresent = FALSE;
     pFullCallStack[0] = sFrameInit;
     
     for(dwIterFrame = 0; dwIterFrame < VMMWINTHREADCS_MAX_DEPTH - 2; dwIterFrame++) {
@@ -604,16 +605,50 @@ PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_UnwindScanCallstack(_In_ VMM_HANDLE H,
         pFullCallStack[dwIterFrame].vaRSP = pFullCallStack[dwIterFrame - 1].vaBaseSP;
         pFullCallStack[dwIterFrame].vaRetAddr = 0;
     }
-    dwIterFrame++;
+    return dwIterFrame + 1;
+}
+
+/*
+* Create a new callstack object from already unwound frames. Symbols are taken
+* from the optional pre-resolved (sorted) symbol table if it exists, otherwise
+* they are resolved frame by frame.
+* CALLER DECREF: return
+* -- H
+* -- pProcess
+* -- pThread
+* -- pFullCallStack
+* -- cFrames
+* -- pSymbolsOpt = optional symbol table sorted by return address.
+* -- cSymbols
+* -- return
+*/
+PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_CreateCallstack(
+    _In_ VMM_HANDLE H,
+    _In_ PVMM_PROCESS pProcess,
+    _In_ PVMM_MAP_THREADENTRY pThread,
+    _In_reads_(cFrames) PVMMWINTHREAD_FRAME pFullCallStack,
+    _In_ DWORD cFrames,
+    _In_reads_opt_(cSymbols) PVMMWINTHREADCS_BATCH_SYMBOL pSymbolsOpt,
+    _In_ DWORD cSymbols
+) {
+    DWORD i, cboText = 0;
+    PVMMWINTHREAD_FRAME peSrc;
+    PVMMOB_MAP_THREADCALLSTACK pObCS = NULL;
+    PVMM_MAP_THREADCALLSTACKENTRY peDst;
+    PVMMWINTHREADCS_BATCH_SYMBOL peSymbol;
+    POB_STRMAP psmOb = NULL;
+    VMMWINTHREAD_SYMBOL sCurrentSymbol;
+    PVMMWINTHREAD_SYMBOL pSymbol;
+    LPSTR uszText = NULL;
 
     // create ob object:
     if(!(psmOb = ObStrMap_New(H, OB_STRMAP_FLAGS_CASE_SENSITIVE))) { goto end; }
-    if(!(pObCS = Ob_AllocEx(H, OB_TAG_THREAD_CALLSTACK, LMEM_ZEROINIT, sizeof(VMMOB_MAP_THREADCALLSTACK) + dwIterFrame * sizeof(VMM_MAP_THREADCALLSTACKENTRY), (OB_CLEANUP_CB)VmmWinThreadCs_CleanupCB, NULL))) { goto end; }
+    if(!(pObCS = Ob_AllocEx(H, OB_TAG_THREAD_CALLSTACK, LMEM_ZEROINIT, sizeof(VMMOB_MAP_THREADCALLSTACK) + cFrames * sizeof(VMM_MAP_THREADCALLSTACKENTRY), (OB_CLEANUP_CB)VmmWinThreadCs_CleanupCB, NULL))) { goto end; }
     if(!(uszText = LocalAlloc(LMEM_ZEROINIT, VMMWINTHREADCS_BUFFER_USERTEXT))) { goto end; }
     if(H->cfg.fFileInfoHeader) {
         cboText += (DWORD)_snprintf_s(uszText + cboText, VMMWINTHREADCS_BUFFER_USERTEXT - cboText, _TRUNCATE, "Index            RSP          RetAddr Module!Function+Displacement\n==================================================================\n");
     }
-    for(i = 0; i < dwIterFrame; i++) {
+    for(i = 0; i < cFrames; i++) {
         peSrc = &pFullCallStack[i];
         peDst = &pObCS->pMap[i];
         peDst->i = i;
@@ -621,11 +656,20 @@ PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_UnwindScanCallstack(_In_ VMM_HANDLE H,
         peDst->vaRetAddr = peSrc->vaRetAddr;
         peDst->vaRSP = peSrc->vaRSP;
         peDst->vaBaseSP = peSrc->vaBaseSP;
-        if(i && pFullCallStack[i - 1].vaRetAddr && VmmWinThreadCs_GetSymbolFromAddr(H, pProcess, pFullCallStack[i - 1].vaRetAddr, &sCurrentSymbol)) {
-            peDst->cbDisplacement = sCurrentSymbol.displacement;
-            ObStrMap_PushPtrUU(psmOb, sCurrentSymbol.szFunction, &peDst->uszFunction, NULL);
-            ObStrMap_PushPtrUU(psmOb, sCurrentSymbol.szModule, &peDst->uszModule, NULL);
-            cboText += (DWORD)_snprintf_s(uszText + cboText, VMMWINTHREADCS_BUFFER_USERTEXT - cboText, _TRUNCATE, "%02u: %016llx %016llx %s!%s+%x\n", peDst->i, peDst->vaRSP, peDst->vaRetAddr, sCurrentSymbol.szModule, sCurrentSymbol.szFunction, sCurrentSymbol.displacement);
+        pSymbol = NULL;
+        if(i && pFullCallStack[i - 1].vaRetAddr) {
+            if(pSymbolsOpt) {
+                peSymbol = Util_qfind(pFullCallStack[i - 1].vaRetAddr, cSymbols, pSymbolsOpt, sizeof(VMMWINTHREADCS_BATCH_SYMBOL), Util_qfind_CmpFindTableQWORD);
+                pSymbol = (peSymbol && peSymbol->fValid) ? &peSymbol->Symbol : NULL;
+            } else if(VmmWinThreadCs_GetSymbolFromAddr(H, pProcess, pFullCallStack[i - 1].vaRetAddr, &sCurrentSymbol)) {
+                pSymbol = &sCurrentSymbol;
+            }
+        }
+        if(pSymbol) {
+            peDst->cbDisplacement = pSymbol->displacement;
+            ObStrMap_PushPtrUU(psmOb, pSymbol->szFunction, &peDst->uszFunction, NULL);
+            ObStrMap_PushPtrUU(psmOb, pSymbol->szModule, &peDst->uszModule, NULL);
+            cboText += (DWORD)_snprintf_s(uszText + cboText, VMMWINTHREADCS_BUFFER_USERTEXT - cboText, _TRUNCATE, "%02u: %016llx %016llx %s!%s+%x\n", peDst->i, peDst->vaRSP, peDst->vaRetAddr, pSymbol->szModule, pSymbol->szFunction, pSymbol->displacement);
         } else {
             ObStrMap_PushPtrUU(psmOb, "", &peDst->uszFunction, NULL);
             ObStrMap_PushPtrUU(psmOb, "", &peDst->uszModule, NULL);
@@ -636,7 +680,7 @@ PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_UnwindScanCallstack(_In_ VMM_HANDLE H,
     pObCS->cbText = cboText;
     pObCS->dwPID = pProcess->dwPID;
     pObCS->dwTID = pThread->dwTID;
-    pObCS->cMap = dwIterFrame;
+    pObCS->cMap = cFrames;
     ObStrMap_FinalizeAllocU_DECREF_NULL(&psmOb, &pObCS->pbMultiText, &pObCS->cbMultiText);
     if(VmmLogIsActive(H, MID_THREADCS, LOGLEVEL_5_DEBUG)) {
         VmmLog(H, MID_THREADCS, LOGLEVEL_5_DEBUG, "CALLSTACK PRINTOUT PID:[%u] TID:[%u]", pObCS->dwPID, pObCS->dwTID);
@@ -646,12 +690,34 @@ PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_UnwindScanCallstack(_In_ VMM_HANDLE H,
         }
         VmmLog(H, MID_THREADCS, LOGLEVEL_5_DEBUG, "\n%s", uszText);
     }
-end: 
-    LocalFree(pFullCallStack);
+end:
+    Ob_DECREF(psmOb);
     LocalFree(uszText);
     return pObCS;
 }
 
+/*
+* Retrieve a new callstack object for the specified thread.
+* CALLER DECREF: return
+* -- H
+* -- pProcess
+* -- pThread
+* -- return
+*/
+PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_UnwindScanCallstack(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_THREADENTRY pThread)
+{
+    DWORD cFrames;
+    PVMMWINTHREAD_FRAME pFullCallStack = NULL;
+    PVMMOB_MAP_THREADCALLSTACK pObCS = NULL;
+    if(H->vmm.tpMemoryModel != VMM_MEMORYMODEL_X64) { return NULL; }
+    if(!(pFullCallStack = LocalAlloc(0, VMMWINTHREADCS_MAX_DEPTH * sizeof(VMMWINTHREAD_FRAME)))) { return NULL; }
+    if((cFrames = VmmWinThreadCs_UnwindFrames(H, pProcess, pThread, pFullCallStack))) {
+        pObCS = VmmWinThreadCs_CreateCallstack(H, pProcess, pThread, pFullCallStack, cFrames, NULL, 0);
+    }
+    LocalFree(pFullCallStack);
+    return pObCS;
+}
+
 _Success_(return)
 BOOL VmmWinThreadCs_PopReturnAddress(VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ QWORD va, _Out_ PQWORD pqwBufferCandidate, _Out_opt_ PVMMWINTHREAD_MODULE_SECTION pModuleSectionOpt)
 {
@@ -928,6 +994,249 @@ end:
     return dwResult;
 }
 
+/*
+* Resolve symbols for a table of return addresses sorted by address. Since the
+* table is sorted return addresses of the same module are adjacent - the module
+* section is only looked up once per module code section and the PDB is only
+* looked up and loaded once per module.
+* -- H
+* -- pProcess
+* -- cSymbols
+* -- pSymbols
+*/
+VOID VmmWinThreadCs_GetSymbolFromAddrBatch(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ DWORD cSymbols, _Inout_updates_(cSymbols) PVMMWINTHREADCS_BATCH_SYMBOL pSymbols)
+{
+    DWORD i, dwModuleType = 0;
+    BOOL fPDB = FALSE;
+    PDB_HANDLE hPDB = 0;
+    QWORD vaModuleBaseLast = 0;
+    CHAR szModulePDB[MAX_PATH] = { 0 };
+    VMMWINTHREAD_MODULE_SECTION sModule = { 0 };
+    PVMMWINTHREADCS_BATCH_SYMBOL pe;
+    for(i = 0; i < cSymbols; i++) {
+        if(H->fAbort) { return; }
+        pe = pSymbols + i;
+        if(!pe->va) { continue; }
+        // addresses are sorted - only look up the module & section once per
+        // module section and re-use it for all following addresses inside it:
+        if((dwModuleType != 1) || (pe->va < sModule.vaModuleBase + sModule.text.Address) || (pe->va >= sModule.vaModuleBase + sModule.text.Address + sModule.text.Size)) {
+            if(!(dwModuleType = VmmWinThreadCs_GetModuleSectionFromAddress(H, pProcess, pe->va, &sModule))) { continue; }
+        }
+        pe->fValid = TRUE;
+        pe->Symbol.retaddress = pe->va;
+        // load the PDB for the module (once per module):
+        if(!vaModuleBaseLast || (vaModuleBaseLast != sModule.vaModuleBase)) {
+            vaModuleBaseLast = sModule.vaModuleBase;
+            fPDB = (hPDB = PDB_GetHandleFromModuleAddress(H, pProcess, sModule.vaModuleBase)) && PDB_LoadEnsure(H, hPDB) && PDB_GetModuleInfo(H, hPDB, szModulePDB, NULL, NULL);
+        }
+        // lookup the symbol:
+        if(fPDB && PDB_GetSymbolFromOffset(H, hPDB, (DWORD)(pe->va - sModule.vaModuleBase), pe->Symbol.szFunction, &pe->Symbol.displacement)) {
+            strncpy_s(pe->Symbol.szModule, sizeof(pe->Symbol.szModule), szModulePDB, _TRUNCATE);
+            continue;
+        }
+        // PDB symbol lookup failed, but we still have the module & section name:
+        _snprintf_s(pe->Symbol.szModule, sizeof(pe->Symbol.szModule), _TRUNCATE, "[%s]", sModule.uszModuleName);
+        _snprintf_s(pe->Symbol.szFunction, sizeof(pe->Symbol.szFunction), _TRUNCATE, "[%s]", sModule.text.szSectionName);
+        pe->Symbol.displacement = (DWORD)(pe->va - sModule.vaModuleBase);
+    }
+}
+
+/*
+* Retrieve the callstack cache lock for a specific thread. The lock is striped
+* by (PID, TID) - unwinding of different threads may run in parallel while
+* duplicate requests wait for the first unwind to finish.
+*/
+PSRWLOCK VmmWinThreadCs_GetCallstackLock(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ DWORD dwTID)
+{
+    return &H->vmm.LockSRW.ThreadCallback[(dwPID ^ (dwTID >> 2) ^ (dwTID >> 6)) % VMM_THREADCALLBACK_LOCK_STRIPES];
+}
+
+/*
+* Create an empty callstack object - used to cache failed unwinds.
+* CALLER DECREF: return
+*/
+PVMMOB_MAP_THREADCALLSTACK VmmWinThreadCs_CreateCallstackEmpty(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ DWORD dwTID)
+{
+    PVMMOB_MAP_THREADCALLSTACK pObCS;
+    if((pObCS = Ob_AllocEx(H, OB_TAG_THREAD_CALLSTACK, LMEM_ZEROINIT, sizeof(VMMOB_MAP_THREADCALLSTACK), NULL, NULL))) {
+        pObCS->dwPID = dwPID;
+        pObCS->dwTID = dwTID;
+    }
+    return pObCS;
+}
+
+typedef struct tdVMMWINTHREADCS_BATCH_THREAD {
+    PVMM_MAP_THREADENTRY pThread;
+    DWORD cFrames;
+    PVMMWINTHREAD_FRAME pFrames;
+} VMMWINTHREADCS_BATCH_THREAD, *PVMMWINTHREADCS_BATCH_THREAD;
+
+/*
+* Unwind the callstacks of all threads in a single process and put them into
+* the callstack cache. The thread stacks and the .pdata unwind tables of the
+* modules executing thread code are prefetched in two scatter reads and the
+* symbols are resolved in bulk (sorted per module/PDB) for all threads.
+* -- H
+* -- pProcess
+* -- fNoCache
+*/
+VOID VmmWinThreadCs_GetCallstackBatch_Process(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ BOOL fNoCache)
+{
+    DWORD i, j, cThreads = 0, cSymbols = 0;
+    QWORD qwKey, va, vaEnd, vaModule;
+    PSRWLOCK pLockSRW;
+    IMAGE_SECTION_HEADER Section;
+    PVMMOB_MAP_THREAD pObThreadMap = NULL;
+    PVMM_MAP_THREADENTRY peThread;
+    PVMMOB_MAP_MODULE pObModuleMap = NULL;
+    PVMM_MAP_MODULEENTRY peModule;
+    PVMMWINTHREADCS_BATCH_THREAD pThreads = NULL, pe;
+    PVMMWINTHREADCS_BATCH_SYMBOL pSymbols = NULL;
+    PVMMWINTHREAD_FRAME pFrameBuffer = NULL;
+    PVMMOB_MAP_THREADCALLSTACK pObCS = NULL;
+    POB_SET psObPrefetch = NULL, psObRetAddr = NULL, psObModule = NULL;
+    POB_DATA pObRetAddr = NULL;
+    if(!VmmMap_GetThread(H, pProcess, &pObThreadMap)) { goto fail; }
+    if(!(pThreads = LocalAlloc(LMEM_ZEROINIT, pObThreadMap->cMap * sizeof(VMMWINTHREADCS_BATCH_THREAD)))) { goto fail; }
+    if(!(pFrameBuffer = LocalAlloc(0, VMMWINTHREADCS_MAX_DEPTH * sizeof(VMMWINTHREAD_FRAME)))) { goto fail; }
+    if(!(psObPrefetch = ObSet_New(H))) { goto fail; }
+    if(!(psObRetAddr = ObSet_New(H))) { goto fail; }
+    if(!(psObModule = ObSet_New(H))) { goto fail; }
+    VmmMap_GetModule(H, pProcess, VMM_MODULE_FLAG_NORMAL, &pObModuleMap);
+    // 1: select threads not yet in cache and prefetch their stacks (from RSP
+    //    towards the stack base), the code pages at RIP and the PE headers of
+    //    the modules executing thread code:
+    for(i = 0; i < pObThreadMap->cMap; i++) {
+        peThread = pObThreadMap->pMap + i;
+        qwKey = ((QWORD)pProcess->dwPID << 32) | peThread->dwTID;
+        if(!fNoCache && ObMap_ExistsKey(H->vmm.pmObThreadCallback, qwKey)) { continue; }
+        pThreads[cThreads++].pThread = peThread;
+        if((peThread->vaRSP <= peThread->vaStackBaseUser) && (peThread->vaRSP >= peThread->vaStackLimitUser)) {
+            vaEnd = min(peThread->vaStackBaseUser, peThread->vaRSP + VMMWINTHREADCS_BATCH_PREFETCH_STACK);
+            for(va = peThread->vaRSP & ~0xfff; va < vaEnd; va += 0x1000) {
+                ObSet_Push(psObPrefetch, va);
+            }
+            ObSet_Push(psObPrefetch, peThread->vaRIP & ~0xfff);
+        }
+        if(pObModuleMap) {
+            if((peModule = VmmMap_GetModuleEntryEx2(H, pObModuleMap, peThread->vaRIP))) {
+                ObSet_Push(psObModule, peModule->vaBase);
+            }
+            if((peModule = VmmMap_GetModuleEntryEx2(H, pObModuleMap, peThread->vaWin32StartAddress))) {
+                ObSet_Push(psObModule, peModule->vaBase);
+            }
+        }
+    }
+    if(!cThreads) { goto fail; }
+    for(i = 0, j = ObSet_Size(psObModule); i < j; i++) {
+        ObSet_Push(psObPrefetch, ObSet_Get(psObModule, i));
+    }
+    VmmCachePrefetchPages(H, pProcess, psObPrefetch, 0);
+    // 1b: prefetch the .pdata (unwind tables) of the modules executing thread
+    //     code - these are read for every frame unwound in the module:
+    ObSet_Clear(psObPrefetch);
+    while((vaModule = ObSet_Pop(psObModule))) {
+        if(!PE_SectionGetFromName(H, pProcess, vaModule, ".pdata", &Section)) { continue; }
+        va = vaModule + Section.VirtualAddress;
+        vaEnd = va + min(Section.Misc.VirtualSize, VMMWINTHREADCS_BATCH_PREFETCH_PDATA);
+        for(va = va & ~0xfff; va < vaEnd; va += 0x1000) {
+            ObSet_Push(psObPrefetch, va);
+        }
+    }
+    VmmCachePrefetchPages(H, pProcess, psObPrefetch, 0);
+    // 2: unwind frames of all threads and collect the return addresses:
+    for(i = 0; i < cThreads; i++) {
+        if(H->fAbort) { goto fail; }
+        pe = pThreads + i;
+        if(!(pe->cFrames = VmmWinThreadCs_UnwindFrames(H, pProcess, pe->pThread, pFrameBuffer))) { continue; }
+        if(!(pe->pFrames = LocalAlloc(0, pe->cFrames * sizeof(VMMWINTHREAD_FRAME)))) {
+            pe->cFrames = 0;
+            continue;
+        }
+        memcpy(pe->pFrames, pFrameBuffer, pe->cFrames * sizeof(VMMWINTHREAD_FRAME));
+        for(j = 0; j + 1 < pe->cFrames; j++) {
+            ObSet_Push(psObRetAddr, pe->pFrames[j].vaRetAddr);
+        }
+    }
+    // 3: resolve symbols in bulk - sorted by address (grouped by module):
+    if((pObRetAddr = ObSet_GetAll(psObRetAddr)) && (cSymbols = pObRetAddr->ObHdr.cbData / sizeof(QWORD))) {
+        qsort(pObRetAddr->pqw, cSymbols, sizeof(QWORD), Util_qsort_QWORD);
+        if(!(pSymbols = LocalAlloc(LMEM_ZEROINIT, cSymbols * sizeof(VMMWINTHREADCS_BATCH_SYMBOL)))) { goto fail; }
+        for(i = 0; i < cSymbols; i++) {
+            pSymbols[i].va = pObRetAddr->pqw[i];
+        }
+        VmmWinThreadCs_GetSymbolFromAddrBatch(H, pProcess, cSymbols, pSymbols);
+    }
+    // 4: create callstack objects and put them into the cache:
+    for(i = 0; i < cThreads; i++) {
+        if(H->fAbort) { goto fail; }
+        pe = pThreads + i;
+        if(pe->cFrames) {
+            pObCS = VmmWinThreadCs_CreateCallstack(H, pProcess, pe->pThread, pe->pFrames, pe->cFrames, pSymbols, cSymbols);
+        }
+        if(!pObCS) {
+            pObCS = VmmWinThreadCs_CreateCallstackEmpty(H, pProcess->dwPID, pe->pThread->dwTID);
+        }
+        if(pObCS) {
+            qwKey = ((QWORD)pProcess->dwPID << 32) | pe->pThread->dwTID;
+            pLockSRW = VmmWinThreadCs_GetCallstackLock(H, pProcess->dwPID, pe->pThread->dwTID);
+            AcquireSRWLockExclusive(pLockSRW);
+            if(fNoCache) {
+                Ob_DECREF(ObMap_RemoveByKey(H->vmm.pmObThreadCallback, qwKey));
+            }
+            if(!ObMap_ExistsKey(H->vmm.pmObThreadCallback, qwKey)) {
+                ObMap_Push(H->vmm.pmObThreadCallback, qwKey, pObCS);
+            }
+            ReleaseSRWLockExclusive(pLockSRW);
+            Ob_DECREF_NULL(&pObCS);
+        }
+    }
+fail:
+    if(pThreads) {
+        for(i = 0; i < cThreads; i++) {
+            LocalFree(pThreads[i].pFrames);
+        }
+        LocalFree(pThreads);
+    }
+    LocalFree(pSymbols);
+    LocalFree(pFrameBuffer);
+    Ob_DECREF(pObRetAddr);
+    Ob_DECREF(psObRetAddr);
+    Ob_DECREF(psObPrefetch);
+    Ob_DECREF(psObModule);
+    Ob_DECREF(pObModuleMap);
+    Ob_DECREF(pObThreadMap);
+}
+
+/*
+* Unwind the callstacks of all threads of a process (or all processes) in a
+* batch and put them into the callstack cache. This is much more efficient
+* than retrieving the callstacks thread-by-thread when many callstacks are
+* needed since stack memory is prefetched and symbols are resolved in bulk.
+* Callback parsing is only supported for x64 user-mode threads.
+* -- H
+* -- pProcessOpt = process to unwind threads of, NULL for all processes.
+* -- flags = VMM_FLAG_NOCACHE (re-unwind already cached callstacks)
+*/
+VOID VmmWinThreadCs_GetCallstackBatch(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pProcessOpt, _In_ DWORD flags)
+{
+    PVMM_PROCESS pObProcess = NULL;
+    BOOL fNoCache = (flags & VMM_FLAG_NOCACHE) ? TRUE : FALSE;
+    if(H->vmm.tpMemoryModel != VMM_MEMORYMODEL_X64) { return; }
+    if(pProcessOpt) {
+        if(pProcessOpt->fUserOnly && !pProcessOpt->win.fWow64) {
+            VmmWinThreadCs_GetCallstackBatch_Process(H, pProcessOpt, fNoCache);
+        }
+        return;
+    }
+    while((pObProcess = VmmProcessGetNext(H, pObProcess, 0)) && !H->fAbort) {
+        if(pObProcess->fUserOnly && !pObProcess->win.fWow64) {
+            VmmWinThreadCs_GetCallstackBatch_Process(H, pObProcess, fNoCache);
+        }
+    }
+    Ob_DECREF(pObProcess);
+}
+
 /*
 * Refresh the callstack cache.
 * -- H
@@ -958,19 +1267,25 @@ BOOL VmmWinThreadCs_GetCallstack(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess,
     BOOL fNoCache = (flags & VMM_FLAG_NOCACHE) ? TRUE : FALSE;
     BOOL fRequireCache = (flags & VMM_FLAG_FORCECACHE_READ) ? TRUE : FALSE;
     QWORD qwKey = ((QWORD)pProcess->dwPID << 32) | pThread->dwTID;
+    PSRWLOCK pLockSRW;
+    if(!fNoCache && (pProcess->pObPersistent->Plugin.flags & VMMOB_PROCESS_PERSISTENT_FLAG_THREAD_CALLSTACK_ENABLE) && !ObMap_ExistsKey(H->vmm.pmObThreadCallback, qwKey)) {
+        // callstacks are enabled for the process - unwind all its threads in
+        // a batch since the remaining threads are very likely to be requested:
+        VmmWinThreadCs_GetCallstackBatch(H, pProcess, 0);
+    }
     if(fNoCache || !(pObCS = ObMap_GetByKey(H->vmm.pmObThreadCallback, qwKey)) || fRequireCache) {
-        AcquireSRWLockExclusive(&H->vmm.LockSRW.ThreadCallback);
+        pLockSRW = VmmWinThreadCs_GetCallstackLock(H, pProcess->dwPID, pThread->dwTID);
+        AcquireSRWLockExclusive(pLockSRW);
         if(fNoCache || !(pObCS = ObMap_GetByKey(H->vmm.pmObThreadCallback, qwKey))) {
             pObCS = VmmWinThreadCs_UnwindScanCallstack(H, pProcess, pThread);       // fetch the callstack
-            if(!pObCS && (pObCS = Ob_AllocEx(H, OB_TAG_THREAD_CALLSTACK, LMEM_ZEROINIT, sizeof(VMMOB_MAP_THREADCALLSTACK), NULL, NULL))) {
-                pObCS->dwPID = pProcess->dwPID;
-                pObCS->dwTID = pThread->dwTID;
+            if(!pObCS) {
+                pObCS = VmmWinThreadCs_CreateCallstackEmpty(H, pProcess->dwPID, pThread->dwTID);
             }
             if(pObCS) {
                 ObMap_Push(H->vmm.pmObThreadCallback, qwKey, pObCS);
             }
         }
-        ReleaseSRWLockExclusive(&H->vmm.LockSRW.ThreadCallback);
+        ReleaseSRWLockExclusive(pLockSRW);
     }
     *ppObCS = pObCS;
     return pObCS ? TRUE : FALSE;
@@ -50,4 +50,16 @@ VOID VmmWinThreadCs_Refresh(_In_ VMM_HANDLE H);
 _Success_(return)
 BOOL VmmWinThreadCs_GetCallstack(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pProcess, _In_ PVMM_MAP_THREADENTRY pThread, _In_ DWORD flags, _Out_ PVMMOB_MAP_THREADCALLSTACK *ppObCS);
 
+/*
+* Unwind the callstacks of all threads of a process (or all processes) in a
+* batch and put them into the callstack cache. This is much more efficient
+* than retrieving the callstacks thread-by-thread when many callstacks are
+* needed since stack memory is prefetched and symbols are resolved in bulk.
+* Callback parsing is only supported for x64 user-mode threads.
+* -- H
+* -- pProcessOpt = process to unwind threads of, NULL for all processes.
+* -- flags = VMM_FLAG_NOCACHE (re-unwind already cached callstacks)
+*/
+VOID VmmWinThreadCs_GetCallstackBatch(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pProcessOpt, _In_ DWORD flags);
+
 #endif /* __VMMWIN_H__ */
@@ -486,86 +486,351 @@ BOOL VmmYaraUtil_ParseSingleResultNext(
 // ----------------------------------------------------------------------------
 // SINGLE PROCESS YARA SEARCH FUNCTIONALITY:
 // This is quite similar to VmmSearch binary search functionality.
+// The search is performed in two steps: (1) the address space is walked and
+// the ranges to search are collected, (2) a number of workers partition the
+// ranges into 1MB chunks. Each worker either merges the results of the next
+// scanned chunk in address order, scans a ready chunk, or reads the next chunk
+// into a free buffer. Chunks are scanned in parallel; the matches of a chunk
+// are recorded and merged (result addresses, cMaxResult cut-off and the user
+// callback) by one worker at a time in ascending address order so that the
+// progress (vaCurrent) is monotonic and results are stable.
 // ----------------------------------------------------------------------------
 
+#define VMMYARAUTIL_SEARCH_CHUNK_SIZE       0x00100000      // 1MB
+#define VMMYARAUTIL_SEARCH_THREADS          4
+#define VMMYARAUTIL_SEARCH_BUFFERS          (2 * VMMYARAUTIL_SEARCH_THREADS)
+
+typedef struct tdVMMYARAUTIL_SEARCH_RANGE {
+    QWORD vaBase;
+    QWORD vaMax;
+} VMMYARAUTIL_SEARCH_RANGE, *PVMMYARAUTIL_SEARCH_RANGE;
+
+typedef struct tdVMMYARAUTIL_SEARCH_MATCH {
+    struct tdVMMYARAUTIL_SEARCH_MATCH *FLink;
+    VMMYARA_RULE_MATCH Match;               // NB! strings point into the (still loaded) rules.
+} VMMYARAUTIL_SEARCH_MATCH, *PVMMYARAUTIL_SEARCH_MATCH;
+
+typedef struct tdVMMYARAUTIL_SEARCH_BUFFER {
+    struct tdVMMYARAUTIL_SEARCH_BUFFER *FLink;
+    struct tdVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT *ctxi;
+    QWORD va;
+    DWORD cb;
+    DWORD iChunk;                           // chunk sequence number (address order).
+    BOOL fEmpty;                            // chunk is unreadable/zero - skip scan.
+    PVMMYARAUTIL_SEARCH_MATCH pMatch;       // recorded matches (in callback order).
+    PVMMYARAUTIL_SEARCH_MATCH *ppMatchTail;
+    BYTE pb[VMMYARAUTIL_SEARCH_CHUNK_SIZE];
+} VMMYARAUTIL_SEARCH_BUFFER, *PVMMYARAUTIL_SEARCH_BUFFER;
+
 typedef struct tdVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT {
     PVMMYARA_RULES hVmmYaraRules;
     PVMM_PROCESS pProcess;
     POB_SET psvaResult;
-    DWORD cb;
-    BYTE pb[0x00100000];    // 1MB
+    PVMMDLL_YARA_CONFIG ctxs;
+    BOOL fFail;                             // scan error in any worker.
+    SRWLOCK LockSRW;                        // protects range cursor, buffer lists and merge state.
+    HANDLE hEvent;                          // manual reset, set on buffer/merge state change.
+    BOOL fEventSet;
+    BOOL fMergeActive;                      // a worker is merging chunk iChunkMerge.
+    DWORD iChunkRead;                       // next chunk sequence number to read.
+    DWORD iChunkMerge;                      // next chunk sequence number to merge.
+    DWORD cRange;
+    DWORD cRangeMax;
+    DWORD iRange;                           // range cursor: current range.
+    QWORD vaNext;                           // range cursor: next chunk address.
+    PVMMYARAUTIL_SEARCH_RANGE pRange;
+    PVMMYARAUTIL_SEARCH_BUFFER pFree;       // buffers available for reading.
+    PVMMYARAUTIL_SEARCH_BUFFER pReady;      // buffers read and ready for scanning.
+    PVMMYARAUTIL_SEARCH_BUFFER pScanned;    // buffers scanned and ready for merging.
+    PVMMYARAUTIL_SEARCH_BUFFER pBuffers[VMMYARAUTIL_SEARCH_BUFFERS];
 } VMMYARAUTIL_SEARCH_INTERNAL_CONTEXT, *PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT;
 
+/*
+* Yara match callback. Called by the scanning worker - possibly in parallel
+* with other workers scanning other chunks. The match is only recorded in the
+* buffer; it's processed in address order by VmmYaraUtil_SearchMerge().
+*/
 BOOL VmmSearch_SearchRegion_YaraCB(_In_ PVOID pvContext, _In_ PVMMYARA_RULE_MATCH pRuleMatch, _In_reads_bytes_(cbBuffer) PBYTE pbBuffer, _In_ SIZE_T cbBuffer)
 {
-    DWORD i, j;
-    PVMMDLL_YARA_CONFIG ctxs = (PVMMDLL_YARA_CONFIG)pvContext;
-    PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi = (PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT)(SIZE_T)ctxs->_Reserved;
+    PVMMYARAUTIL_SEARCH_MATCH pe;
+    PVMMYARAUTIL_SEARCH_BUFFER pBuffer = (PVMMYARAUTIL_SEARCH_BUFFER)pvContext;
     if(pRuleMatch->dwVersion != VMMYARA_RULE_MATCH_VERSION) { return FALSE; }
-    for(i = 0; i < pRuleMatch->cStrings; i++) {
-        for(j = 0; j < pRuleMatch->Strings[i].cMatch; j++) {
-            ObSet_Push(ctxi->psvaResult, ctxs->vaCurrent + pRuleMatch->Strings[i].cbMatchOffset[j]);
+    if(pBuffer->ctxi->ctxs->fAbortRequested) { return FALSE; }
+    if(!(pe = LocalAlloc(0, sizeof(VMMYARAUTIL_SEARCH_MATCH)))) { return FALSE; }
+    memcpy(&pe->Match, pRuleMatch, sizeof(VMMYARA_RULE_MATCH));
+    pe->FLink = NULL;
+    *pBuffer->ppMatchTail = pe;
+    pBuffer->ppMatchTail = &pe->FLink;
+    return TRUE;
+}
+
+/*
+* Merge the recorded matches of a scanned chunk: add the result addresses and
+* make the user callback. Called for one chunk at a time in address order - no
+* locking is required. The context vaCurrent is the base address of the chunk.
+*/
+VOID VmmYaraUtil_SearchMerge(_In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMMYARAUTIL_SEARCH_BUFFER pBuffer)
+{
+    DWORD i, j;
+    PVMMYARAUTIL_SEARCH_MATCH pe;
+    PVMMDLL_YARA_CONFIG ctxs = ctxi->ctxs;
+    ctxs->vaCurrent = pBuffer->va;
+    ctxs->cbReadTotal += pBuffer->cb;
+    for(pe = pBuffer->pMatch; pe && !ctxs->fAbortRequested; pe = pe->FLink) {
+        for(i = 0; i < pe->Match.cStrings; i++) {
+            for(j = 0; j < pe->Match.Strings[i].cMatch; j++) {
+                ObSet_Push(ctxi->psvaResult, pBuffer->va + pe->Match.Strings[i].cbMatchOffset[j]);
+            }
+        }
+        ctxs->cResult = ObSet_Size(ctxi->psvaResult);
+        if(ctxs->cResult >= ctxs->cMaxResult) {
+            ctxs->fAbortRequested = TRUE;
+            break;
+        }
+        if(ctxs->pfnScanMemoryCB && !ctxs->pfnScanMemoryCB(ctxs->pvUserPtrOpt, &pe->Match, pBuffer->pb, pBuffer->cb)) {
+            break;
         }
     }
-    ctxs->cResult = ObSet_Size(ctxi->psvaResult);
-    if(ctxs->cResult >= ctxs->cMaxResult) {
-        ctxs->fAbortRequested = TRUE;
-        return FALSE;
+    while((pe = pBuffer->pMatch)) {
+        pBuffer->pMatch = pe->FLink;
+        LocalFree(pe);
     }
-    if(!ctxs->pfnScanMemoryCB) {
-        return TRUE;
+    pBuffer->ppMatchTail = &pBuffer->pMatch;
+}
+
+/*
+* Add a physical/virtual address range to the ranges to search. Ranges are
+* clipped against the already added ranges (ctxs->vaCurrent).
+*/
+VOID VmmYaraUtil_SearchRangeAdd(_In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMMDLL_YARA_CONFIG ctxs, _In_ QWORD vaMax)
+{
+    if((ctxs->vaCurrent > vaMax) || (ctxi->cRange >= ctxi->cRangeMax)) { return; }
+    ctxi->pRange[ctxi->cRange].vaBase = ctxs->vaCurrent;
+    ctxi->pRange[ctxi->cRange].vaMax = vaMax;
+    ctxi->cRange++;
+    ctxs->vaCurrent = vaMax + 1;
+    if(!ctxs->vaCurrent) {
+        ctxs->vaCurrent = 0xfffffffffffff000;
     }
-    return ctxs->pfnScanMemoryCB(ctxs->pvUserPtrOpt, pRuleMatch, pbBuffer, cbBuffer);
 }
 
 /*
-* Search data inside region.
+* Retrieve the next chunk to read from the ranges.
+* CALLER MUST HOLD ctxi->LockSRW
 */
 _Success_(return)
-BOOL VmmYaraUtil_SearchRegion(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMMDLL_YARA_CONFIG ctxs)
+BOOL VmmYaraUtil_SearchChunkNext(_In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi, _Out_ PQWORD pva, _Out_ PDWORD pcb)
 {
+    PVMMYARAUTIL_SEARCH_RANGE pe;
+    if(ctxi->iRange >= ctxi->cRange) { return FALSE; }
+    pe = ctxi->pRange + ctxi->iRange;
+    *pva = ctxi->vaNext;
+    *pcb = (DWORD)min(VMMYARAUTIL_SEARCH_CHUNK_SIZE, pe->vaMax + 1 - ctxi->vaNext);
+    ctxi->vaNext += *pcb;
+    if(!ctxi->vaNext || (ctxi->vaNext > pe->vaMax)) {
+        ctxi->iRange++;
+        if(ctxi->iRange < ctxi->cRange) {
+            ctxi->vaNext = ctxi->pRange[ctxi->iRange].vaBase;
+        }
+    }
+    return TRUE;
+}
+
+/*
+* Wake up workers waiting for a buffer/merge state change.
+* CALLER MUST HOLD ctxi->LockSRW
+*/
+VOID VmmYaraUtil_SearchNotify(_In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi)
+{
+    if(!ctxi->fEventSet) {
+        ctxi->fEventSet = TRUE;
+        SetEvent(ctxi->hEvent);
+    }
+}
+
+/*
+* Remove the buffer with the lowest chunk sequence number from a buffer list.
+* If iChunk is not -1 only a buffer with that sequence number is removed.
+* CALLER MUST HOLD ctxi->LockSRW
+* -- ppList
+* -- iChunk
+* -- return
+*/
+PVMMYARAUTIL_SEARCH_BUFFER VmmYaraUtil_SearchBufferTake(_In_ PVMMYARAUTIL_SEARCH_BUFFER *ppList, _In_ DWORD iChunk)
+{
+    PVMMYARAUTIL_SEARCH_BUFFER pBuffer, *ppBuffer, *ppBufferMin = NULL;
+    for(ppBuffer = ppList; *ppBuffer; ppBuffer = &(*ppBuffer)->FLink) {
+        if((iChunk != (DWORD)-1) && ((*ppBuffer)->iChunk != iChunk)) { continue; }
+        if(!ppBufferMin || ((*ppBuffer)->iChunk < (*ppBufferMin)->iChunk)) {
+            ppBufferMin = ppBuffer;
+        }
+    }
+    if(!ppBufferMin) { return NULL; }
+    pBuffer = *ppBufferMin;
+    *ppBufferMin = pBuffer->FLink;
+    return pBuffer;
+}
+
+/*
+* Search worker. Multiple workers run in parallel and share the range cursor
+* and the buffers. Merging the next chunk in address order takes priority over
+* scanning ready chunks (lowest address first), which takes priority over
+* reading new chunks. Workers with nothing to do wait for another worker to
+* free, ready, scan or merge a buffer.
+*/
+VOID VmmYaraUtil_SearchWorker(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi)
+{
+    BOOL fRead, fMerge;
     DWORD cbRead;
     VMMYARA_ERROR yrerr;
-    if(ctxs->fAbortRequested || H->fAbort) {
-        ctxs->fAbortRequested = TRUE;
-        return FALSE;
+    PVMMYARAUTIL_SEARCH_BUFFER pBuffer;
+    PVMMDLL_YARA_CONFIG ctxs = ctxi->ctxs;
+    while(TRUE) {
+        if(ctxs->fAbortRequested || ctxi->fFail || H->fAbort) {
+            ctxs->fAbortRequested = TRUE;
+            AcquireSRWLockExclusive(&ctxi->LockSRW);
+            VmmYaraUtil_SearchNotify(ctxi);
+            ReleaseSRWLockExclusive(&ctxi->LockSRW);
+            return;
+        }
+        // 1: fetch the next scanned buffer to merge, a ready buffer to scan,
+        //    or a free buffer and a chunk to read:
+        fRead = FALSE;
+        fMerge = FALSE;
+        AcquireSRWLockExclusive(&ctxi->LockSRW);
+        if(!ctxi->fMergeActive && (pBuffer = VmmYaraUtil_SearchBufferTake(&ctxi->pScanned, ctxi->iChunkMerge))) {
+            ctxi->fMergeActive = TRUE;
+            fMerge = TRUE;
+        } else if((pBuffer = VmmYaraUtil_SearchBufferTake(&ctxi->pReady, (DWORD)-1))) {
+            ;
+        } else if(ctxi->pFree && VmmYaraUtil_SearchChunkNext(ctxi, &ctxi->pFree->va, &ctxi->pFree->cb)) {
+            pBuffer = ctxi->pFree;
+            ctxi->pFree = pBuffer->FLink;
+            pBuffer->iChunk = ctxi->iChunkRead++;
+            fRead = TRUE;
+        }
+        if(!pBuffer) {
+            if((ctxi->iRange >= ctxi->cRange) && (ctxi->iChunkMerge == ctxi->iChunkRead)) {
+                // all chunks read, scanned and merged:
+                VmmYaraUtil_SearchNotify(ctxi);
+                ReleaseSRWLockExclusive(&ctxi->LockSRW);
+                return;
+            }
+            // wait for a buffer to be freed, readied, scanned or merged:
+            if(ctxi->fEventSet) {
+                ctxi->fEventSet = FALSE;
+                ResetEvent(ctxi->hEvent);
+            }
+            ReleaseSRWLockExclusive(&ctxi->LockSRW);
+            WaitForSingleObject(ctxi->hEvent, INFINITE);
+            continue;
+        }
+        ReleaseSRWLockExclusive(&ctxi->LockSRW);
+        // 2: read chunk into buffer and queue it as ready:
+        if(fRead) {
+            VmmReadEx(H, ctxi->pProcess, pBuffer->va, pBuffer->pb, pBuffer->cb, &cbRead, ctxs->ReadFlags | VMM_FLAG_ZEROPAD_ON_FAIL);
+            pBuffer->fEmpty = !cbRead || Util_IsZeroBuffer(pBuffer->pb, pBuffer->cb);
+            AcquireSRWLockExclusive(&ctxi->LockSRW);
+            pBuffer->FLink = ctxi->pReady;
+            ctxi->pReady = pBuffer;
+            VmmYaraUtil_SearchNotify(ctxi);
+            ReleaseSRWLockExclusive(&ctxi->LockSRW);
+            continue;
+        }
+        // 3: merge scanned buffer (in address order) and return it to the free list:
+        if(fMerge) {
+            VmmYaraUtil_SearchMerge(ctxi, pBuffer);
+            AcquireSRWLockExclusive(&ctxi->LockSRW);
+            pBuffer->FLink = ctxi->pFree;
+            ctxi->pFree = pBuffer;
+            ctxi->iChunkMerge++;
+            ctxi->fMergeActive = FALSE;
+            VmmYaraUtil_SearchNotify(ctxi);
+            ReleaseSRWLockExclusive(&ctxi->LockSRW);
+            continue;
+        }
+        // 4: scan ready buffer and queue it for merge (the compiled rules may be
+        //    used by concurrent scans - yr_rules_scan_mem() is thread-safe):
+        if(!pBuffer->fEmpty) {
+            yrerr = VmmYara_ScanMemory(
+                ctxi->hVmmYaraRules,
+                pBuffer->pb,
+                pBuffer->cb,
+                VMMYARA_SCAN_FLAGS_FAST_MODE | VMMYARA_SCAN_FLAGS_REPORT_RULES_MATCHING,
+                VmmSearch_SearchRegion_YaraCB,
+                pBuffer,
+                0
+            );
+            if(yrerr != VMMYARA_ERROR_SUCCESS) {
+                ctxi->fFail = TRUE;
+            }
+        }
+        AcquireSRWLockExclusive(&ctxi->LockSRW);
+        pBuffer->FLink = ctxi->pScanned;
+        ctxi->pScanned = pBuffer;
+        VmmYaraUtil_SearchNotify(ctxi);
+        ReleaseSRWLockExclusive(&ctxi->LockSRW);
     }
-    ctxs->cbReadTotal += ctxi->cb;
-    VmmReadEx(H, ctxi->pProcess, ctxs->vaCurrent, ctxi->pb, ctxi->cb, &cbRead, ctxs->ReadFlags | VMM_FLAG_ZEROPAD_ON_FAIL);
-    if(!cbRead || Util_IsZeroBuffer(ctxi->pb, ctxi->cb)) {
-        return TRUE;
-    }
-    if(Util_IsZeroBuffer(ctxi->pb, ctxi->cb)) {
-        return TRUE;
-    }
-    yrerr = VmmYara_ScanMemory(
-        ctxi->hVmmYaraRules,
-        ctxi->pb,
-        ctxi->cb,
-        VMMYARA_SCAN_FLAGS_FAST_MODE | VMMYARA_SCAN_FLAGS_REPORT_RULES_MATCHING,
-        VmmSearch_SearchRegion_YaraCB,
-        ctxs,
-        0
-    );
-    return yrerr == VMMYARA_ERROR_SUCCESS;
 }
 
 /*
-* Search a physical/virtual address range.
+* Search the collected ranges with multiple parallel workers.
 */
 _Success_(return)
-BOOL VmmYaraUtil_SearchRange(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMMDLL_YARA_CONFIG ctxs, _In_ QWORD vaMax)
+BOOL VmmYaraUtil_SearchRanges(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL_CONTEXT ctxi, _In_ PVMMDLL_YARA_CONFIG ctxs)
 {
-    while(ctxs->vaCurrent < vaMax) {
-        ctxi->cb = (DWORD)min(0x00100000, vaMax + 1 - ctxs->vaCurrent);
-        if(!VmmYaraUtil_SearchRegion(H, ctxi, ctxs)) { return FALSE; }
-        ctxs->vaCurrent += ctxi->cb;
-        if(!ctxs->vaCurrent) {
-            ctxs->vaCurrent = 0xfffffffffffff000;
+    DWORD i, cWork;
+    BOOL fResult = FALSE;
+    PVMMYARAUTIL_SEARCH_MATCH pe;
+    PVMMYARAUTIL_SEARCH_BUFFER pBuffer;
+    PVOID ctxWork[VMMYARAUTIL_SEARCH_THREADS];
+    PVMM_WORK_START_ROUTINE_PVOID_PFN pfnWork[VMMYARAUTIL_SEARCH_THREADS];
+    QWORD vaEnd = ctxs->vaCurrent;
+    if(!ctxi->cRange) { return TRUE; }
+    if(!(ctxi->hEvent = CreateEvent(NULL, TRUE, TRUE, NULL))) { return FALSE; }
+    ctxi->fEventSet = TRUE;
+    // allocate buffers:
+    for(i = 0; i < VMMYARAUTIL_SEARCH_BUFFERS; i++) {
+        if(!(ctxi->pBuffers[i] = LocalAlloc(0, sizeof(VMMYARAUTIL_SEARCH_BUFFER)))) {
+            if(!i) { goto fail; }
             break;
         }
+        ctxi->pBuffers[i]->ctxi = ctxi;
+        ctxi->pBuffers[i]->pMatch = NULL;
+        ctxi->pBuffers[i]->ppMatchTail = &ctxi->pBuffers[i]->pMatch;
+        ctxi->pBuffers[i]->FLink = ctxi->pFree;
+        ctxi->pFree = ctxi->pBuffers[i];
     }
-    return TRUE;
+    // run workers (one worker per two buffers, first worker in this thread):
+    ctxi->iRange = 0;
+    ctxi->vaNext = ctxi->pRange[0].vaBase;
+    ctxs->vaCurrent = ctxi->pRange[0].vaBase;
+    cWork = max(1, i / 2);
+    for(i = 0; i < cWork; i++) {
+        pfnWork[i] = (PVMM_WORK_START_ROUTINE_PVOID_PFN)VmmYaraUtil_SearchWorker;
+        ctxWork[i] = ctxi;
+    }
+    VmmWorkWaitMultiple2_Void(H, cWork, pfnWork, ctxWork);
+    if(ctxs->fAbortRequested || ctxi->fFail || H->fAbort) { goto fail; }
+    ctxs->vaCurrent = vaEnd;
+    fResult = TRUE;
+fail:
+    for(i = 0; i < VMMYARAUTIL_SEARCH_BUFFERS; i++) {
+        if((pBuffer = ctxi->pBuffers[i])) {
+            while((pe = pBuffer->pMatch)) {
+                pBuffer->pMatch = pe->FLink;
+                LocalFree(pe);
+            }
+            LocalFree(pBuffer);
+            ctxi->pBuffers[i] = NULL;
+        }
+    }
+    ctxi->pFree = NULL;
+    ctxi->pReady = NULL;
+    ctxi->pScanned = NULL;
+    CloseHandle(ctxi->hEvent);
+    ctxi->hEvent = NULL;
+    return fResult;
 }
 
 /*
@@ -587,6 +852,8 @@ BOOL VmmYaraUtil_VirtPteVad(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL
     if(ctxs->fForceVAD || (ctxi->pProcess->fUserOnly && !ctxs->fForcePTE)) {
         // VAD method:
         if(!VmmMap_GetVad(H, ctxi->pProcess, &pObVAD, VMM_VADMAP_TP_CORE)) { goto fail; }
+        if(!(ctxi->pRange = LocalAlloc(0, max(1, pObVAD->cMap) * sizeof(VMMYARAUTIL_SEARCH_RANGE)))) { goto fail; }
+        ctxi->cRangeMax = pObVAD->cMap;
         for(ie = 0; ie < pObVAD->cMap; ie++) {
             peVAD = pObVAD->pMap + ie;
             if(peVAD->vaStart + peVAD->vaEnd < ctxs->vaMin) { continue; }   // skip entries below min address
@@ -596,11 +863,13 @@ BOOL VmmYaraUtil_VirtPteVad(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL
             // TODO: is peVAD->vaEnd == 0xfff ????
             ctxs->vaCurrent = max(ctxs->vaCurrent, peVAD->vaStart);
             vaMax = min(ctxs->vaMax, peVAD->vaEnd);
-            if(!VmmYaraUtil_SearchRange(H, ctxi, ctxs, vaMax)) { goto fail; }
+            VmmYaraUtil_SearchRangeAdd(ctxi, ctxs, vaMax);
         }
     } else {
         // PTE method:
         if(!VmmMap_GetPte(H, ctxi->pProcess, &pObPTE, FALSE)) { goto fail; }
+        if(!(ctxi->pRange = LocalAlloc(0, max(1, pObPTE->cMap) * sizeof(VMMYARAUTIL_SEARCH_RANGE)))) { goto fail; }
+        ctxi->cRangeMax = pObPTE->cMap;
         for(ie = 0; ie < pObPTE->cMap; ie++) {
             pePTE = pObPTE->pMap + ie;
             cbPTE = pePTE->cPages << 12;
@@ -610,10 +879,12 @@ BOOL VmmYaraUtil_VirtPteVad(_In_ VMM_HANDLE H, _In_ PVMMYARAUTIL_SEARCH_INTERNAL
             if(ctxs->pfnFilterOptCB && !ctxs->pfnFilterOptCB(ctxs, (PVMMDLL_MAP_PTEENTRY)pePTE, NULL)) { continue; }
             ctxs->vaCurrent = max(ctxs->vaCurrent, pePTE->vaBase);
             vaMax = min(ctxs->vaMax, pePTE->vaBase + cbPTE - 1);
-            if(!VmmYaraUtil_SearchRange(H, ctxi, ctxs, vaMax)) { goto fail; }
+            VmmYaraUtil_SearchRangeAdd(ctxi, ctxs, vaMax);
         }
     }
-    fResult = TRUE;
+    Ob_DECREF_NULL(&pObPTE);
+    Ob_DECREF_NULL(&pObVAD);
+    fResult = VmmYaraUtil_SearchRanges(H, ctxi, ctxs);
 fail:
     Ob_DECREF(pObPTE);
     Ob_DECREF(pObVAD);
@@ -656,7 +927,9 @@ BOOL VmmYaraUtil_SearchSingleProcess(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pP
     if(!(ctxi = LocalAlloc(LMEM_ZEROINIT, sizeof(VMMYARAUTIL_SEARCH_INTERNAL_CONTEXT)))) { goto fail; }
     if(!(ctxi->psvaResult = ObSet_New(H))) { goto fail; }
     ctxs->_Reserved = (QWORD)(SIZE_T)ctxi;
+    ctxi->ctxs = ctxs;
     ctxi->pProcess = pProcess;
+    InitializeSRWLock(&ctxi->LockSRW);
     // 3: load yara rules
     if(ctxs->cRules == 1) {
         VmmYara_RulesLoadCompiled(ctxs->pszRules[0], &ctxi->hVmmYaraRules);
@@ -672,8 +945,13 @@ BOOL VmmYaraUtil_SearchSingleProcess(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pP
     if(pProcess && (ctxs->fForcePTE || ctxs->fForceVAD || (H->vmm.tpMemoryModel == VMMDLL_MEMORYMODEL_X64))) {
         fResult = VmmYaraUtil_VirtPteVad(H, ctxi, ctxs);
     } else {
+        ctxs->cResult = 0;
+        ctxs->cbReadTotal = 0;
         ctxs->vaCurrent = ctxs->vaMin;
-        fResult = VmmYaraUtil_SearchRange(H, ctxi, ctxs, ctxs->vaMax);
+        if(!(ctxi->pRange = LocalAlloc(0, sizeof(VMMYARAUTIL_SEARCH_RANGE)))) { goto fail; }
+        ctxi->cRangeMax = 1;
+        VmmYaraUtil_SearchRangeAdd(ctxi, ctxs, ctxs->vaMax);
+        fResult = VmmYaraUtil_SearchRanges(H, ctxi, ctxs);
     }
     fResult = fResult || (ctxs->cResult && (ctxs->cResult == ctxs->cMaxResult));
     // 5: finish
@@ -685,6 +963,7 @@ fail:
     if(ctxi) {
         if(ctxi->hVmmYaraRules) { VmmYara_RulesDestroy(ctxi->hVmmYaraRules); }
         Ob_DECREF(ctxi->psvaResult);
+        LocalFree(ctxi->pRange);
         LocalFree(ctxi);
     }
     ctxs->_Reserved = 0;
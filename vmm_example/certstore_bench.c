@@ -0,0 +1,442 @@
+// certstore_bench.c : timing benchmark of the certificate store extraction in
+//     vmm/modules/m_sys_cert.c against a synthetic set of registry hives.
+//
+// The real m_sys_cert.c is compiled into this benchmark. Its registry and user
+// map functions are redirected to a synthetic hive set: one local machine hive
+// and a configurable number of user hives, each with SystemCertificates stores
+// holding certificates. The root store certificates are shared by all users -
+// as on a real terminal server - so that duplicate handling is exercised too.
+// Every registry access which would touch hive memory sleeps for a fixed time
+// to emulate the memory read latency of the acquisition device.
+//
+// MSysCert_GetContext() is timed twice: once with the store jobs run one after
+// another on the calling thread (the behavior before the jobs were parallelized
+// and the worst case of a busy worker pool) and once with the jobs spread onto
+// the VmmWork worker pool. The resulting context maps are verified identical.
+//
+// Linux only. The benchmark is linked with the vmm objects (libvmm.a) since the
+// functions exercised are internal. Build with 'make certstore_bench' and run
+// as (from the files directory):
+//     ./certstore_bench [user_hives] [latency_us]
+//
+// (c) Ulf Frisk, 2024
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#include "../vmm/oscompatibility.h"
+
+// minimal crypt32 certificate api used by m_sys_cert.c (not available on linux).
+// the synthetic certificates carry their subject and issuer names in plain text.
+#define X509_ASN_ENCODING                   0x00000001
+#define PKCS_7_ASN_ENCODING                 0x00010000
+#define CERT_NAME_SIMPLE_DISPLAY_TYPE       4
+#define CERT_NAME_ISSUER_FLAG               0x1
+
+typedef struct tdBENCH_CERT_CONTEXT {
+    DWORD cbCertEncoded;
+    PBYTE pbCertEncoded;
+    CHAR szSubject[64];
+    CHAR szIssuer[64];
+} CERT_CONTEXT;
+typedef const CERT_CONTEXT *PCCERT_CONTEXT;
+
+PCCERT_CONTEXT CertCreateCertificateContext(_In_ DWORD dwCertEncodingType, _In_reads_(cb) const BYTE *pb, _In_ DWORD cb);
+DWORD CertGetNameStringW(_In_ PCCERT_CONTEXT pCertContext, _In_ DWORD dwType, _In_ DWORD dwFlags, _In_opt_ PVOID pvTypePara, _Out_writes_opt_(cch) LPWSTR wsz, _In_ DWORD cch);
+BOOL CertFreeCertificateContext(_In_opt_ PCCERT_CONTEXT pCertContext);
+
+// redirect the registry/user map/worker pool functions used by m_sys_cert.c:
+#define VmmWinReg_HiveGetByAddress          Bench_HiveGetByAddress
+#define VmmWinReg_KeyHiveGetByFullPath      Bench_KeyHiveGetByFullPath
+#define VmmWinReg_KeyGetByPath              Bench_KeyGetByPath
+#define VmmWinReg_KeyGetByChildName         Bench_KeyGetByChildName
+#define VmmWinReg_KeyList                   Bench_KeyList
+#define VmmWinReg_KeyInfo                   Bench_KeyInfo
+#define VmmWinReg_KeyValueGetByName         Bench_KeyValueGetByName
+#define VmmWinReg_ValueInfo                 Bench_ValueInfo
+#define VmmWinReg_ValueQuery4               Bench_ValueQuery4
+#define VmmMap_GetUser                      Bench_GetUser
+#define VmmWorkWaitMultiple2_Void           Bench_WorkWaitMultiple2_Void
+
+#include "../vmm/modules/m_sys_cert.c"
+
+#undef VmmWorkWaitMultiple2_Void
+VOID VmmWorkWaitMultiple2_Void(_In_ VMM_HANDLE H, _In_ DWORD cWork, _In_count_(cWork) PVMM_WORK_START_ROUTINE_PVOID_PFN *pfns, _In_count_(cWork) PVOID *ctxs);
+
+#include "../vmm/vmmwork.h"
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_USERS_DEFAULT                 64
+#define BENCH_LATENCY_US_DEFAULT            50
+#define BENCH_STORES                        4
+#define BENCH_CERTS_PER_STORE               6
+#define BENCH_CERT_SIZE                     0x500
+#define BENCH_HIVE_VA_BASE                  0xffffc00000000000ULL
+
+#define BENCH_KEY_TP_SYSCERT                1       // [ROOT\Software\(Policies\)Microsoft\SystemCertificates]
+#define BENCH_KEY_TP_STORE                  2       // [...\SystemCertificates\<store>]
+#define BENCH_KEY_TP_STORECERTS             3       // [...\SystemCertificates\<store>\Certificates]
+#define BENCH_KEY_TP_CERT                   4       // [...\SystemCertificates\<store>\Certificates\<thumbprint>]
+
+static LPSTR BENCH_STORE_NAMES[BENCH_STORES] = { "Root", "CA", "My", "TrustedPeople" };
+
+struct tdOB_REGISTRY_KEY {
+    OB ObHdr;
+    DWORD tp;
+    DWORD iHive;
+    DWORD iPolicy;
+    DWORD iStore;
+    DWORD iCert;
+};
+
+struct tdOB_REGISTRY_VALUE {
+    OB ObHdr;
+    DWORD iHive;
+    DWORD iPolicy;
+    DWORD iStore;
+    DWORD iCert;
+};
+
+static DWORD g_cBenchUsers = BENCH_USERS_DEFAULT;
+static DWORD g_dwBenchLatencyUs = BENCH_LATENCY_US_DEFAULT;
+static BOOL g_fBenchSerial = FALSE;
+static POB_REGISTRY_HIVE *g_pBenchHives = NULL;     // [0] = HKLM\SOFTWARE, [1..] = user hives.
+
+static QWORD Bench_TickCountNS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+* Emulate the latency of reading not yet cached hive memory.
+*/
+static VOID Bench_Latency()
+{
+    if(g_dwBenchLatencyUs) {
+        usleep(g_dwBenchLatencyUs);
+    }
+}
+
+/*
+* Certificate thumbprint of a synthetic certificate. Root store certificates
+* are shared between all hives; other certificates are unique per hive.
+*/
+static VOID Bench_CertThumbprint(_In_ DWORD iHive, _In_ DWORD iPolicy, _In_ DWORD iStore, _In_ DWORD iCert, _Out_writes_(41) LPSTR sz)
+{
+    QWORD qwId = ((QWORD)(iStore ? iHive + 1 : 0) << 32) | (iPolicy << 16) | (iStore << 8) | iCert;
+    snprintf(sz, 41, "%08x%016llx%016llx", 0xc0ffee00 | iStore, qwId * 0x9e3779b97f4a7c15ULL, qwId + 1);
+}
+
+//-----------------------------------------------------------------------------
+// SYNTHETIC CRYPT32 API:
+//-----------------------------------------------------------------------------
+
+PCCERT_CONTEXT CertCreateCertificateContext(_In_ DWORD dwCertEncodingType, _In_reads_(cb) const BYTE *pb, _In_ DWORD cb)
+{
+    CERT_CONTEXT *pc;
+    if((cb < 0x80) || memcmp(pb, "CERT", 4) || !(pc = calloc(1, sizeof(CERT_CONTEXT) + cb))) { return NULL; }
+    pc->cbCertEncoded = cb;
+    pc->pbCertEncoded = (PBYTE)(pc + 1);
+    memcpy(pc->pbCertEncoded, pb, cb);
+    strncpy(pc->szSubject, (LPSTR)pb + 0x04, sizeof(pc->szSubject) - 1);
+    strncpy(pc->szIssuer, (LPSTR)pb + 0x44, sizeof(pc->szIssuer) - 1);
+    return pc;
+}
+
+DWORD CertGetNameStringW(_In_ PCCERT_CONTEXT pCertContext, _In_ DWORD dwType, _In_ DWORD dwFlags, _In_opt_ PVOID pvTypePara, _Out_writes_opt_(cch) LPWSTR wsz, _In_ DWORD cch)
+{
+    DWORD i;
+    LPCSTR sz = (dwFlags & CERT_NAME_ISSUER_FLAG) ? pCertContext->szIssuer : pCertContext->szSubject;
+    DWORD csz = (DWORD)strlen(sz) + 1;
+    if(!wsz) { return csz; }
+    for(i = 0; (i < csz) && (i < cch); i++) {
+        wsz[i] = sz[i];
+    }
+    if(cch) { wsz[min(csz, cch) - 1] = 0; }
+    return min(csz, cch);
+}
+
+BOOL CertFreeCertificateContext(_In_opt_ PCCERT_CONTEXT pCertContext)
+{
+    free((PVOID)pCertContext);
+    return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// SYNTHETIC HIVE SET:
+//-----------------------------------------------------------------------------
+
+static POB_REGISTRY_KEY Bench_KeyNew(_In_ VMM_HANDLE H, _In_ DWORD tp, _In_ DWORD iHive, _In_ DWORD iPolicy, _In_ DWORD iStore, _In_ DWORD iCert)
+{
+    POB_REGISTRY_KEY pObKey;
+    if((pObKey = Ob_AllocEx(H, 'BKey', LMEM_ZEROINIT, sizeof(struct tdOB_REGISTRY_KEY), NULL, NULL))) {
+        pObKey->tp = tp;
+        pObKey->iHive = iHive;
+        pObKey->iPolicy = iPolicy;
+        pObKey->iStore = iStore;
+        pObKey->iCert = iCert;
+    }
+    return pObKey;
+}
+
+static DWORD Bench_HiveIndex(_In_ POB_REGISTRY_HIVE pHive)
+{
+    return (DWORD)((pHive->vaCMHIVE - BENCH_HIVE_VA_BASE) >> 12);
+}
+
+POB_REGISTRY_HIVE Bench_HiveGetByAddress(_In_ VMM_HANDLE H, _In_ QWORD vaCMHIVE)
+{
+    QWORD iHive = (vaCMHIVE - BENCH_HIVE_VA_BASE) >> 12;
+    return (iHive <= g_cBenchUsers) ? Ob_INCREF(g_pBenchHives[iHive]) : NULL;
+}
+
+_Success_(return)
+BOOL Bench_KeyHiveGetByFullPath(_In_ VMM_HANDLE H, _In_ LPCSTR uszPathFull, _Out_ POB_REGISTRY_HIVE *ppObHive, _Out_opt_ POB_REGISTRY_KEY *ppObKey)
+{
+    Bench_Latency();
+    *ppObHive = Ob_INCREF(g_pBenchHives[0]);
+    if(ppObKey) {
+        *ppObKey = Bench_KeyNew(H, BENCH_KEY_TP_SYSCERT, 0, strstr(uszPathFull, "Policies") ? 1 : 0, 0, 0);
+    }
+    return TRUE;
+}
+
+POB_REGISTRY_KEY Bench_KeyGetByPath(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ LPCSTR uszPath)
+{
+    Bench_Latency();
+    return Bench_KeyNew(H, BENCH_KEY_TP_SYSCERT, Bench_HiveIndex(pHive), strstr(uszPath, "Policies") ? 1 : 0, 0, 0);
+}
+
+POB_REGISTRY_KEY Bench_KeyGetByChildName(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pParentKey, _In_ LPSTR uszChildName)
+{
+    Bench_Latency();
+    if((pParentKey->tp != BENCH_KEY_TP_STORE) || strcmp(uszChildName, "Certificates")) { return NULL; }
+    return Bench_KeyNew(H, BENCH_KEY_TP_STORECERTS, pParentKey->iHive, pParentKey->iPolicy, pParentKey->iStore, 0);
+}
+
+POB_MAP Bench_KeyList(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_opt_ POB_REGISTRY_KEY pKeyParent)
+{
+    DWORD i, c, tp;
+    POB_MAP pmObKeys;
+    POB_REGISTRY_KEY pObKey;
+    Bench_Latency();
+    if(!pKeyParent || !(pmObKeys = ObMap_New(H, OB_MAP_FLAGS_OBJECT_OB))) { return NULL; }
+    switch(pKeyParent->tp) {
+        case BENCH_KEY_TP_SYSCERT:      tp = BENCH_KEY_TP_STORE; c = BENCH_STORES; break;
+        case BENCH_KEY_TP_STORECERTS:   tp = BENCH_KEY_TP_CERT;  c = BENCH_CERTS_PER_STORE; break;
+        default:                        tp = 0; c = 0; break;
+    }
+    for(i = 0; i < c; i++) {
+        pObKey = Bench_KeyNew(H, tp, pKeyParent->iHive, pKeyParent->iPolicy, (tp == BENCH_KEY_TP_STORE) ? i : pKeyParent->iStore, (tp == BENCH_KEY_TP_CERT) ? i : 0);
+        ObMap_Push(pmObKeys, i + 1, pObKey);
+        Ob_DECREF(pObKey);
+    }
+    return pmObKeys;
+}
+
+VOID Bench_KeyInfo(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pKey, _Out_ PVMM_REGISTRY_KEY_INFO pKeyInfo)
+{
+    ZeroMemory(pKeyInfo, sizeof(VMM_REGISTRY_KEY_INFO));
+    pKeyInfo->fActive = TRUE;
+    if(pKey->tp == BENCH_KEY_TP_STORE) {
+        strcpy_s(pKeyInfo->uszName, sizeof(pKeyInfo->uszName), BENCH_STORE_NAMES[pKey->iStore]);
+    } else if(pKey->tp == BENCH_KEY_TP_CERT) {
+        Bench_CertThumbprint(pKey->iHive, pKey->iPolicy, pKey->iStore, pKey->iCert, pKeyInfo->uszName);
+    }
+    pKeyInfo->cbuName = (DWORD)strlen(pKeyInfo->uszName) + 1;
+}
+
+POB_REGISTRY_VALUE Bench_KeyValueGetByName(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_KEY pKeyParent, _In_ LPCSTR uszValueName)
+{
+    POB_REGISTRY_VALUE pObValue;
+    Bench_Latency();
+    if((pKeyParent->tp != BENCH_KEY_TP_CERT) || strcmp(uszValueName, "Blob")) { return NULL; }
+    if((pObValue = Ob_AllocEx(H, 'BVal', LMEM_ZEROINIT, sizeof(struct tdOB_REGISTRY_VALUE), NULL, NULL))) {
+        pObValue->iHive = pKeyParent->iHive;
+        pObValue->iPolicy = pKeyParent->iPolicy;
+        pObValue->iStore = pKeyParent->iStore;
+        pObValue->iCert = pKeyParent->iCert;
+    }
+    return pObValue;
+}
+
+VOID Bench_ValueInfo(_In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_VALUE pValue, _Out_ PVMM_REGISTRY_VALUE_INFO pValueInfo)
+{
+    ZeroMemory(pValueInfo, sizeof(VMM_REGISTRY_VALUE_INFO));
+    pValueInfo->dwType = REG_BINARY;
+    pValueInfo->cbData = 0x40 + BENCH_CERT_SIZE;
+    pValueInfo->raValueCell = 0x1000 + (((pValue->iPolicy * BENCH_STORES) + pValue->iStore) * BENCH_CERTS_PER_STORE + pValue->iCert) * 0x20;
+    strcpy_s(pValueInfo->uszName, sizeof(pValueInfo->uszName), "Blob");
+    pValueInfo->cbuName = 5;
+}
+
+/*
+* Synthetic certificate registry blob: a property header followed by the
+* certificate property (id 0x20) holding the "encoded" certificate.
+*/
+_Success_(return)
+BOOL Bench_ValueQuery4(_In_ VMM_HANDLE H, _In_ POB_REGISTRY_HIVE pHive, _In_ POB_REGISTRY_VALUE pKeyValue, _Out_opt_ PDWORD pdwType, _Out_writes_opt_(cbData) PBYTE pbData, _In_ DWORD cbData, _Out_opt_ PDWORD pcbData)
+{
+    DWORD i, cb = 0x40 + BENCH_CERT_SIZE;
+    PBYTE pbCert;
+    Bench_Latency();
+    Bench_Latency();    // blob data is stored in a separate big data cell.
+    if(pdwType) { *pdwType = REG_BINARY; }
+    if(pcbData) { *pcbData = cb; }
+    if(!pbData) { return TRUE; }
+    if(cbData < cb) { return FALSE; }
+    ZeroMemory(pbData, cb);
+    *(PDWORD)(pbData + 0x00) = 0x0f;                    // property: hash
+    *(PDWORD)(pbData + 0x08) = 0x14;
+    *(PQWORD)(pbData + 0x24) = 0x0000000100000020;      // property: certificate
+    *(PDWORD)(pbData + 0x2c) = BENCH_CERT_SIZE;
+    pbCert = pbData + 0x30;
+    memcpy(pbCert, "CERT", 4);
+    snprintf((LPSTR)pbCert + 0x04, 0x40, "Bench %s Cert %i-%i%s", BENCH_STORE_NAMES[pKeyValue->iStore], (pKeyValue->iStore ? pKeyValue->iHive : 0), pKeyValue->iCert, (pKeyValue->iPolicy ? " (Policy)" : ""));
+    snprintf((LPSTR)pbCert + 0x44, 0x40, "Bench %s Issuing CA %i", BENCH_STORE_NAMES[pKeyValue->iStore], pKeyValue->iCert % 3);
+    for(i = 0x84; i < BENCH_CERT_SIZE; i++) {
+        pbCert[i] = (BYTE)(i * 31 + pKeyValue->iCert);
+    }
+    return TRUE;
+}
+
+_Success_(return)
+BOOL Bench_GetUser(_In_ VMM_HANDLE H, _Out_ PVMMOB_MAP_USER *ppObUserMap)
+{
+    DWORD i, o = 0;
+    PVMMOB_MAP_USER pObUserMap;
+    if(!(pObUserMap = Ob_AllocEx(H, OB_TAG_MAP_USER, LMEM_ZEROINIT, sizeof(VMMOB_MAP_USER) + g_cBenchUsers * (sizeof(VMM_MAP_USERENTRY) + 16), NULL, NULL))) { return FALSE; }
+    pObUserMap->cMap = g_cBenchUsers;
+    pObUserMap->pbMultiText = (PBYTE)(pObUserMap->pMap + g_cBenchUsers);
+    pObUserMap->cbMultiText = g_cBenchUsers * 16;
+    for(i = 0; i < g_cBenchUsers; i++) {
+        pObUserMap->pMap[i].uszText = (LPSTR)pObUserMap->pbMultiText + o;
+        pObUserMap->pMap[i].cbuText = 1 + snprintf(pObUserMap->pMap[i].uszText, 16, "user%04i", i);
+        pObUserMap->pMap[i].dwHashSID = 0x51d00000 + i;
+        pObUserMap->pMap[i].vaRegHive = BENCH_HIVE_VA_BASE + ((QWORD)(i + 1) << 12);
+        o += 16;
+    }
+    *ppObUserMap = pObUserMap;
+    return TRUE;
+}
+
+/*
+* Worker pool: run the jobs on the real VmmWork pool or - in serial mode - on
+* the calling thread only. The work items share a job index so the first item
+* processes all jobs in order when run alone.
+*/
+VOID Bench_WorkWaitMultiple2_Void(_In_ VMM_HANDLE H, _In_ DWORD cWork, _In_count_(cWork) PVMM_WORK_START_ROUTINE_PVOID_PFN *pfns, _In_count_(cWork) PVOID *ctxs)
+{
+    if(g_fBenchSerial) {
+        pfns[0](H, ctxs[0]);
+        return;
+    }
+    VmmWorkWaitMultiple2_Void(H, cWork, pfns, ctxs);
+}
+
+//-----------------------------------------------------------------------------
+// BENCHMARK:
+//-----------------------------------------------------------------------------
+
+/*
+* Build the certificate context map from the synthetic hive set.
+* -- H
+* -- ctxP
+* -- fSerial
+* -- pqwTimeNS
+* -- return = the context map, CALLER DECREF.
+*/
+static POB_MAP Bench_GetContext(_In_ VMM_HANDLE H, _In_ PVMMDLL_PLUGIN_CONTEXT ctxP, _In_ BOOL fSerial, _Out_ PQWORD pqwTimeNS)
+{
+    QWORD tcStart;
+    POB_MAP pmObCtx;
+    g_fBenchSerial = fSerial;
+    ObContainer_SetOb((POB_CONTAINER)ctxP->ctxM, NULL);
+    tcStart = Bench_TickCountNS();
+    pmObCtx = MSysCert_GetContext(H, ctxP);
+    *pqwTimeNS = Bench_TickCountNS() - tcStart;
+    return pmObCtx;
+}
+
+/*
+* Verify that the two context maps contain the same certificates in the same
+* order (certificate indexes in certificates.txt must not change).
+*/
+static BOOL Bench_Verify(_In_ POB_MAP pm1, _In_ POB_MAP pm2)
+{
+    DWORD i, c;
+    BOOL fResult = TRUE;
+    PMSYSCERT_OB_ENTRY pe1, pe2;
+    if(!pm1 || !pm2 || ((c = ObMap_Size(pm1)) != ObMap_Size(pm2)) || !c) { return FALSE; }
+    for(i = 0; fResult && (i < c); i++) {
+        pe1 = ObMap_GetByIndex(pm1, i);
+        pe2 = ObMap_GetByIndex(pm2, i);
+        fResult = pe1 && pe2 &&
+            (pe1->qwIdMapKey == pe2->qwIdMapKey) && (pe1->vaHive == pe2->vaHive) && (pe1->dwHashUserSID == pe2->dwHashUserSID) &&
+            (pe1->oRegBlob == pe2->oRegBlob) && (pe1->oRegCellValue == pe2->oRegCellValue) && (pe1->cbCert == pe2->cbCert) &&
+            !strcmp(pe1->uszStore, pe2->uszStore) && !strcmp(pe1->uszIdHash, pe2->uszIdHash) &&
+            !strcmp(pe1->uszSubjectCN, pe2->uszSubjectCN) && !strcmp(pe1->uszIssuerCN, pe2->uszIssuerCN);
+        Ob_DECREF(pe1);
+        Ob_DECREF(pe2);
+    }
+    return fResult;
+}
+
+int main(_In_ int argc, _In_ char *argv[])
+{
+    int iResult = 1;
+    DWORD i, cStoreJobs;
+    QWORD tcSerial, tcParallel;
+    VMM_HANDLE H = NULL;
+    VMMDLL_PLUGIN_CONTEXT ctxP = { 0 };
+    POB_MAP pmObSerial = NULL, pmObParallel = NULL;
+    if(argc > 1) { g_cBenchUsers = (DWORD)strtoul(argv[1], NULL, 0); }
+    if(argc > 2) { g_dwBenchLatencyUs = (DWORD)strtoul(argv[2], NULL, 0); }
+    // 1: minimal vmm handle with object manager and worker pool:
+    if(!(H = LocalAlloc(LMEM_ZEROINIT, sizeof(struct tdVMM_HANDLE)))) { goto fail; }
+    InitializeCriticalSection(&H->vmm.LockUpdateModule);
+    Ob_PoolInitialize();
+    if(!VmmWork_Initialize(H)) { goto fail; }
+    // 2: synthetic hive set:
+    if(!(g_pBenchHives = LocalAlloc(LMEM_ZEROINIT, (1 + g_cBenchUsers) * sizeof(POB_REGISTRY_HIVE)))) { goto fail; }
+    for(i = 0; i <= g_cBenchUsers; i++) {
+        if(!(g_pBenchHives[i] = Ob_AllocEx(H, 'BHiv', LMEM_ZEROINIT, sizeof(OB_REGISTRY_HIVE), NULL, NULL))) { goto fail; }
+        g_pBenchHives[i]->vaCMHIVE = BENCH_HIVE_VA_BASE + ((QWORD)i << 12);
+        snprintf(g_pBenchHives[i]->uszName, sizeof(g_pBenchHives[i]->uszName), i ? "user%04i-ntuser" : "SOFTWARE", i - 1);
+    }
+    if(!(ctxP.ctxM = (PVMMDLL_PLUGIN_INTERNAL_CONTEXT)ObContainer_New())) { goto fail; }
+    ctxP.uszPath = "";
+    cStoreJobs = 2 * (1 + g_cBenchUsers);
+    printf("certstore_bench: %i user hives, %i store jobs, %i certificates, %i us latency per hive read.\n", g_cBenchUsers, cStoreJobs, cStoreJobs * BENCH_STORES * BENCH_CERTS_PER_STORE, g_dwBenchLatencyUs);
+    // 3: serial (one store job after another) vs. parallel (worker pool):
+    pmObSerial = Bench_GetContext(H, &ctxP, TRUE, &tcSerial);
+    pmObParallel = Bench_GetContext(H, &ctxP, FALSE, &tcParallel);
+    if(!Bench_Verify(pmObSerial, pmObParallel)) {
+        printf("certstore_bench: verification FAILED - context maps differ.\n");
+        goto fail;
+    }
+    printf("certstore_bench: context maps verified identical (%i unique certificates).\n", ObMap_Size(pmObParallel));
+    printf("  serial:   %9.1f ms\n", tcSerial / 1000000.0);
+    printf("  parallel: %9.1f ms  (%i workers)  speedup %.2fx\n", tcParallel / 1000000.0, min(MSYSCERT_WORK_THREADS, cStoreJobs), (double)tcSerial / (tcParallel ? tcParallel : 1));
+    iResult = 0;
+fail:
+    Ob_DECREF(pmObSerial);
+    Ob_DECREF(pmObParallel);
+    if(ctxP.ctxM) { MSysCert_Close(H, &ctxP); }
+    if(g_pBenchHives) {
+        for(i = 0; i <= g_cBenchUsers; i++) {
+            Ob_DECREF(g_pBenchHives[i]);
+        }
+        LocalFree(g_pBenchHives);
+    }
+    if(H) {
+        H->fAbort = TRUE;
+        VmmWork_Interrupt(H);
+        VmmWork_Close(H);
+        DeleteCriticalSection(&H->vmm.LockUpdateModule);
+        LocalFree(H);
+    }
+    return iResult;
+}
@@ -0,0 +1,190 @@
+// hexascii_bench.c : microbenchmark of the hex dump renderer in vmm.
+//
+// Benchmark VMMDLL_UtilFillHexAscii() (Util_FillHexAscii() in vmm/util.c,
+// which renders full 16-byte rows with SSE2 on x64 / NEON on arm64) against
+// the previous per-byte implementation which is kept below as reference.
+// Output of the two is verified to be identical for random buffers, sizes and
+// initial offsets before any timing is done.
+//
+// Build with 'make hexascii_bench' and run as (from the files directory):
+//     ./hexascii_bench [iterations]
+//
+// (c) Ulf Frisk, 2024
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else /* _WIN32 */
+#include <time.h>
+#endif /* _WIN32 */
+#include <leechcore.h>
+#include <vmmdll.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#define FALSE                           0
+#endif /* TRUE */
+
+#define BENCH_ITERATIONS_DEFAULT        0x4000
+#define BENCH_VERIFY_ROUNDS             0x1000
+#define BENCH_BUFFER_MAX                0x10000
+
+#define Bench_2HexChar(x) (((((x) & 0xf) <= 9) ? '0' : ('a' - 10)) + ((x) & 0xf))
+
+static LPCSTR BENCH_PRINTASCII =
+    "................................ !\"#$%&'()*+,-./0123456789:;<=>?"
+    "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ "
+    "................................................................"
+    "................................................................";
+
+static QWORD Bench_TickCountNS()
+{
+#ifdef _WIN32
+    LARGE_INTEGER qwFreq, qwNow;
+    QueryPerformanceFrequency(&qwFreq);
+    QueryPerformanceCounter(&qwNow);
+    return (QWORD)(qwNow.QuadPart * (1000000000.0 / qwFreq.QuadPart));
+#else /* _WIN32 */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif /* _WIN32 */
+}
+
+/*
+* Reference: the per-byte Util_FillHexAscii() implementation before the full
+* row fast path was added.
+*/
+static BOOL Bench_FillHexAscii_Reference(_In_reads_opt_(cb) PBYTE pb, _In_ DWORD cb, _In_ DWORD cbInitialOffset, _Out_writes_opt_(*pcsz) LPSTR sz, _Inout_ PDWORD pcsz)
+{
+    DWORD i, j, o = 0, iMod, cRows;
+    // checks
+    if((cbInitialOffset > cb) || (cbInitialOffset > 0x1000) || (cbInitialOffset & 0xf)) { return FALSE; }
+    cRows = (cb + 0xf) >> 4;
+    if(!sz) {
+        *pcsz = 1 + cRows * 76;
+        return TRUE;
+    }
+    if(!pb || (*pcsz <= cRows * 76)) { return FALSE; }
+    // fill buffer with bytes
+    for(i = cbInitialOffset; i < cb + ((cb % 16) ? (16 - cb % 16) : 0); i++)
+    {
+        // address
+        if(0 == i % 16) {
+            iMod = i % 0x10000;
+            sz[o++] = Bench_2HexChar(iMod >> 12);
+            sz[o++] = Bench_2HexChar(iMod >> 8);
+            sz[o++] = Bench_2HexChar(iMod >> 4);
+            sz[o++] = Bench_2HexChar(iMod);
+            sz[o++] = ' ';
+            sz[o++] = ' ';
+            sz[o++] = ' ';
+            sz[o++] = ' ';
+        } else if(0 == i % 8) {
+            sz[o++] = ' ';
+        }
+        // hex
+        if(i < cb) {
+            sz[o++] = Bench_2HexChar(pb[i] >> 4);
+            sz[o++] = Bench_2HexChar(pb[i]);
+            sz[o++] = ' ';
+        } else {
+            sz[o++] = ' ';
+            sz[o++] = ' ';
+            sz[o++] = ' ';
+        }
+        // ascii
+        if(15 == i % 16) {
+            sz[o++] = ' ';
+            sz[o++] = ' ';
+            for(j = i - 15; j <= i; j++) {
+                if(j >= cb) {
+                    sz[o++] = ' ';
+                } else {
+                    sz[o++] = BENCH_PRINTASCII[pb[j]];
+                }
+            }
+            sz[o++] = '\n';
+        }
+    }
+    sz[o] = 0;
+    *pcsz = o;
+    return TRUE;
+}
+
+/*
+* Verify that vmm and the reference render identical output for random data,
+* sizes and initial offsets.
+* -- return
+*/
+static BOOL Bench_Verify(_In_ PBYTE pb, _In_ LPSTR szRef, _In_ LPSTR szVmm, _In_ DWORD csz)
+{
+    DWORD i, cb, cbOffset, cszRef, cszVmm;
+    for(i = 0; i < BENCH_VERIFY_ROUNDS; i++) {
+        cb = 1 + (rand() % 0x2000);
+        cbOffset = (rand() % 4) ? 0 : ((rand() % (((cb < 0x1000) ? cb : 0x1000) + 1)) & ~0xf);
+        cszRef = cszVmm = csz;
+        if(!Bench_FillHexAscii_Reference(pb + (i & 0xff), cb, cbOffset, szRef, &cszRef)) { return FALSE; }
+        if(!VMMDLL_UtilFillHexAscii(pb + (i & 0xff), cb, cbOffset, szVmm, &cszVmm)) { return FALSE; }
+        if((cszRef != cszVmm) || memcmp(szRef, szVmm, cszRef + 1)) {
+            printf("hexascii_bench: output mismatch: cb=%x offset=%x\n", cb, cbOffset);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+int main(_In_ int argc, _In_ char *argv[])
+{
+    DWORD i, iSize, cIterations, csz, cszResult;
+    DWORD cbSize[] = { 0x40, 0x100, 0x1000, 0x10000 };
+    QWORD tcStart, tcRef, tcVmm;
+    PBYTE pb;
+    LPSTR szRef, szVmm;
+    cIterations = (argc > 1) ? (DWORD)strtoul(argv[1], NULL, 0) : BENCH_ITERATIONS_DEFAULT;
+    if(!cIterations) { cIterations = BENCH_ITERATIONS_DEFAULT; }
+    csz = 2 + ((BENCH_BUFFER_MAX + 0x100 + 0xf) >> 4) * 76;
+    pb = malloc(BENCH_BUFFER_MAX + 0x100);
+    szRef = malloc(csz);
+    szVmm = malloc(csz);
+    if(!pb || !szRef || !szVmm) { return 1; }
+    srand(1);
+    for(i = 0; i < BENCH_BUFFER_MAX + 0x100; i++) {
+        pb[i] = (BYTE)rand();
+    }
+    if(!Bench_Verify(pb, szRef, szVmm, csz)) {
+        printf("hexascii_bench: verification FAILED.\n");
+        return 1;
+    }
+    printf("hexascii_bench: output verified identical (%i random buffers).\n", BENCH_VERIFY_ROUNDS);
+    for(iSize = 0; iSize < sizeof(cbSize) / sizeof(DWORD); iSize++) {
+        tcStart = Bench_TickCountNS();
+        for(i = 0; i < cIterations; i++) {
+            cszResult = csz;
+            Bench_FillHexAscii_Reference(pb, cbSize[iSize], 0, szRef, &cszResult);
+        }
+        tcRef = Bench_TickCountNS() - tcStart;
+        tcStart = Bench_TickCountNS();
+        for(i = 0; i < cIterations; i++) {
+            cszResult = csz;
+            VMMDLL_UtilFillHexAscii(pb, cbSize[iSize], 0, szVmm, &cszResult);
+        }
+        tcVmm = Bench_TickCountNS() - tcStart;
+        printf(
+            "  %6u bytes:  reference %9.1f ns  vmm %9.1f ns  (%5.2f ns/byte -> %5.2f ns/byte)  speedup %.2fx\n",
+            cbSize[iSize],
+            (double)tcRef / cIterations,
+            (double)tcVmm / cIterations,
+            (double)tcRef / cIterations / cbSize[iSize],
+            (double)tcVmm / cIterations / cbSize[iSize],
+            (double)tcRef / (tcVmm ? tcVmm : 1));
+    }
+    free(pb);
+    free(szRef);
+    free(szVmm);
+    return 0;
+}
@@ -0,0 +1,692 @@
+// ntfsfinalize_test.c : regression test of the ntfs mft finalize step in
+//     vmm/modules/m_fc_ntfs.c against a synthetic set of MFT records.
+//
+// The real m_fc_ntfs.c is compiled into this test. A synthetic set of 1kB MFT
+// 'FILE' records is generated - a directory tree spread over the physical
+// volume and two $Mft volumes with resident data, alternate data streams,
+// duplicate records, deleted entries, orphans (missing parent directories),
+// name collisions, non-ascii names and directory chains deep enough to exceed
+// the max path length. The records are ingested with FcNtfs2_IngestFileRecord.
+//
+// The same record set is finalized twice into two separate in-memory forensic
+// databases: once with the sequential finalize implementation which is kept
+// below as reference (the implementation before sorting, hashing and path
+// building were parallelized and database inserts were batched) and once with
+// FcNtfs2_FcIngestFinalize(). All 'ntfs' table rows - joined with their 'str'
+// table path strings - must be identical. The ntfs_files.txt line offset and
+// record index published to the module vfs context is verified against the
+// database too: entry lookups, directory listings and ntfs_files.txt windows.
+//
+// A memory report of the ingested entries is printed: the heap used by the
+// arena blocks the entries are packed into is compared with the heap used when
+// the same entries are allocated with one LocalAlloc each (as before the arena
+// was introduced - replayed with the entry sizes of the ingested set).
+//
+// Linux only. The test is linked with the vmm objects (libvmm.a) since the
+// functions exercised are internal. Build with 'make ntfsfinalize_test' and
+// run as (from the files directory):
+//     ./ntfsfinalize_test [records] [seed]
+//
+// (c) Ulf Frisk, 2024
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#include "../vmm/modules/m_fc_ntfs.c"
+#include "../vmm/vmmwork.h"
+#include <time.h>
+#include <uchar.h>
+#include <malloc.h>
+
+#define TEST_RECORDS_DEFAULT                100000
+#define TEST_SEED_DEFAULT                   1
+#define TEST_VOLUMES                        3           // physical + 2x $Mft volumes.
+#define TEST_DEEP_CHAIN                     40          // directories in the deep chain.
+
+#define TEST_SQL_SCHEMA_STR                 "DROP TABLE IF EXISTS str; CREATE TABLE str ( id INTEGER PRIMARY KEY, cbu INT, cbj INT, cbv INT, sz TEXT ); "
+#define TEST_SQL_SELECT                     "SELECT n.id, n.id_parent, n.id_str, n.hash, n.hash_parent, n.addr_phys, n.inode, n.inode_parent, n.flags, n.size_file, n.time_create, n.time_modify, n.time_read, n.name_seq, n.oln_u, n.oln_j, s.cbu, s.cbj, s.cbv, s.sz FROM ntfs n LEFT JOIN str s ON s.id = n.id_str ORDER BY n.id"
+
+static LPCSTR TEST_NAMES[] = {
+    "Windows", "System32", "drivers", "Program Files", "Users", "AppData", "Local", "Temp", "desktop.ini", "ntoskrnl.exe",
+    "kernel32.dll", "notepad.exe", "README.txt", "readme.TXT", "data.bin", "log.etl", "caf\xc3\xa9", "\xe6\x97\xa5\xe6\x9c\xac",
+    "quote\"name", "$Recycle.Bin", "pagefile.sys", "a", "B", "config"
+};
+
+static QWORD Test_TickCountNS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static DWORD g_dwTestRand = 1;
+
+static DWORD Test_wcslen(_In_ LPWSTR wsz)
+{
+    DWORD i = 0;
+    while(wsz[i]) { i++; }
+    return i;
+}
+
+static DWORD Test_Rand()
+{
+    g_dwTestRand = g_dwTestRand * 1103515245 + 12345;
+    return (g_dwTestRand >> 8) & 0x00ffffff;
+}
+
+//-----------------------------------------------------------------------------
+// REFERENCE: SEQUENTIAL FINALIZE (SORT/COUNT/HASH/PATH BUILD/INSERT):
+//-----------------------------------------------------------------------------
+
+static VOID Ref_MergeSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    DWORD iEntry, cEntries, i;
+    DWORD cChildArrayMax = 0x80000;     // 512k entries
+    PFCNTFS2 *pChildArray, pDir, pe;
+    if(!(pChildArray = (PFCNTFS2*)LocalAlloc(0, cChildArrayMax * sizeof(SIZE_T)))) { return; }
+    cEntries = ObMap_Size(ctx->pmMft);
+    for(iEntry = 0; iEntry < cEntries; iEntry++) {
+        pDir = (PFCNTFS2)ObMap_GetByIndex(ctx->pmMft, iEntry);
+        if(pDir->cChild < 2) { continue; }
+        if(pDir->cChild >= cChildArrayMax) { continue; }
+        pe = pDir->pChild;
+        i = 0;
+        while(pe) {
+            pChildArray[i++] = pe;
+            pe = pe->pSibling;
+        }
+        qsort(pChildArray, i, sizeof(PFCNTFS2), (_CoreCrtNonSecureSearchSortCompareFunction)FcNtfs2_FcIngestFinalize_MergeSortCompare);
+        pDir->pChild = NULL;
+        while(i) {
+            i--;
+            pe = pChildArray[i];
+            pe->pSibling = pDir->pChild;
+            pDir->pChild = pe;
+        }
+    }
+    LocalFree(pChildArray);
+}
+
+static VOID Ref_VolumeCountSort(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    DWORD i, c;
+    PFCNTFS2 pe;
+    POB_MAP pmOb = NULL;
+    if(ctx->cVolumes == 1) { return; }
+    if(!(pmOb = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID | OB_MAP_FLAGS_NOKEY))) { return; }
+    for(i = 1; i < ctx->cVolumes; i++) {
+        c = 0;
+        ObMap_Push(pmOb, 0, ctx->pVolumes[i].pRoot);
+        while((pe = ObMap_Pop(pmOb))) {
+            while(pe) {
+                c++;
+                if(pe->pChild) {
+                    ObMap_Push(pmOb, 0, pe->pChild);
+                }
+                pe = pe->pSibling;
+            }
+        }
+        ctx->pVolumes[i].cEntry = c;
+    }
+    qsort(ctx->pVolumes + 1, ctx->cVolumes - 1, sizeof(FCNTFS2_VOLUME), (_CoreCrtNonSecureSearchSortCompareFunction)FcNtfs2_FcIngestFinalize_VolumeCountSort_Compare);
+    for(i = 1; i < ctx->cVolumes; i++) {
+        ctx->pVolumes[i].wId = (WORD)i;
+        if(ctx->pVolumes[i].pRoot) {
+            _snprintf_s(ctx->pVolumes[i].pRoot->uszName, FCNTFS2_SYNTHETIC_NAME_BUFSIZE, _TRUNCATE, "%u", i);
+        }
+    }
+    Ob_DECREF(pmOb);
+}
+
+static BOOL Ref_MergeHash(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    BOOL fResult = FALSE;
+    DWORD iParent = 0, i;
+    PFCNTFS2 peParent, pe;
+    POB_MAP pmOb = NULL;
+    POB_COUNTER pcOb = NULL;
+    QWORD qwName_SeqNbr;
+    if(!(pmOb = ObMap_New(H, OB_MAP_FLAGS_OBJECT_VOID | OB_MAP_FLAGS_NOKEY))) { goto fail; }
+    if(!(pcOb = ObCounter_New(H, 0))) { goto fail; }
+    for(i = 0; i < ctx->cVolumes; i++) {
+        if((pe = ctx->pVolumes[i].pRoot)) {
+            pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, pe->wName_SeqNbr);
+            pe->qwHashPath = pe->dwHashName;
+            ObMap_Push(pmOb, 0, pe);
+        }
+    }
+    while(TRUE) {
+        peParent = ObMap_GetByIndex(pmOb, iParent++);
+        if(!peParent) { break; }
+        ObCounter_Clear(pcOb);
+        pe = peParent->pChild;
+        while(pe) {
+            pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, 0);
+            if((qwName_SeqNbr = ObCounter_Inc(pcOb, pe->dwHashName) - 1)) {
+                if(qwName_SeqNbr >= 0xffff) {
+                    pe->pSibling = NULL;
+                }
+                pe->wName_SeqNbr = (WORD)qwName_SeqNbr;
+                pe->dwHashName = CharUtil_HashNameFsU(pe->uszName, pe->wName_SeqNbr);
+            }
+            pe->qwHashPath = pe->dwHashName + ((peParent->qwHashPath >> 13) | (peParent->qwHashPath << 51));
+            if(pe->pChild) {
+                ObMap_Push(pmOb, 0, pe);
+            }
+            while(pe->pSibling && !pe->pSibling->paRecord && !pe->pSibling->cChild && (pe->dwHashName == CharUtil_HashNameFsU(pe->pSibling->uszName, 0))) {
+                pe->pSibling = pe->pSibling->pSibling;
+                pe->pParent->cChild--;
+            }
+            pe = pe->pSibling;
+        }
+    }
+    fResult = TRUE;
+fail:
+    Ob_DECREF(pcOb);
+    Ob_DECREF(pmOb);
+    return fResult;
+}
+
+static VOID Ref_DbPush_Database(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctx, _In_ PFCNTFS2 pe, _In_ LPSTR uszPathName)
+{
+    FCSQL_INSERTSTRTABLE SqlStrInsert = { 0 };
+    if(!Fc_SqlInsertStr(H, ctx->st_str, uszPathName + 1, &SqlStrInsert)) { return; }
+    sqlite3_reset(ctx->st);
+    Fc_SqlBindMultiInt64(ctx->st, 1, 16,
+        pe->qwDbId,
+        pe->pParent ? pe->pParent->qwDbId : (QWORD)-1,
+        SqlStrInsert.id,
+        pe->qwHashPath,
+        pe->pParent ? pe->pParent->qwHashPath : 0,
+        pe->paRecord,
+        (QWORD)pe->dwMftRecordNumber,
+        (QWORD)pe->dwParentMftRecordNumber,
+        (QWORD)pe->flags,
+        pe->cbFileSize,
+        pe->ftCreate,
+        pe->ftModify,
+        pe->ftRead,
+        (QWORD)pe->wName_SeqNbr,
+        ctx->cbUtf8Total + pe->qwDbId * M_NTFS_INFO_LINELENGTH_UTF8,
+        ctx->cbJsonTotal + pe->qwDbId * M_NTFS_INFO_LINELENGTH_JSON);
+    sqlite3_step(ctx->st);
+    ctx->cbUtf8Total += SqlStrInsert.cbu;
+    ctx->cbJsonTotal += SqlStrInsert.cbj;
+}
+
+static VOID Ref_DbPush_BuildPath(_In_ VMM_HANDLE H, _In_ PFCNTFS2_FINALIZE_CONTEXT ctx, _In_ PFCNTFS2 peNt, _In_ WORD wDirDepth, _In_reads_(2048) LPSTR uszPath, _In_ DWORD cuszPath)
+{
+    DWORD cuszName;
+    while(peNt) {
+        cuszName = (DWORD)strlen(peNt->uszName);
+        if(cuszPath + cuszName + 2 >= 2048) { break; }
+        uszPath[cuszPath] = '\\';
+        memcpy(&uszPath[cuszPath + 1], peNt->uszName, cuszName + 1ULL);
+        peNt->wDirDepth = wDirDepth;
+        peNt->qwDbId = ctx->qwNextDbId++;
+        Ref_DbPush_Database(H, ctx, peNt, uszPath);
+        if(peNt->pChild) {
+            Ref_DbPush_BuildPath(H, ctx, peNt->pChild, wDirDepth + 1, uszPath, cuszPath + cuszName + 1);
+        }
+        peNt = peNt->pSibling;
+    }
+    uszPath[cuszPath] = 0;
+}
+
+static VOID Ref_DbPush(_In_ VMM_HANDLE H, POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    FCNTFS2_FINALIZE_CONTEXT ctxFinal = { 0 };
+    CHAR uszPath[2048] = { 0 };
+    DWORD i;
+    uszPath[0] = '\\';
+    if(!(ctxFinal.hSql = Fc_SqlReserve(H))) { goto fail; }
+    if(SQLITE_OK != sqlite3_prepare_v2(ctxFinal.hSql, szFCNTFS2_SQL_INSERT "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &ctxFinal.st, NULL)) { goto fail; }
+    if(SQLITE_OK != sqlite3_prepare_v2(ctxFinal.hSql, szFC_SQL_STR_INSERT, -1, &ctxFinal.st_str, NULL)) { goto fail; }
+    sqlite3_exec(ctxFinal.hSql, "BEGIN TRANSACTION", NULL, NULL, NULL);
+    for(i = 0; i < ctx->cVolumes; i++) {
+        if((i == 0) || (ctx->pVolumes[i].cEntry > 2)) {
+            Ref_DbPush_BuildPath(H, &ctxFinal, ctx->pVolumes[i].pRoot, 0, uszPath, 1);
+        }
+    }
+    sqlite3_exec(ctxFinal.hSql, "COMMIT TRANSACTION", NULL, NULL, NULL);
+fail:
+    sqlite3_finalize(ctxFinal.st);
+    sqlite3_finalize(ctxFinal.st_str);
+    Fc_SqlReserveReturn(H, ctxFinal.hSql);
+}
+
+static VOID Ref_IngestFinalize(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx)
+{
+    if(!FcNtfs2_FcIngestFinalize_CreateVolumeRoots(H, ctx)) { return; }
+    if(!FcNtfs2_FcIngestFinalize_MergeAll(H, ctx)) { return; }
+    FcNtfs2_FcIngestFinalize_MergeShrink(H, ctx);
+    Ref_MergeSort(H, ctx);
+    Ref_VolumeCountSort(H, ctx);
+    if(!Ref_MergeHash(H, ctx)) { return; }
+    Fc_SqlExec(H, FC_SQL_SCHEMA_NTFS);
+    Ref_DbPush(H, ctx);
+}
+
+//-----------------------------------------------------------------------------
+// SYNTHETIC MFT RECORD SET:
+//-----------------------------------------------------------------------------
+
+/*
+* Append a resident attribute to a synthetic MFT record.
+* -- pb = 1kB record.
+* -- po = offset of next attribute (updated).
+* -- dwType
+* -- pbData
+* -- cbData
+* -- wszName = optional attribute name (alternate data stream).
+* -- return = pointer to attribute data, NULL if out of space.
+*/
+static PBYTE Test_RecordAddAttr(_Inout_updates_(0x400) PBYTE pb, _Inout_ PDWORD po, _In_ DWORD dwType, _In_reads_opt_(cbData) PBYTE pbData, _In_ DWORD cbData, _In_opt_ LPWSTR wszName)
+{
+    PNTFS_ATTR pA = (PNTFS_ATTR)(pb + *po);
+    DWORD cwName = wszName ? Test_wcslen(wszName) : 0;
+    DWORD oData = (0x18 + cwName * 2 + 7) & ~7;
+    DWORD cb = (oData + cbData + 7) & ~7;
+    if(*po + cb + 8 > 0x400) { return NULL; }
+    pA->Type = dwType;
+    pA->Length = cb;
+    pA->NameLength = (BYTE)cwName;
+    pA->NameOffset = 0x18;
+    pA->AttrLength = cbData;
+    pA->AttrOffset = (WORD)oData;
+    if(cwName) {
+        memcpy(pb + *po + 0x18, wszName, cwName * 2);
+    }
+    if(pbData) {
+        memcpy(pb + *po + oData, pbData, cbData);
+    }
+    *po += cb;
+    *(PDWORD)(pb + *po) = 0xffffffff;
+    return pb + *po - cb + oData;
+}
+
+/*
+* Build a synthetic 1kB MFT 'FILE' record.
+*/
+static VOID Test_RecordBuild(_Out_writes_(0x400) PBYTE pb, _In_ DWORD dwRecord, _In_ DWORD dwParent, _In_ BOOL fDir, _In_ BOOL fActive, _In_ LPCSTR uszName, _In_ QWORD ftBase, _In_ DWORD cbResident, _In_opt_ LPWSTR wszADS)
+{
+    DWORD o, cwName;
+    BYTE pbFn[0x42 + 2 * 0x80] = { 0 };
+    BYTE pbData[0x40] = { 0 };
+    PNTFS_FILE_RECORD pR = (PNTFS_FILE_RECORD)pb;
+    NTFS_STANDARD_INFORMATION si = { 0 };
+    PNTFS_FILE_NAME pfn = (PNTFS_FILE_NAME)pbFn;
+    ZeroMemory(pb, 0x400);
+    pR->Signature = 'ELIF';
+    pR->SequenceNumber = (WORD)(1 + (dwRecord % 7));
+    pR->HardLinkCount = 1;
+    pR->FirstAttributeOffset = 0x38;
+    pR->Flags = (fActive ? NTFS_FILE_RECORD_FLAG_ACTIVE : 0) | (fDir ? NTFS_FILE_RECORD_FLAG_DIRECTORY : 0);
+    pR->MftRecordNumber = dwRecord;
+    o = 0x38;
+    si.TimeCreate = ftBase;
+    si.TimeModify = ftBase + 0x1000 * (dwRecord & 0xff);
+    si.TimeRead = ftBase + 0x2000 * (dwRecord & 0xfff);
+    Test_RecordAddAttr(pb, &o, NTFS_ATTR_TYPE_STANDARD_INFORMATION, (PBYTE)&si, sizeof(si), NULL);
+    CharUtil_UtoW((LPSTR)uszName, -1, (PBYTE)pfn->Name, 2 * 0x80, NULL, &cwName, CHARUTIL_FLAG_STR_BUFONLY | CHARUTIL_FLAG_TRUNCATE);
+    pfn->ParentDirectory.SegmentNumber = dwParent;
+    pfn->ParentDirectory.SequenceNumber = 1 + (dwParent % 7);
+    pfn->TimeCreate = si.TimeCreate;
+    pfn->TimeModify = si.TimeModify;
+    pfn->TimeRead = si.TimeRead;
+    pfn->SizeReal = fDir ? 0 : (0x1000 + dwRecord * 0x10ULL);
+    pfn->SizeAllocated = (pfn->SizeReal + 0xfff) & ~0xfffULL;
+    pfn->NameLength = (BYTE)Test_wcslen(pfn->Name);
+    pfn->NameSpace = NTFS_FILENAME_NAMESPACE_WIN32;
+    Test_RecordAddAttr(pb, &o, NTFS_ATTR_TYPE_FILE_NAME, pbFn, 0x42 + 2 * pfn->NameLength, NULL);
+    if(!fDir && cbResident) {
+        Test_RecordAddAttr(pb, &o, NTFS_ATTR_TYPE_DATA, pbData, cbResident, NULL);
+    }
+    if(wszADS) {
+        Test_RecordAddAttr(pb, &o, NTFS_ATTR_TYPE_DATA, pbData, 0x10, wszADS);
+    }
+}
+
+/*
+* Generate and ingest the synthetic MFT record set. The same seed always
+* generates the same set.
+* -- H
+* -- ctx
+* -- cRecords
+* -- dwSeed
+*/
+static VOID Test_Generate(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_ DWORD cRecords, _In_ DWORD dwSeed)
+{
+    DWORD i, r, dwRecord, dwParent, cDir;
+    WORD wVolumeId, wFlagsSource;
+    BOOL fDir, fActive;
+    CHAR uszName[MAX_PATH];
+    BYTE pb[0x400];
+    PFCNTFS2_VOLUME pVolume;
+    g_dwTestRand = dwSeed;
+    // $Mft volumes (physical volume is created by FcNtfs2_InitContext):
+    for(i = 1; i < TEST_VOLUMES; i++) {
+        if(!(pVolume = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS2_VOLUME)))) { return; }
+        pVolume->wId = ctx->wNextVolumeId++;
+        pVolume->vaDevice = 0xffffd00000000000ULL + i * 0x1000;
+        snprintf(pVolume->uszVolumeName, sizeof(pVolume->uszVolumeName), "HarddiskVolume%u", i);
+        ObMap_Push(ctx->pmVolume, pVolume->vaDevice, pVolume);
+    }
+    cDir = max(16, cRecords / 8);
+    for(i = 0; i < cRecords; i++) {
+        r = Test_Rand();
+        wVolumeId = (WORD)(r % TEST_VOLUMES);
+        fDir = (i < cDir);
+        fActive = (r >> 4) % 11 != 0;
+        dwRecord = 16 + i;
+        if(i < TEST_DEEP_CHAIN) {
+            // deep directory chain - exceeds max path length:
+            dwParent = i ? (dwRecord - 1) : 5;
+            snprintf(uszName, sizeof(uszName), "deep_%02u_%s", i, "0123456789012345678901234567890123456789012345678901234567");
+            wVolumeId = 1;
+        } else {
+            dwParent = (r % 97 == 0) ? (0x00800000 + (Test_Rand() % 64)) : ((r % 13 == 0) ? 5 : (16 + (Test_Rand() % (fDir ? i : cDir))));
+            snprintf(uszName, sizeof(uszName), "%s%s%u", TEST_NAMES[Test_Rand() % _countof(TEST_NAMES)], (r % 5) ? "_" : "", (r % 3) ? (Test_Rand() % 50) : 0);
+        }
+        Test_RecordBuild(pb, dwRecord, dwParent, fDir, fActive, uszName, 0x01d8000000000000ULL + ((QWORD)i << 24), (r % 7 == 0) ? (1 + (r % 0x40)) : 0, (r % 41 == 0) ? (LPWSTR)u"Zone.Identifier" : NULL);
+        wFlagsSource = (r % 3) ? FCNTFS2_FLAG_SOURCE_PMEM_MFT : FCNTFS2_FLAG_SOURCE_FILE_MFT;
+        FcNtfs2_IngestFileRecord(H, ctx, (PNTFS_FILE_RECORD)pb, pb, wVolumeId, wFlagsSource, 0x100000000ULL + ((QWORD)i << 10));
+        if(r % 29 == 0) {
+            // duplicate record seen twice in physical memory:
+            FcNtfs2_IngestFileRecord(H, ctx, (PNTFS_FILE_RECORD)pb, pb, wVolumeId, FCNTFS2_FLAG_SOURCE_PMEM_MFT, 0x200000000ULL + ((QWORD)i << 10));
+        }
+        if(r % 31 == 0) {
+            // older version of the record (different timestamps) on another volume:
+            Test_RecordBuild(pb, dwRecord, dwParent, fDir, FALSE, uszName, 0x01d7000000000000ULL + ((QWORD)i << 24), 0, NULL);
+            FcNtfs2_IngestFileRecord(H, ctx, (PNTFS_FILE_RECORD)pb, pb, (WORD)((wVolumeId + 1) % TEST_VOLUMES), FCNTFS2_FLAG_SOURCE_PMEM_MFT, 0x300000000ULL + ((QWORD)i << 10));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// MEMORY REPORT:
+//-----------------------------------------------------------------------------
+
+static QWORD Test_HeapInUse()
+{
+    struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+}
+
+/*
+* Print the heap used by the ingested entries: arena (current) versus one
+* LocalAlloc per entry (previous, replayed with the same entry sizes). The
+* previous implementation LocalFree'd duplicates removed from pmMft, so only
+* entries in pmMft are replayed.
+* -- ctx
+* -- cbHeapIngest = measured heap growth of the ingest (incl. maps).
+*/
+static VOID Test_MemoryReport(_In_ POB_FCNTFS2_INIT_CONTEXT ctx, _In_ QWORD cbHeapIngest)
+{
+    DWORD i, cEntry;
+    QWORD cbHeapStart, cbHeapArena = 0, cbHeapEntry, cbUsed = 0;
+    PFCNTFS2 pe;
+    PVOID *ppv;
+    PFCNTFS2_ARENA_BLOCK pBlock;
+    for(pBlock = ctx->Arena.pBlock; pBlock; pBlock = pBlock->pNext) {
+        cbHeapArena += malloc_usable_size(pBlock);
+        cbUsed += pBlock->oUsed;
+    }
+    cEntry = ObMap_Size(ctx->pmMft);
+    if(!(ppv = LocalAlloc(LMEM_ZEROINIT, max(1, cEntry) * sizeof(PVOID)))) { return; }
+    cbHeapStart = Test_HeapInUse();
+    for(i = 0; i < cEntry; i++) {
+        pe = ObMap_GetByIndex(ctx->pmMft, i);
+        ppv[i] = LocalAlloc(LMEM_ZEROINIT, sizeof(FCNTFS2) + ((pe->flags & FCNTFS2_FLAG_SOURCE_SYNTHETIC) ? FCNTFS2_SYNTHETIC_NAME_BUFSIZE : (strlen(pe->uszName) + 1)));
+    }
+    cbHeapEntry = Test_HeapInUse() - cbHeapStart;
+    for(i = 0; i < cEntry; i++) {
+        LocalFree(ppv[i]);
+    }
+    LocalFree(ppv);
+    printf("  memory: %u entries (%llu arena allocations)\n", cEntry, ctx->Arena.cAlloc);
+    printf("    entry storage: per-entry LocalAlloc %7.2f MB  ->  arena %7.2f MB heap (%llu blocks, %.2f MB, %.1f%% used)\n",
+        cbHeapEntry / 1048576.0, cbHeapArena / 1048576.0, ctx->Arena.cBlock, ctx->Arena.cbBlock / 1048576.0, 100.0 * cbUsed / max(1, ctx->Arena.cbBlock));
+    printf("    ingest peak heap:                   %7.2f MB  ->  %7.2f MB\n",
+        (cbHeapIngest - cbHeapArena + cbHeapEntry) / 1048576.0, cbHeapIngest / 1048576.0);
+}
+
+//-----------------------------------------------------------------------------
+// TEST:
+//-----------------------------------------------------------------------------
+
+/*
+* Run a single finalize on a freshly generated record set into a new database.
+* -- H
+* -- fReference = TRUE: reference implementation, FALSE: vmm implementation.
+* -- cRecords
+* -- dwSeed
+* -- phSql = receives the database, caller closes.
+* -- ppObVfs = receives the published vfs line index (vmm implementation only).
+* -- pcEntry = receives the number of ingested entries.
+* -- pqwTimeNS = receives the finalize time.
+* -- return
+*/
+static BOOL Test_Run(_In_ VMM_HANDLE H, _In_ BOOL fReference, _In_ DWORD cRecords, _In_ DWORD dwSeed, _Out_ sqlite3 **phSql, _Out_ POB_FCNTFS2_VFS *ppObVfs, _Out_ PDWORD pcEntry, _Out_ PQWORD pqwTimeNS)
+{
+    QWORD tcStart, cbHeapStart;
+    VMMDLL_PLUGIN_CONTEXT ctxP = { 0 };
+    POB_FCNTFS2_INIT_CONTEXT ctxOb = NULL;
+    *phSql = NULL;
+    *ppObVfs = NULL;
+    if(SQLITE_OK != sqlite3_open(":memory:", phSql)) { return FALSE; }
+    if(SQLITE_OK != sqlite3_exec(*phSql, TEST_SQL_SCHEMA_STR, NULL, NULL, NULL)) { return FALSE; }
+    H->fc->db.hSql[0] = *phSql;
+    H->fc->db.qwIdStr = 0;
+    if(!(ctxP.ctxM = (PVMMDLL_PLUGIN_INTERNAL_CONTEXT)ObContainer_New())) { return FALSE; }
+    if(!(ctxOb = FcNtfs2_InitContext(H, &ctxP))) { goto fail; }
+    cbHeapStart = Test_HeapInUse();
+    Test_Generate(H, ctxOb, cRecords, dwSeed);
+    *pcEntry = ObMap_Size(ctxOb->pmMft);
+    if(!fReference) {
+        Test_MemoryReport(ctxOb, Test_HeapInUse() - cbHeapStart);
+    }
+    tcStart = Test_TickCountNS();
+    if(fReference) {
+        Ref_IngestFinalize(H, ctxOb);
+    } else {
+        FcNtfs2_FcIngestFinalize(H, ctxOb);
+    }
+    *pqwTimeNS = Test_TickCountNS() - tcStart;
+    *ppObVfs = (POB_FCNTFS2_VFS)ObContainer_GetOb((POB_CONTAINER)ctxP.ctxM);
+fail:
+    Ob_DECREF(ctxOb);
+    Ob_DECREF(ctxP.ctxM);
+    return TRUE;
+}
+
+/*
+* Compare the ntfs/str rows of the reference and vmm databases and the vmm
+* ntfs_files.txt line offset index against the database.
+* -- return = number of verified rows, zero on mismatch.
+*/
+static DWORD Test_Verify(_In_ sqlite3 *hSqlRef, _In_ sqlite3 *hSqlVmm, _In_opt_ POB_FCNTFS2_VFS pVfs)
+{
+    DWORD iCol, cCol, cRow = 0;
+    int rcRef, rcVmm;
+    BOOL fResult = FALSE;
+    LPCSTR szRef, szVmm;
+    sqlite3_stmt *stRef = NULL, *stVmm = NULL;
+    if(SQLITE_OK != sqlite3_prepare_v2(hSqlRef, TEST_SQL_SELECT, -1, &stRef, NULL)) { goto fail; }
+    if(SQLITE_OK != sqlite3_prepare_v2(hSqlVmm, TEST_SQL_SELECT, -1, &stVmm, NULL)) { goto fail; }
+    cCol = sqlite3_column_count(stRef);
+    while(TRUE) {
+        rcRef = sqlite3_step(stRef);
+        rcVmm = sqlite3_step(stVmm);
+        if(rcRef != rcVmm) {
+            printf("ntfsfinalize_test: row count mismatch after %u rows.\n", cRow);
+            goto fail;
+        }
+        if(rcRef != SQLITE_ROW) { break; }
+        for(iCol = 0; iCol < cCol; iCol++) {
+            szRef = (LPCSTR)sqlite3_column_text(stRef, iCol);
+            szVmm = (LPCSTR)sqlite3_column_text(stVmm, iCol);
+            if(!szRef || !szVmm || strcmp(szRef, szVmm)) {
+                printf("ntfsfinalize_test: mismatch row %u column '%s': reference='%s' vmm='%s'\n", cRow, sqlite3_column_name(stRef, iCol), szRef ? szRef : "(null)", szVmm ? szVmm : "(null)");
+                goto fail;
+            }
+        }
+        if(!pVfs || (cRow >= pVfs->cRecords) || (pVfs->pqwOlnU[cRow] != (QWORD)sqlite3_column_int64(stVmm, 14))) {
+            printf("ntfsfinalize_test: vfs line offset index mismatch row %u.\n", cRow);
+            goto fail;
+        }
+        cRow++;
+    }
+    if(!cRow || (cRow != pVfs->cRecords)) {
+        printf("ntfsfinalize_test: vfs line offset index record count mismatch (%u/%llu).\n", cRow, pVfs ? pVfs->cRecords : 0);
+        goto fail;
+    }
+    fResult = TRUE;
+fail:
+    sqlite3_finalize(stRef);
+    sqlite3_finalize(stVmm);
+    return fResult ? cRow : 0;
+}
+
+/*
+* Compare two ntfs map objects (database vs memory resident record index).
+*/
+static BOOL Test_VerifyMap(_In_ LPCSTR szWhat, _In_ QWORD qwKey, _In_ PFCOB_MAP_NTFS pDb, _In_ PFCOB_MAP_NTFS pVfs)
+{
+    DWORD i;
+    PFC_MAP_NTFSENTRY p1, p2;
+    if(pDb->cMap != pVfs->cMap) {
+        printf("ntfsfinalize_test: %s %llx: entry count mismatch (%u/%u).\n", szWhat, qwKey, pDb->cMap, pVfs->cMap);
+        return FALSE;
+    }
+    for(i = 0; i < pDb->cMap; i++) {
+        p1 = pDb->pMap + i;
+        p2 = pVfs->pMap + i;
+        if((p1->qwId != p2->qwId) || (p1->pa != p2->pa) || (p1->qwFileSize != p2->qwFileSize) || (p1->ftCreate != p2->ftCreate) || (p1->ftModify != p2->ftModify) || (p1->ftRead != p2->ftRead) ||
+            (p1->dwMftId != p2->dwMftId) || (p1->dwMftIdParent != p2->dwMftIdParent) || (p1->flags != p2->flags) || (p1->dwTextSeq != p2->dwTextSeq) ||
+            (p1->cszuOffset != p2->cszuOffset) || (p1->cbuText != p2->cbuText) || strcmp(p1->uszText, p2->uszText)) {
+            printf("ntfsfinalize_test: %s %llx: entry %u mismatch: database='%s' vfs='%s'\n", szWhat, qwKey, i, p1->uszText, p2->uszText);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+* Verify the memory resident record index against the database: single entry
+* lookups of all records, directory listings of all directories (and of the
+* volume roots) and all rendered ntfs_files.txt windows. Directory listings of
+* all directories are timed with the database and the record index.
+* -- return
+*/
+static BOOL Test_VerifyVfs(_In_ VMM_HANDLE H, _In_ POB_FCNTFS2_VFS pVfs)
+{
+    BOOL fResult = FALSE;
+    QWORD i, qwHash, cDir = 0, cszu, cbu, tcStart, tcDb = 0, tcVfs = 0;
+    LPSTR szu = NULL;
+    PFCOB_MAP_NTFS pObDb = NULL, pObVfs = NULL;
+    POB_FCNTFS2_VFS_WINDOW pObWindow = NULL;
+    if(!pVfs->pRecord) {
+        printf("ntfsfinalize_test: vfs record index missing.\n");
+        return FALSE;
+    }
+    // 1: single entries and directory listings:
+    for(i = 0; i <= pVfs->cRecords; i++) {
+        qwHash = (i < pVfs->cRecords) ? pVfs->pHash[i].qwHashPath : 0;
+        if(i < pVfs->cRecords) {
+            if(!FcNtfs2_Map_GetFromHash(H, NULL, qwHash, &pObDb) || !FcNtfs2_Map_GetFromHash(H, pVfs, qwHash, &pObVfs)) { goto fail; }
+            if(!Test_VerifyMap("hash", qwHash, pObDb, pObVfs)) { goto fail; }
+            Ob_DECREF_NULL(&pObDb);
+            Ob_DECREF_NULL(&pObVfs);
+            if(!(pVfs->pRecord[pVfs->pHash[i].qwId].flags & FCNTFS2_FLAG_DIRECTORY)) { continue; }
+        }
+        tcStart = Test_TickCountNS();
+        if(!FcNtfs2_Map_GetFromHashParent(H, NULL, qwHash, &pObDb)) { goto fail; }
+        tcDb += Test_TickCountNS() - tcStart;
+        tcStart = Test_TickCountNS();
+        if(!FcNtfs2_Map_GetFromHashParent(H, pVfs, qwHash, &pObVfs)) { goto fail; }
+        tcVfs += Test_TickCountNS() - tcStart;
+        if(!Test_VerifyMap("parent", qwHash, pObDb, pObVfs)) { goto fail; }
+        Ob_DECREF_NULL(&pObDb);
+        Ob_DECREF_NULL(&pObVfs);
+        cDir++;
+    }
+    // 2: rendered ntfs_files.txt windows:
+    if(!(szu = malloc(0x01000000))) { goto fail; }
+    for(i = 0; i * FCNTFS2_VFS_WINDOW_RECORDS < pVfs->cRecords; i++) {
+        if(!FcNtfs2_Map_GetFromIdRange(H, NULL, i * FCNTFS2_VFS_WINDOW_RECORDS, FCNTFS2_VFS_WINDOW_RECORDS, &pObDb)) { goto fail; }
+        cszu = pVfs->pqwOlnU[min(pVfs->cRecords, (i + 1) * FCNTFS2_VFS_WINDOW_RECORDS)] - pVfs->pqwOlnU[i * FCNTFS2_VFS_WINDOW_RECORDS] + 0x2000;
+        cbu = FcNtfs2_ReadInfoAll_Render(pObDb, szu, cszu);
+        if(!(pObWindow = FcNtfs2_ReadInfoAll_GetWindow(H, pVfs, i)) || (pObWindow->cb != cbu) || memcmp(pObWindow->sz, szu, (SIZE_T)cbu)) {
+            printf("ntfsfinalize_test: ntfs_files.txt window %llu mismatch.\n", i);
+            goto fail;
+        }
+        Ob_DECREF_NULL(&pObDb);
+        Ob_DECREF_NULL(&pObWindow);
+    }
+    printf("ntfsfinalize_test: vfs record index verified: %llu entries, %llu directory listings, %llu windows.\n", pVfs->cRecords, cDir, i);
+    printf("  directory listings: database %9.1f ms  vfs %9.1f ms  speedup %.2fx\n", tcDb / 1000000.0, tcVfs / 1000000.0, (double)tcDb / (tcVfs ? tcVfs : 1));
+    fResult = TRUE;
+fail:
+    free(szu);
+    Ob_DECREF(pObDb);
+    Ob_DECREF(pObVfs);
+    Ob_DECREF(pObWindow);
+    return fResult;
+}
+
+int main(_In_ int argc, _In_ char *argv[])
+{
+    int iResult = 1;
+    DWORD cRecords, dwSeed, cRow, cEntryRef = 0, cEntryVmm = 0;
+    QWORD tcRef = 0, tcVmm = 0;
+    VMM_HANDLE H = NULL;
+    sqlite3 *hSqlRef = NULL, *hSqlVmm = NULL;
+    POB_FCNTFS2_VFS pObVfsRef = NULL, pObVfsVmm = NULL;
+    cRecords = (argc > 1) ? (DWORD)strtoul(argv[1], NULL, 0) : TEST_RECORDS_DEFAULT;
+    dwSeed = (argc > 2) ? (DWORD)strtoul(argv[2], NULL, 0) : TEST_SEED_DEFAULT;
+    if(cRecords < 2 * TEST_DEEP_CHAIN) { cRecords = 2 * TEST_DEEP_CHAIN; }
+    // 1: minimal vmm handle with object manager, worker pool and forensic database:
+    if(!(H = LocalAlloc(LMEM_ZEROINIT, sizeof(struct tdVMM_HANDLE)))) { goto fail; }
+    InitializeCriticalSection(&H->vmm.LockUpdateModule);
+    Ob_PoolInitialize();
+    if(!VmmWork_Initialize(H)) { goto fail; }
+    if(!(H->fc = LocalAlloc(LMEM_ZEROINIT, sizeof(FC_CONTEXT)))) { goto fail; }
+    H->fc->db.fSingleThread = TRUE;
+    if(!(H->fc->db.hEventIngestPhys[0] = CreateEvent(NULL, FALSE, TRUE, NULL))) { goto fail; }
+    // 2: finalize the same synthetic record set with reference and vmm:
+    if(!Test_Run(H, TRUE, cRecords, dwSeed, &hSqlRef, &pObVfsRef, &cEntryRef, &tcRef)) { goto fail; }
+    if(!Test_Run(H, FALSE, cRecords, dwSeed, &hSqlVmm, &pObVfsVmm, &cEntryVmm, &tcVmm)) { goto fail; }
+    if(cEntryRef != cEntryVmm) {
+        printf("ntfsfinalize_test: ingested entry count mismatch (%u/%u).\n", cEntryRef, cEntryVmm);
+        goto fail;
+    }
+    // 3: verify:
+    if(!(cRow = Test_Verify(hSqlRef, hSqlVmm, pObVfsVmm))) {
+        printf("ntfsfinalize_test: FAILED.\n");
+        goto fail;
+    }
+    printf("ntfsfinalize_test: %u records (seed %u), %u entries: %u ntfs rows verified identical.\n", cRecords, dwSeed, cEntryVmm, cRow);
+    if(!Test_VerifyVfs(H, pObVfsVmm)) {
+        printf("ntfsfinalize_test: FAILED.\n");
+        goto fail;
+    }
+    printf("  finalize: reference %9.1f ms  vmm %9.1f ms  speedup %.2fx\n", tcRef / 1000000.0, tcVmm / 1000000.0, (double)tcRef / (tcVmm ? tcVmm : 1));
+    iResult = 0;
+fail:
+    Ob_DECREF(pObVfsRef);
+    Ob_DECREF(pObVfsVmm);
+    sqlite3_close(hSqlRef);
+    sqlite3_close(hSqlVmm);
+    if(H) {
+        H->fAbort = TRUE;
+        VmmWork_Interrupt(H);
+        VmmWork_Close(H);
+        if(H->fc) {
+            CloseHandle(H->fc->db.hEventIngestPhys[0]);
+            LocalFree(H->fc);
+        }
+        DeleteCriticalSection(&H->vmm.LockUpdateModule);
+        LocalFree(H);
+    }
+    return iResult;
+}
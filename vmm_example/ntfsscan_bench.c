@@ -0,0 +1,176 @@
+// ntfsscan_bench.c : microbenchmark of the ntfs mft record candidate scanner
+//     FcNtfs2_IngestScanPage() in vmm/modules/m_fc_ntfs.c.
+//
+// A synthetic 16MB physical memory chunk (4096 separately allocated 4kB pages,
+// as delivered by the forensic physical memory scan) is filled with a mix of
+// MFT pages (some with damaged or misaligned record slots), INDX pages, pages
+// with random data and zero pages. The scanner in vmm is verified against the
+// scalar reference below for every page before any timing is done. Then the
+// chunk is scanned with the vmm scanner and the reference scanners:
+//  - scalar: per slot signature + record number check (reference).
+//  - gather: all four slots checked with SSE2 from dwords gathered with
+//            _mm_set_epi32 for every page (the previous vmm implementation,
+//            timed only since it did not require a valid first slot).
+//
+// Linux only. The benchmark is linked with the vmm objects (libvmm.a) since the
+// function exercised is internal. Build with 'make ntfsscan_bench' and run as
+// (from the files directory):
+//     ./ntfsscan_bench [iterations] [mft_page_percent]
+//
+// (c) Ulf Frisk, 2024
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#include "../vmm/oscompatibility.h"
+#include <time.h>
+#if defined(__amd64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif /* __amd64__ || __SSE2__ */
+
+#define BENCH_ITERATIONS_DEFAULT            64
+#define BENCH_MFT_PERCENT_DEFAULT           2
+#define BENCH_CHUNK_PAGES                   0x1000
+
+#define FCNTFS2_INGEST_SCAN_MASK_INDX       0x10
+
+DWORD FcNtfs2_IngestScanPage(_In_reads_(0x1000) PBYTE pb);
+
+static QWORD Bench_TickCountNS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+* Reference: scalar per slot check of the first slot signature followed by the
+* signature and record number alignment check of all four slots.
+*/
+static DWORD Bench_ScanPage_Scalar(_In_reads_(0x1000) PBYTE pb)
+{
+    DWORD i, dwMask = 0;
+    if(*(PDWORD)pb == 'XDNI') { return FCNTFS2_INGEST_SCAN_MASK_INDX; }
+    if(*(PDWORD)pb != 'ELIF') { return 0; }
+    for(i = 0; i < 4; i++) {
+        if((*(PDWORD)(pb + (i << 10)) == 'ELIF') && ((*(PDWORD)(pb + (i << 10) + 0x2c) & 3) == i)) {
+            dwMask |= 1 << i;
+        }
+    }
+    return dwMask;
+}
+
+#if defined(__amd64__) || defined(__SSE2__)
+/*
+* Reference: the previous implementation which gathered the signature and
+* record number dwords of every page with _mm_set_epi32.
+*/
+static DWORD Bench_ScanPage_Gather(_In_reads_(0x1000) PBYTE pb)
+{
+    PDWORD pdw = (PDWORD)pb;
+    __m128i vSig, vNum;
+    if(pdw[0] == 'XDNI') {
+        return FCNTFS2_INGEST_SCAN_MASK_INDX;
+    }
+    vSig = _mm_set_epi32(pdw[0x300], pdw[0x200], pdw[0x100], pdw[0x000]);
+    vNum = _mm_set_epi32(pdw[0x30b], pdw[0x20b], pdw[0x10b], pdw[0x00b]);
+    vSig = _mm_cmpeq_epi32(vSig, _mm_set1_epi32('ELIF'));
+    vNum = _mm_cmpeq_epi32(_mm_and_si128(vNum, _mm_set1_epi32(3)), _mm_set_epi32(3, 2, 1, 0));
+    return (DWORD)_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(vSig, vNum)));
+}
+#else /* __amd64__ || __SSE2__ */
+#define Bench_ScanPage_Gather               Bench_ScanPage_Scalar
+#endif /* __amd64__ || __SSE2__ */
+
+/*
+* Fill a page with synthetic content.
+* -- pb
+* -- dwMftPercent = percentage of pages which should be MFT pages.
+*/
+static VOID Bench_FillPage(_Out_writes_(0x1000) PBYTE pb, _In_ DWORD dwMftPercent)
+{
+    DWORD i, r = (DWORD)rand() % 100, dwRecord;
+    if(r < dwMftPercent) {
+        // mft page - four 1kB records, occasionally damaged / misaligned.
+        memset(pb, 0, 0x1000);
+        dwRecord = ((DWORD)rand() & 0xfffff) << 2;
+        for(i = 0; i < 4; i++) {
+            *(PDWORD)(pb + (i << 10)) = (rand() % 16) ? 'ELIF' : 0;
+            *(PDWORD)(pb + (i << 10) + 0x2c) = dwRecord + ((rand() % 16) ? i : (DWORD)rand());
+            pb[(i << 10) + 0x30] = (BYTE)rand();
+        }
+        *(PDWORD)pb = 'ELIF';
+        return;
+    }
+    if(r < dwMftPercent + 1) {
+        memset(pb, 0, 0x1000);
+        *(PDWORD)pb = 'XDNI';
+        return;
+    }
+    if(r < 50) {
+        memset(pb, 0, 0x1000);
+        return;
+    }
+    for(i = 0; i < 0x1000; i += 4) {
+        *(PDWORD)(pb + i) = (DWORD)rand();
+    }
+}
+
+/*
+* Scan the chunk and return the number of candidate slots (to keep the work).
+*/
+static DWORD Bench_ScanChunk(_In_ PBYTE *ppb, _In_ DWORD(*pfnScan)(PBYTE), _Out_ PQWORD pqwTimeNS)
+{
+    DWORD i, c = 0;
+    QWORD tcStart = Bench_TickCountNS();
+    for(i = 0; i < BENCH_CHUNK_PAGES; i++) {
+        c += __builtin_popcount(pfnScan(ppb[i]));
+    }
+    *pqwTimeNS += Bench_TickCountNS() - tcStart;
+    return c;
+}
+
+int main(_In_ int argc, _In_ char *argv[])
+{
+    DWORD i, iIter, cIterations, dwMftPercent, dwRef, dwVmm, cCandidates = 0, cCheck = 0;
+    QWORD tcScalar = 0, tcGather = 0, tcVmm = 0;
+    PBYTE *ppb;
+    cIterations = (argc > 1) ? (DWORD)strtoul(argv[1], NULL, 0) : BENCH_ITERATIONS_DEFAULT;
+    dwMftPercent = (argc > 2) ? (DWORD)strtoul(argv[2], NULL, 0) : BENCH_MFT_PERCENT_DEFAULT;
+    if(!cIterations) { cIterations = BENCH_ITERATIONS_DEFAULT; }
+    if(dwMftPercent > 49) { dwMftPercent = 49; }
+    if(!(ppb = calloc(BENCH_CHUNK_PAGES, sizeof(PBYTE)))) { return 1; }
+    srand(1);
+    for(i = 0; i < BENCH_CHUNK_PAGES; i++) {
+        if(!(ppb[i] = aligned_alloc(0x1000, 0x1000))) { return 1; }
+        Bench_FillPage(ppb[i], dwMftPercent);
+    }
+    // verify:
+    for(i = 0; i < BENCH_CHUNK_PAGES; i++) {
+        dwRef = Bench_ScanPage_Scalar(ppb[i]);
+        dwVmm = FcNtfs2_IngestScanPage(ppb[i]);
+        if(dwRef != dwVmm) {
+            printf("ntfsscan_bench: verification FAILED: page %i reference=%02x vmm=%02x\n", i, dwRef, dwVmm);
+            return 1;
+        }
+        cCandidates += __builtin_popcount(dwRef);
+    }
+    printf("ntfsscan_bench: output verified identical (%i pages, %i candidate slots/indx pages).\n", BENCH_CHUNK_PAGES, cCandidates);
+    // timing (interleaved to even out cache effects):
+    for(iIter = 0; iIter < cIterations; iIter++) {
+        cCheck += Bench_ScanChunk(ppb, Bench_ScanPage_Scalar, &tcScalar);
+        cCheck += Bench_ScanChunk(ppb, Bench_ScanPage_Gather, &tcGather);
+        cCheck += Bench_ScanChunk(ppb, FcNtfs2_IngestScanPage, &tcVmm);
+    }
+    printf("  16MB chunk, %u%% mft pages, %u iterations (%u):\n", dwMftPercent, cIterations, cCheck);
+    printf("    scalar %9.1f us  gather %9.1f us  vmm %9.1f us  (%5.2f ns/page)  speedup vs gather %.2fx\n",
+        (double)tcScalar / cIterations / 1000,
+        (double)tcGather / cIterations / 1000,
+        (double)tcVmm / cIterations / 1000,
+        (double)tcVmm / cIterations / BENCH_CHUNK_PAGES,
+        (double)tcGather / (tcVmm ? tcVmm : 1));
+    for(i = 0; i < BENCH_CHUNK_PAGES; i++) {
+        free(ppb[i]);
+    }
+    free(ppb);
+    return 0;
+}
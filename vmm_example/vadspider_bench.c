@@ -0,0 +1,261 @@
+// vadspider_bench.c : microbenchmark of the Win8.1+ VAD spider node decoders
+//     MmVad_Spider_MMVAD64_10_*() in vmm/mm/mm_vad.c.
+//
+// A synthetic balanced tree of 64-bit _MMVAD nodes is built in memory and is
+// spidered breadth first - in the same way as MmVad_Spider_DoWork() - with
+// the real per build family decoders in vmm (switch pool tag compare and
+// compile time constant _MMVAD_FLAGS bit offsets) and with the previous
+// generic decoder which is kept below as reference (variadic pool tag compare
+// and runtime _MMVAD_FLAGS bit offset mask). Kernel reads of the decoders are
+// redirected to the synthetic tree. The output of the decoders is verified to
+// be identical for all build families before any timing is done.
+//
+// Linux only. The benchmark is linked with the vmm objects (libvmm.a) since the
+// functions exercised are internal. Build with 'make vadspider_bench' and run
+// as (from the files directory):
+//     ./vadspider_bench [iterations] [nodes]
+//
+// (c) Ulf Frisk, 2024
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#define VmmRead2 Bench_VmmRead2
+#include "../vmm/mm/mm_vad.c"
+#undef VmmRead2
+#include <time.h>
+
+#define BENCH_ITERATIONS_DEFAULT            50
+#define BENCH_NODES_DEFAULT                 100000
+#define BENCH_VA_BASE                       0xffffa10000000000ULL
+
+// kernel pool allocations are 16-byte aligned.
+#define BENCH_NODE_STRIDE                   ((sizeof(_MMVAD64_10) + 0xf) & ~0xf)
+
+typedef struct tdBENCH_FAMILY {
+    LPCSTR szName;
+    PFN_MMVAD_SPIDER pfnVmm;
+    DWORD dwFlagsBitMask;           // reference: bit offset of empty:PrivateMemory:Protection:VadType
+} BENCH_FAMILY, *PBENCH_FAMILY;
+
+static _MMVAD64_10 *g_pBenchNodes = NULL;
+static DWORD g_cBenchNodes = 0;
+
+static QWORD Bench_TickCountNS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+* Kernel read of the decoders: "read" a node from the synthetic tree. Reads of
+* addresses outside of the tree fail (just as a not yet cached read would).
+*/
+BOOL Bench_VmmRead2(_In_ VMM_HANDLE H, _In_opt_ PVMM_PROCESS pProcess, _In_ QWORD qwA, _Out_writes_(cb) PBYTE pb, _In_ DWORD cb, _In_ QWORD flags)
+{
+    QWORD i = (qwA - BENCH_VA_BASE) / BENCH_NODE_STRIDE;
+    (VOID)H;
+    (VOID)pProcess;
+    (VOID)flags;
+    if((qwA < BENCH_VA_BASE) || (i >= g_cBenchNodes) || (cb > sizeof(_MMVAD64_10)) || ((qwA - BENCH_VA_BASE) % BENCH_NODE_STRIDE)) { return FALSE; }
+    memcpy(pb, g_pBenchNodes + i, cb);
+    return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// REFERENCE: GENERIC DECODER (BEFORE BUILD FAMILY SPECIALIZATION):
+//-----------------------------------------------------------------------------
+
+static BOOL Bench_Ref_PoolTagAny(_In_ DWORD dwPoolTag, _In_ DWORD cPoolTag, ...)
+{
+    va_list argp;
+    dwPoolTag = _byteswap_ulong(dwPoolTag);
+    va_start(argp, cPoolTag);
+    while(cPoolTag) {
+        if(dwPoolTag == va_arg(argp, DWORD)) {
+            va_end(argp);
+            return TRUE;
+        }
+        cPoolTag--;
+    }
+    va_end(argp);
+    return FALSE;
+}
+
+static PVMM_MAP_VADENTRY Bench_Ref_Spider_MMVAD64_10(_In_ VMM_HANDLE H, _In_ PVMM_PROCESS pSystemProcess, _In_ QWORD va, _In_ PVMMOB_MAP_VAD pmVad, _In_ POB_SET psAll, _In_ POB_SET psTry1, _In_opt_ POB_SET psTry2, _In_ QWORD fVmmRead, _In_ DWORD dwFlagsBitMask)
+{
+    _MMVAD64_10 v = { 0 };
+    PVMM_MAP_VADENTRY e;
+    if(!Bench_VmmRead2(H, pSystemProcess, va, (PBYTE)&v, sizeof(_MMVAD64_10), fVmmRead | VMM_FLAG_FORCECACHE_READ)) {
+        ObSet_Push(psTry2, va);
+        return NULL;
+    }
+    if((v.EndingVpnHigh < v.StartingVpnHigh) || (v.EndingVpn < v.StartingVpn) || !Bench_Ref_PoolTagAny(v.PoolTag, 5, MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF)) {
+        return NULL;
+    }
+    // short vad
+    e = &pmVad->pMap[pmVad->cMap++];
+    if(VMM_KADDR64_16(v.Children[0]) && ObSet_Push(psAll, v.Children[0] - 0x10)) {
+        ObSet_Push(psTry1, v.Children[0] - 0x10);
+    }
+    if(VMM_KADDR64_16(v.Children[1]) && ObSet_Push(psAll, v.Children[1] - 0x10)) {
+        ObSet_Push(psTry1, v.Children[1] - 0x10);
+    }
+    e->vaStart = ((QWORD)v.StartingVpnHigh << (32 + 12)) | ((QWORD)v.StartingVpn << 12);
+    e->vaEnd = ((QWORD)v.EndingVpnHigh << (32 + 12)) | ((QWORD)v.EndingVpn << 12) | 0xfff;
+    e->CommitCharge = (DWORD)v.CommitCharge;
+    e->MemCommit = (DWORD)v.MemCommit;
+    e->VadType = 0x07 & (v.u >> (dwFlagsBitMask & 0xff));
+    e->Protection = 0x1f & (v.u >> ((dwFlagsBitMask >> 8) & 0xff));
+    e->fPrivateMemory = 0x01 & (v.u >> ((dwFlagsBitMask >> 16) & 0xff));
+    // full vad
+    if(v.PoolTag == MMVAD_POOLTAG_VADS) { return e; }
+    e->flags[2] = (DWORD)v.u2;
+    e->vaSubsection = v.Subsection;
+    if(VMM_KADDR64_8(v.FirstPrototypePte)) {
+        e->vaPrototypePte = v.FirstPrototypePte;
+        e->cbPrototypePte = (DWORD)(v.LastContiguousPte - v.FirstPrototypePte + 8);
+    }
+    return e;
+}
+
+//-----------------------------------------------------------------------------
+// SYNTHETIC TREE AND BENCHMARK DRIVER:
+//-----------------------------------------------------------------------------
+
+/*
+* Build a balanced tree (heap order: children of node i are 2i+1 and 2i+2).
+* Children pointers point to the _MMVAD_SHORT.VadNode member (+0x10) just like
+* in the kernel. Pool tags, flags and prototype ptes are mixed to exercise both
+* the short and the full vad code path.
+*/
+static VOID Bench_TreeBuild(_Out_writes_(cNodes) _MMVAD64_10 *pNodes, _In_ DWORD cNodes)
+{
+    DWORD i, j;
+    QWORD vpn;
+    _MMVAD64_10 *pv;
+    DWORD dwPoolTags[] = { MMVAD_POOLTAG_VADS, MMVAD_POOLTAG_VAD, MMVAD_POOLTAG_VADL, MMVAD_POOLTAG_VADM, MMVAD_POOLTAG_VADF };
+    memset(pNodes, 0, cNodes * sizeof(_MMVAD64_10));
+    for(i = 0; i < cNodes; i++) {
+        pv = pNodes + i;
+        pv->PoolTag = _byteswap_ulong(dwPoolTags[i % _countof(dwPoolTags)]);
+        for(j = 0; j < 2; j++) {
+            if(2 * i + 1 + j < cNodes) {
+                pv->Children[j] = BENCH_VA_BASE + (2 * i + 1 + j) * BENCH_NODE_STRIDE + 0x10;
+            }
+        }
+        vpn = 0x10000 + (QWORD)i * 0x20;
+        pv->StartingVpn = (DWORD)vpn;
+        pv->EndingVpn = (DWORD)vpn + 0x1f;
+        pv->StartingVpnHigh = pv->EndingVpnHigh = (BYTE)(vpn >> 32);
+        pv->u = (i * 0x9e3779b9) & 0x00ffffff;
+        pv->CommitCharge = i & 0x1f;
+        pv->MemCommit = i & 1;
+        pv->u2 = i;
+        if(i & 1) {
+            pv->Subsection = 0xffffb00000000000ULL + (QWORD)i * 0x80;
+            pv->FirstPrototypePte = 0xffffc00000000000ULL + (QWORD)i * 0x1000;
+            pv->LastContiguousPte = pv->FirstPrototypePte + 0xf8;
+        }
+    }
+}
+
+/*
+* Spider the tree - same set handling as MmVad_Spider_DoWork(): the root is
+* tried in the 2nd attempt set, children are tried in the 1st attempt set.
+* Either the vmm decoder (pfnVmm) or the reference decoder is used.
+* -- return = number of decoded vad entries.
+*/
+static DWORD Bench_Spider(_In_ VMM_HANDLE H, _In_ PVMMOB_MAP_VAD pmVad, _In_opt_ PFN_MMVAD_SPIDER pfnVmm, _In_ DWORD dwFlagsBitMask)
+{
+    QWORD va;
+    POB_SET psObAll = NULL, psObTry1 = NULL, psObTry2 = NULL;
+    pmVad->cMap = 0;
+    memset(pmVad->pMap, 0, g_cBenchNodes * sizeof(VMM_MAP_VADENTRY));
+    if(!(psObAll = ObSet_New(H)) || !(psObTry1 = ObSet_New(H)) || !(psObTry2 = ObSet_New(H))) { goto fail; }
+    ObSet_Push(psObAll, BENCH_VA_BASE);
+    ObSet_Push(psObTry2, BENCH_VA_BASE);
+    while((pmVad->cMap < g_cBenchNodes) && (ObSet_Size(psObTry1) || ObSet_Size(psObTry2))) {
+        while((pmVad->cMap < g_cBenchNodes) && (va = ObSet_Pop(psObTry2))) {
+            if(pfnVmm) {
+                pfnVmm(H, NULL, va, pmVad, psObAll, psObTry1, NULL, 0);
+            } else {
+                Bench_Ref_Spider_MMVAD64_10(H, NULL, va, pmVad, psObAll, psObTry1, NULL, 0, dwFlagsBitMask);
+            }
+        }
+        while((pmVad->cMap < g_cBenchNodes) && (va = ObSet_Pop(psObTry1))) {
+            if(pfnVmm) {
+                pfnVmm(H, NULL, va, pmVad, psObAll, psObTry1, psObTry2, 0);
+            } else {
+                Bench_Ref_Spider_MMVAD64_10(H, NULL, va, pmVad, psObAll, psObTry1, psObTry2, 0, dwFlagsBitMask);
+            }
+        }
+    }
+fail:
+    Ob_DECREF(psObAll);
+    Ob_DECREF(psObTry1);
+    Ob_DECREF(psObTry2);
+    return pmVad->cMap;
+}
+
+int main(_In_ int argc, _In_ char *argv[])
+{
+    int iResult = 1;
+    DWORD iFamily, iIter, cIterations, cRef, cVmm;
+    QWORD tcStart, tcRef, tcVmm;
+    VMM_HANDLE H = NULL;
+    PVMMOB_MAP_VAD pmRef = NULL, pmVmm = NULL;
+    BENCH_FAMILY Family[] = {
+        { "10240", MmVad_Spider_MMVAD64_10_10240, 0x000f0300 },
+        { "17134", MmVad_Spider_MMVAD64_10_17134, 0x000e0300 },
+        { "18362", MmVad_Spider_MMVAD64_10_18362, 0x00140704 },
+        { "20348", MmVad_Spider_MMVAD64_10_20348, 0x00150704 },
+    };
+    cIterations = (argc > 1) ? (DWORD)strtoul(argv[1], NULL, 0) : BENCH_ITERATIONS_DEFAULT;
+    g_cBenchNodes = (argc > 2) ? (DWORD)strtoul(argv[2], NULL, 0) : BENCH_NODES_DEFAULT;
+    if(!cIterations) { cIterations = BENCH_ITERATIONS_DEFAULT; }
+    if(!g_cBenchNodes || (g_cBenchNodes > MMVAD_MAXVADS_THRESHOLD)) { g_cBenchNodes = BENCH_NODES_DEFAULT; }
+    // 1: minimal vmm handle with object manager and the synthetic tree:
+    if(!(H = LocalAlloc(LMEM_ZEROINIT, sizeof(struct tdVMM_HANDLE)))) { goto fail; }
+    Ob_PoolInitialize();
+    if(!(g_pBenchNodes = LocalAlloc(0, g_cBenchNodes * sizeof(_MMVAD64_10)))) { goto fail; }
+    if(!(pmRef = LocalAlloc(0, sizeof(VMMOB_MAP_VAD) + g_cBenchNodes * sizeof(VMM_MAP_VADENTRY)))) { goto fail; }
+    if(!(pmVmm = LocalAlloc(0, sizeof(VMMOB_MAP_VAD) + g_cBenchNodes * sizeof(VMM_MAP_VADENTRY)))) { goto fail; }
+    Bench_TreeBuild(g_pBenchNodes, g_cBenchNodes);
+    // 2: verify all build families:
+    for(iFamily = 0; iFamily < _countof(Family); iFamily++) {
+        cRef = Bench_Spider(H, pmRef, NULL, Family[iFamily].dwFlagsBitMask);
+        cVmm = Bench_Spider(H, pmVmm, Family[iFamily].pfnVmm, 0);
+        if((cRef != g_cBenchNodes) || (cRef != cVmm) || memcmp(pmRef->pMap, pmVmm->pMap, cRef * sizeof(VMM_MAP_VADENTRY))) {
+            printf("vadspider_bench: verification FAILED: build %s (nodes: %u reference: %u vmm: %u)\n", Family[iFamily].szName, g_cBenchNodes, cRef, cVmm);
+            goto fail;
+        }
+    }
+    printf("vadspider_bench: output verified identical (%u nodes, %u build families).\n", g_cBenchNodes, (DWORD)_countof(Family));
+    // 3: timing (interleaved to even out cache effects):
+    for(iFamily = 0; iFamily < _countof(Family); iFamily++) {
+        tcRef = tcVmm = 0;
+        for(iIter = 0; iIter < cIterations; iIter++) {
+            tcStart = Bench_TickCountNS();
+            Bench_Spider(H, pmRef, NULL, Family[iFamily].dwFlagsBitMask);
+            tcRef += Bench_TickCountNS() - tcStart;
+            tcStart = Bench_TickCountNS();
+            Bench_Spider(H, pmVmm, Family[iFamily].pfnVmm, 0);
+            tcVmm += Bench_TickCountNS() - tcStart;
+        }
+        printf("  build %s:  reference %9.1f us  vmm %9.1f us  (%5.1f ns/node -> %5.1f ns/node)  speedup %.2fx\n",
+            Family[iFamily].szName,
+            (double)tcRef / cIterations / 1000,
+            (double)tcVmm / cIterations / 1000,
+            (double)tcRef / cIterations / g_cBenchNodes,
+            (double)tcVmm / cIterations / g_cBenchNodes,
+            (double)tcRef / (tcVmm ? tcVmm : 1));
+    }
+    iResult = 0;
+fail:
+    LocalFree(pmRef);
+    LocalFree(pmVmm);
+    LocalFree(g_pBenchNodes);
+    LocalFree(H);
+    return iResult;
+}
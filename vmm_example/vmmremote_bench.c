@@ -0,0 +1,250 @@
+// vmmremote_bench.c : loopback benchmark of remote MemProcFS vfs reads.
+//
+// The benchmark connects vmm.so in remote mode (-remotefs) to an in-process
+// loopback stand-in for the LeechCore/LeechAgent remote transport. The stand-in
+// serves LC_CMD_AGENT_VFS_* commands from a synthetic file and delays every
+// command by a configurable round-trip time (RTT). Commands may be in flight
+// concurrently - just like over a real remote connection.
+//
+// The file is read twice with the same read size (FUSE style small reads):
+//   (1) at read size aligned offsets in shuffled order - no read-ahead is done,
+//       every read pays one RTT (the behavior before read-ahead pipelining).
+//   (2) sequentially - served by the read-ahead cache in vmmdll_remote.c.
+// The content of every read is verified against the synthetic file.
+//
+// NB! LINUX ONLY: the stand-in interposes the LcCreateEx/LcCommand/LcClose/
+//     LcMemFree symbols imported by vmm.so - the executable is linked with
+//     -rdynamic so that its definitions take precedence over leechcore.so.
+//     This is not possible on Windows where imports are bound to leechcore.dll.
+//
+// Build with 'make vmmremote_bench' and run as (from the files directory):
+//     ./vmmremote_bench [rtt_us] [file_mb] [read_kb]
+//
+// (c) Ulf Frisk, 2024
+// Author: Ulf Frisk, pcileech@frizk.net
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <leechcore.h>
+#include <vmmdll.h>
+
+#ifndef TRUE
+#define TRUE                            1
+#define FALSE                           0
+#endif /* TRUE */
+
+#define BENCH_FILE_NAME                 "\\bench\\synthetic.bin"
+#define BENCH_RTT_US_DEFAULT            1000
+#define BENCH_FILE_MB_DEFAULT           64
+#define BENCH_READ_KB_DEFAULT           64
+#define BENCH_STATUS_SUCCESS            0x00000000
+#define BENCH_STATUS_END_OF_FILE        0xC0000011
+#define BENCH_STATUS_FILE_INVALID       0xC0000098
+
+// remote console response - wire format of VMMDLL_VFS_CONSOLE_RSP in vmm/vmmdll_remote.c
+#define BENCH_VFS_CONSOLE_RSP_VERSION   0xf00f0001
+
+typedef struct tdBENCH_VFS_CONSOLE_RSP {
+    DWORD dwVersion;
+    DWORD cbStruct;
+    QWORD qwStdOut;
+    QWORD qwStdErr;
+    BYTE pbBuffer[0];
+} BENCH_VFS_CONSOLE_RSP, *PBENCH_VFS_CONSOLE_RSP;
+
+static struct {
+    DWORD dwRttUs;
+    QWORD cbFile;
+    QWORD cCommandRead;                 // # LC_CMD_AGENT_VFS_READ (atomic)
+    QWORD cCommandOther;                // # other LC_CMD_AGENT_VFS_* (atomic)
+} g_Bench;
+
+/*
+* Synthetic file content: a byte pattern which depends on the file offset.
+*/
+static inline BYTE Bench_FileByte(_In_ QWORD qwOffset)
+{
+    return (BYTE)((qwOffset >> 12) * 0x9d + (qwOffset & 0xfff) * 7);
+}
+
+static QWORD Bench_TickCountUS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (QWORD)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+
+// ----------------------------------------------------------------------------
+// LOOPBACK STAND-IN FOR THE LEECHCORE REMOTE TRANSPORT:
+// Only the functions used by the remote MemProcFS code path are implemented.
+// ----------------------------------------------------------------------------
+
+EXPORTED_FUNCTION _Success_(return != NULL)
+HANDLE LcCreateEx(_Inout_ PLC_CONFIG pLcCreateConfig, _Out_opt_ PPLC_CONFIG_ERRORINFO ppLcCreateErrorInfo)
+{
+    (void)pLcCreateConfig;
+    if(ppLcCreateErrorInfo) { *ppLcCreateErrorInfo = NULL; }
+    return (HANDLE)&g_Bench;
+}
+
+EXPORTED_FUNCTION
+VOID LcClose(_In_opt_ _Post_ptr_invalid_ HANDLE hLC)
+{
+    (void)hLC;
+}
+
+EXPORTED_FUNCTION
+VOID LcMemFree(_Frees_ptr_opt_ PVOID pv)
+{
+    free(pv);
+}
+
+/*
+* Serve a LC_CMD_AGENT_VFS_READ request from the synthetic file.
+*/
+static BOOL Bench_CommandRead(_In_ PLC_CMD_AGENT_VFS_REQ pReq, _Out_ PBYTE *ppbDataOut, _Out_ PDWORD pcbDataOut)
+{
+    QWORD i, cb = 0;
+    PLC_CMD_AGENT_VFS_RSP pRsp;
+    if(pReq->qwOffset < g_Bench.cbFile) {
+        cb = pReq->dwLength;
+        if(pReq->qwOffset + cb > g_Bench.cbFile) { cb = g_Bench.cbFile - pReq->qwOffset; }
+    }
+    if(!(pRsp = calloc(1, sizeof(LC_CMD_AGENT_VFS_RSP) + cb))) { return FALSE; }
+    pRsp->dwVersion = LC_CMD_AGENT_VFS_RSP_VERSION;
+    pRsp->dwStatus = strcmp(pReq->uszPathFile, BENCH_FILE_NAME) ? BENCH_STATUS_FILE_INVALID : (cb ? BENCH_STATUS_SUCCESS : BENCH_STATUS_END_OF_FILE);
+    if(pRsp->dwStatus == BENCH_STATUS_FILE_INVALID) { cb = 0; }
+    pRsp->cbReadWrite = (DWORD)cb;
+    pRsp->cb = (DWORD)cb;
+    for(i = 0; i < cb; i++) {
+        pRsp->pb[i] = Bench_FileByte(pReq->qwOffset + i);
+    }
+    *ppbDataOut = (PBYTE)pRsp;
+    *pcbDataOut = (DWORD)(sizeof(LC_CMD_AGENT_VFS_RSP) + cb);
+    return TRUE;
+}
+
+EXPORTED_FUNCTION _Success_(return)
+BOOL LcCommand(_In_ HANDLE hLC, _In_ QWORD fCommand, _In_ DWORD cbDataIn, _In_reads_opt_(cbDataIn) PBYTE pbDataIn, _Out_opt_ PBYTE *ppbDataOut, _Out_opt_ PDWORD pcbDataOut)
+{
+    PBENCH_VFS_CONSOLE_RSP pConsole;
+    (void)hLC;
+    if(ppbDataOut) { *ppbDataOut = NULL; }
+    if(pcbDataOut) { *pcbDataOut = 0; }
+    usleep(g_Bench.dwRttUs);            // simulated network round-trip
+    switch(fCommand) {
+        case LC_CMD_AGENT_VFS_READ:
+            __sync_fetch_and_add(&g_Bench.cCommandRead, 1);
+            if(!ppbDataOut || !pcbDataOut || (cbDataIn < sizeof(LC_CMD_AGENT_VFS_REQ))) { return FALSE; }
+            return Bench_CommandRead((PLC_CMD_AGENT_VFS_REQ)pbDataIn, ppbDataOut, pcbDataOut);
+        case LC_CMD_AGENT_VFS_CONSOLE:
+            __sync_fetch_and_add(&g_Bench.cCommandOther, 1);
+            if(!ppbDataOut || !pcbDataOut || !(pConsole = calloc(1, sizeof(BENCH_VFS_CONSOLE_RSP) + 1))) { return FALSE; }
+            pConsole->dwVersion = BENCH_VFS_CONSOLE_RSP_VERSION;
+            pConsole->cbStruct = sizeof(BENCH_VFS_CONSOLE_RSP) + 1;
+            *ppbDataOut = (PBYTE)pConsole;
+            *pcbDataOut = pConsole->cbStruct;
+            return TRUE;
+        case LC_CMD_AGENT_VFS_INITIALIZE:
+            __sync_fetch_and_add(&g_Bench.cCommandOther, 1);
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+
+
+// ----------------------------------------------------------------------------
+// BENCHMARK DRIVER:
+// ----------------------------------------------------------------------------
+
+/*
+* Read the synthetic file in cbRead sized reads in the order given by pqwOffset
+* and verify the contents.
+* -- return = elapsed time in microseconds, or 0 on failure.
+*/
+static QWORD Bench_ReadFile(_In_ VMM_HANDLE hVMM, _In_ DWORD cbRead, _In_ DWORD cOffset, _In_ PQWORD pqwOffset, _Out_ PQWORD pcCommand)
+{
+    DWORD i, j, cbResult;
+    NTSTATUS nt;
+    PBYTE pb;
+    QWORD tcStart, tcEnd, cCommandStart;
+    if(!(pb = malloc(cbRead))) { return 0; }
+    cCommandStart = __sync_fetch_and_add(&g_Bench.cCommandRead, 0);
+    tcStart = Bench_TickCountUS();
+    for(i = 0; i < cOffset; i++) {
+        nt = VMMDLL_VfsReadU(hVMM, BENCH_FILE_NAME, pb, cbRead, &cbResult, pqwOffset[i]);
+        if((nt != BENCH_STATUS_SUCCESS) || (cbResult != cbRead)) {
+            printf("vmmremote_bench: read failed: offset=%llx status=%08x cb=%x\n", (unsigned long long)pqwOffset[i], nt, cbResult);
+            free(pb);
+            return 0;
+        }
+        for(j = 0; j < cbRead; j++) {
+            if(pb[j] != Bench_FileByte(pqwOffset[i] + j)) {
+                printf("vmmremote_bench: content mismatch: offset=%llx\n", (unsigned long long)(pqwOffset[i] + j));
+                free(pb);
+                return 0;
+            }
+        }
+    }
+    tcEnd = Bench_TickCountUS();
+    *pcCommand = __sync_fetch_and_add(&g_Bench.cCommandRead, 0) - cCommandStart;
+    free(pb);
+    return (tcEnd > tcStart) ? (tcEnd - tcStart) : 1;
+}
+
+static VOID Bench_PrintResult(_In_ LPCSTR szName, _In_ QWORD tcUs, _In_ QWORD cCommand)
+{
+    printf("  %-28s %8.1f ms  %8.1f MB/s  %6llu remote reads\n", szName, tcUs / 1000.0, (double)g_Bench.cbFile / tcUs, (unsigned long long)cCommand);
+}
+
+int main(_In_ int argc, _In_ char *argv[])
+{
+    DWORD i, j, cbRead, cOffset;
+    QWORD qw, *pqwOffset, tcRandom, tcSequential, cCommandRandom, cCommandSequential;
+    VMM_HANDLE hVMM;
+    LPCSTR szArgs[] = { "", "-remotefs", "-device", "loopback", "-remote", "loopback://" };
+    g_Bench.dwRttUs = (argc > 1) ? (DWORD)strtoul(argv[1], NULL, 0) : BENCH_RTT_US_DEFAULT;
+    g_Bench.cbFile = ((argc > 2) ? strtoull(argv[2], NULL, 0) : BENCH_FILE_MB_DEFAULT) << 20;
+    cbRead = ((argc > 3) ? (DWORD)strtoul(argv[3], NULL, 0) : BENCH_READ_KB_DEFAULT) << 10;
+    if(!g_Bench.cbFile || !cbRead || (cbRead > g_Bench.cbFile) || (g_Bench.cbFile % cbRead)) {
+        printf("vmmremote_bench: invalid arguments - file size must be a multiple of the read size.\n");
+        return 1;
+    }
+    cOffset = (DWORD)(g_Bench.cbFile / cbRead);
+    if(!(pqwOffset = malloc(cOffset * sizeof(QWORD)))) { return 1; }
+    if(!(hVMM = VMMDLL_InitializeEx(sizeof(szArgs) / sizeof(LPCSTR), szArgs, NULL))) {
+        printf("vmmremote_bench: VMMDLL_InitializeEx (remote loopback) failed.\n");
+        return 1;
+    }
+    printf("vmmremote_bench: file %llu MB, read size %u KB, RTT %u us\n", (unsigned long long)(g_Bench.cbFile >> 20), cbRead >> 10, g_Bench.dwRttUs);
+    // 1: shuffled (non-sequential) reads - one round-trip per read:
+    for(i = 0; i < cOffset; i++) {
+        pqwOffset[i] = (QWORD)i * cbRead;
+    }
+    srand(1);
+    for(i = cOffset - 1; i; i--) {
+        j = (DWORD)(rand() % (i + 1));
+        qw = pqwOffset[i]; pqwOffset[i] = pqwOffset[j]; pqwOffset[j] = qw;
+    }
+    tcRandom = Bench_ReadFile(hVMM, cbRead, cOffset, pqwOffset, &cCommandRandom);
+    // 2: sequential reads - pipelined by the read-ahead cache:
+    for(i = 0; i < cOffset; i++) {
+        pqwOffset[i] = (QWORD)i * cbRead;
+    }
+    tcSequential = Bench_ReadFile(hVMM, cbRead, cOffset, pqwOffset, &cCommandSequential);
+    VMMDLL_Close(hVMM);
+    free(pqwOffset);
+    if(!tcRandom || !tcSequential) { return 1; }
+    Bench_PrintResult("shuffled (no read-ahead):", tcRandom, cCommandRandom);
+    Bench_PrintResult("sequential (read-ahead):", tcSequential, cCommandSequential);
+    printf("  speedup: %.1fx\n", (double)tcRandom / tcSequential);
+    return 0;
+}
@@ -159,6 +159,16 @@ public interface IVmmProcess
      */
     public byte[] memRead(long va, int size, int flags);
     
+    /**
+     * Read multiple chunks of memory in one single call with the given flags.
+     * This is more efficient than multiple calls to memRead.
+     * @param vas        virtual addresses to read.
+     * @param sizes        number of bytes to read for each address.
+     * @param flags        flags as specified by IVmm.FLAG_*
+     * @return            array of read data, null entries for chunks not read in full.
+     */
+    public byte[][] memReadMulti(long[] vas, int[] sizes, int flags);
+    
     /**
      * Write data to the memory. NB! writing may fail silently.
      * If important it's recommended to verify a write with a subsequent read. 
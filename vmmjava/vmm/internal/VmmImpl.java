@@ -347,6 +347,32 @@ public class VmmImpl implements IVmm
 	    }
 	}
 	
+	public byte[][] _memReadMulti(int pid, long[] vas, int[] sizes, int flags)
+	{
+		// VMMDLL_MEM_READ_RANGE: dwPID, cb, qwA, oDst, cbRead, _Reserved (32 bytes).
+		if(vas.length != sizes.length) { throw new VmmException("Bad Argument"); }
+		byte[][] result = new byte[vas.length][];
+		if(vas.length == 0) { return result; }
+		long cbArena = 0;
+		Memory pRanges = new Memory(32L * vas.length);
+		pRanges.clear();
+		for(int i = 0; i < vas.length; i++) {
+			pRanges.setInt(i * 32L + 0, pid);
+			pRanges.setInt(i * 32L + 4, sizes[i]);
+			pRanges.setLong(i * 32L + 8, vas[i]);
+			pRanges.setLong(i * 32L + 16, cbArena);
+			cbArena += sizes[i];
+		}
+		Memory pbArena = new Memory(Math.max(1, cbArena));
+		VmmNative.INSTANCE.VMMDLL_MemReadMulti(hVMM, pRanges, vas.length, pbArena, cbArena, flags);
+		for(int i = 0; i < vas.length; i++) {
+			if(pRanges.getInt(i * 32L + 24) == sizes[i]) {
+				result[i] = pbArena.getByteArray(pRanges.getLong(i * 32L + 16), sizes[i]);
+			}
+		}
+		return result;
+	}
+	
 	public void _memWrite(int pid, long va, byte[] data)
 	{
 	    if(jnative == null) {
@@ -402,6 +428,10 @@ public class VmmImpl implements IVmm
 		return _memRead(-1, pa, size, flags);
 	}
 
+	public byte[][] memReadMulti(long[] pas, int[] sizes, int flags) {
+		return _memReadMulti(-1, pas, sizes, flags);
+	}
+
 	public void memWrite(long pa, byte[] data)
 	{
 		_memWrite(-1, pa, data);
@@ -684,6 +714,10 @@ public class VmmImpl implements IVmm
 			return _memRead(pid, va, size, flags);
 		}
 
+		public byte[][] memReadMulti(long[] vas, int[] sizes, int flags) {
+			return _memReadMulti(pid, vas, sizes, flags);
+		}
+
 		public void memWrite(long va, byte[] data) {
 			_memWrite(pid, va, data);
 		}
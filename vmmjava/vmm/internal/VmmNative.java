@@ -83,6 +83,7 @@ interface VmmNative extends Library {
 	
 	
 	boolean VMMDLL_MemReadEx(Pointer hVMM, int dwPID, long qwA, byte[] pb, int cb, IntByReference pcbReadOpt, int flags);
+	int VMMDLL_MemReadMulti(Pointer hVMM, Pointer pRanges, int cRanges, Pointer pbArena, long cbArena, int flags);
 	boolean VMMDLL_MemPrefetchPages(Pointer hVMM, int dwPID, long[] pPrefetchAddresses, int cPrefetchAddresses);
 	boolean VMMDLL_MemWrite(Pointer hVMM, int dwPID, long qwA, byte[] pb, int cb);
 	boolean VMMDLL_MemVirt2Phys(Pointer hVMM, int dwPID, long qwVA, LongByReference pqwPA);
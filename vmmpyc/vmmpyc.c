@@ -64,43 +64,41 @@ PyObject* VmmPyc_MemReadScatter(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ LPSTR
 PyObject* VmmPyc_MemRead_Multi(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ LPSTR szFN, PyObject *args)
 {
     BOOL fResult = FALSE;
-    QWORD flags = 0;
+    QWORD flags = 0, cbArena = 0;
     PyObject *pyListSrc, *pyListItemSrc, *pyLongAddress, *pyLongSize, *pyListResult, *pyBytes;
-    DWORD cItem, iItem, cbMax = 0, cbRead;
-    struct MultiInfo {
-        QWORD qwA;
-        DWORD cb;
-    };
-    struct MultiInfo *pMultiInfo = NULL, *pInfo;
-    VMMDLL_SCATTER_HANDLE hS = NULL;
-    PBYTE pb = NULL;
+    DWORD cItem, iItem;
+    PVMMDLL_MEM_READ_RANGE pRanges = NULL, pr;
+    PBYTE pbArena = NULL;
     if(!PyArg_ParseTuple(args, "O!|K", &PyList_Type, &pyListSrc, &flags)) {     // borrowed reference
         return PyErr_Format(PyExc_RuntimeError, "%s: Illegal argument.", szFN);
     }
     cItem = (DWORD)PyList_Size(pyListSrc);
-    pMultiInfo = LocalAlloc(LMEM_ZEROINIT, cItem * sizeof(struct MultiInfo));
-    hS = VMMDLL_Scatter_Initialize(H, dwPID, (DWORD)flags);
+    pRanges = LocalAlloc(LMEM_ZEROINIT, cItem * sizeof(VMMDLL_MEM_READ_RANGE));
     pyListResult = PyList_New(0);
-    if(!pMultiInfo || !hS || !pyListResult) { goto fail; }
+    if(!pRanges || !pyListResult) { goto fail; }
     for(iItem = 0; iItem < cItem; iItem++) {
-        pInfo = pMultiInfo + iItem;
+        pr = pRanges + iItem;
         pyListItemSrc = PyList_GetItem(pyListSrc, iItem);           // borrowed reference
         if(!pyListItemSrc || !PyList_Check(pyListItemSrc)) { goto fail; }
         pyLongAddress = PyList_GetItem(pyListItemSrc, 0);           // borrowed reference
         pyLongSize = PyList_GetItem(pyListItemSrc, 1);              // borrowed reference
         if(!pyLongAddress || !pyLongSize || !PyLong_Check(pyLongAddress) || !PyLong_Check(pyLongSize)) { goto fail; }
-        pInfo->qwA = PyLong_AsUnsignedLongLong(pyLongAddress);
-        pInfo->cb = PyLong_AsUnsignedLong(pyLongSize);
-        if((pInfo->qwA == (DWORD)-1) || (pInfo->cb == (DWORD)-1)) { goto fail; }
-        cbMax = max(cbMax, pInfo->cb);
-        VMMDLL_Scatter_Prepare(hS, pInfo->qwA, pInfo->cb);
+        pr->dwPID = dwPID;
+        pr->qwA = PyLong_AsUnsignedLongLong(pyLongAddress);
+        pr->cb = PyLong_AsUnsignedLong(pyLongSize);
+        if((pr->qwA == (DWORD)-1) || (pr->cb == (DWORD)-1)) { goto fail; }
+        pr->oDst = cbArena;
+        cbArena += pr->cb;
+    }
+    if(cbArena && !(pbArena = LocalAlloc(0, (SIZE_T)cbArena))) { goto fail; }
+    if(cItem) {
+        Py_BEGIN_ALLOW_THREADS;
+        VMMDLL_MemReadMulti(H, pRanges, cItem, pbArena, cbArena, (DWORD)flags);
+        Py_END_ALLOW_THREADS;
     }
-    VMMDLL_Scatter_ExecuteRead(hS);
-    pb = LocalAlloc(0, cbMax);
-    if(!pb) { goto fail; }
     for(iItem = 0; iItem < cItem; iItem++) {
-        pInfo = pMultiInfo + iItem;
-        if(VMMDLL_Scatter_Read(hS, pInfo->qwA, pInfo->cb, pb, &cbRead) && (pInfo->cb == cbRead) && (pyBytes = PyBytes_FromStringAndSize((const char*)pb, cbRead))) {
+        pr = pRanges + iItem;
+        if((pr->cb == pr->cbRead) && (pyBytes = PyBytes_FromStringAndSize((const char*)(pbArena + pr->oDst), pr->cbRead))) {
             PyList_Append_DECREF(pyListResult, pyBytes);
         } else {
             PyList_Append(pyListResult, Py_None);
@@ -108,9 +106,8 @@ PyObject* VmmPyc_MemRead_Multi(_In_ VMM_HANDLE H, _In_ DWORD dwPID, _In_ LPSTR s
     }
     fResult = TRUE;
 fail:
-    LocalFree(pb);
-    LocalFree(pMultiInfo);
-    VMMDLL_Scatter_CloseHandle(hS);
+    LocalFree(pbArena);
+    LocalFree(pRanges);
     if(!fResult) {
         Py_XDECREF(pyListResult);
         PyErr_Format(PyExc_RuntimeError, "%s: Failed.", szFN);
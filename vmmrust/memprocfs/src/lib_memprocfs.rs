@@ -1033,6 +1033,36 @@ impl Vmm<'_> {
         return self.impl_mem_read_into(u32::MAX, pa, flags, data);
     }
 
+    /// Read multiple physical memory chunks with flags in one single call.
+    /// 
+    /// Flags are constants named `FLAG_*`
+    /// 
+    /// All ranges are read in one merged scatter operation by MemProcFS. This
+    /// is more efficient than multiple calls to `mem_read_ex()` when reading
+    /// many smaller structures.
+    /// 
+    /// Result is a vector of (data, bytes_read) tuples in the same order as
+    /// the requested ranges. Unread bytes in data are zero-padded.
+    /// 
+    /// 
+    /// # Arguments
+    /// * `ranges` - Vector of (physical address, size) tuples to read.
+    /// * `flags` - Any combination of `FLAG_*`.
+    /// 
+    /// # Examples
+    /// ```
+    /// // Read 0x100 bytes at 0x1000 and 0x20 bytes at 0x5000.
+    /// if let Ok(data_read) = vmm.mem_read_multi(&[(0x1000, 0x100), (0x5000, 0x20)], 0) {
+    ///     for (data, bytes_read) in data_read {
+    ///         println!("bytes_read: {bytes_read} {:?}", data.hex_dump());
+    ///     }
+    /// }
+    /// ```
+    pub fn mem_read_multi(&self, ranges : &[(u64, usize)], flags : u64) -> ResultEx<Vec<(Vec<u8>, usize)>> {
+        let ranges_pid = ranges.iter().map(|r| (u32::MAX, r.0, r.1)).collect::<Vec<_>>();
+        return self.impl_mem_read_multi(&ranges_pid, flags);
+    }
+
     /// Read a contigious physical memory chunk with flags as a type/struct.
     /// 
     /// Flags are constants named `FLAG_*`
@@ -2750,6 +2780,36 @@ impl VmmProcess<'_> {
         return self.vmm.impl_mem_read_into(self.pid, va, flags, data);
     }
 
+    /// Read multiple virtual memory chunks with flags in one single call.
+    /// 
+    /// Flags are constants named `FLAG_*`
+    /// 
+    /// All ranges are read in one merged scatter operation by MemProcFS. This
+    /// is more efficient than multiple calls to `mem_read_ex()` when reading
+    /// many smaller structures.
+    /// 
+    /// Result is a vector of (data, bytes_read) tuples in the same order as
+    /// the requested ranges. Unread bytes in data are zero-padded.
+    /// 
+    /// 
+    /// # Arguments
+    /// * `ranges` - Vector of (virtual address, size) tuples to read.
+    /// * `flags` - Any combination of `FLAG_*`.
+    /// 
+    /// # Examples
+    /// ```
+    /// // Read the first 0x40 bytes of kernel32 and ntdll.
+    /// if let Ok(data_read) = vmmprocess.mem_read_multi(&[(va_kernel32, 0x40), (va_ntdll, 0x40)], 0) {
+    ///     for (data, bytes_read) in data_read {
+    ///         println!("bytes_read: {bytes_read} {:?}", data.hex_dump());
+    ///     }
+    /// }
+    /// ```
+    pub fn mem_read_multi(&self, ranges : &[(u64, usize)], flags : u64) -> ResultEx<Vec<(Vec<u8>, usize)>> {
+        let ranges_pid = ranges.iter().map(|r| (self.pid, r.0, r.1)).collect::<Vec<_>>();
+        return self.vmm.impl_mem_read_multi(&ranges_pid, flags);
+    }
+
     /// Read a contigious virtual memory chunk with flags as a type/struct.
     /// 
     /// Flags are constants named `FLAG_*`
@@ -4594,6 +4654,7 @@ struct VmmNative {
     VMMDLL_YaraSearch :             extern "C" fn(hVMM : usize, pid : u32, ctx : *mut CVMMDLL_YARA_CONFIG, ppva : *mut u64, pcva : *mut u32) -> bool,
 
     VMMDLL_MemReadEx :              extern "C" fn(hVMM : usize, pid : u32, qwA : u64, pb : *mut u8, cb : u32, pcbReadOpt : *mut u32, flags : u64) -> bool,
+    VMMDLL_MemReadMulti :           extern "C" fn(hVMM : usize, pRanges : *mut CVMMDLL_MEM_READ_RANGE, cRanges : u32, pbArena : *mut u8, cbArena : u64, flags : u32) -> u32,
     VMMDLL_MemWrite :               extern "C" fn(hVMM : usize, pid : u32, qwA : u64, pb : *const u8, cb : u32) -> bool,
     VMMDLL_MemVirt2Phys :           extern "C" fn(hVMM : usize, pid : u32, qwA : u64, pqwPA : *mut u64) -> bool,
 
@@ -4693,6 +4754,7 @@ fn impl_new<'a>(vmm_lib_path : &str, lc_existing_opt : Option<&LeechCore>, h_vmm
         let VMMDLL_MemSearch = *lib.get(b"VMMDLL_MemSearch")?;
         let VMMDLL_YaraSearch = *lib.get(b"VMMDLL_YaraSearch")?;
         let VMMDLL_MemReadEx = *lib.get(b"VMMDLL_MemReadEx")?;
+        let VMMDLL_MemReadMulti = *lib.get(b"VMMDLL_MemReadMulti")?;
         let VMMDLL_MemWrite = *lib.get(b"VMMDLL_MemWrite")?;
         let VMMDLL_MemVirt2Phys = *lib.get(b"VMMDLL_MemVirt2Phys")?;
         let VMMDLL_Scatter_Initialize = *lib.get(b"VMMDLL_Scatter_Initialize")?;
@@ -4790,6 +4852,7 @@ fn impl_new<'a>(vmm_lib_path : &str, lc_existing_opt : Option<&LeechCore>, h_vmm
             VMMDLL_MemSearch,
             VMMDLL_YaraSearch,
             VMMDLL_MemReadEx,
+            VMMDLL_MemReadMulti,
             VMMDLL_MemWrite,
             VMMDLL_MemVirt2Phys,
             VMMDLL_Scatter_Initialize,
@@ -6052,6 +6115,35 @@ impl Vmm<'_> {
         return Ok(cb_read as usize);
     }
 
+    fn impl_mem_read_multi(&self, ranges : &[(u32, u64, usize)], flags : u64) -> ResultEx<Vec<(Vec<u8>, usize)>> {
+        let flags = u32::try_from(flags)?;
+        let c_ranges = u32::try_from(ranges.len())?;
+        let mut cb_arena : u64 = 0;
+        let mut native_ranges = Vec::with_capacity(ranges.len());
+        for r in ranges {
+            let cb = u32::try_from(r.2)?;
+            native_ranges.push(CVMMDLL_MEM_READ_RANGE {
+                dwPID : r.0,
+                cb : cb,
+                qwA : r.1,
+                oDst : cb_arena,
+                cbRead : 0,
+                _Reserved : 0,
+            });
+            cb_arena += cb as u64;
+        }
+        let mut pb_arena = vec![0u8; usize::try_from(cb_arena)?];
+        if c_ranges > 0 {
+            let _r = (self.native.VMMDLL_MemReadMulti)(self.native.h, native_ranges.as_mut_ptr(), c_ranges, pb_arena.as_mut_ptr(), cb_arena, flags);
+        }
+        let mut result = Vec::with_capacity(ranges.len());
+        for r in &native_ranges {
+            let o = r.oDst as usize;
+            result.push((pb_arena[o..o + r.cb as usize].to_vec(), r.cbRead as usize));
+        }
+        return Ok(result);
+    }
+
     fn impl_mem_read_as<T>(&self, pid : u32, va : u64, flags : u64) -> ResultEx<T> {
         unsafe {
             let cb = u32::try_from(std::mem::size_of::<T>())?;
@@ -8020,6 +8112,18 @@ impl fmt::Display for VmmSearchResult {
     }
 }
 
+#[repr(C)]
+#[allow(non_snake_case, non_camel_case_types)]
+#[derive(Debug, Default)]
+struct CVMMDLL_MEM_READ_RANGE {
+    dwPID : u32,
+    cb : u32,
+    qwA : u64,
+    oDst : u64,
+    cbRead : u32,
+    _Reserved : u32,
+}
+
 /// Maximum number of supported search terms.
 const CVMMDLL_MEM_SEARCH_CONTEXT_SEARCHENTRY_MAX : usize = 0x00100000;
 
@@ -147,6 +147,17 @@ namespace Vmmsharp.Internal
             internal ulong h;
         }
 
+        [System.Runtime.InteropServices.StructLayoutAttribute(System.Runtime.InteropServices.LayoutKind.Sequential)]
+        internal struct VMMDLL_MEM_READ_RANGE
+        {
+            internal uint dwPID;
+            internal uint cb;
+            internal ulong qwA;
+            internal ulong oDst;
+            internal uint cbRead;
+            internal uint _Reserved;
+        }
+
         internal const ulong VMMDLL_PROCESS_INFORMATION_MAGIC = 0xc0ffee663df9301e;
         internal const ushort VMMDLL_PROCESS_INFORMATION_VERSION = 7;
 
@@ -1027,6 +1038,15 @@ namespace Vmmsharp.Internal
             out uint pcbReadOpt,
             uint flags);
 
+        [LibraryImport("vmm", EntryPoint = "VMMDLL_MemReadMulti")]
+        internal static unsafe partial uint VMMDLL_MemReadMulti(
+            IntPtr hVMM,
+            VMMDLL_MEM_READ_RANGE* pRanges,
+            uint cRanges,
+            byte* pbArena,
+            ulong cbArena,
+            uint flags);
+
         [LibraryImport("vmm", EntryPoint = "VMMDLL_MemPrefetchPages")]
         [return: MarshalAs(UnmanagedType.Bool)]
         internal static unsafe partial bool VMMDLL_MemPrefetchPages(
@@ -1592,6 +1612,15 @@ namespace Vmmsharp.Internal
             out uint pcbReadOpt,
             uint flags);
 
+        [DllImport("vmm", EntryPoint = "VMMDLL_MemReadMulti")]
+        internal static extern unsafe uint VMMDLL_MemReadMulti(
+            IntPtr hVMM,
+            VMMDLL_MEM_READ_RANGE* pRanges,
+            uint cRanges,
+            byte* pbArena,
+            ulong cbArena,
+            uint flags);
+
         [DllImport("vmm", EntryPoint = "VMMDLL_MemPrefetchPages")]
         internal static extern unsafe bool VMMDLL_MemPrefetchPages(
             IntPtr hVMM,
@@ -2168,6 +2197,39 @@ namespace Vmmsharp.Internal
             return result;
         }
 
+        internal static unsafe byte[][] MemReadMulti(IntPtr hVMM, uint pid, ulong[] qwA, uint[] cb, uint flags = 0)
+        {
+            if (qwA.Length != cb.Length)
+                throw new ArgumentException("qwA and cb must be of equal length.");
+            var result = new byte[qwA.Length][];
+            if (qwA.Length == 0)
+                return result;
+            ulong cbArena = 0;
+            var ranges = new VMMDLL_MEM_READ_RANGE[qwA.Length];
+            for (int i = 0; i < qwA.Length; i++)
+            {
+                ranges[i].dwPID = pid;
+                ranges[i].cb = cb[i];
+                ranges[i].qwA = qwA[i];
+                ranges[i].oDst = cbArena;
+                cbArena += cb[i];
+            }
+            byte[] arena = new byte[cbArena];
+            fixed (VMMDLL_MEM_READ_RANGE* pRanges = ranges)
+            fixed (byte* pbArena = arena)
+            {
+                Vmmi.VMMDLL_MemReadMulti(hVMM, pRanges, (uint)ranges.Length, pbArena, cbArena, flags);
+            }
+            for (int i = 0; i < ranges.Length; i++)
+            {
+                if (ranges[i].cbRead != ranges[i].cb)
+                    continue;
+                result[i] = new byte[ranges[i].cb];
+                System.Buffer.BlockCopy(arena, (int)ranges[i].oDst, result[i], 0, (int)ranges[i].cb);
+            }
+            return result;
+        }
+
         internal static unsafe bool MemPrefetchPages(IntPtr hVMM, uint pid, ulong[] qwA)
         {
             byte[] data = new byte[qwA.Length * sizeof(ulong)];
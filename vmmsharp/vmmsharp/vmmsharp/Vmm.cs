@@ -491,6 +491,18 @@ namespace Vmmsharp
             uint flags = 0, bool terminateOnNullChar = true) =>
             Vmmi.MemReadString(hVMM, encoding, PID_PHYSICALMEMORY, pa, cb, flags, terminateOnNullChar);
 
+        /// <summary>
+        /// Read Memory from multiple Physical Addresses in one single call.
+        /// All ranges are read in one merged scatter operation.
+        /// </summary>
+        /// <param name="pa">An array of the physical addresses to read from.</param>
+        /// <param name="cb">An array of the count of bytes to read for each address.</param>
+        /// <param name="flags">VMM Flags.</param>
+        /// <returns>Array of managed byte arrays. NULL entries for ranges not read in full.</returns>
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public unsafe byte[][] MemReadMulti(ulong[] pa, uint[] cb, uint flags = 0) =>
+            Vmmi.MemReadMulti(hVMM, PID_PHYSICALMEMORY, pa, cb, flags);
+
         /// <summary>
         /// Prefetch pages into the MemProcFS internal cache.
         /// </summary>
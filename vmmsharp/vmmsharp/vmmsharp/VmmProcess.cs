@@ -284,6 +284,18 @@ namespace Vmmsharp
             uint flags = 0, bool terminateOnNullChar = true) =>
             Vmmi.MemReadString(_hVmm, encoding, this.PID, va, cb, flags, terminateOnNullChar);
 
+        /// <summary>
+        /// Read Memory from multiple Virtual Addresses in one single call.
+        /// All ranges are read in one merged scatter operation.
+        /// </summary>
+        /// <param name="va">An array of the virtual addresses to read from.</param>
+        /// <param name="cb">An array of the count of bytes to read for each address.</param>
+        /// <param name="flags">VMM Flags.</param>
+        /// <returns>Array of managed byte arrays. NULL entries for ranges not read in full.</returns>
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public unsafe byte[][] MemReadMulti(ulong[] va, uint[] cb, uint flags = 0) =>
+            Vmmi.MemReadMulti(_hVmm, this.PID, va, cb, flags);
+
         /// <summary>
         /// Prefetch pages into the MemProcFS internal cache.
         /// </summary>